@@ -223,6 +223,8 @@ public:
     AIS_Target_Data();
     ~AIS_Target_Data();
 
+    AIS_Target_Data *Clone(void);
+
     wxString BuildQueryResult(void);
     wxString GetRolloverString(void);
     wxString Get_vessel_type_string(bool b_short = false);
@@ -303,6 +305,10 @@ public:
     AISTargetTrackList        *m_ptrack;
 
     AIS_Area_Notice_Hash     area_notices;
+
+    //      Snapshot bookkeeping
+    bool                      b_changed;                // working copy: modified since last published
+    volatile long             m_nRefs;                  // published copy: snapshots holding it
 };
 
 WX_DEFINE_SORTED_ARRAY(AIS_Target_Data *, ArrayOfAISTarget);
@@ -310,11 +316,17 @@ WX_DEFINE_SORTED_ARRAY_INT(int, ArrayOfMMSI);
 
 
 #define AIS_MAX_MESSAGE_LEN (10 * 82)           // AIS Spec allows up to 9 sentences per message, 82 bytes each
+
+//    The payload is held as big-endian 64 bit words, plus one zero pad word so that
+//    a field straddling the last word never reads outside the array
+#define AIS_MAX_MESSAGE_WORDS (((AIS_MAX_MESSAGE_LEN * 6) + 63) / 64 + 1)
+
 class AIS_Bitstring
 {
 public:
 
     AIS_Bitstring(const char *str);
+    AIS_Bitstring(const char *str, int len);
     unsigned char to_6bit(const char c);
 
     /// sp is starting bit, 1-based
@@ -324,8 +336,9 @@ public:
 
 
 private:
+    void Init(const char *str, int len);
 
-    unsigned char bitbytes[AIS_MAX_MESSAGE_LEN];
+    wxUint64 m_words[AIS_MAX_MESSAGE_WORDS];
     int byte_length;
 };
 
@@ -337,15 +350,37 @@ private:
 WX_DECLARE_HASH_MAP( int, AIS_Target_Data*, wxIntegerHash, wxIntegerEqual, AIS_Target_Hash );
 
 
+//      A published copy of the AIS target table
+//      Built by the AIS worker thread, then owned and read only by the UI thread.
+//      The target records are reference counted copies, shared with the previous
+//      snapshot for targets that did not change in between.
+class AIS_Target_Snapshot
+{
+public:
+      AIS_Target_Snapshot();
+      ~AIS_Target_Snapshot();
+
+      AIS_Target_Hash   *m_pTargets;
+      bool              m_bGeneralAlert;
+      wxArrayInt        m_SART_alerts;            // MMSIs of active SARTs heard since the previous snapshot
+      wxArrayInt        m_changed;                // MMSIs with a new record since the previous snapshot
+      wxArrayInt        m_removed;                // MMSIs dropped since the previous snapshot
+};
+
+
 
 #define AIS_SOCKET_ID             7
 
 enum
 {
     EVT_AIS_DIRECT,
-    EVT_AIS_PARSE_RX
+    EVT_AIS_PARSE_RX,
+    EVT_AIS_SNAPSHOT
 };
 
+#define AIS_SNAPSHOT_MSEC         500           // minimum interval between published snapshots
+#define AIS_POSN_RING             8             // AIVDO ownship fixes in flight to the main thread
+
 //----------------------------------------------------------------------------
 // AISEvent
 //----------------------------------------------------------------------------
@@ -390,8 +425,12 @@ extern /*expdecl*/ const wxEventType wxEVT_OCPN_AIS;
 //
 //---------------------------------------------------------------------------------
 
+class OCP_AIS_Worker;
+class NMEASentenceQueue;
+
 class AIS_Decoder : public wxEvtHandler
 {
+    friend class OCP_AIS_Worker;
 
 public:
     AIS_Decoder(void);
@@ -402,15 +441,20 @@ public:
 
     void OnEvtAIS(OCPN_AISEvent& event);
     AIS_Error Decode(const wxString& str);
+    AIS_Error Decode(const char *str);
     void Pause(void);
     void UnPause(void);
     void GetSource(wxString& source);
     AIS_Target_Hash *GetTargetList(void) {return AISTargetList;}
     AIS_Target_Data *Get_Target_Data_From_MMSI(int mmsi);
-    int GetNumTargets(void){ return m_n_targets;}
+    int GetNumTargets(void){ return AISTargetList->size();}
     bool IsAISSuppressed(void){ return m_bSuppressed; }
     bool IsAISAlertGeneral(void) { return m_bGeneralAlert; }
 
+    //    Alert dialog actions, applied to the published target and forwarded to the worker
+    void AcknowledgeTarget(int mmsi);
+    void SilenceTarget(int mmsi);
+
     int             m_Thread_run_flag;
 
 private:
@@ -421,17 +465,53 @@ private:
     void OnTimerAISAudio(wxTimerEvent& event);
 
     bool NMEACheckSumOK(const wxString& str);
+    bool NMEACheckSumOK(const char *str);
     bool Parse_VDXBitstring(AIS_Bitstring *bstr, AIS_Target_Data *ptd);
     void UpdateAllCPA(void);
     void UpdateOneCPA(AIS_Target_Data *ptarget);
     void UpdateAllAlarms(void);
     void UpdateAllTracks(void);
     void UpdateOneTrack(AIS_Target_Data *ptarget);
+    void UpdateOneAlarm(AIS_Target_Data *ptarget);
+    void ScrubTargets(void);
     void Parse_And_Send_Posn(wxString &str_temp_buf);
+
+    //    Worker thread side
+    void WorkerProcess(void);
+    void WorkerSendOwnship(void);
+    void PublishSnapshot(void);
+
+    //    UI thread side
+    void AdoptSnapshot(void);
     void ThreadMessage(const wxString &msg);
     void BuildERIShipTypeHash(void);
 
-    AIS_Target_Hash *AISTargetList;
+    AIS_Target_Hash *AISTargetList;               // the published snapshot, UI thread only
+
+    //    AIS worker thread, and the state it owns
+    OCP_AIS_Worker    *m_pWorker;
+    volatile int      m_Worker_run_flag;
+    NMEASentenceQueue *m_pInputQueue;               // UI thread -> worker
+    wxSemaphore       *m_pWorkerSemaphore;
+    AIS_Target_Hash   *m_pWorkTargets;
+    AIS_Target_Hash   *m_pPublishedTargets;           // latest published record of each target, not owned
+    wxArrayInt        m_SART_pending;
+    bool              m_bWorkDirty;
+    bool              m_bWorkGeneralAlert;
+    wxLongLong        m_last_tick_ms;
+    wxLongLong        m_last_publish_ms;
+    double            m_cpa_lat, m_cpa_lon, m_cpa_cog, m_cpa_sog;
+    bool              m_cpa_bGPSValid;
+    int               m_posn_ring_index;
+
+    //    Hand-off between the UI thread and the worker, guarded by m_WorkerMutex
+    wxMutex           m_WorkerMutex;
+    AIS_Target_Snapshot *m_pPendingSnapshot;
+    AIS_Target_Snapshot *m_pSnapshot;
+    wxArrayInt        m_AckRequests;
+    wxArrayInt        m_SilenceRequests;
+    double            m_own_lat, m_own_lon, m_own_cog, m_own_sog;
+    bool              m_own_bGPSValid;
 
 #ifndef OCPN_NO_SOCKETS
     wxIPV4address     addr;
@@ -447,7 +527,8 @@ private:
 
     int               nsentences;
     int               isentence;
-    wxString          sentence_accumulator;
+    char              sentence_accumulator[AIS_MAX_MESSAGE_LEN + 1];
+    int               accumulator_length;
     bool              m_OK;
 
     AIS_Target_Data   *m_pLatestTargetData;
@@ -523,6 +604,29 @@ private:
 };
 
 
+
+//-------------------------------------------------------------------------------------------------------------
+//
+//    AIS Worker Thread
+//
+//    This thread owns the working AIS target table.  It decodes queued sentences, maintains
+//    CPA/TCPA, alarms and tracks, and publishes snapshots of the table to the UI thread.
+//
+//-------------------------------------------------------------------------------------------------------------
+
+class OCP_AIS_Worker: public wxThread
+{
+
+public:
+
+      OCP_AIS_Worker(AIS_Decoder *pDecoder);
+      void *Entry();
+
+private:
+      AIS_Decoder             *m_pDecoder;
+};
+
+
 class AISInfoWin;
 //----------------------------------------------------------------------------------------------------------
 //    AISTargetAlertDialog Specification
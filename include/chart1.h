@@ -212,9 +212,12 @@ class MyFrame: public wxFrame
     void OnMove(wxMoveEvent& event);
     void OnFrameTimer1(wxTimerEvent& event);
     bool DoChartUpdate(void);
+    void DoChartPrefetch(void);
     void OnEvtNMEA(wxCommandEvent& event);
     void OnEvtTHREADMSG(wxCommandEvent& event);
     void OnEvtOCPN_NMEA(OCPN_NMEAEvent & event);
+    void OnEvtOCPN_NMEA_QUEUE(wxCommandEvent & event);
+    void ProcessNMEASentence(wxString &str_buf, bool b_navigate);
     void OnMemFootTimer(wxTimerEvent& event);
 
     void UpdateAllFonts(void);
@@ -39,6 +39,8 @@
 #include "wx/dir.h"
 #include "wx/filename.h"
 #include <wx/xml/xml.h>
+#include <wx/hashmap.h>
+#include <wx/thread.h>
 
 #include "chartbase.h"
 #include "chartdbs.h"
@@ -62,6 +64,7 @@ typedef struct  {
 //    Fwd Declarations
 // ----------------------------------------------------------------------------
 class ChartBase;
+class s57chart;
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
@@ -91,11 +94,15 @@ class CacheEntry
 public:
       wxString    FullPath;
       void        *pChart;
-      int         RecentTime;
+      int         RecentTime;             // cache access count at last use, strictly increasing
       int         dbIndex;
-      bool        b_in_use;
+      bool        b_in_use;               // pinned, e.g. a member of the current quilt
+      CacheEntry  *pLRUPrev;              // toward least recently used
+      CacheEntry  *pLRUNext;              // toward most recently used
 };
 
+WX_DECLARE_HASH_MAP( int, CacheEntry*, wxIntegerHash, wxIntegerEqual, ChartCacheHash );
+
 
 
 // ----------------------------------------------------------------------------
@@ -146,6 +153,10 @@ public:
 
       void ClearCacheInUseFlags(void);
       void PurgeCacheUnusedCharts(bool b_force = false);
+      bool IsCacheFull(void);
+      int  PrefetchCharts(float lat, float lon, ChartFamilyEnum family, int max_open);
+
+      void SetPrefetchDone(InitReturn ir);
 
 protected:
       virtual ChartBase *GetChart(const wxChar *theFilePath, ChartClassDescriptor &chart_desc) const;
@@ -158,11 +169,55 @@ private:
       bool CheckPositionWithinChart(int index, float lat, float lon);
       ChartBase *OpenChartUsingCache(int dbindex, ChartInitFlag init_flag);
 
+      CacheEntry *FindCacheEntry(int dbindex);
+      void AddCacheEntry(CacheEntry *pce);
+      void TouchCacheEntry(CacheEntry *pce);
+      void RemoveCacheEntry(CacheEntry *pce);
+      CacheEntry *GetCacheEvictionCandidate(void);
+      void EvictCacheEntry(CacheEntry *pce);
+
+      bool StartPrefetch(int dbindex);
+      bool IsPrefetchDone(void);
+      void FinishPrefetch(bool b_wait);
+      void AbandonPrefetch(void);
+
       wxArrayPtrVoid    *pChartCache;
+      ChartCacheHash    m_CacheHash;            // dbIndex -> CacheEntry
+      CacheEntry        *m_pLRUOldest;
+      CacheEntry        *m_pLRUNewest;
+      int               m_cache_access_count;
 
       MyFrame           *pParent;
       bool              m_b_locked;
+      int               m_nOpenDepth;           // >0 while a chart Init() is in progress
 
+      //    S57 chart loading on the prefetch worker, owned by the worker until it is done
+      s57chart          *m_pPrefetchChart;
+      int               m_prefetch_dbindex;
+      wxString          m_PrefetchPath;
+      wxMutex           m_PrefetchMutex;        // guards the two below
+      bool              m_b_prefetch_done;
+      InitReturn        m_prefetch_result;
+
+      ChartPathHash     m_PrefetchFailures;     // charts which failed to prefetch, skipped for the session
+
+};
+
+
+//----------------------------------------------------------------------------
+//    Chart prefetch worker
+//    Does the GDI free part of an S57 chart full init, see s57chart::LoadInit()
+//----------------------------------------------------------------------------
+class ChartPrefetchThread: public wxThread
+{
+public:
+      ChartPrefetchThread(ChartDB *pDB, s57chart *pChart, const wxChar *pPath);
+      void *Entry();
+
+private:
+      ChartDB           *m_pDB;
+      s57chart          *m_pChart;
+      const wxChar      *m_pPath;               // kept by ChartDB until the worker is done
 };
 
 
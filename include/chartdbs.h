@@ -30,6 +30,7 @@
 #define __CHARTDBS_H__
 
 #include "wx/dynarray.h"
+#include "wx/hashmap.h"
 #include "wx/file.h"
 #include "wx/stream.h"
 #include "wx/wfstream.h"
@@ -46,6 +47,12 @@ class wxProgressDialog;
 static const int DB_VERSION_PREVIOUS = 15;
 static const int DB_VERSION_CURRENT = 16;
 
+//    Coarse lat/lon grid used to find candidate charts for a position
+//    without walking the whole chart table
+static const int DB_INDEX_CELL_DEG = 5;
+static const int DB_INDEX_NLAT = 180 / DB_INDEX_CELL_DEG;
+static const int DB_INDEX_NLON = 360 / DB_INDEX_CELL_DEG;
+
 class ChartDatabase;
 class ChartGroupArray;
 
@@ -215,6 +222,7 @@ public:
 ///////////////////////////////////////////////////////////////////////
 
 WX_DECLARE_OBJARRAY(ChartTableEntry, ChartTable);
+WX_DECLARE_STRING_HASH_MAP(int, ChartPathHash);
 WX_DECLARE_OBJARRAY(ChartClassDescriptor, ArrayOfChartClassDescriptor);
 
 class ChartDatabase
@@ -257,6 +265,7 @@ public:
     int FinddbIndex(wxString PathToFind);
     wxString GetDBChartFileName(int dbIndex);
     void ApplyGroupArray(ChartGroupArray *pGroupArray);
+    const ArrayOfInts &GetIndexCandidates(float lat, float lon) const;
 
 protected:
     virtual ChartBase *GetChart(const wxChar *theFilePath, ChartClassDescriptor &chart_desc) const;
@@ -277,6 +286,8 @@ private:
 
     bool Check_CM93_Structure(wxString dir_name);
 
+    void BuildSpatialIndex(void);
+
     bool          bValid;
     wxArrayString m_chartDirs;
     int           m_dbversion;
@@ -285,6 +296,7 @@ private:
     ChartTableEntry           m_ChartTableEntryDummy;   // used for return value if database is not valid
     wxString      m_DBFileName;
 
+    ArrayOfInts   m_SpatialIndex[DB_INDEX_NLAT * DB_INDEX_NLON];    // dbIndex lists, ascending, per grid cell
 };
 
 
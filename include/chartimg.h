@@ -220,11 +220,22 @@ protected:
 
       virtual wxBitmap *CreateThumbnail(int tnx, int tny, ColorScheme cs);
       virtual int BSBGetScanline( unsigned char *pLineBuf, int y, int xs, int xl, int sub_samp);
+      void PrefetchCompressedBand(int y0, int y1);
 
 
       bool GetViewUsingCache( wxRect& source, wxRect& dest, const wxRegion& Region, ScaleTypeEnum scale_type );
       bool GetView( wxRect& source, wxRect& dest, ScaleTypeEnum scale_type );
 
+      void InitTileCache(void);
+      bool MakeTileCacheDir(void);
+      bool LoadLineIndex(void);
+      bool SaveLineIndex(void);
+      bool GetTiledData(unsigned char *ppn, wxRect& source, wxRect& dest, int dest_stride,
+                        int factor, ScaleTypeEnum scale_type);
+      wxString GetTileFileName(int factor, ScaleTypeEnum scale_type, int tx, int ty);
+      bool LoadTile(const wxString& file, int factor, ScaleTypeEnum scale_type, unsigned char *pTile);
+      bool SaveTile(const wxString& file, int factor, ScaleTypeEnum scale_type, unsigned char *pTile);
+
 
       virtual int BSBScanScanline(wxInputStream *pinStream);
       virtual int ReadBSBHdrLine( wxFileInputStream*, char *, int );
@@ -289,6 +300,13 @@ protected:
       unsigned char     *ifs_lp;
       int               ifs_file_offset;
       int               nFileOffsetDataStart;
+
+      unsigned char     *m_pBandBuf;            // raw compressed data of rows m_band_y0..m_band_y1-1
+      int               m_BandBufSize;
+      int               m_band_y0;
+      int               m_band_y1;
+      int               m_band_file_offset;     // file offset of m_pBandBuf[0]
+      unsigned char     *m_pLineScratch;        // line expansion buffer used when the line cache is off
       int               m_nLineOffset;
 
       GeoRef            cPoints;
@@ -330,6 +348,12 @@ protected:
 
       int       m_b_cdebug;
 
+      bool      m_b_tilecache;          // on-disk cache of downsampled views enabled
+      wxString  m_TileCacheDir;         // per chart tile directory, empty if unusable
+      int       m_tile_key_mtime;       // bitmap file signature written to each tile and the line index
+      int       m_tile_key_size;
+      unsigned char *m_pTileBuf;        // one tile of decoded pixels
+
       double    m_proj_lat, m_proj_lon;
 
       ViewPort  m_vp_render_last;
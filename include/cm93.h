@@ -334,6 +334,8 @@ class cm93chart : public s57chart
             void SetVPParms(const ViewPort &vpt);
             void GetPointPix(ObjRazRules *rzRules, float northing, float easting, wxPoint *r);
             void GetPointPix(ObjRazRules *rzRules, wxPoint2DDouble *en, wxPoint *r, int nPoints);
+            //    Edges are projected per object, so cannot be retained per edge
+            wxPoint *GetEdgePix(VE_Element *pedge, int *pnPoints){ return NULL; }
             void GetPixPoint(int pixx, int pixy, double *plat, double *plon, ViewPort *vpt);
 
             void SetCM93Dict(cm93_dictionary *pDict){m_pDict = pDict;}
@@ -452,6 +454,7 @@ class cm93compchart : public s57chart
             bool RenderNextSmallerCellOutlines( ocpnDC &dc, ViewPort& vp);
 
             void GetPointPix(ObjRazRules *rzRules, float rlat, float rlon, wxPoint *r);
+            wxPoint *GetEdgePix(VE_Element *pedge, int *pnPoints){ return NULL; }
             void GetPixPoint(int pixx, int pixy, double *plat, double *plon, ViewPort *vpt);
             void GetPointPix(ObjRazRules *rzRules, wxPoint2DDouble *en, wxPoint *r, int nPoints);
 
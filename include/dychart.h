@@ -48,6 +48,8 @@
 
 #define CACHE_MEM_LIMIT_DEFAULT 0       // Application memory useage target, kBytes
 
+#define RASTER_TILE_CACHE_LIMIT_DEFAULT 256     // On-disk raster tile cache size target, MBytes
+
 
 
 //          If defined, update the system time using GPS receiver data.
@@ -218,4 +218,80 @@ private:
       GpxExtensionsElement *my_extensions;
 };
 
+//    Streaming access to GPX files, without a DOM of the whole file.
+//    The reader walks the element tree one child at a time, a child may be
+//    entered (start tag only) or read whole as a small detached element.
+//    Anything it cannot handle, such as a non UTF-8 file, is reported by HasError(),
+//    so the caller can fall back to GpxDocument.
+#define GPX_STREAM_BUFFER_SIZE      65536
+
+class GpxStreamReader
+{
+public:
+      GpxStreamReader();
+      ~GpxStreamReader();
+
+      bool Open(const wxString &filename);
+      void Close(void);
+      bool HasError(void){ return m_bError; }
+
+      //    Find the next child element of the current element, false at its end
+      bool NextChild(wxString &name);
+      //    The element returned belongs to the reader, and is valid until the next call
+      TiXmlElement *ReadChild(void);
+      TiXmlElement *EnterChild(void);
+      void SkipChild(void);
+
+private:
+      int  GetChar(void);
+      int  PeekChar(void);
+      bool SkipPast(const char *terminator);
+      int  ReadToken(void);
+      void AppendFrag(char c);
+      TiXmlElement *ParseFrag(void);
+
+      FILE              *m_fp;
+      char              *m_buf;
+      int               m_buf_len;
+      int               m_buf_pos;
+
+      char              *m_frag;                // raw text of the current token or child
+      int               m_frag_len;
+      int               m_frag_size;
+      bool              m_bCapture;
+
+      int               m_utf8_pending;         // continuation bytes still expected
+      int               m_depth;
+      bool              m_bChildPending;        // NextChild() found a start tag not yet consumed
+      bool              m_bChildEmpty;          // and it was <name/>
+      bool              m_bEnteredEmpty;        // EnterChild() on <name/>, no children follow
+      bool              m_bError;
+
+      wxString          m_tag_name;
+      TiXmlDocument     m_doc;
+};
+
+//    The writer emits the same layout as GpxDocument::SaveFile(), element by element.
+//    An element may be begun and its children written one at a time before it is ended.
+class GpxStreamWriter
+{
+public:
+      GpxStreamWriter();
+      ~GpxStreamWriter();
+
+      bool Open(const wxString &filename);
+      bool Close(void);
+
+      void WriteElement(TiXmlNode *node);
+      void BeginElement(TiXmlElement *element);
+      void EndElement(void);
+
+private:
+      void Indent(int depth);
+
+      FILE              *m_fp;
+      int               m_depth;
+      wxArrayString     m_open_names;
+};
+
 #endif          // _GPXDOCUMENT_H_
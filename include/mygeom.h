@@ -124,6 +124,7 @@ public:
 
         TriPrim         *tri_prim_head;         // head of linked list of TriPrims
         bool            m_bSMSENC;
+        bool            m_bMapped;              // arrays and vertices point into a mapped binary SENC
 
     private:
         int my_bufgets( char *buf, int buf_len_max );
@@ -178,6 +179,9 @@ class PolyTessGeo
 
         PolyTessGeo(Extended_Geometry *pxGeom);
 
+        PolyTessGeo(PolyTriGroup *ppg, double xmin, double ymin, double xmax, double ymax,
+                    int nwkb, int nvertex_max);                 // Adopt a group read from a binary SENC
+
         bool IsOk(){ return m_bOK;}
 
         int BuildTessGL(void);
@@ -191,6 +195,7 @@ class PolyTessGeo
         double Get_ymax(){ return ymax;}
         PolyTriGroup *Get_PolyTriGroup_head(){ return m_ppg_head;}
         int GetnVertexMax(){ return m_nvertex_max; }
+        int GetnWKB(){ return nwkb; }
         int     ErrorCode;
 
 
@@ -35,6 +35,7 @@
 #include <wx/config.h>
 #include <wx/confbase.h>
 #include <wx/fileconf.h>
+#include <wx/hashmap.h>
 
 #ifdef __WXMSW__
 #include <wx/msw/regconf.h>
@@ -70,6 +71,7 @@ extern double parseLatLon(wxString latlon);
 
 class Route;
 class NavObjectCollection;
+class NavObjectJournal;
 class wxProgressDialog;
 class ocpnDC;
 
@@ -203,6 +205,8 @@ public:
       void UpdateSegmentDistances(double planspeed = -1.0);
       void CalculateDCRect(wxDC& dc_route, wxRect *prect, ViewPort &VP);
       int GetnPoints(void){ return m_nPoints; }
+      void IncModifyCount(void){ m_nModifyCount++; }
+      int GetModifyCount(void){ return m_nModifyCount; }
       void Reverse(bool bRenamePoints = false);
       void RebuildGUIDList(void);
       void RenameRoutePoints();
@@ -261,6 +265,7 @@ public:
 private:
       bool        CalculateCrossesIDL();
       int         m_nPoints;
+      int         m_nModifyCount;   // bumped when points are added, removed or edited
       int         m_nm_sequence;
       bool        m_bVisible; // should this route be drawn?
       bool        m_bListed;
@@ -274,6 +279,95 @@ WX_DECLARE_LIST(Route, RouteList);                    // establish class Route a
 
 #define TIMER_TRACK1           778
 
+//----------------------------------------------------------------------------
+//    TrackPointStore
+//    Compact columnar record of track fixes.
+//    Positions are held in 1e-7 degree units, and times in seconds,
+//    as offsets from the first fix of each fixed size chunk.
+//----------------------------------------------------------------------------
+#define TRACK_STORE_CHUNK_FIXES     4096
+
+typedef struct _TrackFixChunk
+{
+      double      base_lat;
+      double      base_lon;
+      time_t      base_time;
+      int         nfixes;
+      int         dlat[TRACK_STORE_CHUNK_FIXES];
+      int         dlon[TRACK_STORE_CHUNK_FIXES];
+      int         dtime[TRACK_STORE_CHUNK_FIXES];
+}TrackFixChunk;
+
+class TrackPointStore
+{
+      public:
+            TrackPointStore();
+            ~TrackPointStore();
+
+            void  Append(double lat, double lon, time_t fix_time);
+            void  Clear(void);
+            int   GetCount(void){ return m_nfixes; }
+            void  GetFix(int index, double *lat, double *lon, time_t *fix_time);
+
+      private:
+            wxArrayPtrVoid    m_chunks;
+            int               m_nfixes;
+};
+
+//----------------------------------------------------------------------------
+//    TrackLOD
+//    Level of detail cache for drawing a track's RoutePoints.
+//    Level 0 is every point, each further level is a Douglas-Peucker
+//    simplification of the one below at four times the tolerance.
+//    Points are grouped in fixed size chunks with a Lat/Lon extent each,
+//    so that chunks wholly off screen are never projected.
+//----------------------------------------------------------------------------
+#define TRACK_LOD_CHUNK_POINTS      256
+#define TRACK_LOD_LEVELS            8
+#define TRACK_LOD_BASE_TOLERANCE    2.0         // meters, level 1
+
+#define TRACK_LOD_CLASS_MASK        0x03        // pen class, see Track::Draw
+#define TRACK_LOD_BREAK             0x04        // no segment from the previous point
+#define TRACK_LOD_DECORATED         0x08        // icon or name, RoutePoint must draw itself
+#define TRACK_LOD_KEEP              0x10        // never simplified away
+
+class TrackLOD
+{
+      public:
+            TrackLOD();
+            ~TrackLOD();
+
+            void  Clear(void);
+            bool  IsValidFor(Route *pRoute);
+            void  Build(Route *pRoute);
+            int   GetLevel(double view_scale_ppm);
+
+            int   GetCount(int level){ return level ? m_nlevel_points[level] : m_npoints; }
+            int   GetIndex(int level, int pos){ return level ? m_plevel_points[level][pos] : pos; }
+            int   GetChunkStart(int level, int chunk)
+                  { return level ? m_plevel_chunk_start[level][chunk] : wxMin(chunk * TRACK_LOD_CHUNK_POINTS, m_npoints); }
+
+            int               m_npoints;
+            RoutePoint        **m_ppoints;
+            double            *m_plat;
+            double            *m_plon;
+            unsigned char     *m_pflags;
+
+            int               m_nchunks;
+            double            *m_pchunk_bbox;         // lat_min, lat_max, lon_min, lon_max per chunk
+            bool              *m_pchunk_wraps;        // chunk crosses the IDL
+            double            m_coslat;               // longitude scale used for the tolerances
+
+      private:
+            void  Simplify(int level, double tolerance);
+
+            int               m_modify_count;         // Route::GetModifyCount() when built
+
+            int               *m_plevel_points[TRACK_LOD_LEVELS];
+            int               m_nlevel_points[TRACK_LOD_LEVELS];
+            int               *m_plevel_chunk_start[TRACK_LOD_LEVELS];
+};
+
 //----------------------------------------------------------------------------
 //    Track
 //----------------------------------------------------------------------------
@@ -297,6 +391,12 @@ class Track : public wxEvtHandler, public Route
 
             Route *RouteFromTrack(wxProgressDialog *pprog);
             double GetXTE(RoutePoint *fm1, RoutePoint *fm2, RoutePoint *to);
+            double GetXTE(double fm1Lat, double fm1Lon, double fm2Lat, double fm2Lon, double toLat, double toLon);
+
+            //    Fixes recorded since the last materialisation are held compactly,
+            //    not as RoutePoints.  Convert them before editing the point list.
+            void MaterializeFixes(void);
+            TrackPointStore *GetFixStore(){ return &m_Fixes; }
 
       private:
             void OnTimerTrack(wxTimerEvent& event);
@@ -317,6 +417,11 @@ class Track : public wxEvtHandler, public Route
             int               m_track_run;
             double            m_minTrackpoint_delta;
 
+            TrackPointStore   m_Fixes;
+            double            m_fixes_length;
+
+            TrackLOD          m_LOD;
+
 
 
 DECLARE_EVENT_TABLE()
@@ -362,13 +467,14 @@ RoutePoint *LoadGPXWaypoint (GpxWptElement *wptnode, wxString def_symbol_name, b
 Route *LoadGPXRoute (GpxRteElement *rtenode, int routenum, bool b_fullviz = false );
 Route *LoadGPXTrack (GpxTrkElement *trknode, bool b_fullviz = false );
 void GPXLoadTrack ( GpxTrkElement *trknode, bool b_fullviz = false  );
+void GPXStreamLoadTrack ( GpxStreamReader &reader, bool b_fullviz = false );
 void GPXLoadRoute ( GpxRteElement *rtenode, int routenum, bool b_fullviz = false );
 void InsertRoute(Route *pTentRoute, int routenum);
 void UpdateRoute(Route *pTentRoute);
 
 GpxWptElement *CreateGPXWpt ( RoutePoint *pr, char * waypoint_type, bool b_props_explicit = false, bool b_props_minimal = false );
 GpxRteElement *CreateGPXRte ( Route *pRoute );
-GpxTrkElement *CreateGPXTrk ( Route *pRoute );
+GpxTrkElement *CreateGPXTrk ( Route *pRoute, GpxStreamWriter *pWriter = NULL );
 
 bool WptIsInRouteList(RoutePoint *pr);
 RoutePoint *WaypointExists( const wxString& name, double lat, double lon);
@@ -405,7 +511,10 @@ public:
       virtual bool LoadChartDirArray(ArrayOfCDI &ChartDirArray);
       virtual void UpdateSettings();
       virtual void UpdateNavObj();
-      virtual void StoreNavObjChanges();
+      virtual void StoreNavObjChange(TiXmlElement *element);
+      virtual void StoreTrackFix(Route *pTrack, double lat, double lon, time_t fix_time);
+      void CompactNavObj(void);
+      void SetNavObjDirty(void){ m_bNavObjDirty = true; }
 
       void ExportGPX(wxWindow* parent);
 	void ImportGPX(wxWindow* parent, bool islayer = false, wxString dirpath = _T(""), bool isdirectory = true);
@@ -413,7 +522,11 @@ public:
       bool ExportGPXRoute(wxWindow* parent, Route *pRoute);
       bool ExportGPXWaypoint(wxWindow* parent, RoutePoint *pRoutePoint);
 
+      void ImportGPXElement(TiXmlNode *child, Layer *l);
+      bool ImportGPXStream(const wxString &path, Layer *l, int *pnloaded);
+
       void CreateRotatingNavObjBackup();
+      void ReplayNavObjChange(TiXmlElement *gpx_element, wxArrayPtrVoid *pAppendedTracks = NULL);
 
       int m_NextRouteNum;
       int m_NextWPNum;
@@ -424,10 +537,13 @@ public:
       wxString    m_gpx_path;
 
       wxString                m_sNavObjSetFile;
-      wxString                m_sNavObjSetChangesFile;
+      wxString                m_sNavObjSetChangesFile;            // written by earlier versions
+      wxString                m_sNavObjJournalFile;
 
       NavObjectCollection     *m_pNavObjectInputSet;
-      NavObjectCollection     *m_pNavObjectChangesSet;
+      NavObjectJournal        *m_pNavObjJournal;
+      time_t                  m_navobj_update_time;               // of the last UpdateNavObj()
+      bool                    m_bNavObjDirty;                     // changed without a journal record
 
 //    These members are set/reset in Options dialog
       bool  m_bShowDebugWindows;
@@ -449,6 +565,15 @@ public:
 #define            SELTYPE_MARKPOINT            0x0080
 #define            SELTYPE_TRACKSEGMENT         0x0100
 
+//    Select spatial index resolution
+//    Grid cells per degree of lat/lon, and the largest cell footprint a segment
+//    may have before it is kept on the unindexed "oversize" list instead
+#define            SELECT_GRID_CELLS_PER_DEG    32
+#define            SELECT_GRID_MAX_SEG_CELLS    256
+#define            SELECT_NUM_TYPES             9
+
+class wxSelectableItemListNode;
+
 //-----------------------------------------------------------------------------
 //          Selectable Item
 //-----------------------------------------------------------------------------
@@ -472,12 +597,53 @@ public:
       void  *m_pData2;
       void  *m_pData3;
       int   m_Data4;
+
+      int                       m_seq;            // position in the Select list, smaller is nearer the head
+      wxSelectableItemListNode  *m_pListNode;
 };
 
 
 
 WX_DECLARE_LIST(SelectItem, SelectableItemList);// establish class as list member
 
+WX_DECLARE_HASH_MAP( int, wxArrayPtrVoid *, wxIntegerHash, wxIntegerEqual, SelectCellHash );
+WX_DECLARE_HASH_MAP( void *, wxArrayPtrVoid *, wxPointerHash, wxPointerEqual, SelectOwnerHash );
+
+//-----------------------------------------------------------------------------
+//          Select Type Index
+//    Lat/lon grid of the SelectItems of one type, plus maps from the owning
+//    object pointers back to their items
+//-----------------------------------------------------------------------------
+
+class SelectTypeIndex
+{
+public:
+      SelectTypeIndex();
+      ~SelectTypeIndex();
+
+      void  Add(SelectItem *pItem);
+      void  Remove(SelectItem *pItem);
+      void  Clear(void);
+
+      bool  Query(float slat, float slon, float SelectRadius, wxArrayPtrVoid &candidates);
+
+      wxArrayPtrVoid *GetOwnerItems(void *pOwner);
+      wxArrayPtrVoid *GetEndpointItems(void *pPoint);
+      SelectOwnerHash &GetOwnerHash(){ return m_owners; }
+
+private:
+      bool  GetItemCells(SelectItem *pItem, int *ix0, int *iy0, int *ix1, int *iy1);
+      void  AddToMap(SelectOwnerHash &map, void *key, SelectItem *pItem);
+      void  RemoveFromMap(SelectOwnerHash &map, void *key, SelectItem *pItem);
+      void  ClearMap(SelectOwnerHash &map);
+
+      SelectCellHash    m_cells;
+      wxArrayPtrVoid    m_oversize;
+      SelectOwnerHash   m_owners;         // m_pData1 for points, m_pData3 (Route) for segments
+      SelectOwnerHash   m_endpoints;      // m_pData1 and m_pData2 for segments
+      int               m_nitems;
+};
+
 
 
 class Select
@@ -522,14 +688,26 @@ public:
 //    Delete all selectable points in list by type
       bool DeleteAllSelectableTypePoints(int SeltypeToDelete);
 
+//    Move an existing item, keeping the spatial index current
+      void ModifySelectItem(SelectItem *pItem, float slat, float slon);
+
       //  Accessors
 
       SelectableItemList *GetSelectList(){return pSelectList;}
 
 private:
+      SelectTypeIndex *GetTypeIndex(int seltype);
+      bool IsItemSelected(SelectItem *pItem, float slat, float slon, float SelectRadius);
+      void LinkItem(SelectItem *pItem, bool bAppend);
+      void UnlinkItem(SelectItem *pItem);
+      SelectItem *FindOwnedItem(void *data, int seltype);
 
       SelectableItemList      *pSelectList;
 
+      SelectTypeIndex         m_TypeIndex[SELECT_NUM_TYPES];
+      int                     m_seq_front;
+      int                     m_seq_back;
+
 };
 
 
@@ -547,13 +725,53 @@ class NavObjectCollection : public GpxDocument
             bool CreateNavObjGPXRoutes(void);
             bool CreateNavObjGPXTracks(void);
 
-            bool LoadAllGPXObjects(void);
+            bool LoadAllGPXObjects(int nskip = 0);
+
+            //    Without building a DOM, false if the file could not be streamed.
+            //    *pnloaded counts the root children done, for LoadAllGPXObjects() to skip.
+            static bool StreamLoadAllGPXObjects(const wxString &filename, int *pnloaded);
+            static bool StreamSaveAllGPXObjects(const wxString &filename);
 
       private:
             GpxRootElement   *m_pXMLrootnode;
             TiXmlNode   *m_proot_next;
 };
 
+//---------------------------------------------------------------------------------
+//          Append-only journal of the nav object changes since navobj.xml was saved
+//
+//    One record per line, the CRC-32 of the element text in hex, a blank and the
+//    GPX element printed without line breaks. Replay stops at the first record
+//    that is cut short or fails its CRC, a crash can only lose the record being written.
+//---------------------------------------------------------------------------------
+#define NAVOBJ_JOURNAL_COMPACT_SIZE       (1 << 20)   // bytes, navobj.xml is rewritten beyond
+#define NAVOBJ_JOURNAL_COMPACT_SECONDS    3600        // and at least this often
+
+class NavObjectJournal
+{
+      public:
+            NavObjectJournal(const wxString &filename);
+            ~NavObjectJournal();
+
+            bool Append(TiXmlElement *element);
+            void Remove(void);
+            long GetSize(void);
+
+            //    The element returned belongs to the journal, and is valid until the next call
+            bool OpenReplay(void);
+            TiXmlElement *NextRecord(void);
+            void CloseReplay(void);
+
+      private:
+            wxString          m_filename;
+            FILE              *m_fp;                  // append handle, open from the first Append()
+            FILE              *m_fp_replay;
+            long              m_size;
+            char              *m_line;
+            int               m_line_size;
+            TiXmlDocument     m_doc;
+};
+
 
 
 
@@ -159,6 +159,60 @@ class OCPN_NMEAEvent: public wxEvent
 };
 
     extern  const wxEventType wxEVT_OCPN_NMEA;
+    extern  const wxEventType wxEVT_OCPN_NMEA_QUEUE;
+
+
+//----------------------------------------------------------------------------
+// NMEASentenceQueue
+//
+//    Single producer, single consumer queue of sentences from an NMEA
+//    reader thread to the main thread.  The reader thread validates and
+//    classifies each sentence as it is queued, and posts one
+//    wxEVT_OCPN_NMEA_QUEUE event per batch rather than one event per sentence.
+//----------------------------------------------------------------------------
+
+#define NMEA_QUEUE_SIZE             256           // slots, must be a power of 2
+#define NMEA_QUEUE_MAX_SENTENCE     127           // bytes, including CR/LF
+
+typedef enum {
+      NMEA_QUEUE_KEEP = 0,                        // always processed
+      NMEA_QUEUE_COALESCE                         // only the latest of a batch is processed
+} NMEAQueuePolicy;
+
+typedef struct {
+      char              sentence[NMEA_QUEUE_MAX_SENTENCE + 1];
+      char              id[4];                    // sentence formatter, e.g. "RMC"
+      NMEAQueuePolicy   policy;
+} NMEAQueueSlot;
+
+class NMEASentenceQueue
+{
+public:
+      NMEASentenceQueue(bool b_check_sum = true);
+      ~NMEASentenceQueue();
+
+      //    Producer side
+      bool Push(const char *sentence);
+      bool ArmWakeup(void);
+
+      //    Consumer side
+      void ClearWakeup(void);
+      int Available(void);
+      NMEAQueueSlot *Peek(int i);
+      void Pop(int n);
+
+      int GetDropCount(void){ return m_n_dropped; }
+      int GetBadCount(void){ return m_n_bad; }
+
+private:
+      NMEAQueueSlot           *m_slots;
+      bool                    m_b_check_sum;    // reject bad checksums, or leave them to the consumer
+      volatile unsigned int   m_put;            // written by the producer only
+      volatile unsigned int   m_take;           // written by the consumer only
+      volatile int            m_wakeup_armed;
+      volatile int            m_n_dropped;
+      volatile int            m_n_bad;
+};
 
 
 
@@ -194,6 +248,7 @@ public:
       bool SendRouteToGPS(Route *pr, wxString &com_name,  bool bsend_waypoints, wxGauge *pProgress);
 
       wxFrame *GetParentFrame(){ return m_parent_frame; }
+      NMEASentenceQueue *GetSentenceQueue(){ return m_pSentenceQueue; }
 
       DeviceMonitorWindow     *m_pdevmon;
       int                     m_Thread_run_flag;
@@ -225,6 +280,7 @@ private:
       bool              m_brequest_thread_pause;
 
       bool              m_bsec_thread_active;
+      NMEASentenceQueue *m_pSentenceQueue;
       int               m_gpsd_major;
       int               m_gpsd_minor;
       bool              m_bgot_version;
@@ -285,10 +341,11 @@ public:
       void OnExit(void);
 
 private:
-      void Parse_And_Send_Posn(wxString &str_temp_buf);
+      void Parse_And_Send_Posn(char *sentence);
       void ThreadMessage(const wxString &msg);          // Send a wxLogMessage to main program event loop
       wxEvtHandler            *m_pMainEventHandler;
       NMEAHandler             *m_launcher;
+      NMEASentenceQueue       *m_pSentenceQueue;
       wxString                m_PortName;
       wxMutex                 *m_pShareMutex;
       wxMutex                 *m_pPortMutex;
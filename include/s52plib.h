@@ -51,6 +51,7 @@ WX_DEFINE_SORTED_ARRAY( LUPrec *, wxArrayOfLUPrec );
 WX_DECLARE_LIST( S57Obj, ObjList );
 
 WX_DECLARE_STRING_HASH_MAP( int, CARC_Hash );
+WX_DECLARE_STRING_HASH_MAP( LUPrec *, CSLUP_Hash );
 
 class ViewPort;
 class PixelCache;
@@ -134,6 +135,107 @@ extern void txfRenderFancyString( TexFont * txf, char *string, int len );
 
 class RenderFromHPGL;
 
+//    An area fill primitive, held for deferred rasterising
+typedef struct {
+	int type;                           // AREA_OP_TRI or AREA_OP_TRAP
+	wxPoint pts[4];                     // triangle, or the left and right trapezoid edges
+	int ytop;
+	int ybot;
+	S52color color;
+	render_canvas_parms *ppatt;         // shared pattern buffer, or NULL
+	int patt_x;                         // pattern reference point for this object
+	int patt_y;
+} AreaRasterOp;
+
+//    A rendered symbol, as held in the symbol atlas
+typedef struct _SymbolAtlasEntry {
+	Rule *prule;
+	int colortable_index;
+	int rot;                            // rotation, whole degrees 0..359
+	int scale_key;                      // display pixels per mm * 1000
+	int type;                           // ID_wxBitmap or ID_RGBA
+	void *pixels;                       // wxBitmap * or RGBA array, may be NULL
+	int orgx;                           // bitmap origin, relative to the symbol pivot
+	int orgy;
+	int width;
+	int height;
+	int nbytes;
+	struct _SymbolAtlasEntry *hash_next;
+	struct _SymbolAtlasEntry *lru_prev;
+	struct _SymbolAtlasEntry *lru_next;
+} SymbolAtlasEntry;
+
+WX_DECLARE_HASH_MAP( long, SymbolAtlasEntry*, wxIntegerHash, wxIntegerEqual, SymbolAtlasHash );
+
+#define SYMBOL_ATLAS_MAX_BYTES      (16 * 1024 * 1024)
+
+//-----------------------------------------------------------------------------
+//    Cache of rendered symbols, shared by all charts.
+//    Symbols are kept per colour table, rotation and scale,
+//    and the least recently used are dropped when the atlas is full.
+//-----------------------------------------------------------------------------
+
+class SymbolAtlas {
+public:
+	SymbolAtlas( int max_bytes );
+	~SymbolAtlas();
+
+	SymbolAtlasEntry *Find( Rule *prule, int colortable_index, int rot,
+			int scale_key, int type );
+	SymbolAtlasEntry *Add( Rule *prule, int colortable_index, int rot,
+			int scale_key, int type, void *pixels, int orgx, int orgy,
+			int width, int height );
+	void Flush( void );
+
+private:
+	long MakeKey( Rule *prule, int colortable_index, int rot, int scale_key,
+			int type );
+	void Remove( SymbolAtlasEntry *pe );
+
+	SymbolAtlasHash m_hash;
+	SymbolAtlasEntry *m_lru_head; // most recently used
+	SymbolAtlasEntry *m_lru_tail;
+	int m_bytes;
+	int m_max_bytes;
+};
+
+//    A drawn text label, as held in the text declutter grid
+typedef struct {
+	S57Obj *obj;                        // identity only, never dereferenced
+	wxRect rect;                        // in grid coordinates
+} TextGridEntry;
+
+WX_DECLARE_HASH_MAP( long, wxArrayPtrVoid*, wxIntegerHash, wxIntegerEqual, TextGridCellHash );
+WX_DECLARE_HASH_MAP( long, TextGridEntry*, wxIntegerHash, wxIntegerEqual, TextGridEntryHash );
+
+#define TEXT_GRID_CELL      64          // pixels
+
+//-----------------------------------------------------------------------------
+//    Screen space bucket grid of drawn text rectangles, for declutter tests.
+//    The grid is fixed to the chart, not the screen, so a pan only moves
+//    the grid origin.
+//-----------------------------------------------------------------------------
+
+class TextGrid {
+public:
+	TextGrid();
+	~TextGrid();
+
+	void Add( S57Obj *pobj, const wxRect &rect );
+	bool Intersects( const wxRect &test_rect, S57Obj *pobj );
+	void Translate( int dx, int dy, int screenw, int screenh );
+	void Clear( void );
+
+private:
+	void Link( TextGridEntry *pe );
+	void Unlink( TextGridEntry *pe );
+
+	TextGridCellHash m_cells;
+	TextGridEntryHash m_entries;
+	int m_orgx;                         // screen position of grid origin
+	int m_orgy;
+};
+
 //-----------------------------------------------------------------------------
 //    s52plib definition
 //-----------------------------------------------------------------------------
@@ -162,6 +264,18 @@ public:
 	long GetStateHash() {
 		return m_state_hash;
 	}
+	void GenerateCSStateHash();
+	void GenerateLUPHash();
+	long GetCSStateHash() {
+		return m_cs_state_hash;
+	}
+	int GetCSGeneration() {
+		return m_cs_generation;
+	}
+	long GetLUPHash() {
+		return m_lup_hash;
+	}
+	void SetCSRules( ObjRazRules *rzRules, const wxString &cs_string );
 
 	void SetPLIBColorScheme( wxString scheme );
 	wxString GetPLIBColorScheme( void ) {
@@ -193,6 +307,9 @@ public:
 	int RenderObjectToDC( wxDC *pdc, ObjRazRules *rzRules, ViewPort *vp );
 	int RenderAreaToDC( wxDC *pdc, ObjRazRules *rzRules, ViewPort *vp,
 			render_canvas_parms *pb_spec );
+	void BeginAreaRaster( void );
+	void FlushAreaRaster( render_canvas_parms *pb_spec );
+	void RasterAreaOps( render_canvas_parms *pband, int *pledge, int *predge );
 
 	//    For OpenGL
 	int RenderObjectToGL( const wxGLContext &glcc, ObjRazRules *rzRules,
@@ -331,15 +448,22 @@ private:
 	int PrioritizeLineFeature( ObjRazRules *rzRules, int npriority );
 
 	int dda_tri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
-			render_canvas_parms *pPatt_spec );
+			render_canvas_parms *pPatt_spec, int *pledge, int *predge );
 	int dda_trap( wxPoint *segs, int lseg, int rseg, int ytop, int ybot,
 			S52color *c, render_canvas_parms *pb_spec,
+			render_canvas_parms *pPatt_spec, int *pledge, int *predge );
+	void RasterTri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
 			render_canvas_parms *pPatt_spec );
+	void RasterTrap( wxPoint *segs, int lseg, int rseg, int ytop, int ybot,
+			S52color *c, render_canvas_parms *pb_spec,
+			render_canvas_parms *pPatt_spec );
+	AreaRasterOp *AddAreaOp( void );
 
 	LUPrec *FindBestLUP( wxArrayPtrVoid *nameMatch, char *objAtt,
 			wxArrayOfS57attVal *objAttVal, bool bStrict );
 	Rules *StringToRules( const wxString& str_in );
 	void GetAndAddCSRules( ObjRazRules *rzRules, Rules *rules );
+	void UpdateCSRules( ObjRazRules *rzRules, Rules *rules );
 
 	void DestroyPattRules( RuleHash *rh );
 
@@ -368,16 +492,27 @@ private:
 	int *ledge;
 	int *redge;
 
+	bool m_bDeferAreaRaster;
+	AreaRasterOp *m_pAreaOps;
+
+	SymbolAtlas *m_pSymbolAtlas;
+	int m_nAreaOps;
+	int m_nAreaOpsMax;
+
 	int m_colortable_index;
 	int m_colortable_index_save;
 
-	ObjList m_textObjList;
+	TextGrid m_TextGrid;
 
 	double m_display_pix_per_mm;
 
 	wxString m_ColorScheme;
 
 	long m_state_hash;
+	long m_cs_state_hash; // hash of the state used by conditional symbology
+	int m_cs_generation; // incremented when the CS LUPs are destroyed
+	long m_lup_hash; // hash of the static lookup tables, identifies the loaded library
+	CSLUP_Hash m_CSLUP_hashmap; // CS LUPs by class, category and instruction string
 
 	wxRect m_render_rect;
 
@@ -41,6 +41,7 @@
 #define _S52S57_H_
 
 #include "bbox.h"
+#include <wx/buffer.h>
 
 #define CURRENT_SENC_FORMAT_VERSION  122
 
@@ -313,7 +314,7 @@ public:
       //  Public Methods
       S57Obj();
       ~S57Obj();
-      S57Obj(char *first_line, wxInputStream *fpx, double ref_lat, double ref_lon);
+      S57Obj(char *first_line, wxInputStream *fpx, wxMemoryBuffer &scratch, double ref_lat, double ref_lon);
 
       wxString GetAttrValueAsString ( char *attr );
 
@@ -353,6 +354,9 @@ public:
 
       Rules                   *CSrules;               // per object conditional symbology
       int                     bCS_Added;
+      LUPrec                  *CSLUP;                 // dynamic LUP owning CSrules
+      long                    CS_state_hash;          // s52plib CS state and LUP generation
+      int                     CS_generation;          //  for which CSrules were evaluated
 
       S52_TextC                *FText;
       int                     bFText_Added;
@@ -360,6 +364,7 @@ public:
 
       int                     Scamin;                 // SCAMIN attribute decoded during load
       bool                    bIsClone;
+      bool                    bIsMapped;              // geometry and attribute values point into a mapped binary SENC
       int                     nRef;                   // Reference counter, to signal OK for deletion
       bool                    bIsAton;                // This object is an aid-to-navigation
       bool                    bIsAssociable;          // This object is DRGARE or DEPARE
@@ -369,6 +374,7 @@ public:
       int                     m_n_edge_max_points;
 
       DisCat                  m_DisplayCat;
+      int                     m_DPRI;                 // display priority set by the CS, -1 for that of the LUP
 
 
                                                       // This transform converts from object geometry
@@ -430,10 +436,17 @@ public:
 class VE_Element
 {
 public:
+      VE_Element(){ pPix = NULL; nPix = 0; pix_ppm = 0.; }
+
       int         index;
       int         nCount;
       double      *pPoints;
       int         max_priority;
+
+      //    Retained projection of pPoints at scale pix_ppm, simplified, without the pan offset
+      wxPoint     *pPix;
+      int         nPix;
+      double      pix_ppm;
 };
 
 class VC_Element
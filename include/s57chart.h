@@ -106,6 +106,57 @@ WX_DECLARE_HASH_MAP( int, int, wxIntegerHash, wxIntegerEqual, VectorHelperHash )
 WX_DECLARE_HASH_MAP( int, VE_Element *, wxIntegerHash, wxIntegerEqual, VE_Hash );
 WX_DECLARE_HASH_MAP( int, VC_Element *, wxIntegerHash, wxIntegerEqual, VC_Hash );
 
+//----------------------------------------------------------------------------
+// Spatial index over the line and area rules of a chart
+//----------------------------------------------------------------------------
+
+#define OBJ_INDEX_NODE_SIZE   16                          // entries per R-tree node
+#define OBJ_INDEX_BUCKETS     (PRIO_NUM * LUPNAME_NUM)
+
+typedef struct {
+      double      minx, miny, maxx, maxy;
+      int         first;                // first child, in m_pleaf_entries for leaves, else in m_pnodes
+      int         count;
+      bool        bleaf;
+} ObjIndexNode;
+
+typedef struct {
+      double      minx, miny, maxx, maxy;                 // lat/lon box of the object geometry
+      ObjRazRules *rzRules;
+      int         bucket;                                 // (priority * LUPNAME_NUM) + lookup type
+} ObjIndexEntry;
+
+//    A static, packed (Sort-Tile-Recursive) R-tree.
+//    Entries are numbered in razRules walk order, so query hits, which are
+//    returned sorted by entry number, come out in rendering order.
+class S57ObjIndex
+{
+public:
+      S57ObjIndex();
+      ~S57ObjIndex();
+
+      void AddRules(ObjRazRules *rzRules, int bucket);
+      void Build(void);
+
+      void Query(double minx, double miny, double maxx, double maxy, wxArrayInt &hits, bool b_append = false);
+      void GetBucketRanges(const wxArrayInt &hits, int *pfirst);
+
+      ObjIndexEntry *GetEntry(int index){ return &m_pentries[index]; }
+      int GetEntryCount(void){ return m_nentries; }
+
+private:
+      ObjIndexEntry     *m_pentries;
+      int               m_nentries;
+      int               m_nentries_max;
+
+      int               *m_pleaf_entries;       // entry numbers, in leaf order
+      int               *m_pentry_stamp;        // query stamp, to drop duplicate hits
+      int               m_stamp;
+
+      ObjIndexNode      *m_pnodes;
+      int               m_nnodes;
+};
+
 //----------------------------------------------------------------------------
 // s57 Chart object class
 //----------------------------------------------------------------------------
@@ -117,6 +168,12 @@ public:
 
       virtual InitReturn Init( const wxString& name, ChartInitFlag flags );
 
+      //    FULL_INIT in two steps, for loading on a worker thread:
+      //    LoadInit finds, builds and reads the SENC without touching GDI or the S52 library,
+      //    FinishInit then attaches the S52 rules and does the rest, on the UI thread
+      InitReturn LoadInit( const wxString& name, bool b_worker = false );
+      InitReturn FinishInit( void );
+
 //    Accessors
 
       virtual ThumbData *GetThumbData(int tnx, int tny, float lat, float lon);
@@ -138,6 +195,8 @@ public:
 
       virtual void GetPointPix(ObjRazRules *rzRules, float rlat, float rlon, wxPoint *r);
       virtual void GetPointPix(ObjRazRules *rzRules, wxPoint2DDouble *en, wxPoint *r, int nPoints);
+      virtual wxPoint *GetEdgePix(VE_Element *pedge, int *pnPoints);
+      wxPoint GetPixOffset(void){ return wxPoint(m_pix_offset_x, m_pix_offset_y); }
       virtual void GetPixPoint(int pixx, int pixy, double *plat, double *plon, ViewPort *vpt);
 
       virtual void SetVPParms(const ViewPort &vpt);
@@ -175,6 +234,7 @@ public:
       bool GetNearestSafeContour(double safe_cnt, double &next_safe_cnt);
 
       virtual ListOfS57Obj *GetAssociatedObjects(S57Obj *obj);
+      S57ObjIndex *GetObjIndex(void);
 
       virtual VE_Hash&  Get_ve_hash(void){ return m_ve_hash; }
       virtual VC_Hash&  Get_vc_hash(void){ return m_vc_hash; }
@@ -198,6 +258,7 @@ public:
       double    m_easting_vp_center, m_northing_vp_center;
       double    m_pixx_vp_center, m_pixy_vp_center;
       double    m_view_scale_ppm;
+      int       m_pix_offset_x, m_pix_offset_y;     // pixel position of easting/northing 0, 0
 
       //    Last ViewPort succesfully rendered, stored as an aid to calculating pixel cache address offsets and regions
       ViewPort    m_last_vp;
@@ -230,8 +291,19 @@ private:
       void SetClipRegionGL(const wxGLContext &glc, const ViewPort& VPoint, const wxRect &Rect, bool b_render_nodta = true);
 
       InitReturn PostInit( ChartInitFlag flags, ColorScheme cs );
+      void LoadCSCache(void);
+      void SaveCSCache(void);
       InitReturn FindOrCreateSenc( const wxString& name );
       int BuildSENCFile(const wxString& FullPath000, const wxString& SENCFileName);
+      int LoadSENCObjects(const wxString& FullPath);
+      void AttachSENCObjects(void);
+
+      int LoadSENCText(const wxString& SENCPath, ListOfS57Obj &obj_list, wxString &date_000, wxString &date_upd);
+      int LoadSENCBinary(const wxString& BinPath, const wxFileName& SENCFileName, ListOfS57Obj &obj_list,
+                         wxString &date_000, wxString &date_upd);
+      bool WriteSENCBinary(const wxString& BinPath, const wxFileName& SENCFileName, ListOfS57Obj &obj_list,
+                           const wxString &date_000, const wxString &date_upd);
+      void ReleaseSENCBinary(void);
 
       void  CreateSENCRecord( OGRFeature *pFeature, FILE * fpOut, int mode, S57Reader *poReader );
       void  CreateSENCVectorEdgeTable(FILE * fpOut, S57Reader *poReader);
@@ -246,6 +318,7 @@ private:
       bool GetBaseFileAttr(wxFileName fn);
 
       void ResetPointBBoxes(const ViewPort &vp_last, const ViewPort &vp_this);
+      void QueryVisibleRules(ViewPort &vp, wxArrayInt &hits, int *pbucket_first);
 
            //    Access to raw ENC DataSet
       bool InitENCMinimal( const wxString& FullPath );
@@ -268,6 +341,7 @@ private:
       int         hdr_len;
       wxFileName  m_SENCFileName;
       ObjRazRules *razRules[PRIO_NUM][LUPNAME_NUM];
+      S57ObjIndex *m_pObjIndex;                 // built on first use, discarded when rules change
 
 
       wxArrayString *m_tmpup_array;
@@ -303,6 +377,13 @@ private:
       VE_Hash     m_ve_hash;
       VC_Hash     m_vc_hash;
 
+      char        *m_pSENCBin;                  // binary SENC the objects and edge tables point into
+      size_t      m_SENCBin_len;
+      bool        m_bSENCBin_mapped;            // mapped, else read whole into memory
+
+      ListOfS57Obj m_SENCObjList;               // objects read by LoadSENCObjects, not yet attached
+      bool        m_bWorkerLoad;                // loading on a worker thread, so no dialogs
+
       MyNatsurHash m_natsur_hash;               // hash table for cacheing NATSUR string values from int attributes
 
       bool        m_blastS57TextRender;
@@ -315,6 +396,8 @@ private:
       bool        m_btex_mem;
 
       char        m_usage_char;
+
+      int         m_n_cs_loaded;                // number of CS results restored from the CS cache file
 };
 
 //----------------------------------------------------------------------------
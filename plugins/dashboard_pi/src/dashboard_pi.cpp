@@ -369,7 +369,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
       if(m_NMEA0183.PreParse())
       {
             SendUtcTimeToAllInstruments(OCPN_DBP_STC_CLK | OCPN_DBP_STC_MON, mUTCDateTime);
-            if(m_NMEA0183.LastSentenceIDReceived == _T("DBT"))
+            if(m_NMEA0183.LastSentenceID == NMEA0183_ID('D', 'B', 'T'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -387,7 +387,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("DPT"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('D', 'P', 'T'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -404,7 +404,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 // TODO: GBS - GPS Satellite fault detection
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("GGA"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('G', 'G', 'A'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -442,7 +442,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("GLL"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('G', 'L', 'L'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -479,7 +479,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("GSV"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('G', 'S', 'V'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -490,7 +490,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("HDG"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('H', 'D', 'G'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -511,7 +511,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("HDM"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('H', 'D', 'M'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -524,7 +524,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("HDT"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('H', 'D', 'T'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -538,7 +538,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("MTW"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('M', 'T', 'W'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -550,7 +550,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("MWD"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('M', 'W', 'D'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -567,7 +567,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("MWV"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('M', 'W', 'V'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -599,7 +599,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("RMC"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('R', 'M', 'C'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -667,7 +667,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("RSA"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('R', 'S', 'A'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -682,7 +682,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("VHW"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('V', 'H', 'W'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -704,7 +704,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("VTG"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('V', 'T', 'G'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -736,7 +736,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("VWR"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('V', 'W', 'R'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -754,7 +754,7 @@ void dashboard_pi::SetNMEASentence(wxString &sentence)
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("VWT"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('V', 'W', 'T'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -775,7 +775,7 @@ Calculated wind angle relative to the vessel, 0 to 180o, left/right L/R of vesse
                   }
             }
 
-            else if(m_NMEA0183.LastSentenceIDReceived == _T("ZDA"))
+            else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('Z', 'D', 'A'))
             {
                   if(m_NMEA0183.Parse())
                   {
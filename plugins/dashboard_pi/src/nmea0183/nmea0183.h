@@ -62,6 +62,15 @@
 #define CARRIAGE_RETURN 0x0D
 #define LINE_FEED       0x0A
 
+#define NMEA0183_MAX_SENTENCE   255
+#define NMEA0183_MAX_FIELDS     64
+
+/*
+** Sentence identifiers, as compared by NMEA0183::Parse
+*/
+
+#define NMEA0183_ID( a, b, c )  ( ( (a) << 16 ) | ( (b) << 8 ) | (c) )
+
 
 typedef enum _NMEA0183_BOOLEAN
 {
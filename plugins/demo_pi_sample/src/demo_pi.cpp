@@ -345,7 +345,7 @@ void demoWindow::SetSentence(wxString &sentence)
 
       if(m_NMEA0183.PreParse())
       {
-            if(m_NMEA0183.LastSentenceIDReceived == _T("RMC"))
+            if(m_NMEA0183.LastSentenceID == NMEA0183_ID('R', 'M', 'C'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -70,8 +70,30 @@ bool LATITUDE::IsDataValid( void )
 
 void LATITUDE::Parse( int position_field_number, int north_or_south_field_number, const SENTENCE& sentence )
 {
-   wxString n_or_s = sentence.Field( north_or_south_field_number );
-   Set( sentence.Double( position_field_number ), n_or_s );
+   Latitude = sentence.Double( position_field_number );
+
+   //    As for Set(), the first non-blank character gives the hemisphere
+   int length;
+   const char *field_data = sentence.FieldData( north_or_south_field_number, &length );
+
+   while( length && *field_data == ' ' )
+   {
+      field_data++;
+      length--;
+   }
+
+   if ( length && *field_data == 'N' )
+   {
+      Northing = North;
+   }
+   else if ( length && *field_data == 'S' )
+   {
+      Northing = South;
+   }
+   else
+   {
+      Northing = NS_Unknown;
+   }
 }
 
 void LATITUDE::Set( double position, const wxString& north_or_south )
@@ -48,6 +48,9 @@ NMEA0183::NMEA0183()
 {
    initialize();
 
+   LastSentenceID = 0;
+   m_LastTalker = 0;
+
 /*
    response_table.Add( (RESPONSE *) &Aam );
    response_table.Add( (RESPONSE *) &Alm );
@@ -145,6 +148,25 @@ void NMEA0183::set_container_pointers( void )
 
       this_response->SetContainer( this );
 
+      /*
+      ** Index the response by the same packed ID that PreParse computes,
+      ** so Parse can find it without comparing mnemonic strings
+      */
+
+      const wxString &mnemonic = this_response->Mnemonic;
+      size_t length = mnemonic.Len();
+
+      if ( length && length <= 3 )
+      {
+            int id = 0;
+            for( size_t i = 0; i < length; i++ )
+                  id = ( id << 8 ) | (unsigned char) mnemonic[ i ];
+
+            //    The first registered response wins, as the list scan did
+            if ( response_index.find( id ) == response_index.end() )
+                  response_index[ id ] = this_response;
+      }
+
       index++;
    }
 }
@@ -199,7 +221,7 @@ bool NMEA0183::IsGood( void ) const
    ** NMEA 0183 sentences begin with $ and and with CR LF
    */
 
-   if ( sentence.Sentence[ 0 ] != '$' )
+   if ( sentence.Sentence.IsEmpty() || sentence.Sentence[ 0 ] != '$' )
    {
       return( FALSE );
    }
@@ -208,12 +230,14 @@ bool NMEA0183::IsGood( void ) const
    ** Next to last character must be a CR
    */
 
-   if ( sentence.Sentence.Mid( sentence.Sentence.Len() - 2, 1 ) != CARRIAGE_RETURN )
+   size_t length = sentence.Sentence.Len();
+
+   if ( length < 2 || sentence.Sentence[ length - 2 ] != CARRIAGE_RETURN )
    {
       return( FALSE );
    }
 
-   if ( sentence.Sentence.Right( 1 ) != LINE_FEED )
+   if ( sentence.Sentence[ length - 1 ] != LINE_FEED )
    {
       return( FALSE );
    }
@@ -226,20 +250,30 @@ bool NMEA0183::PreParse( void )
 {
       if ( IsGood() )
       {
-            wxString mnemonic = sentence.Field( 0 );
+            int length;
+            const char *mnemonic = sentence.FieldData( 0, &length );
 
       /*
-            ** See if this is a proprietary field
+            ** See if this is a proprietary field, otherwise the mnemonic
+            ** is the last three characters of the address field
       */
 
-            if ( mnemonic.Left( 1 ) == 'P' )
-                  mnemonic = _T("P");
+            int id = 0;
+            int first = 0;
+
+            if ( length && mnemonic[ 0 ] == 'P' )
+                  length = 1;
+            else if ( length > 3 )
+                  first = length - 3;
 
-            else
-                  mnemonic = mnemonic.Right( 3 );
+            for( int i = first; i < length; i++ )
+                  id = ( id << 8 ) | (unsigned char) mnemonic[ i ];
 
+            //    Only rebuild the string form when the sentence type changes
+            if ( id != LastSentenceID || LastSentenceIDReceived.IsEmpty() )
+                  LastSentenceIDReceived = wxString( &mnemonic[ first ], wxConvISO8859_1, length - first );
 
-            LastSentenceIDReceived = mnemonic;
+            LastSentenceID = id;
 
             return true;
       }
@@ -254,73 +288,49 @@ bool NMEA0183::Parse( void )
 
    if(PreParse())
    {
+      RESPONSE *response_p = (RESPONSE *) NULL;
 
-      wxString mnemonic = sentence.Field( 0 );
-
-      /*
-      ** See if this is a proprietary field
-      */
+      MRH::iterator it = response_index.find( LastSentenceID );
+      if ( it != response_index.end() )
+            response_p = it->second;
 
-      if ( mnemonic.Left( 1 ) == 'P' )
+      if ( response_p == NULL )
       {
-          mnemonic = _T("P");
-      }
-      else
-      {
-         mnemonic = mnemonic.Right( 3 );
+            ErrorMessage = LastSentenceIDReceived;
+            ErrorMessage += _T(" is an unknown type of sentence");
+
+            return( FALSE );
       }
 
+      return_value = response_p->Parse( sentence );
+
       /*
-      ** Set up our default error message
+      ** Set your ErrorMessage
       */
 
-      ErrorMessage = mnemonic;
-      ErrorMessage += _T(" is an unknown type of sentence");
-
-      LastSentenceIDReceived = mnemonic;
-
-      RESPONSE *response_p = (RESPONSE *) NULL;
-
-
-//          Traverse the response list to find a mnemonic match
-
-       wxMRLNode *node = response_table.GetFirst();
-
-       int comparison  = 0;
+      if ( return_value == TRUE )
+      {
+            static const wxString no_error( _T("No Error") );
 
-        while(node)
-        {
-           RESPONSE *resp = node->GetData();
+            ErrorMessage = no_error;
+            LastSentenceIDParsed = response_p->Mnemonic;
 
-            comparison = mnemonic.Cmp( resp->Mnemonic );
+            //    Only rebuild the talker strings when the talker changes
+            int talker = 0;
+            if ( sentence.Sentence.Len() >= 3 && sentence.Sentence[ 0 ] == '$' )
+                  talker = ( sentence.Sentence[ 1 ] << 8 ) | sentence.Sentence[ 2 ];
 
-            if ( comparison == 0 )
+            if ( talker != m_LastTalker || TalkerID.IsEmpty() )
             {
-                        response_p = (RESPONSE *) resp;
-                        return_value = response_p->Parse( sentence );
-
-                        /*
-                        ** Set your ErrorMessage
-                        */
-
-                        if ( return_value == TRUE )
-                        {
-                           ErrorMessage = _T("No Error");
-                           LastSentenceIDParsed = response_p->Mnemonic;
-                           TalkerID = talker_id( sentence );
-                           ExpandedTalkerID = expand_talker_id( TalkerID );
-                        }
-                        else
-                        {
-                           ErrorMessage = response_p->ErrorMessage;
-                        }
-
-                        break;
-                   }
-
-              node = node->GetNext();
-        }
-
+                  TalkerID = talker_id( sentence );
+                  ExpandedTalkerID = expand_talker_id( TalkerID );
+                  m_LastTalker = talker;
+            }
+      }
+      else
+      {
+            ErrorMessage = response_p->ErrorMessage;
+      }
    }
    else
    {
@@ -45,6 +45,8 @@
 ** General Purpose Classes
 */
 
+#include <wx/hashmap.h>
+
 #include "Sentence.hpp"
 #include "Response.hpp"
 #include "LatLong.hpp"
@@ -126,6 +128,7 @@
 */
 
 WX_DECLARE_LIST(RESPONSE, MRL);
+WX_DECLARE_HASH_MAP( int, RESPONSE *, wxIntegerHash, wxIntegerEqual, MRH );
 
 class NMEA0183
 {
@@ -133,12 +136,14 @@ class NMEA0183
    private:
 
       SENTENCE sentence;
+      int m_LastTalker;
 
       void initialize( void );
 
    protected:
 
       MRL response_table;
+      MRH response_index;     // response_table keyed on NMEA0183_ID()
 
       void set_container_pointers( void );
       void sort_response_table( void );
@@ -217,6 +222,7 @@ class NMEA0183
       wxString ErrorMessage; // Filled when Parse returns FALSE
       wxString LastSentenceIDParsed; // ID of the lst sentence successfully parsed
       wxString LastSentenceIDReceived; // ID of the last sentence received, may not have parsed successfully
+      int LastSentenceID; // NMEA0183_ID() of the last sentence received
 
       wxString TalkerID;
       wxString ExpandedTalkerID;
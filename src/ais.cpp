@@ -127,9 +127,9 @@ extern bool             bGPSValid;
 extern PlugInManager    *g_pi_manager;
 extern TTYWindow        *g_NMEALogWindow;
 
-//    A static structure storing generic position data
-//    Used to communicate  AIVDO events to main application loop
-static      GenericPosDatEx     AISPositionData;
+//    A static ring of structures storing generic position data
+//    Used to communicate  AIVDO events from the AIS worker to main application loop
+static      GenericPosDatEx     AISPositionData[AIS_POSN_RING];
 extern ComPortManager   *g_pCommMan;
 
 
@@ -589,14 +589,96 @@ AIS_Target_Data::AIS_Target_Data()
     b_OwnShip = false;
     b_in_ack_timeout = false;
 
+    b_changed = true;
+    m_nRefs = 0;
+
     m_ptrack = new AISTargetTrackList;
 }
 
 AIS_Target_Data::~AIS_Target_Data()
 {
+      m_ptrack->DeleteContents(true);
       delete m_ptrack;
 }
 
+//    Deep copy, for publishing to the UI thread
+AIS_Target_Data *AIS_Target_Data::Clone(void)
+{
+      AIS_Target_Data *ptd = new AIS_Target_Data;
+      AISTargetTrackList *ptrack = ptd->m_ptrack;
+
+      *ptd = *this;
+      ptd->m_ptrack = ptrack;
+      ptd->b_changed = false;
+      ptd->m_nRefs = 0;
+
+      //    The copy must not share wxString buffers with the original, since the two
+      //    live on different threads and the buffer reference counts are not atomic
+      ptd->MSG_14_text = wxString(MSG_14_text.c_str());
+
+      AIS_Area_Notice_Hash::iterator it;
+      for( it = ptd->area_notices.begin(); it != ptd->area_notices.end(); ++it )
+      {
+            Ais8_001_22_SubAreaList &sub_areas = it->second.sub_areas;
+            for(size_t i = 0 ; i < sub_areas.size() ; i++)
+                  sub_areas[i].text = wxString(sub_areas[i].text.c_str());
+      }
+
+      wxAISTargetTrackListNode *node = m_ptrack->GetFirst();
+      while(node)
+      {
+            AISTargetTrackPoint *ptrackpoint = new AISTargetTrackPoint;
+            *ptrackpoint = *node->GetData();
+            ptrack->Append(ptrackpoint);
+
+            node = node->GetNext();
+      }
+
+      return ptd;
+}
+
+
+//    Published target records are shared by consecutive snapshots.  The worker
+//    takes references as it builds a snapshot, the UI thread drops them when it
+//    frees one, and the record goes with its last snapshot.
+#ifdef __WXMSW__
+#define AIS_REF_INC(x)      InterlockedIncrement(&(x))
+#define AIS_REF_DEC(x)      InterlockedDecrement(&(x))
+#else
+#define AIS_REF_INC(x)      __sync_add_and_fetch(&(x), 1)
+#define AIS_REF_DEC(x)      __sync_sub_and_fetch(&(x), 1)
+#endif
+
+static void AISTargetRef(AIS_Target_Data *ptd)
+{
+      AIS_REF_INC(ptd->m_nRefs);
+}
+
+static void AISTargetUnref(AIS_Target_Data *ptd)
+{
+      if(AIS_REF_DEC(ptd->m_nRefs) == 0)
+            delete ptd;
+}
+
+
+//---------------------------------------------------------------------------------
+//          AIS_Target_Snapshot Implementation
+//---------------------------------------------------------------------------------
+AIS_Target_Snapshot::AIS_Target_Snapshot()
+{
+      m_pTargets = new AIS_Target_Hash;
+      m_bGeneralAlert = false;
+}
+
+AIS_Target_Snapshot::~AIS_Target_Snapshot()
+{
+      AIS_Target_Hash::iterator it;
+      for( it = (*m_pTargets).begin(); it != (*m_pTargets).end(); ++it )
+            AISTargetUnref(it->second);
+
+      delete m_pTargets;
+}
+
 wxString AIS_Target_Data::BuildQueryResult( void )
 {
 
@@ -1230,13 +1312,62 @@ wxString AIS_Target_Data::Get_class_string(bool b_short)
 //  AIS_Decoder Helpers
 //
 //---------------------------------------------------------------------------------
+//  IEC 6 bit armour lookup, indexed by the raw payload character
+//  Characters outside the armour alphabet map to 0xff, as before
+static const unsigned char s_ais_6bit_lut[256] =
+{
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+         0,    1,    2,    3,    4,    5,    6,    7,    8,    9,   10,   11,   12,   13,   14,   15,
+        16,   17,   18,   19,   20,   21,   22,   23,   24,   25,   26,   27,   28,   29,   30,   31,
+        32,   33,   34,   35,   36,   37,   38,   39, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        40,   41,   42,   43,   44,   45,   46,   47,   48,   49,   50,   51,   52,   53,   54,   55,
+        56,   57,   58,   59,   60,   61,   62,   63, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
 AIS_Bitstring::AIS_Bitstring(const char *str)
 {
-    byte_length = strlen(str);
+    Init(str, strlen(str));
+}
+
+AIS_Bitstring::AIS_Bitstring(const char *str, int len)
+{
+    Init(str, len);
+}
+
+void AIS_Bitstring::Init(const char *str, int len)
+{
+    byte_length = wxMin(len, AIS_MAX_MESSAGE_LEN);
+
+    int nwords = ((byte_length * 6) + 63) / 64 + 1;
+    memset(m_words, 0, nwords * sizeof(wxUint64));
 
+    //  Pack the 6 bit characters MSB first into 64 bit words
+    //  A character lands in at most two adjacent words
+    int bp = 0;
     for(int i=0 ; i<byte_length ; i++)
     {
-        bitbytes[i] = to_6bit(str[i]);
+        wxUint64 v = s_ais_6bit_lut[(unsigned char)str[i]] & 0x3f;
+        int w = bp >> 6;
+        int off = bp & 63;
+
+        if(off <= 58)
+              m_words[w] |= v << (58 - off);
+        else
+        {
+              m_words[w] |= v >> (off - 58);
+              m_words[w + 1] |= v << (122 - off);
+        }
+        bp += 6;
     }
 }
 
@@ -1250,91 +1381,50 @@ int AIS_Bitstring::GetBitCount()
 //  according to rules in IEC AIS Specification
 unsigned char AIS_Bitstring::to_6bit(const char c)
 {
-    if(c < 0x30)
-        return (unsigned char)-1;
-    if(c > 0x77)
-        return (unsigned char)-1;
-    if((0x57 < c) && (c < 0x60))
-        return (unsigned char)-1;
-
-    unsigned char cp = c;
-    cp += 0x28;
-
-    if(cp > 0x80)
-        cp += 0x20;
-    else
-        cp += 0x28;
-
-    return (unsigned char)(cp & 0x3f);
+    return s_ais_6bit_lut[(unsigned char)c];
 }
 
 
+//  Fields are at most 32 bits, so any field spans at most two words
+//  Bits beyond the end of the payload read as zero
 int AIS_Bitstring::GetInt(int sp, int len, bool signed_flag)
 {
-    int acc = 0;
     int s0p = sp-1;                          // to zero base
 
-    int cp, cx, c0, cs;
+    if((len <= 0) || (len > 32) || (s0p < 0) || (s0p >= byte_length * 6))
+          return 0;
 
+    int w = s0p >> 6;
+    int off = s0p & 63;
 
-    for(int i=0 ; i<len ; i++)
-    {
-        acc  = acc << 1;
-        cp = (s0p + i) / 6;
-        cx = bitbytes[cp];		// what if cp >= byte_length?
-        cs = 5 - ((s0p + i) % 6);
-        c0 = (cx >> (5 - ((s0p + i) % 6))) & 1;
-        if(i == 0 && signed_flag && c0) // if signed value and first bit is 1, pad with 1's
-            acc = ~acc;
-        acc |= c0;
-    }
+    wxUint64 acc = m_words[w] << off;
+    if(off + len > 64)
+          acc |= m_words[w + 1] >> (64 - off);
+
+    acc >>= (64 - len);
 
-    return acc;
+    if(signed_flag && ((acc >> (len - 1)) & 1))  // if signed value and first bit is 1, pad with 1's
+          acc |= ~wxULL(0) << len;
 
+    return (int)acc;
 }
 
 int AIS_Bitstring::GetStr(int sp, int bit_len, char *dest, int max_len)
 {
-    //char temp_str[85];
-    char *temp_str = new char[max_len + 1];
-
-    char acc = 0;
-    int s0p = sp-1;                          // to zero base
-
-    int k=0;
-    int cp, cx, c0, cs;
-
+    int k = 0;
     int i = 0;
     while(i < bit_len && k < max_len)
     {
-         acc=0;
-         for(int j=0 ; j<6 ; j++)
-         {
-            acc  = acc << 1;
-            cp = (s0p + i) / 6;
-            cx = bitbytes[cp];		// what if cp >= byte_length?
-            cs = 5 - ((s0p + i) % 6);
-            c0 = (cx >> (5 - ((s0p + i) % 6))) & 1;
-            acc |= c0;
-
-            i++;
-         }
-         temp_str[k] = (char)(acc & 0x3f);
+         int acc = GetInt(sp + i, 6);
 
          if(acc < 32)
-             temp_str[k] += 0x40;
-         k++;
+             acc += 0x40;
+         dest[k++] = (char)acc;
 
+         i += 6;
     }
 
-    temp_str[k] = 0;
-
-    int copy_len = wxMin((int)strlen(temp_str), max_len);
-    strncpy(dest, temp_str, copy_len);
-
-    delete [] temp_str;
-
-    return copy_len;
+    return k;
 }
 
 
@@ -1370,7 +1460,29 @@ AIS_Decoder::AIS_Decoder(int handler_id, wxFrame *pParent, const wxString& AISDa
 {
       m_handler_id = handler_id;
 
-      AISTargetList = new AIS_Target_Hash;
+      //    The UI thread reads the published snapshot, the worker owns the working table
+      m_pSnapshot = new AIS_Target_Snapshot;
+      m_pPendingSnapshot = NULL;
+      AISTargetList = m_pSnapshot->m_pTargets;
+
+      m_pWorkTargets = new AIS_Target_Hash;
+      m_pPublishedTargets = new AIS_Target_Hash;
+      m_pInputQueue = new NMEASentenceQueue(false);       // Decode() makes the checksum decision
+      m_pWorkerSemaphore = new wxSemaphore;
+      m_pLatestTargetData = NULL;
+      m_bWorkDirty = false;
+      m_bWorkGeneralAlert = false;
+      m_bGeneralAlert = false;
+      m_bSuppressed = false;
+      m_last_tick_ms = 0;
+      m_last_publish_ms = 0;
+      m_posn_ring_index = 0;
+
+      m_cpa_lat = m_own_lat = 0.;
+      m_cpa_lon = m_own_lon = 0.;
+      m_cpa_cog = m_own_cog = 0.;
+      m_cpa_sog = m_own_sog = 0.;
+      m_cpa_bGPSValid = m_own_bGPSValid = false;
 
       BuildERIShipTypeHash();
 
@@ -1385,11 +1497,19 @@ AIS_Decoder::AIS_Decoder(int handler_id, wxFrame *pParent, const wxString& AISDa
 
       m_n_targets = 0;
 
+      accumulator_length = 0;
+      sentence_accumulator[0] = 0;
+
       OpenDataSource(pParent, AISDataSource);
 
       //  Create/connect a dynamic event handler slot for OCPN_AISEvent(s) coming from AIS thread
       Connect(wxEVT_OCPN_AIS, (wxObjectEventFunction)(wxEventFunction)&AIS_Decoder::OnEvtAIS);
 
+      //  Kick off the AIS worker thread
+      m_pWorker = new OCP_AIS_Worker(this);
+      m_Worker_run_flag = 1;
+      m_pWorker->Run();
+
 }
 
 AIS_Decoder::~AIS_Decoder(void)
@@ -1415,18 +1535,44 @@ AIS_Decoder::~AIS_Decoder(void)
             pAIS_Thread = NULL;
       }
 
+      //    Stop the worker before releasing the state it owns
+      bool b_worker_stopped = true;
+      if(m_pWorker)
+      {
+            m_Worker_run_flag = 0;
+            m_pWorkerSemaphore->Post();
+
+            int tmsec = 2000;
+            while((m_Worker_run_flag >= 0) && (tmsec > 0))
+            {
+                  wxMilliSleep(10);
+                  tmsec -= 10;
+            }
+
+            if(m_Worker_run_flag >= 0)
+            {
+                  wxLogMessage(_T("AIS Worker Thread not stopped after 2 sec."));
+                  b_worker_stopped = false;
+            }
+
+            m_pWorker = NULL;
+      }
 
-    AIS_Target_Hash::iterator it;
-    AIS_Target_Hash *current_targets = GetTargetList();
+    delete m_pSnapshot;
 
-    for( it = (*current_targets).begin(); it != (*current_targets).end(); ++it )
+    if(b_worker_stopped)
     {
-          AIS_Target_Data *td = it->second;
+          delete m_pPendingSnapshot;
 
-          delete td;
-    }
+          AIS_Target_Hash::iterator it;
+          for( it = (*m_pWorkTargets).begin(); it != (*m_pWorkTargets).end(); ++it )
+                delete it->second;
 
-    delete current_targets;
+          delete m_pWorkTargets;
+          delete m_pPublishedTargets;
+          delete m_pInputQueue;
+          delete m_pWorkerSemaphore;
+    }
 
 #ifndef OCPN_NO_SOCKETS
     //    Kill off the TCP/IP Socket if alive
@@ -1538,7 +1684,6 @@ void AIS_Decoder::OnEvtAIS(OCPN_AISEvent& event)
 
             wxString message = event.GetNMEAString();
 
-            int nr = 0;
             if(!message.IsEmpty())
             {
                   if(g_NMEALogWindow)
@@ -1554,46 +1699,14 @@ void AIS_Decoder::OnEvtAIS(OCPN_AISEvent& event)
 
                   if( message.Mid(3,3).IsSameAs(_T("VDM")) || message.Mid(3,3).IsSameAs(_T("VDO")) || message.Mid(1,5).IsSameAs(_T("FRPOS")) || message.Mid(1,2).IsSameAs(_T("CD")) )
                   {
-                        nr = Decode(message);
-                        if(message.Mid(3,3).IsSameAs(_T("VDO")))
+                        //    Hand the sentence to the worker thread for decoding
+                        //    AIVDO ownship reports are forwarded upstream from there
+                        if(m_pInputQueue->Push(message.mb_str()))
                         {
-                              //    This is an ownship message, presumably from a transponder
-                              //    Simulate an ownship GPS position report upstream for message IDs 1,2,3
-
-                              if(m_pLatestTargetData && (nr == AIS_NoError) && g_bGPSAISMux && !m_pLatestTargetData->b_positionDoubtful && m_pLatestTargetData->b_positionOnceValid)
-                              {
-                                    switch(m_pLatestTargetData->MID)
-                                    {
-                                          case 1:
-                                          case 2:
-                                          case 3:
-                                          {
-                                                AISPositionData.kLat = m_pLatestTargetData->Lat;
-                                                AISPositionData.kLon = m_pLatestTargetData->Lon;
-
-                                                if(m_pLatestTargetData->COG == 360.0)
-                                                      AISPositionData.kCog = NAN;
-                                                else
-                                                      AISPositionData.kCog = m_pLatestTargetData->COG;
-
-
-                                                if(m_pLatestTargetData->SOG > 102.2)
-                                                      AISPositionData.kSog = NAN;
-                                                else
-                                                      AISPositionData.kSog = m_pLatestTargetData->SOG;
-
-                                                wxCommandEvent event( EVT_NMEA,  m_handler_id );
-                                                event.SetEventObject( (wxObject *)this );
-                                                event.SetExtraLong(EVT_NMEA_DIRECT);
-                                                event.SetClientData(&AISPositionData);
-                                                m_pMainEventHandler->AddPendingEvent(event);
-                                                break;
-                                          }
-                                          default:
-                                                break;
-                                    }
-                              }
+                              if(m_pInputQueue->ArmWakeup())
+                                    m_pWorkerSemaphore->Post();
                         }
+
                         g_pi_manager->SendAISSentenceToAllPlugIns(message);
 
                         gFrame->TouchAISActive();
@@ -1607,6 +1720,12 @@ void AIS_Decoder::OnEvtAIS(OCPN_AISEvent& event)
             }
             break;
         }       //case
+
+        case EVT_AIS_SNAPSHOT:
+        {
+            AdoptSnapshot();
+            break;
+        }
     }           // switch
 }
 
@@ -1651,9 +1770,20 @@ void AIS_Decoder::Parse_And_Send_Posn(wxString &message)
 //      Decode NMEA VDM/VDO/FRPOS/DSCDSE sentence to AIS Target(s)
 //----------------------------------------------------------------------------------
 AIS_Error AIS_Decoder::Decode(const wxString& str)
+{
+    if(str.Len() > 100)
+        return AIS_NMEAVDX_TOO_LONG;
+
+    char sentence[128];
+    strncpy(sentence, str.mb_str(), 127);
+    sentence[127] = 0;
+
+    return Decode(sentence);
+}
+
+AIS_Error AIS_Decoder::Decode(const char *str)
 {
     AIS_Error ret;
-    wxString string_to_parse;
 
     double gpsg_lat, gpsg_lon, gpsg_mins, gpsg_degs;
     double  gpsg_cog, gpsg_sog, gpsg_utc_time;
@@ -1673,12 +1803,14 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
 
     //  Make some simple tests for validity
 
-//    int nlen = str.Len();
-
-    if(str.Len() > 100)
+    if(strlen(str) > 100)
         return AIS_NMEAVDX_TOO_LONG;
 
-    if(!NMEACheckSumOK(str))
+    //  Work on a local copy of the sentence, the VDM/VDO fields are split in place
+    char sentence[128];
+    strcpy(sentence, str);
+
+    if(!NMEACheckSumOK(sentence))
     {
 //          printf("Checksum error at n_msgs:%d\n", n_msgs);
 
@@ -1686,13 +1818,19 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
             {
                   g_total_NMEAerror_messages++;
                   wxString msg(_T("   AIS checksum bad, continuing..."));
-                  msg.Append(str);
+                  msg.Append(wxString(sentence, wxConvUTF8));
                   ThreadMessage(msg);
             }
             else
             return AIS_NMEAVDX_CHECKSUM_BAD;
     }
-    if (str.Mid(1,2).IsSameAs(_T("CD")) )
+
+    if(strlen(sentence) < 6)
+          return AIS_NMEAVDX_BAD;
+
+    bool b_vdo = !strncmp(&sentence[3], "VDO", 3);
+
+    if (!strncmp(&sentence[1], "CD", 2))
     {
           // parse a DSC Position message			$CDDSx,.....
 
@@ -1704,13 +1842,13 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
                 ThreadMessage(msg);
           }
 
-          wxString string(str);
+          wxString string(sentence, wxConvUTF8);
           wxStringTokenizer tkz(string, _T(",*"));
 
           wxString token;
           token = tkz.GetNextToken();         // !$CDDS
 
-          if (str.Mid(3,3).IsSameAs(_T("DSC")) ){
+          if (!strncmp(&sentence[3], "DSC", 3)){
                 token = tkz.GetNextToken();         // format specifier (02-area,12-distress,16-allships,20-individual,...)
                 token.ToLong(&dsc_fmt);
 
@@ -1754,7 +1892,7 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
                 if (dsc_fmt != 02)
                       mmsi = (int) dsc_mmsi;
           }
-          else if (str.Mid(3,3).IsSameAs(_T("DSE")) ) {
+          else if (!strncmp(&sentence[3], "DSE", 3)) {
 
                 token = tkz.GetNextToken();         // total number of sentences
 
@@ -1778,7 +1916,7 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
                 mmsi = (int) dse_mmsi;
           }
       }
-      else if (str.Mid(1,5).IsSameAs(_T("FRPOS")) )
+      else if (!strncmp(&sentence[1], "FRPOS", 5))
       {
       // parse a GpsGate Position message			$FRPOS,.....
 
@@ -1790,7 +1928,7 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
                   ThreadMessage(msg);
             }
 
-            wxString string(str);
+            wxString string(sentence, wxConvUTF8);
             wxStringTokenizer tkz(string, _T(",*"));
 
             wxString token;
@@ -1849,74 +1987,80 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
             gpsg_mmsi = 199000000 + hash;  // 199 is INMARSAT-A MID, should not occur ever in AIS stream
             mmsi = gpsg_mmsi;
     }
-    else if(!str.Mid(3,2).IsSameAs(_T("VD")))
+    else if(strncmp(&sentence[3], "VD", 2))
     {
           return AIS_NMEAVDX_BAD;
     }
 
     //  OK, looks like the sentence is OK
 
-    //  Use a tokenizer to pull out the first 4 fields
-    wxString string(str);
-    wxStringTokenizer tkz(string, _T(","));
-
-    wxString token;
-    token = tkz.GetNextToken();         // !xxVDx
-
-    token = tkz.GetNextToken();
-    nsentences = atoi(token.mb_str());
-
-    token = tkz.GetNextToken();
-    isentence = atoi(token.mb_str());
-
-    token = tkz.GetNextToken();
-    long lsequence_id = 0;
-    token.ToLong(&lsequence_id);
+    //  Split the leading fields in place
+    //  !xxVDx,count,index,sequence,channel,payload,fill*hh
+    const char *field[7];
+    int nfield = 0;
+    char *p = sentence;
+    field[nfield++] = p;
+    while(*p && (nfield < 7))
+    {
+          if(*p == ',')
+          {
+                *p = 0;
+                field[nfield++] = p + 1;
+          }
+          p++;
+    }
+    while(nfield < 7)
+          field[nfield++] = "";
 
-    token = tkz.GetNextToken();
-    long lchannel;
-    token.ToLong(&lchannel);
+    nsentences = atoi(field[1]);
+    isentence = atoi(field[2]);
 
     //  Now, some decisions
 
-    string_to_parse.Clear();
+    const char *payload = "";
+    int payload_len = 0;
 
     //  Simple case first
     //  First and only part of a one-part sentence
     if((1 == nsentences) && (1 == isentence))
     {
-        string_to_parse = tkz.GetNextToken();         // the encapsulated data
+        payload = field[5];                             // the encapsulated data
+        payload_len = strlen(payload);
     }
 
     else if(nsentences > 1)
     {
         if(1 == isentence)
-        {
-            sentence_accumulator = tkz.GetNextToken();         // the encapsulated data
-        }
+              accumulator_length = 0;
 
-        else
+        int flen = strlen(field[5]);
+        if(accumulator_length + flen < AIS_MAX_MESSAGE_LEN)
         {
-            sentence_accumulator += tkz.GetNextToken();
+              memcpy(&sentence_accumulator[accumulator_length], field[5], flen);
+              accumulator_length += flen;
         }
+        else
+              accumulator_length = AIS_MAX_MESSAGE_LEN;       // overlong, will be rejected below
+
+        sentence_accumulator[accumulator_length] = 0;
 
         if(isentence == nsentences)
         {
-            string_to_parse = sentence_accumulator;
+            payload = sentence_accumulator;
+            payload_len = accumulator_length;
         }
      }
 
 
-     if ( mmsi || (!string_to_parse.IsEmpty() && (string_to_parse.Len() < AIS_MAX_MESSAGE_LEN)) )
+     if ( mmsi || ((payload_len > 0) && (payload_len < AIS_MAX_MESSAGE_LEN)) )
      {
 
         //  Create the bit accessible string
-        AIS_Bitstring strbit(string_to_parse.mb_str());
+        AIS_Bitstring strbit(payload, payload_len);
 
         //  Extract the MMSI
         if (!mmsi)
               mmsi = strbit.GetInt(9, 30);
-        long mmsi_long = mmsi;
 
         //  Here is some debug code to capture/filter to on MMSI number
 //        if(mmsi != 244670456)
@@ -1928,9 +2072,9 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
         AIS_Target_Data *pStaleTarget = NULL;
         bool bnewtarget = false;
 
-        //  Search the current AISTargetList for an MMSI match
-        AIS_Target_Hash::iterator it = AISTargetList->find( mmsi );
-        if(it == AISTargetList->end())                  // not found
+        //  Search the working target list for an MMSI match
+        AIS_Target_Hash::iterator it = m_pWorkTargets->find( mmsi );
+        if(it == m_pWorkTargets->end())                  // not found
         {
               pTargetData = new AIS_Target_Data;
               bnewtarget = true;
@@ -1938,7 +2082,7 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
         }
         else
         {
-              pTargetData = (*AISTargetList)[mmsi];          // find current entry
+              pTargetData = it->second;                     // find current entry
               pStaleTarget = pTargetData;                   // save a pointer to stale data
         }
 
@@ -1953,10 +2097,6 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
         else
               last_report_ticks = now.GetTicks();
 
-        // Delete the stale AIS Target selectable point if not a CDDSE
-        if(pStaleTarget && !dse_mmsi)
-            pSelectAIS->DeleteSelectablePoint((void *)mmsi_long, SELTYPE_AISTARGET);
-
         bool bhad_name = false;
         if(pStaleTarget)
             bhad_name =  pStaleTarget->b_nameValid;
@@ -2031,7 +2171,7 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
 
         m_pLatestTargetData = pTargetData;
 
-        if(str.Mid(3,3).IsSameAs(_T("VDO")))
+        if(b_vdo)
               pTargetData->b_OwnShip = true;
 
         if((bdecode_result) && (pTargetData->b_nameValid) && (pStaleTarget))
@@ -2042,21 +2182,17 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
         //  Update the AIS Target information
         if(bdecode_result)
         {
-              (*AISTargetList)[mmsi] = pTargetData;            // update the hash table entry
+              (*m_pWorkTargets)[mmsi] = pTargetData;           // update the hash table entry
+              pTargetData->b_changed = true;
 
               //     Update the most recent report period
               if (!dse_mmsi)
                     pTargetData->RecentPeriod = pTargetData->PositionReportTicks - last_report_ticks;
 
-              //  If this is not an ownship message, update the AIS Target in the Selectable list, and update the CPA info
+              //  If this is not an ownship message, update the CPA info
+              //  The Selectable list is rebuilt from each published snapshot
               if(!pTargetData->b_OwnShip)
               {
-                    if(pTargetData->b_positionOnceValid)
-                    {
-                          SelectItem *pSel = pSelectAIS->AddSelectablePoint(pTargetData->Lat, pTargetData->Lon, (void *)mmsi_long, SELTYPE_AISTARGET);
-                          pSel->SetUserData(mmsi);
-                    }
-
             //    Calculate CPA info for this target immediately
                     UpdateOneCPA(pTargetData);
 
@@ -2073,9 +2209,13 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
                     delete pTargetData;                                       // this target is not going to be used
                     m_n_targets--;
              }
+             else
+                    pTargetData->b_changed = true;                            // may be partly updated
         }
 
 
+        m_bWorkDirty = true;
+
         ret = AIS_NoError;
 
         if( g_nNMEADebug && (g_total_NMEAerror_messages < g_nNMEADebug) ) // debug pjotrc
@@ -2113,6 +2253,52 @@ AIS_Error AIS_Decoder::Decode(const wxString& str)
 
 
 
+//----------------------------------------------------------------------------
+//      Position report field layouts, by message type
+//      Start bits are 1-based, a zero start bit means the field is not carried
+//----------------------------------------------------------------------------
+typedef struct
+{
+      int   lon_sp;           // 28 bits signed, 1/10000 minute
+      int   lat_sp;           // 27 bits signed, 1/10000 minute
+      int   sog_sp;           // 10 bits, 0.1 knot
+      int   cog_sp;           // 12 bits, 0.1 degree
+      int   hdg_sp;           //  9 bits, degrees
+      int   sec_sp;           //  6 bits, UTC second
+} AIS_PosnLayout;
+
+static const AIS_PosnLayout s_PosnLayout_ClassA = {  62,  90, 51, 117, 129, 138 };      // 1, 2, 3
+static const AIS_PosnLayout s_PosnLayout_ClassB = {  58,  86, 47, 113, 125, 134 };      // 18
+static const AIS_PosnLayout s_PosnLayout_Base   = {  80, 108,  0,   0,   0,   0 };      // 4
+static const AIS_PosnLayout s_PosnLayout_AtoN   = { 165, 193,  0,   0,   0,   0 };      // 21
+
+static void ParsePosnLayout(AIS_Bitstring *bstr, const AIS_PosnLayout &layout, AIS_Target_Data *ptd, time_t ticks)
+{
+      if(layout.sog_sp)
+            ptd->SOG = 0.1 * (bstr->GetInt(layout.sog_sp, 10));
+
+      double lon_tentative = bstr->GetInt(layout.lon_sp, 28, true) / 600000.;
+      double lat_tentative = bstr->GetInt(layout.lat_sp, 27, true) / 600000.;
+
+      if((lon_tentative <= 180.) && (lat_tentative <= 90.))   // Ship does not report Lat or Lon "unavailable"
+      {
+            ptd->Lon = lon_tentative;
+            ptd->Lat = lat_tentative;
+            ptd->b_positionDoubtful = false;
+            ptd->b_positionOnceValid = true;          // Got the position at least once
+            ptd->PositionReportTicks = ticks;
+      }
+      else
+            ptd->b_positionDoubtful = true;
+
+      if(layout.cog_sp)
+            ptd->COG = 0.1 * (bstr->GetInt(layout.cog_sp, 12));
+      if(layout.hdg_sp)
+            ptd->HDG = 1.0 * (bstr->GetInt(layout.hdg_sp, 9));
+      if(layout.sec_sp)
+            ptd->m_utc_sec = bstr->GetInt(layout.sec_sp, 6);
+}
+
 //----------------------------------------------------------------------------
 //      Parse a NMEA VDM/VDO Bitstring
 //----------------------------------------------------------------------------
@@ -2149,33 +2335,10 @@ bool AIS_Decoder::Parse_VDXBitstring(AIS_Bitstring *bstr, AIS_Target_Data *ptd)
             n_msg1++;
 
             ptd->NavStatus = bstr->GetInt(39, 4);
-            ptd->SOG = 0.1 * (bstr->GetInt(51, 10));
 
-            int lon = bstr->GetInt(62, 28);
-            if(lon & 0x08000000)                    // negative?
-                lon |= 0xf0000000;
-            double lon_tentative = lon / 600000.;
-
-            int lat = bstr->GetInt(90, 27);
-            if(lat & 0x04000000)                    // negative?
-                lat |= 0xf8000000;
-            double lat_tentative = lat / 600000.;
-
-            if((lon_tentative <= 180.) && (lat_tentative <= 90.))   // Ship does not report Lat or Lon "unavailable"
-            {
-                  ptd->Lon = lon_tentative;
-                  ptd->Lat = lat_tentative;
-                  ptd->b_positionDoubtful = false;
-                  ptd->b_positionOnceValid = true;          // Got the position at least once
-                  ptd->PositionReportTicks = now.GetTicks();
-            }
-            else
-                  ptd->b_positionDoubtful = true;
+            ParsePosnLayout(bstr, s_PosnLayout_ClassA, ptd, now.GetTicks());
 
             //    decode balance of message....
-            ptd->COG = 0.1 * (bstr->GetInt(117, 12));
-            ptd->HDG = 1.0 * (bstr->GetInt(129, 9));
-
 
             ptd->ROTAIS = bstr->GetInt(43, 8);
             double rot_dir = 1.0;
@@ -2190,8 +2353,6 @@ bool AIS_Decoder::Parse_VDXBitstring(AIS_Bitstring *bstr, AIS_Target_Data *ptd)
 
             ptd->ROTIND = wxRound(rot_dir * pow((((double)ptd->ROTAIS) / 4.733), 2));      // Convert to indicated ROT
 
-            ptd->m_utc_sec = bstr->GetInt(138, 6);
-
             if((1 == message_ID) || (2 == message_ID))      // decode SOTDMA per 7.6.7.2.2
             {
                   ptd->SyncState = bstr->GetInt(151,2);
@@ -2241,33 +2402,7 @@ bool AIS_Decoder::Parse_VDXBitstring(AIS_Bitstring *bstr, AIS_Target_Data *ptd)
 
           case 18:
           {
-                ptd->SOG = 0.1 * (bstr->GetInt(47, 10));
-
-                int lon = bstr->GetInt(58, 28);
-                if(lon & 0x08000000)                    // negative?
-                      lon |= 0xf0000000;
-                double lon_tentative = lon / 600000.;
-
-                int lat = bstr->GetInt(86, 27);
-                if(lat & 0x04000000)                    // negative?
-                      lat |= 0xf8000000;
-                double lat_tentative = lat / 600000.;
-
-                if((lon_tentative <= 180.) && (lat_tentative <= 90.))   // Ship does not report Lat or Lon "unavailable"
-                {
-                      ptd->Lon = lon_tentative;
-                      ptd->Lat = lat_tentative;
-                      ptd->b_positionDoubtful = false;
-                      ptd->b_positionOnceValid = true;          // Got the position at least once
-                      ptd->PositionReportTicks = now.GetTicks();
-                }
-                else
-                      ptd->b_positionDoubtful = true;
-
-                ptd->COG = 0.1 * (bstr->GetInt(113, 12));
-                ptd->HDG = 1.0 * (bstr->GetInt(125, 9));
-
-                ptd->m_utc_sec = bstr->GetInt(134, 6);
+                ParsePosnLayout(bstr, s_PosnLayout_ClassB, ptd, now.GetTicks());
 
                 ptd->Class = AIS_CLASS_B;
 
@@ -2362,26 +2497,7 @@ bool AIS_Decoder::Parse_VDXBitstring(AIS_Bitstring *bstr, AIS_Target_Data *ptd)
                 ptd->m_utc_min    = bstr->GetInt(67,  6);
                 ptd->m_utc_sec    = bstr->GetInt(73,  6);
                 //                              (79,  1);
-                int lon = bstr->GetInt(80, 28);
-                if(lon & 0x08000000)                    // negative?
-                      lon |= 0xf0000000;
-                double lon_tentative = lon / 600000.;
-
-                int lat = bstr->GetInt(108, 27);
-                if(lat & 0x04000000)                    // negative?
-                      lat |= 0xf8000000;
-                double lat_tentative = lat / 600000.;
-
-                if((lon_tentative <= 180.) && (lat_tentative <= 90.))   // Ship does not report Lat or Lon "unavailable"
-                {
-                      ptd->Lon = lon_tentative;
-                      ptd->Lat = lat_tentative;
-                      ptd->b_positionDoubtful = false;
-                      ptd->b_positionOnceValid = true;          // Got the position at least once
-                      ptd->PositionReportTicks = now.GetTicks();
-                }
-                else
-                      ptd->b_positionDoubtful = true;
+                ParsePosnLayout(bstr, s_PosnLayout_Base, ptd, now.GetTicks());
 
                 ptd->COG = -1.;
                 ptd->HDG = 511;
@@ -2445,28 +2561,7 @@ bool AIS_Decoder::Parse_VDXBitstring(AIS_Bitstring *bstr, AIS_Target_Data *ptd)
 
                 ptd->Class = AIS_ATON;
 
-                int lon = bstr->GetInt(165, 28);
-
-                if(lon & 0x08000000)                    // negative?
-                      lon |= 0xf0000000;
-                double lon_tentative = lon / 600000.;
-
-                int lat = bstr->GetInt(193, 27);
-
-                if(lat & 0x04000000)                    // negative?
-                      lat |= 0xf8000000;
-                double lat_tentative = lat / 600000.;
-
-                if((lon_tentative <= 180.) && (lat_tentative <= 90.))   // Ship does not report Lat or Lon "unavailable"
-                {
-                      ptd->Lon = lon_tentative;
-                      ptd->Lat = lat_tentative;
-                      ptd->b_positionDoubtful = false;
-                      ptd->b_positionOnceValid = true;          // Got the position at least once
-                      ptd->PositionReportTicks = now.GetTicks();
-                }
-                else
-                      ptd->b_positionDoubtful = true;
+                ParsePosnLayout(bstr, s_PosnLayout_AtoN, ptd, now.GetTicks());
 
                 if( g_nNMEADebug && (g_total_NMEAerror_messages < g_nNMEADebug) )
                 {
@@ -2622,19 +2717,11 @@ bool AIS_Decoder::Parse_VDXBitstring(AIS_Bitstring *bstr, AIS_Target_Data *ptd)
                   }
 
                 //      Show the alert dialog for "active" AIS_SART target only
+                //      The dialog itself is raised by the UI thread when the next snapshot is adopted
                   if((ptd->Class == AIS_SART) && (ptd->NavStatus == 14))
                   {
-                        if(!g_pais_alert_dialog_active)
-                        {
-                              AISTargetAlertDialog *pAISAlertDialog = new AISTargetAlertDialog();
-                              pAISAlertDialog->Create ( ptd->MMSI, m_parent_frame, this, -1, _("AIS SART Alert"),
-                                    wxPoint( g_ais_alert_dialog_x, g_ais_alert_dialog_y),
-                                                wxSize( g_ais_alert_dialog_sx, g_ais_alert_dialog_sy));
-
-                              g_pais_alert_dialog_active = pAISAlertDialog;
-                              pAISAlertDialog->Show();                        // Show modeless, so it stays on the screen
-                        }
-
+                        if(wxNOT_FOUND == m_SART_pending.Index(ptd->MMSI))
+                              m_SART_pending.Add(ptd->MMSI);
                   }
                 break;
           }
@@ -2671,14 +2758,19 @@ bool AIS_Decoder::Parse_VDXBitstring(AIS_Bitstring *bstr, AIS_Target_Data *ptd)
 
 bool AIS_Decoder::NMEACheckSumOK(const wxString& str_in)
 {
-
-   unsigned char checksum_value = 0;
-   int sentence_hex_sum;
-
    char str_ascii[AIS_MAX_MESSAGE_LEN + 1];
    strncpy(str_ascii, str_in.mb_str(), AIS_MAX_MESSAGE_LEN);
    str_ascii[AIS_MAX_MESSAGE_LEN] = '\0';
 
+   return NMEACheckSumOK(str_ascii);
+}
+
+bool AIS_Decoder::NMEACheckSumOK(const char *str_ascii)
+{
+
+   unsigned char checksum_value = 0;
+   int sentence_hex_sum;
+
    int string_length = strlen(str_ascii);
 
    int payload_length = 0;                       // pjotrc 2010.02.07
@@ -2714,14 +2806,26 @@ void AIS_Decoder::UpdateAllCPA(void)
 {
       //    Iterate thru all the targets
       AIS_Target_Hash::iterator it;
-      AIS_Target_Hash *current_targets = GetTargetList();
+      AIS_Target_Hash *current_targets = m_pWorkTargets;
 
       for( it = (*current_targets).begin(); it != (*current_targets).end(); ++it )
       {
             AIS_Target_Data *td = it->second;
 
             if(NULL != td)
+            {
+                  double range = td->Range_NM;
+                  double brg = td->Brg;
+                  double cpa = td->CPA;
+                  double tcpa = td->TCPA;
+                  bool b_cpa_valid = td->bCPA_Valid;
+
                   UpdateOneCPA(td);
+
+                  if((td->Range_NM != range) || (td->Brg != brg) || (td->CPA != cpa) ||
+                      (td->TCPA != tcpa) || (td->bCPA_Valid != b_cpa_valid))
+                        td->b_changed = true;
+            }
       }
 }
 
@@ -2729,7 +2833,7 @@ void AIS_Decoder::UpdateAllTracks(void)
 {
            //    Iterate thru all the targets
       AIS_Target_Hash::iterator it;
-      AIS_Target_Hash *current_targets = GetTargetList();
+      AIS_Target_Hash *current_targets = m_pWorkTargets;
 
       for( it = (*current_targets).begin(); it != (*current_targets).end(); ++it )
       {
@@ -2781,12 +2885,12 @@ void AIS_Decoder::UpdateOneTrack(AIS_Target_Data *ptarget)
 
 void AIS_Decoder::UpdateAllAlarms(void)
 {
-      m_bGeneralAlert    = false;                // no alerts yet
+      m_bWorkGeneralAlert = false;                // no alerts yet
 
 
            //    Iterate thru all the targets
       AIS_Target_Hash::iterator it;
-      AIS_Target_Hash *current_targets = GetTargetList();
+      AIS_Target_Hash *current_targets = m_pWorkTargets;
 
       for( it = (*current_targets).begin(); it != (*current_targets).end(); ++it )
       {
@@ -2794,93 +2898,104 @@ void AIS_Decoder::UpdateAllAlarms(void)
 
             if(NULL != td)
             {
-                  //  Maintain General Alert
-                  if(!m_bGeneralAlert)
-                  {
-                  //    Quick check on basic condition
-                        if((td->CPA < g_CPAWarn_NM) && (td->TCPA > 0))
-                              m_bGeneralAlert = true;
+                  ais_alarm_type alarm_state = td->n_alarm_state;
+                  bool b_in_ack_timeout = td->b_in_ack_timeout;
 
-                  //    Some options can suppress general alerts
-                        if(g_bAIS_CPA_Alert_Suppress_Moored && (td->SOG <= g_ShowMoored_Kts))
-                              m_bGeneralAlert = false;
+                  UpdateOneAlarm(td);
 
-                  //    Skip distant targets if requested
-                        if((g_bCPAMax) && ( td->Range_NM > g_CPAMax_NM))
-                              m_bGeneralAlert = false;
+                  if((td->n_alarm_state != alarm_state) || (td->b_in_ack_timeout != b_in_ack_timeout))
+                        td->b_changed = true;
+            }
+      }
+}
 
-                  //    Skip if TCPA is too long
-                        if((g_bTCPA_Max) && (td->TCPA > g_TCPA_Max))
-                              m_bGeneralAlert = false;
-                  }
+void AIS_Decoder::UpdateOneAlarm(AIS_Target_Data *ptarget)
+{
+      //  Maintain General Alert
+      if(!m_bWorkGeneralAlert)
+      {
+      //    Quick check on basic condition
+            if((ptarget->CPA < g_CPAWarn_NM) && (ptarget->TCPA > 0))
+                  m_bWorkGeneralAlert = true;
 
-                  ais_alarm_type this_alarm = AIS_NO_ALARM;
-                  if(g_bCPAWarn && td->b_active && td->b_positionOnceValid)
-                  {
-                        //      Skip anchored/moored(interpreted as low speed) targets if requested
-                        if((!g_bShowMoored) && (td->SOG <= g_ShowMoored_Kts))        // dsr
-                        {
-                              td->n_alarm_state = AIS_NO_ALARM;
-                              continue;
-                        }
+      //    Some options can suppress general alerts
+            if(g_bAIS_CPA_Alert_Suppress_Moored && (ptarget->SOG <= g_ShowMoored_Kts))
+                  m_bWorkGeneralAlert = false;
 
-                        //    No Alert on moored(interpreted as low speed) targets if so requested
-                        if(g_bAIS_CPA_Alert_Suppress_Moored && (td->SOG <= g_ShowMoored_Kts))                 // dsr
-                        {
+      //    Skip distant targets if requested
+            if((g_bCPAMax) && ( ptarget->Range_NM > g_CPAMax_NM))
+                  m_bWorkGeneralAlert = false;
 
-                              td->n_alarm_state = AIS_NO_ALARM;
-                              continue;
-                        }
+      //    Skip if TCPA is too long
+            if((g_bTCPA_Max) && (ptarget->TCPA > g_TCPA_Max))
+                  m_bWorkGeneralAlert = false;
+      }
 
+      ais_alarm_type this_alarm = AIS_NO_ALARM;
+      if(g_bCPAWarn && ptarget->b_active && ptarget->b_positionOnceValid)
+      {
+            //      Skip anchored/moored(interpreted as low speed) targets if requested
+            if((!g_bShowMoored) && (ptarget->SOG <= g_ShowMoored_Kts))        // dsr
+            {
+                  ptarget->n_alarm_state = AIS_NO_ALARM;
+                  return;
+            }
 
-                        //    Skip distant targets if requested
-                        if(g_bCPAMax)
-                        {
-                              if( td->Range_NM > g_CPAMax_NM)
-                              {
-                                    td->n_alarm_state = AIS_NO_ALARM;
-                                    continue;
-                              }
-                        }
+            //    No Alert on moored(interpreted as low speed) targets if so requested
+            if(g_bAIS_CPA_Alert_Suppress_Moored && (ptarget->SOG <= g_ShowMoored_Kts))                 // dsr
+            {
+
+                  ptarget->n_alarm_state = AIS_NO_ALARM;
+                  return;
+            }
 
-                        if((td->CPA < g_CPAWarn_NM) && (td->TCPA > 0))
-                        {
-                              if(g_bTCPA_Max)
-                              {
-                                    if(td->TCPA < g_TCPA_Max)
-                                          this_alarm = AIS_ALARM_SET;
-                              }
-                        else
-                              this_alarm = AIS_ALARM_SET;
-                        }
-                  }
 
-                  //    Maintain the timer for in_ack flag
-                  if(g_bAIS_ACK_Timeout)
+            //    Skip distant targets if requested
+            if(g_bCPAMax)
+            {
+                  if( ptarget->Range_NM > g_CPAMax_NM)
                   {
-                        if(td->b_in_ack_timeout)
-                        {
-                              wxTimeSpan delta = wxDateTime::Now() - td->m_ack_time;
-                              if(delta.GetMinutes() > g_AckTimeout_Mins)
-                                   td->b_in_ack_timeout = false;
-                        }
+                        ptarget->n_alarm_state = AIS_NO_ALARM;
+                        return;
                   }
-                  else
-                        td->b_in_ack_timeout = false;
+            }
 
-                  td->n_alarm_state = this_alarm;
+            if((ptarget->CPA < g_CPAWarn_NM) && (ptarget->TCPA > 0))
+            {
+                  if(g_bTCPA_Max)
+                  {
+                        if(ptarget->TCPA < g_TCPA_Max)
+                              this_alarm = AIS_ALARM_SET;
+                  }
+            else
+                  this_alarm = AIS_ALARM_SET;
+            }
+      }
 
+      //    Maintain the timer for in_ack flag
+      if(g_bAIS_ACK_Timeout)
+      {
+            if(ptarget->b_in_ack_timeout)
+            {
+                  wxTimeSpan delta = wxDateTime::Now() - ptarget->m_ack_time;
+                  if(delta.GetMinutes() > g_AckTimeout_Mins)
+                       ptarget->b_in_ack_timeout = false;
             }
       }
+      else
+            ptarget->b_in_ack_timeout = false;
+
+      ptarget->n_alarm_state = this_alarm;
 }
 
 
 void AIS_Decoder::UpdateOneCPA(AIS_Target_Data *ptarget)
 {
+      //    Ownship state is the copy taken by the worker at its last tick
       ptarget->Range_NM = -1.;            // Defaults
       ptarget->Brg = -1.;
 
-      if(!ptarget->b_positionOnceValid || !bGPSValid)
+      if(!ptarget->b_positionOnceValid || !m_cpa_bGPSValid)
       {
             ptarget->bCPA_Valid = false;
             return;
@@ -2888,7 +3003,7 @@ void AIS_Decoder::UpdateOneCPA(AIS_Target_Data *ptarget)
 
       //    Compute the current Range/Brg to the target
       double brg, dist;
-      DistanceBearingMercator(ptarget->Lat, ptarget->Lon, gLat, gLon, &brg, &dist);
+      DistanceBearingMercator(ptarget->Lat, ptarget->Lon, m_cpa_lat, m_cpa_lon, &brg, &dist);
       ptarget->Range_NM = dist;
       ptarget->Brg = brg;
 
@@ -2907,20 +3022,20 @@ void AIS_Decoder::UpdateOneCPA(AIS_Target_Data *ptarget)
             return;
       }
 
-      double cpa_calc_ownship_cog = gCog;
+      double cpa_calc_ownship_cog = m_cpa_cog;
       double cpa_calc_target_cog = ptarget->COG;
 
 //    Ownship is not reporting valid SOG, so no way to calculate CPA
-      if(wxIsNaN(gSog) || (gSog > 102.2))
+      if(wxIsNaN(m_cpa_sog) || (m_cpa_sog > 102.2))
       {
             ptarget->bCPA_Valid = false;
             return;
       }
 
 //    Ownship is maybe anchored and not reporting COG
-      if( wxIsNaN(gCog) || gCog == 360.0 )
+      if( wxIsNaN(m_cpa_cog) || m_cpa_cog == 360.0 )
       {
-            if(gSog < .01)
+            if(m_cpa_sog < .01)
                   cpa_calc_ownship_cog = 0.;          // substitute value
                                                       // for the case where SOG ~= 0, and COG is unknown.
             else
@@ -2950,7 +3065,7 @@ void AIS_Decoder::UpdateOneCPA(AIS_Target_Data *ptarget)
 
 
       //    Express the SOGs as meters per hour
-      double v0 = gSog         * 1852.;
+      double v0 = m_cpa_sog    * 1852.;
       double v1 = ptarget->SOG * 1852.;
 
       if((v0 < 1e-6) && (v1 < 1e-6))
@@ -2967,10 +3082,10 @@ void AIS_Decoder::UpdateOneCPA(AIS_Target_Data *ptarget)
             //    Working on a Reduced Lat/Lon orthogonal plotting sheet....
             //    Get easting/northing to target,  in meters
 
-            double east1 = (ptarget->Lon - gLon) * 60 * 1852;
-            double north1 = (ptarget->Lat - gLat) * 60 * 1852;
+            double east1 = (ptarget->Lon - m_cpa_lon) * 60 * 1852;
+            double north1 = (ptarget->Lat - m_cpa_lat) * 60 * 1852;
 
-            double east = east1 * (cos(gLat * PI / 180));;
+            double east = east1 * (cos(m_cpa_lat * PI / 180));;
             double north = north1;
 
             //    Convert COGs trigonometry to standard unit circle
@@ -3002,7 +3117,7 @@ void AIS_Decoder::UpdateOneCPA(AIS_Target_Data *ptarget)
 
             double OwnshipLatCPA, OwnshipLonCPA, TargetLatCPA, TargetLonCPA;
 
-            ll_gc_ll(gLat,         gLon,         cpa_calc_ownship_cog, gSog * tcpa, &OwnshipLatCPA, &OwnshipLonCPA);
+            ll_gc_ll(m_cpa_lat,    m_cpa_lon,    cpa_calc_ownship_cog, m_cpa_sog * tcpa, &OwnshipLatCPA, &OwnshipLonCPA);
             ll_gc_ll(ptarget->Lat, ptarget->Lon, cpa_calc_target_cog, ptarget->SOG * tcpa, &TargetLatCPA,  &TargetLonCPA);
 
             //   And compute the distance
@@ -3277,69 +3392,15 @@ void AIS_Decoder::OnSocketEvent(wxSocketEvent& event)
 #endif
 }
 
-void AIS_Decoder::OnTimerAISAudio(wxTimerEvent& event)
+//    Scrub the target hash list
+//    removing any targets older than stipulated age
+void AIS_Decoder::ScrubTargets(void)
 {
-      if(g_bAIS_CPA_Alert_Audio && m_bAIS_Audio_Alert_On)
-      {
-            m_AIS_Sound.Create(g_sAIS_Alert_Sound_File);
-            if(m_AIS_Sound.IsOk())
-                  m_AIS_Sound.Play();
-      }
-      m_AIS_Audio_Alert_Timer.Start(TIMER_AIS_AUDIO_MSEC,wxTIMER_CONTINUOUS);
-}
-
-void AIS_Decoder::OnTimerAIS(wxTimerEvent& event)
-{
-      TimerAIS.Stop();
-
-#if 0
-      /// testing for orphans in the Select list
-      SelectItem *pFindSel;
-
-//    Iterate on the list
-      wxSelectableItemListNode *node = pSelectAIS->GetSelectList()->GetFirst();
-
-      int n_sel = 0;
-      while(node)
-      {
-            pFindSel = node->GetData();
-            if(pFindSel->m_seltype == SELTYPE_AISTARGET)
-            {
-                  int mmsi = (int) pFindSel->m_Data4;
-
-                  AIS_Target_Data *tdp = Get_Target_Data_From_MMSI(mmsi);
-                  if(tdp == NULL)
-                        int yyp = 6;
-
-                  if(tdp->SOG > 200.)
-                        int yyu = 4;
-            }
-
-            n_sel++;
-
-            node = node->GetNext();
-      }
-
-      if(n_sel > m_n_targets)
-            int yyr = 3;
-
-      if(n_sel > GetTargetList()->size())
-            int yyl = 4;
-#endif
-
-
-      ///testing
-
-
-      //    Scrub the target hash list
-      //    removing any targets older than stipulated age
-
-
       wxDateTime now = wxDateTime::Now();
       now.MakeGMT();
 
       AIS_Target_Hash::iterator it;
-      AIS_Target_Hash *current_targets = GetTargetList();
+      AIS_Target_Hash *current_targets = m_pWorkTargets;
 
       it = (*current_targets).begin();
       while( it != (*current_targets).end())
@@ -3360,8 +3421,11 @@ void AIS_Decoder::OnTimerAIS(wxTimerEvent& event)
           //      Mark lost targets if specified
           if(g_bMarkLost)
           {
-                if((target_posn_age > g_MarkLost_Mins * 60) && (td->Class != AIS_GPSG_BUDDY))
+                if((target_posn_age > g_MarkLost_Mins * 60) && (td->Class != AIS_GPSG_BUDDY) && td->b_active)
+                {
                         td->b_active = false;
+                        td->b_changed = true;
+                }
           }
 
           //      Remove lost targets if specified
@@ -3381,9 +3445,7 @@ void AIS_Decoder::OnTimerAIS(wxTimerEvent& event)
                       td->SOG = 103.0;
                       td->HDG = 511.0;
                       td->ROTAIS = -128;
-
-                      long mmsi_long = td->MMSI;
-                      pSelectAIS->DeleteSelectablePoint((void *)mmsi_long, SELTYPE_AISTARGET);
+                      td->b_changed = true;
 
                       //      If we have not seen a static report in 3 times the removal spec,
                       //      then remove the target from all lists.
@@ -3402,7 +3464,75 @@ void AIS_Decoder::OnTimerAIS(wxTimerEvent& event)
           if(!b_new_it)
                 ++it;
       }
+}
+
+void AIS_Decoder::OnTimerAISAudio(wxTimerEvent& event)
+{
+      if(g_bAIS_CPA_Alert_Audio && m_bAIS_Audio_Alert_On)
+      {
+            m_AIS_Sound.Create(g_sAIS_Alert_Sound_File);
+            if(m_AIS_Sound.IsOk())
+                  m_AIS_Sound.Play();
+      }
+      m_AIS_Audio_Alert_Timer.Start(TIMER_AIS_AUDIO_MSEC,wxTIMER_CONTINUOUS);
+}
+
+void AIS_Decoder::OnTimerAIS(wxTimerEvent& event)
+{
+      TimerAIS.Stop();
+
+#if 0
+      /// testing for orphans in the Select list
+      SelectItem *pFindSel;
 
+//    Iterate on the list
+      wxSelectableItemListNode *node = pSelectAIS->GetSelectList()->GetFirst();
+
+      int n_sel = 0;
+      while(node)
+      {
+            pFindSel = node->GetData();
+            if(pFindSel->m_seltype == SELTYPE_AISTARGET)
+            {
+                  int mmsi = (int) pFindSel->m_Data4;
+
+                  AIS_Target_Data *tdp = Get_Target_Data_From_MMSI(mmsi);
+                  if(tdp == NULL)
+                        int yyp = 6;
+
+                  if(tdp->SOG > 200.)
+                        int yyu = 4;
+            }
+
+            n_sel++;
+
+            node = node->GetNext();
+      }
+
+      if(n_sel > m_n_targets)
+            int yyr = 3;
+
+      if(n_sel > GetTargetList()->size())
+            int yyl = 4;
+#endif
+
+
+      ///testing
+
+
+      //    Hand the current ownship state to the worker for its next CPA pass
+      //    Scrubbing, CPA and alarms are computed there, and reach this thread via snapshots
+      {
+            wxMutexLocker lock(m_WorkerMutex);
+            m_own_lat = gLat;
+            m_own_lon = gLon;
+            m_own_cog = gCog;
+            m_own_sog = gSog;
+            m_own_bGPSValid = bGPSValid;
+      }
+
+      AIS_Target_Hash::iterator it;
+      AIS_Target_Hash *current_targets = GetTargetList();
 
 //--------------TEST DATA strings
 #if 0
@@ -3421,10 +3551,6 @@ void AIS_Decoder::OnTimerAIS(wxTimerEvent& event)
       }
 #endif
 
-      UpdateAllCPA();
-
-      UpdateAllAlarms();
-
       //    Update the general suppression flag
       m_bSuppressed = false;
       if(g_bAIS_CPA_Alert_Suppress_Moored ||
@@ -3584,6 +3710,324 @@ AIS_Target_Data *AIS_Decoder::Get_Target_Data_From_MMSI(int mmsi)
 
 
 
+void AIS_Decoder::AcknowledgeTarget(int mmsi)
+{
+      AIS_Target_Data *td = Get_Target_Data_From_MMSI(mmsi);
+      if(td && (AIS_ALARM_SET == td->n_alarm_state))
+      {
+            td->m_ack_time = wxDateTime::Now();
+            td->b_in_ack_timeout = true;
+
+            wxMutexLocker lock(m_WorkerMutex);
+            m_AckRequests.Add(mmsi);
+      }
+}
+
+void AIS_Decoder::SilenceTarget(int mmsi)
+{
+      AIS_Target_Data *td = Get_Target_Data_From_MMSI(mmsi);
+      if(td)
+      {
+            td->b_suppress_audio = true;
+
+            wxMutexLocker lock(m_WorkerMutex);
+            m_SilenceRequests.Add(mmsi);
+      }
+}
+
+//    Apply the alert dialog actions to a target table
+//    Called with m_WorkerMutex held
+static void ApplyAlertRequests(AIS_Target_Hash *ptargets, wxArrayInt &acks, wxArrayInt &silences)
+{
+      for(unsigned int i=0 ; i < acks.GetCount() ; i++)
+      {
+            AIS_Target_Hash::iterator it = ptargets->find( acks.Item(i) );
+            if((it != ptargets->end()) && it->second)
+            {
+                  it->second->m_ack_time = wxDateTime::Now();
+                  it->second->b_in_ack_timeout = true;
+                  it->second->b_changed = true;
+            }
+      }
+
+      for(unsigned int i=0 ; i < silences.GetCount() ; i++)
+      {
+            AIS_Target_Hash::iterator it = ptargets->find( silences.Item(i) );
+            if((it != ptargets->end()) && it->second)
+            {
+                  it->second->b_suppress_audio = true;
+                  it->second->b_changed = true;
+            }
+      }
+}
+
+//    UI thread, on EVT_AIS_SNAPSHOT
+//    Swap in the pending snapshot, and update what is derived from the targets that changed
+void AIS_Decoder::AdoptSnapshot(void)
+{
+      AIS_Target_Snapshot *psnap;
+      {
+            wxMutexLocker lock(m_WorkerMutex);
+            psnap = m_pPendingSnapshot;
+            m_pPendingSnapshot = NULL;
+
+            //    Requests the worker has not yet taken still apply to this copy
+            if(psnap)
+                  ApplyAlertRequests(psnap->m_pTargets, m_AckRequests, m_SilenceRequests);
+      }
+
+      if(!psnap)
+            return;
+
+      //    Update the AIS Target entries in the Selectable list for the targets that changed
+      for(unsigned int i=0 ; i < psnap->m_removed.GetCount() ; i++)
+      {
+            long mmsi_long = psnap->m_removed.Item(i);
+            pSelectAIS->DeleteSelectablePoint((void *)mmsi_long, SELTYPE_AISTARGET);
+      }
+
+      for(unsigned int i=0 ; i < psnap->m_changed.GetCount() ; i++)
+      {
+            int mmsi = psnap->m_changed.Item(i);
+            long mmsi_long = mmsi;
+
+            AIS_Target_Data *td = (*psnap->m_pTargets)[mmsi];
+            if(td && !td->b_OwnShip && td->b_positionOnceValid)
+            {
+                  if(!pSelectAIS->ModifySelectablePoint(td->Lat, td->Lon, (void *)mmsi_long, SELTYPE_AISTARGET))
+                  {
+                        SelectItem *pSel = pSelectAIS->AddSelectablePoint(td->Lat, td->Lon, (void *)mmsi_long, SELTYPE_AISTARGET);
+                        pSel->SetUserData(mmsi);
+                  }
+            }
+            else
+                  pSelectAIS->DeleteSelectablePoint((void *)mmsi_long, SELTYPE_AISTARGET);
+      }
+
+      //    No reader holds a target pointer across events, so the previous snapshot can go now.
+      //    Only the records it does not share with the new one are freed.
+      AIS_Target_Snapshot *pold = m_pSnapshot;
+      m_pSnapshot = psnap;
+      AISTargetList = psnap->m_pTargets;
+      m_bGeneralAlert = psnap->m_bGeneralAlert;
+      delete pold;
+
+      //      Show the alert dialog for "active" AIS_SART target only
+      for(unsigned int i=0 ; i < psnap->m_SART_alerts.GetCount() ; i++)
+      {
+            if(!g_pais_alert_dialog_active)
+            {
+                  AISTargetAlertDialog *pAISAlertDialog = new AISTargetAlertDialog();
+                  pAISAlertDialog->Create ( psnap->m_SART_alerts.Item(i), m_parent_frame, this, -1, _("AIS SART Alert"),
+                                            wxPoint( g_ais_alert_dialog_x, g_ais_alert_dialog_y),
+                                            wxSize( g_ais_alert_dialog_sx, g_ais_alert_dialog_sy));
+
+                  g_pais_alert_dialog_active = pAISAlertDialog;
+                  pAISAlertDialog->Show();                        // Show modeless, so it stays on the screen
+            }
+      }
+}
+
+//    Worker thread
+//    Decode one batch of queued sentences, run the periodic target maintenance,
+//    and publish a snapshot if anything changed
+void AIS_Decoder::WorkerProcess(void)
+{
+      m_pInputQueue->ClearWakeup();
+
+      int n = m_pInputQueue->Available();
+      for(int i=0 ; i < n ; i++)
+      {
+            NMEAQueueSlot *pslot = m_pInputQueue->Peek(i);
+
+            AIS_Error nr = Decode(pslot->sentence);
+
+            if((AIS_NoError == nr) && !strcmp(pslot->id, "VDO"))
+                  WorkerSendOwnship();
+      }
+      m_pInputQueue->Pop(n);
+
+      wxLongLong now_ms = wxGetLocalTimeMillis();
+
+      if((now_ms - m_last_tick_ms) >= TIMER_AIS_MSEC)
+      {
+            m_last_tick_ms = now_ms;
+
+            {
+                  wxMutexLocker lock(m_WorkerMutex);
+                  m_cpa_lat = m_own_lat;
+                  m_cpa_lon = m_own_lon;
+                  m_cpa_cog = m_own_cog;
+                  m_cpa_sog = m_own_sog;
+                  m_cpa_bGPSValid = m_own_bGPSValid;
+            }
+
+            ScrubTargets();
+            UpdateAllCPA();
+            UpdateAllAlarms();
+
+            m_bWorkDirty = true;
+      }
+
+      if(m_bWorkDirty && ((now_ms - m_last_publish_ms) >= AIS_SNAPSHOT_MSEC))
+            PublishSnapshot();
+}
+
+//    Worker thread
+//    This is an ownship message, presumably from a transponder
+//    Simulate an ownship GPS position report upstream for message IDs 1,2,3
+void AIS_Decoder::WorkerSendOwnship(void)
+{
+      if(!m_pLatestTargetData || !g_bGPSAISMux)
+            return;
+      if(m_pLatestTargetData->b_positionDoubtful || !m_pLatestTargetData->b_positionOnceValid)
+            return;
+
+      switch(m_pLatestTargetData->MID)
+      {
+            case 1:
+            case 2:
+            case 3:
+            {
+                  //    The main thread may still be reading the previous fix, so use the next slot
+                  GenericPosDatEx *pfix = &AISPositionData[m_posn_ring_index];
+                  m_posn_ring_index = (m_posn_ring_index + 1) % AIS_POSN_RING;
+
+                  pfix->kLat = m_pLatestTargetData->Lat;
+                  pfix->kLon = m_pLatestTargetData->Lon;
+
+                  if(m_pLatestTargetData->COG == 360.0)
+                        pfix->kCog = NAN;
+                  else
+                        pfix->kCog = m_pLatestTargetData->COG;
+
+
+                  if(m_pLatestTargetData->SOG > 102.2)
+                        pfix->kSog = NAN;
+                  else
+                        pfix->kSog = m_pLatestTargetData->SOG;
+
+                  wxCommandEvent event( EVT_NMEA,  m_handler_id );
+                  event.SetEventObject( (wxObject *)this );
+                  event.SetExtraLong(EVT_NMEA_DIRECT);
+                  event.SetClientData(pfix);
+                  m_pMainEventHandler->AddPendingEvent(event);
+                  break;
+            }
+            default:
+                  break;
+      }
+}
+
+//    Worker thread
+//    Publish the working table to the UI thread as a new snapshot.  Targets changed
+//    since the previous snapshot get a fresh copy, the others share the record
+//    already published.
+//    m_pPublishedTargets holds no references of its own.  A snapshot is only built
+//    once the previous one has been adopted, and the adopted snapshot keeps every
+//    record in m_pPublishedTargets alive until its successor has taken its references.
+void AIS_Decoder::PublishSnapshot(void)
+{
+      {
+            wxMutexLocker lock(m_WorkerMutex);
+
+            //    At most one snapshot in flight
+            if(m_pPendingSnapshot)
+                  return;
+
+            //    Take the alert dialog actions queued so far
+            ApplyAlertRequests(m_pWorkTargets, m_AckRequests, m_SilenceRequests);
+            m_AckRequests.Clear();
+            m_SilenceRequests.Clear();
+      }
+
+      AIS_Target_Snapshot *psnap = new AIS_Target_Snapshot;
+
+      AIS_Target_Hash::iterator it;
+      for( it = (*m_pWorkTargets).begin(); it != (*m_pWorkTargets).end(); ++it )
+      {
+            AIS_Target_Data *td = it->second;
+            if(!td)
+                  continue;
+
+            AIS_Target_Data *ppub = NULL;
+            AIS_Target_Hash::iterator itp = m_pPublishedTargets->find( it->first );
+            if(itp != m_pPublishedTargets->end())
+                  ppub = itp->second;
+
+            if(td->b_changed || !ppub)
+            {
+                  ppub = td->Clone();
+                  (*m_pPublishedTargets)[it->first] = ppub;
+
+                  td->b_changed = false;
+                  psnap->m_changed.Add(it->first);
+            }
+
+            AISTargetRef(ppub);                                   // held by the snapshot
+            (*psnap->m_pTargets)[it->first] = ppub;
+      }
+
+      //    Targets scrubbed from the working table since the previous snapshot
+      for( it = (*m_pPublishedTargets).begin(); it != (*m_pPublishedTargets).end(); ++it )
+      {
+            if(m_pWorkTargets->find( it->first ) == m_pWorkTargets->end())
+                  psnap->m_removed.Add(it->first);
+      }
+
+      for(unsigned int i=0 ; i < psnap->m_removed.GetCount() ; i++)
+            m_pPublishedTargets->erase(psnap->m_removed.Item(i));
+
+      psnap->m_bGeneralAlert = m_bWorkGeneralAlert;
+      psnap->m_SART_alerts = m_SART_pending;
+      m_SART_pending.Clear();
+
+      {
+            wxMutexLocker lock(m_WorkerMutex);
+            m_pPendingSnapshot = psnap;
+      }
+
+      m_bWorkDirty = false;
+      m_last_publish_ms = wxGetLocalTimeMillis();
+
+      OCPN_AISEvent event(wxEVT_OCPN_AIS, ID_AIS_WINDOW);
+      event.SetEventObject( (wxObject *)this );
+      event.SetExtraLong(EVT_AIS_SNAPSHOT);
+      AddPendingEvent(event);
+}
+
+
+
+//-------------------------------------------------------------------------------------------------------------
+//    OCP_AIS_Worker Implementation
+//-------------------------------------------------------------------------------------------------------------
+
+OCP_AIS_Worker::OCP_AIS_Worker(AIS_Decoder *pDecoder)
+{
+      m_pDecoder = pDecoder;
+
+      Create();
+}
+
+void *OCP_AIS_Worker::Entry()
+{
+      //    Wake on queued sentences, or at least every 100 msec for the periodic work
+      while(m_pDecoder->m_Worker_run_flag > 0)
+      {
+            m_pDecoder->m_pWorkerSemaphore->WaitTimeout(100);
+
+            if(m_pDecoder->m_Worker_run_flag <= 0)
+                  break;
+
+            m_pDecoder->WorkerProcess();
+      }
+
+      m_pDecoder->m_Worker_run_flag = -1;
+      return 0;
+}
+
+
+
 //-------------------------------------------------------------------------------------------------------------
 //
 //    AIS Serial Input Thread
@@ -4404,16 +4848,7 @@ void AISTargetAlertDialog::OnIdAckClick( wxCommandEvent& event )
       //    Acknowledge the Alert, and dismiss the dialog
       if(m_pdecoder)
       {
-            AIS_Target_Data *td = m_pdecoder->Get_Target_Data_From_MMSI(Get_Dialog_MMSI());
-            if(td)
-            {
-                  if(AIS_ALARM_SET == td->n_alarm_state)
-                  {
-//                        td->n_alarm_state = AIS_ALARM_ACKNOWLEDGED;
-                        td->m_ack_time = wxDateTime::Now();
-                        td->b_in_ack_timeout = true;
-                  }
-            }
+            m_pdecoder->AcknowledgeTarget(Get_Dialog_MMSI());
       }
       Destroy();
       g_pais_alert_dialog_active = NULL;
@@ -4423,11 +4858,7 @@ void AISTargetAlertDialog::OnIdSilenceClick( wxCommandEvent& event )
 {
       //    Set the suppress audio flag
       if(m_pdecoder)
-      {
-            AIS_Target_Data *td = m_pdecoder->Get_Target_Data_From_MMSI(Get_Dialog_MMSI());
-            if(td)
-                  td->b_suppress_audio = true;
-      }
+            m_pdecoder->SilenceTarget(Get_Dialog_MMSI());
 }
 
 void AISTargetAlertDialog::OnMove( wxMoveEvent& event )
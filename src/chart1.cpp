@@ -391,6 +391,8 @@ bool             g_bUseGLL;
 
 int              g_nCacheLimit;
 int              g_memCacheLimit;
+int              g_nRasterTileCacheLimit;
+bool             g_bPrefetchCharts;
 bool             g_bGDAL_Debug;
 
 double           g_VPRotate;                   // Viewport rotation angle, used on "Course Up" mode
@@ -3253,6 +3255,7 @@ MyFrame::MyFrame(wxFrame *frame, const wxString& title, const wxPoint& pos, cons
 
         //  Create/connect a dynamic event handler slot for OCPN_NMEAEvent(s) coming from NMEA or AIS threads
         Connect(wxEVT_OCPN_NMEA, (wxObjectEventFunction)(wxEventFunction)&MyFrame::OnEvtOCPN_NMEA);
+        Connect(wxEVT_OCPN_NMEA_QUEUE, wxCommandEventHandler(MyFrame::OnEvtOCPN_NMEA_QUEUE));
 
         bFirstAuto = true;
 
@@ -4331,8 +4334,7 @@ void MyFrame::OnCloseWindow(wxCloseEvent& event)
       pConfig->UpdateSettings();
       pConfig->UpdateNavObj();
 
-      pConfig->m_pNavObjectChangesSet->Clear();
-      delete pConfig->m_pNavObjectChangesSet;
+      delete pConfig->m_pNavObjJournal;
 
 	  //Remove any leftover Routes and Waypoints from config file as they were saved to navobj before
 	  pConfig->DeleteGroup( _T ( "/Routes" ) );
@@ -4387,6 +4389,7 @@ void MyFrame::OnCloseWindow(wxCloseEvent& event)
     {
           g_pnmea->Close();
           delete g_pnmea;
+          g_pnmea = NULL;               // queue drain events may still be pending
     }
 
 #ifdef USE_WIFI_CLIENT
@@ -6471,6 +6474,10 @@ void MyFrame::OnFrameTimer1(wxTimerEvent& event)
       {
             bnew_view = DoChartUpdate();
             m_ChartUpdatePeriod = g_ChartUpdatePeriod;
+
+            //    Use a quiet update cycle to open the charts lying ahead
+            if(!bnew_view)
+                  DoChartPrefetch();
       }
 
 //      Update the active route, if any
@@ -6486,7 +6493,7 @@ void MyFrame::OnFrameTimer1(wxTimerEvent& event)
       if(0 == (g_tick % (g_nautosave_interval_seconds)))
       {
              pConfig->UpdateSettings();
-             pConfig->UpdateNavObj();
+             pConfig->CompactNavObj();
       }
 
 //  Force own-ship drawing parameters
@@ -7294,6 +7301,63 @@ void MyFrame::UpdateControlBar(void)
 
 }
 
+//----------------------------------------------------------------------------------
+//      Chart prefetch
+//      While following own ship, open into the cache the charts covering the position
+//      a few minutes ahead on the present COG/SOG, and the active waypoint, so that
+//      crossing onto them later does not stall the display while they are loaded.
+//      At most one chart is opened per call, on a quiet update tick.  S57 charts are
+//      loaded on a worker thread and finished here on a later tick, see ChartDB::PrefetchCharts().
+//----------------------------------------------------------------------------------
+#define PREFETCH_LOOKAHEAD_MINUTES  15.
+#define PREFETCH_MIN_SOG            1.0
+#define PREFETCH_MAX_RANGE_NMI      20.
+
+void MyFrame::DoChartPrefetch(void)
+{
+      if(!g_bPrefetchCharts || !cc1 || !ChartData || bDBUpdateInProgress)
+            return;
+
+      if(!cc1->m_bFollow || !bGPSValid)
+            return;
+
+      //    Only prefetch charts like the ones being shown
+      ChartFamilyEnum family = CHART_FAMILY_UNKNOWN;
+      if(cc1->GetQuiltMode())
+      {
+            int ref_index = cc1->GetQuiltRefChartdbIndex();
+            if(ref_index >= 0)
+                  family = (ChartFamilyEnum)ChartData->GetDBChartFamily(ref_index);
+      }
+      else if(Current_Ch)
+            family = Current_Ch->GetChartFamily();
+
+      if(CHART_FAMILY_UNKNOWN == family)
+            return;
+
+      //    Position ahead on present course
+      if(!wxIsNaN(gSog) && !wxIsNaN(gCog) && (gSog > PREFETCH_MIN_SOG))
+      {
+            double dist = wxMin(gSog * PREFETCH_LOOKAHEAD_MINUTES / 60., PREFETCH_MAX_RANGE_NMI);
+            double pLat, pLon;
+            ll_gc_ll(gLat, gLon, gCog, dist, &pLat, &pLon);
+
+            if(ChartData->PrefetchCharts(pLat, pLon, family, 1))
+                  return;
+      }
+
+      //    Active waypoint, if it is not too far off
+      if(g_pRouteMan && g_pRouteMan->GetpActivePoint())
+      {
+            RoutePoint *prp = g_pRouteMan->GetpActivePoint();
+
+            double brg, dist;
+            DistanceBearingMercator(prp->m_lat, prp->m_lon, gLat, gLon, &brg, &dist);
+            if(dist < PREFETCH_MAX_RANGE_NMI)
+                  ChartData->PrefetchCharts(prp->m_lat, prp->m_lon, family, 1);
+      }
+}
+
 //----------------------------------------------------------------------------------
 //      DoChartUpdate
 //      Create a chartstack based on current lat/lon.
@@ -8156,13 +8220,99 @@ void MyFrame::OnEvtTHREADMSG(wxCommandEvent & event)
 
 
 void MyFrame::OnEvtOCPN_NMEA(OCPN_NMEAEvent & event)
+{
+      wxString str_buf = event.GetNMEAString();
+      ProcessNMEASentence(str_buf, true);
+}
+
+//    Drain a batch of sentences queued by the NMEA input thread
+void MyFrame::OnEvtOCPN_NMEA_QUEUE(wxCommandEvent & event)
+{
+      if(!g_pnmea)
+            return;
+
+      NMEASentenceQueue *pq = g_pnmea->GetSentenceQueue();
+      if(!pq)
+            return;
+
+      pq->ClearWakeup();
+
+      int n = pq->Available();
+      if(!n)
+            return;
+
+      //    Find the last of each coalescable sentence type in this batch
+      char last_id[16][4];
+      int last_index[16];
+      int n_ids = 0;
+
+      for(int i=0 ; i < n ; i++)
+      {
+            NMEAQueueSlot *pslot = pq->Peek(i);
+            if(pslot->policy != NMEA_QUEUE_COALESCE)
+                  continue;
+
+            int k;
+            for(k=0 ; k < n_ids ; k++)
+                  if(!strcmp(last_id[k], pslot->id))
+                        break;
+
+            if(k == n_ids)
+            {
+                  if(n_ids == 16)
+                        continue;
+                  strcpy(last_id[k], pslot->id);
+                  n_ids++;
+            }
+            last_index[k] = i;
+      }
+
+      for(int i=0 ; i < n ; i++)
+      {
+            NMEAQueueSlot *pslot = pq->Peek(i);
+
+            bool b_navigate = true;
+            if(pslot->policy == NMEA_QUEUE_COALESCE)
+            {
+                  for(int k=0 ; k < n_ids ; k++)
+                  {
+                        if(!strcmp(last_id[k], pslot->id))
+                        {
+                              b_navigate = (last_index[k] == i);
+                              break;
+                        }
+                  }
+            }
+
+            wxString str_buf(pslot->sentence, wxConvUTF8);
+            ProcessNMEASentence(str_buf, b_navigate);
+      }
+
+      pq->Pop(n);
+
+      if(g_nNMEADebug)
+      {
+            static int s_last_dropped, s_last_bad;
+            if((pq->GetDropCount() != s_last_dropped) || (pq->GetBadCount() != s_last_bad))
+            {
+                  s_last_dropped = pq->GetDropCount();
+                  s_last_bad = pq->GetBadCount();
+                  wxString msg;
+                  msg.Printf(_T("NMEA queue: %d sentences dropped, %d rejected"), s_last_dropped, s_last_bad);
+                  wxLogMessage(msg);
+            }
+      }
+}
+
+//    Process one NMEA sentence.
+//    If b_navigate is false, the sentence has been superseded by a later one of the same type,
+//    and is only passed to the log window and PlugIns.
+void MyFrame::ProcessNMEASentence(wxString &str_buf, bool b_navigate)
 {
       wxString sfixtime;
       bool bshow_tick = false;
       bool bis_recognized_sentence = true; //PL
 
-      wxString str_buf = event.GetNMEAString();
-
       if( g_nNMEADebug && (g_total_NMEAerror_messages < g_nNMEADebug) )
       {
             g_total_NMEAerror_messages++;
@@ -8185,10 +8335,13 @@ void MyFrame::OnEvtOCPN_NMEA(OCPN_NMEAEvent & event)
       if(g_pi_manager)
             g_pi_manager->SendNMEASentenceToAllPlugIns(str_buf);
 
+      if(!b_navigate)
+            return;
+
       m_NMEA0183 << str_buf;
       if(m_NMEA0183.PreParse())
       {
-            if(m_NMEA0183.LastSentenceIDReceived == _T("RMC"))
+            if(m_NMEA0183.LastSentenceID == NMEA0183_ID('R', 'M', 'C'))
             {
                   if(m_NMEA0183.Parse())
                   {
@@ -8244,7 +8397,7 @@ void MyFrame::OnEvtOCPN_NMEA(OCPN_NMEAEvent & event)
 
                   }
 
-                  else if(m_NMEA0183.LastSentenceIDReceived == _T("HDT"))
+                  else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('H', 'D', 'T'))
                   {
                         if(m_NMEA0183.Parse())
                         {
@@ -8267,7 +8420,7 @@ void MyFrame::OnEvtOCPN_NMEA(OCPN_NMEAEvent & event)
                   }
 
 
-                  else if(m_NMEA0183.LastSentenceIDReceived == _T("HDG"))
+                  else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('H', 'D', 'G'))
                   {
                         if(m_NMEA0183.Parse())
                         {
@@ -8296,7 +8449,7 @@ void MyFrame::OnEvtOCPN_NMEA(OCPN_NMEAEvent & event)
 
                   }
 
-                  else if(m_NMEA0183.LastSentenceIDReceived == _T("HDM"))
+                  else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('H', 'D', 'M'))
                   {
                         if(m_NMEA0183.Parse())
                         {
@@ -8320,7 +8473,7 @@ void MyFrame::OnEvtOCPN_NMEA(OCPN_NMEAEvent & event)
 
                   }
 
-                  else if(m_NMEA0183.LastSentenceIDReceived == _T("VTG"))
+                  else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('V', 'T', 'G'))
                   {
                         if(m_NMEA0183.Parse())
                         {
@@ -8339,7 +8492,7 @@ void MyFrame::OnEvtOCPN_NMEA(OCPN_NMEAEvent & event)
                         }
                   }
 
-                  else if(m_NMEA0183.LastSentenceIDReceived == _T("GSV"))
+                  else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('G', 'S', 'V'))
                   {
                         if(m_NMEA0183.Parse())
                         {
@@ -8358,7 +8511,7 @@ void MyFrame::OnEvtOCPN_NMEA(OCPN_NMEAEvent & event)
                         }
                   }
 
-                  else if(g_bUseGLL && m_NMEA0183.LastSentenceIDReceived == _T("GLL"))
+                  else if(g_bUseGLL && m_NMEA0183.LastSentenceID == NMEA0183_ID('G', 'L', 'L'))
                   {
                         if(m_NMEA0183.Parse())
                         {
@@ -8403,7 +8556,7 @@ void MyFrame::OnEvtOCPN_NMEA(OCPN_NMEAEvent & event)
                         }
                   }
 
-                  else if(m_NMEA0183.LastSentenceIDReceived == _T("GGA"))
+                  else if(m_NMEA0183.LastSentenceID == NMEA0183_ID('G', 'G', 'A'))
                   {
                         if(m_NMEA0183.Parse())
                         {
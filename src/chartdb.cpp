@@ -121,6 +121,15 @@ ChartDB::ChartDB(MyFrame *parent)
 {
       pParent = parent;
       pChartCache = new wxArrayPtrVoid;
+      m_pLRUOldest = NULL;
+      m_pLRUNewest = NULL;
+      m_cache_access_count = 0;
+      m_nOpenDepth = 0;
+
+      m_pPrefetchChart = NULL;
+      m_prefetch_dbindex = -1;
+      m_b_prefetch_done = false;
+      m_prefetch_result = INIT_OK;
 
       SetValid(false);                           // until loaded or created
       UnLockCache();
@@ -144,6 +153,9 @@ ChartDB::ChartDB(MyFrame *parent)
 
 ChartDB::~ChartDB()
 {
+//    The prefetch worker may still be using its chart
+      AbandonPrefetch();
+
 //    Empty the cache
       PurgeCache();
 
@@ -177,6 +189,9 @@ void ChartDB::PurgeCache()
             delete pce;
       }
       pChartCache->Clear();
+      m_CacheHash.clear();
+      m_pLRUOldest = NULL;
+      m_pLRUNewest = NULL;
 }
 
 void ChartDB::ClearCacheInUseFlags(void)
@@ -200,29 +215,23 @@ void ChartDB::PurgeCacheUnusedCharts(bool b_force)
             if(((mem_used > g_memCacheLimit) || b_force) && !m_b_locked)
             {
 //                  printf(" ChartdB::PurgeCacheUnusedCharts Before--- Mem_total: %d  mem_used: %d\n", mem_total, mem_used);
-                  unsigned int i = 0;
-                  while( i<pChartCache->GetCount())
+                  CacheEntry *pce = m_pLRUOldest;
+                  while(pce)
                   {
-                        CacheEntry *pce = (CacheEntry *)(pChartCache->Item(i));
+                        CacheEntry *pnext = pce->pLRUNext;
                         if(!pce->b_in_use)
                         {
-                              ChartBase *Ch = (ChartBase *)pce->pChart;
-
                               //    The glCanvas may be cacheing some information (i.e. texture tiles) for this chart
                               if(g_bopengl && cc1)
-                                    cc1->PurgeGLCanvasChartCache(Ch);
+                                    cc1->PurgeGLCanvasChartCache((ChartBase *)pce->pChart);
 
                               //    And delete the chart
-                              delete Ch;
+                              delete (ChartBase *)pce->pChart;
 
                               //remove the cache entry
-                              pChartCache->Remove(pce);
-
-                              i=0;
-
+                              RemoveCacheEntry(pce);
                         }
-                        else
-                              i++;
+                        pce = pnext;
                   }
 //                  GetMemoryStatus(&mem_total, &mem_used);
 //                  printf(" ChartdB::PurgeCacheUnusedCharts After--- Mem_total: %d  mem_used: %d\n", mem_total, mem_used);
@@ -233,6 +242,369 @@ void ChartDB::PurgeCacheUnusedCharts(bool b_force)
 
 
 
+bool ChartDB::IsCacheFull(void)
+{
+      if(g_memCacheLimit)
+      {
+            int mem_total, mem_used;
+            GetMemoryStatus(&mem_total, &mem_used);
+            return (mem_used > g_memCacheLimit * 9 / 10);
+      }
+      else
+            return (pChartCache->GetCount() >= (unsigned int)g_nCacheLimit);
+}
+
+//-------------------------------------------------------------------------------------------------------
+//      Open, ahead of need, charts of the requested family that cover lat/lon
+//      Only free cache room is used, and the charts so opened are not pinned,
+//      so they will be the first to go if the space is needed by the active view.
+//      S57 charts, whose SENC may need building, are loaded one at a time on a worker thread,
+//      and are collected here on a later call.  Charts that fail are not tried again this session.
+//      Returns the number of charts opened or loading.
+//-------------------------------------------------------------------------------------------------------
+int ChartDB::PrefetchCharts(float lat, float lon, ChartFamilyEnum family, int max_open)
+{
+      ChartStack PrefetchStack;
+      int n_open = 0;
+
+      if(!IsValid())
+            return 0;
+
+      //    Collect the worker's chart if it is done, and start nothing else while it is not
+      if(m_pPrefetchChart)
+      {
+            FinishPrefetch(false);
+            if(m_pPrefetchChart)
+                  return 1;
+      }
+
+      BuildChartStack(&PrefetchStack, lat, lon);
+
+      for(int i=0 ; i < PrefetchStack.nEntry ; i++)
+      {
+            if(n_open >= max_open)
+                  break;
+
+            int db_index = PrefetchStack.GetDBIndex(i);
+            if(IsChartInCache(db_index))
+                  continue;
+
+            if((family != CHART_FAMILY_UNKNOWN) && (GetDBChartFamily(db_index) != family))
+                  continue;
+
+            wxString ChartFullPath = GetDBChartFileName(db_index);
+            if(m_PrefetchFailures.find(ChartFullPath) != m_PrefetchFailures.end())
+                  continue;
+
+            if(IsCacheFull())
+                  break;
+
+            wxString msg(_T("Prefetching chart "));
+            msg += ChartFullPath;
+            wxLogMessage(msg);
+
+#ifdef USE_S57
+            if(GetDBChartType(db_index) == CHART_TYPE_S57)
+            {
+                  if(StartPrefetch(db_index))
+                        return n_open + 1;
+
+                  m_PrefetchFailures[ChartFullPath] = 1;
+                  continue;
+            }
+#endif
+
+            if(!OpenChartFromDB(db_index, FULL_INIT))
+                  m_PrefetchFailures[ChartFullPath] = 1;
+
+            CacheEntry *pce = FindCacheEntry(db_index);
+            if(pce)
+                  pce->b_in_use = false;
+
+            n_open++;
+      }
+
+      return n_open;
+}
+
+//-------------------------------------------------------------------------------------------------------
+//      Chart prefetch worker
+//      The worker owns m_pPrefetchChart until it reports done, and touches nothing else of ChartDB
+//-------------------------------------------------------------------------------------------------------
+bool ChartDB::StartPrefetch(int dbindex)
+{
+#ifdef USE_S57
+      const ChartTableEntry &cte = GetChartTableEntry(dbindex);
+
+      s57chart *Chs57 = new s57chart();
+      Chs57->SetNativeScale(cte.GetScale());
+
+      //    Explicitely set the chart extents from the database to
+      //    support the case wherein the SENC file has not yet been built
+      Extent ext;
+      ext.NLAT = cte.GetLatMax();
+      ext.SLAT = cte.GetLatMin();
+      ext.WLON = cte.GetLonMin();
+      ext.ELON = cte.GetLonMax();
+      Chs57->SetFullExtent(ext);
+
+      m_pPrefetchChart = Chs57;
+      m_prefetch_dbindex = dbindex;
+      m_PrefetchPath = wxString(cte.GetpFullPath(), wxConvUTF8);
+      m_b_prefetch_done = false;
+
+      //    The worker gets a plain pointer to the path, as wxString reference counting is not thread safe
+      ChartPrefetchThread *pThread = new ChartPrefetchThread(this, Chs57, m_PrefetchPath.c_str());
+      if(wxTHREAD_NO_ERROR == pThread->Run())
+            return true;
+
+      wxLogMessage(_T("   Cannot start chart prefetch thread"));
+      delete pThread;
+      delete Chs57;
+      m_pPrefetchChart = NULL;
+#endif
+      return false;
+}
+
+void ChartDB::SetPrefetchDone(InitReturn ir)
+{
+      wxMutexLocker lock(m_PrefetchMutex);
+      m_prefetch_result = ir;
+      m_b_prefetch_done = true;
+}
+
+bool ChartDB::IsPrefetchDone(void)
+{
+      wxMutexLocker lock(m_PrefetchMutex);
+      return m_b_prefetch_done;
+}
+
+//    Finish the worker's chart on this (UI) thread, and cache it unpinned
+//    Unless b_wait, returns at once if the worker is still busy
+void ChartDB::FinishPrefetch(bool b_wait)
+{
+#ifdef USE_S57
+      if(!m_pPrefetchChart)
+            return;
+
+      if(!IsPrefetchDone())
+      {
+            if(!b_wait)
+                  return;
+
+            ::wxBeginBusyCursor();
+            while(!IsPrefetchDone())
+                  wxMilliSleep(10);
+            ::wxEndBusyCursor();
+      }
+
+      s57chart *Chs57 = m_pPrefetchChart;
+      m_pPrefetchChart = NULL;
+
+      //    The database may have been rebuilt, or the chart opened by the view, meanwhile
+      int dbindex = m_prefetch_dbindex;
+      bool b_current = (dbindex < GetChartTableEntries()) && !IsChartInCache(dbindex)
+                  && (GetDBChartFileName(dbindex) == m_PrefetchPath);
+
+      if(!b_current)
+      {
+            delete Chs57;
+            return;
+      }
+
+      InitReturn ir = m_prefetch_result;
+      if(INIT_OK == ir)
+      {
+            ir = Chs57->FinishInit();
+            Chs57->SetColorScheme(pParent->GetColorScheme());
+      }
+
+      if(INIT_OK == ir)
+      {
+            CacheEntry *pce = new CacheEntry;
+            pce->FullPath = m_PrefetchPath;
+            pce->pChart = Chs57;
+            pce->dbIndex = dbindex;
+            pce->b_in_use = false;
+
+            AddCacheEntry(pce);
+      }
+      else
+      {
+            delete Chs57;
+
+            m_PrefetchFailures[m_PrefetchPath] = 1;
+
+            wxString msg(_T("   Prefetch...Error opening chart "));
+            msg += m_PrefetchPath;
+            wxString id;
+            id.Printf(_T("... return code %d"),  ir);
+            msg += id;
+            wxLogMessage(msg);
+      }
+#endif
+}
+
+//    Wait out the worker, and drop its chart
+void ChartDB::AbandonPrefetch(void)
+{
+#ifdef USE_S57
+      if(!m_pPrefetchChart)
+            return;
+
+      if(!IsPrefetchDone())
+      {
+            wxLogMessage(_T("Waiting for chart prefetch thread"));
+            while(!IsPrefetchDone())
+                  wxMilliSleep(10);
+      }
+
+      delete m_pPrefetchChart;
+      m_pPrefetchChart = NULL;
+#endif
+}
+
+ChartPrefetchThread::ChartPrefetchThread(ChartDB *pDB, s57chart *pChart, const wxChar *pPath)
+{
+      m_pDB = pDB;
+      m_pChart = pChart;
+      m_pPath = pPath;
+
+      Create();
+}
+
+void *ChartPrefetchThread::Entry()
+{
+#ifdef USE_S57
+      InitReturn ir;
+      {
+            wxString path(m_pPath);                   // private copy, released before reporting done
+            ir = m_pChart->LoadInit(path, true);
+      }
+
+      m_pDB->SetPrefetchDone(ir);
+#endif
+      return 0;
+}
+
+//-------------------------------------------------------------------------------------------------------
+//      Chart cache bookkeeping
+//      Entries are found by dbIndex through m_CacheHash, and are kept on a doubly linked list
+//      ordered from least to most recently used, so lookup and touch are O(1) and eviction
+//      starts from the oldest entry.
+//-------------------------------------------------------------------------------------------------------
+
+CacheEntry *ChartDB::FindCacheEntry(int dbindex)
+{
+      ChartCacheHash::iterator it = m_CacheHash.find(dbindex);
+      if(it == m_CacheHash.end())
+            return NULL;
+      return it->second;
+}
+
+void ChartDB::AddCacheEntry(CacheEntry *pce)
+{
+      pce->RecentTime = ++m_cache_access_count;
+      pce->pLRUPrev = m_pLRUNewest;
+      pce->pLRUNext = NULL;
+      if(m_pLRUNewest)
+            m_pLRUNewest->pLRUNext = pce;
+      else
+            m_pLRUOldest = pce;
+      m_pLRUNewest = pce;
+
+      m_CacheHash[pce->dbIndex] = pce;
+      pChartCache->Add((void *)pce);
+}
+
+void ChartDB::TouchCacheEntry(CacheEntry *pce)
+{
+      pce->RecentTime = ++m_cache_access_count;
+      pce->b_in_use = true;
+
+      if(pce == m_pLRUNewest)
+            return;
+
+      //    Unlink...
+      if(pce->pLRUPrev)
+            pce->pLRUPrev->pLRUNext = pce->pLRUNext;
+      else
+            m_pLRUOldest = pce->pLRUNext;
+      pce->pLRUNext->pLRUPrev = pce->pLRUPrev;
+
+      //    ...and relink as the newest
+      pce->pLRUPrev = m_pLRUNewest;
+      pce->pLRUNext = NULL;
+      m_pLRUNewest->pLRUNext = pce;
+      m_pLRUNewest = pce;
+}
+
+void ChartDB::RemoveCacheEntry(CacheEntry *pce)
+{
+      if(pce->pLRUPrev)
+            pce->pLRUPrev->pLRUNext = pce->pLRUNext;
+      else
+            m_pLRUOldest = pce->pLRUNext;
+
+      if(pce->pLRUNext)
+            pce->pLRUNext->pLRUPrev = pce->pLRUPrev;
+      else
+            m_pLRUNewest = pce->pLRUPrev;
+
+      m_CacheHash.erase(pce->dbIndex);
+      pChartCache->Remove(pce);
+      delete pce;
+}
+
+//    Choose the least recently used entry that may be removed.
+//    Entries not pinned by the current quilt are preferred, so that composing a large quilt
+//    does not push out its own members.  Current_Ch is never chosen.
+CacheEntry *ChartDB::GetCacheEvictionCandidate(void)
+{
+      CacheEntry *pce_pinned = NULL;
+
+      for(CacheEntry *pce = m_pLRUOldest ; pce ; pce = pce->pLRUNext)
+      {
+            if((ChartBase *)(pce->pChart) == Current_Ch)
+                  continue;
+
+            if(!pce->b_in_use)
+                  return pce;
+
+            if(!pce_pinned)
+                  pce_pinned = pce;
+      }
+
+      return pce_pinned;
+}
+
+void ChartDB::EvictCacheEntry(CacheEntry *pce)
+{
+      ChartBase *pDeleteCandidate =  (ChartBase *)(pce->pChart);
+
+      wxString msg(_T("Removing oldest chart from cache: "));
+      msg += pDeleteCandidate->GetFullPath();
+      wxLogMessage(msg);
+
+      //  If this chart should happen to be in the thumbnail window....
+      if(pthumbwin)
+      {
+            if(pthumbwin->pThumbChart == pDeleteCandidate)
+                  pthumbwin->pThumbChart = NULL;
+      }
+
+      //    Delete the chart
+      delete pDeleteCandidate;
+
+      //    The glCanvas may be cacheing some information for this chart
+      if(g_bopengl && cc1)
+            cc1->PurgeGLCanvasChartCache(pDeleteCandidate);
+
+      //remove the cache entry
+      RemoveCacheEntry(pce);
+}
+
+
 //-------------------------------------------------------------------------------------------------------
 //      Create a Chart
 //      This version creates a fully functional UI-capable chart.
@@ -293,7 +665,6 @@ ChartBase *ChartDB::GetChart(const wxChar *theFilePath, ChartClassDescriptor &ch
 
 int ChartDB::BuildChartStack(ChartStack * cstk, float lat, float lon)
 {
-      int i=0;
       int j=0;
 
       if(!IsValid())
@@ -302,10 +673,14 @@ int ChartDB::BuildChartStack(ChartStack * cstk, float lat, float lon)
       if(!cstk)
             return 0;                           // Chartstack not ready yet
 
-      int nEntry = GetChartTableEntries();
+      cstk->nEntry = 0;
+
+      //    Only charts whose extents touch this position's index cell need be examined
+      const ArrayOfInts &candidates = GetIndexCandidates(lat, lon);
 
-      for(int db_index=0 ; db_index<nEntry ; db_index++)
+      for(unsigned int ic=0 ; ic < candidates.GetCount() ; ic++)
       {
+            int db_index = candidates.Item(ic);
 
             ChartTableEntry *pt = (ChartTableEntry *)&GetChartTableEntry(db_index);
 
@@ -325,109 +700,54 @@ int ChartDB::BuildChartStack(ChartStack * cstk, float lat, float lon)
             else
                   b_group_add = true;
 
-            if(b_group_add)
-            {
-                  if(CheckPositionWithinChart(db_index, lat, lon)  &&  (j < MAXSTACK) )
-                  {
-                        j++;
-                        cstk->nEntry = j;
-                        cstk->SetDBIndex(j-1, db_index);
-                  }
+            if(!b_group_add)
+                  continue;
 
-                  //    Check the special case where chart spans the international dateline
-                  else if( (pt->GetLonMax() > 180.) && (pt->GetLonMin() < 180.) )
-                  {
-                        if(CheckPositionWithinChart(db_index, lat, lon + 360.)  &&  (j < MAXSTACK) )
-                        {
-                              j++;
-                              cstk->nEntry = j;
-                              cstk->SetDBIndex(j-1, db_index);
-
-                        }
-                  }
-            }
-      }
+            bool b_inside = CheckPositionWithinChart(db_index, lat, lon);
 
-      cstk->nEntry = j;
+            //    Check the special case where chart spans the international dateline
+            if(!b_inside && (pt->GetLonMax() > 180.) && (pt->GetLonMin() < 180.) )
+                  b_inside = CheckPositionWithinChart(db_index, lat, lon + 360.);
 
+            if(!b_inside)
+                  continue;
 
-//    Remove exact duplicates, i.e. charts that have exactly the same file name and mod time
+//    Skip exact duplicates, i.e. charts that have exactly the same file name and mod time
 //    These charts can be in the database due to having the exact same chart in different directories,
 //    as may be desired for some grouping schemes
-      for(int id = 0 ; id < j-1 ; id++)
-      {
-            if(cstk->GetDBIndex(id) != -1)
+            bool b_dup = false;
+            for(int id = 0 ; id < j ; id++)
             {
                   ChartTableEntry *pm = GetpChartTableEntry(cstk->GetDBIndex(id));
-
-                  for(int jd = id+1; jd < j; jd++)
+                  if(pm->GetFileTime() == pt->GetFileTime())      // simple test
                   {
-                        if(cstk->GetDBIndex(jd) != -1)
+                        if(pt->GetpFileName()->IsSameAs(*(pm->GetpFileName())))
                         {
-                              ChartTableEntry *pn = GetpChartTableEntry(cstk->GetDBIndex(jd));
-                              if(pm->GetFileTime() == pn->GetFileTime())      // simple test
-                              {
-                                    if(pn->GetpFileName()->IsSameAs(*(pm->GetpFileName())))
-                                    {
-                                          cstk->SetDBIndex(jd, -1);           // mark to remove
-                                    }
-                              }
+                              b_dup = true;
+                              break;
                         }
                   }
             }
-      }
-
-      int id = 0;
-      while( (id < j) )
-      {
-            if(cstk->GetDBIndex(id) == -1)
-            {
-                  int jd = id+1;
-                  while( jd < j )
-                  {
-                        int db_index = cstk->GetDBIndex(jd);
-                        cstk->SetDBIndex(jd-1, db_index);
-                        jd++;
-                  }
-
-                  j--;
-                  cstk->nEntry = j;
-
-                  id = 0;
-            }
-            else
-                  id++;
-      }
-
-
-
 
+            if(b_dup)
+                  continue;
 
+            if(j >= MAXSTACK)
+                  break;
 
-//    Sort the stack on scale
-      int swap = 1;
-      int ti;
-      while(swap == 1)
-      {
-            swap = 0;
-            for(i=0 ; i<j-1 ; i++)
+//    Insert in scale order, after any entries of equal scale so that the sort is stable
+            int scale = pt->GetScale();
+            int is = j;
+            cstk->nEntry = j + 1;
+            while( (is > 0) && (GetChartTableEntry(cstk->GetDBIndex(is-1)).GetScale() > scale) )
             {
-                  const ChartTableEntry &m = GetChartTableEntry(cstk->GetDBIndex(i));
-                  const ChartTableEntry &n = GetChartTableEntry(cstk->GetDBIndex(i+1));
-
-
-                  if(n.GetScale() < m.GetScale())
-                  {
-                        ti = cstk->GetDBIndex(i);
-                        cstk->SetDBIndex(i, cstk->GetDBIndex(i+1));
-                        cstk->SetDBIndex(i+1, ti);
-                        swap = 1;
-                  }
+                  cstk->SetDBIndex(is, cstk->GetDBIndex(is-1));
+                  is--;
             }
+            cstk->SetDBIndex(is, db_index);
+            j++;
       }
 
-
-
       cstk->b_valid = true;
 
       return j;
@@ -654,21 +974,7 @@ ArrayOfInts ChartDB::GetCSArray(ChartStack *ps)
 
 bool ChartDB::IsChartInCache(int dbindex)
 {
-      bool bInCache = false;
-
-//    Search the cache
-      unsigned int nCache = pChartCache->GetCount();
-      for(unsigned int i=0 ; i<nCache ; i++)
-      {
-            CacheEntry *pce = (CacheEntry *)(pChartCache->Item(i));
-            if(pce->dbIndex == dbindex)
-            {
-                  bInCache = true;
-                  break;
-            }
-      }
-
-      return bInCache;
+      return (FindCacheEntry(dbindex) != NULL);
 }
 
 
@@ -701,25 +1007,18 @@ ChartBase *ChartDB::OpenChartUsingCache(int dbindex, ChartInitFlag init_flag)
       ChartTypeEnum chart_type = (ChartTypeEnum)cte.GetChartType();
 
       ChartBase *Ch = NULL;
-      CacheEntry *pce;
 
-      wxDateTime now = wxDateTime::Now();                   // get time for LRU use
-
-      bool bInCache = false;
+//    The chart may be loading on the prefetch worker, so take it from there
+//    Not when called from within another chart's Init(), which may hold what the worker needs
+      if((FULL_INIT == init_flag) && m_pPrefetchChart && (m_prefetch_dbindex == dbindex))
+            FinishPrefetch(0 == m_nOpenDepth);
 
 //    Search the cache
+      CacheEntry *pce = FindCacheEntry(dbindex);
 
-      unsigned int nCache = pChartCache->GetCount();
-      for(unsigned int i=0 ; i<nCache ; i++)
-      {
-            pce = (CacheEntry *)(pChartCache->Item(i));
-            if(pce->FullPath == ChartFullPath)
-            {
-                  Ch = (ChartBase *)pce->pChart;
-                  bInCache = true;
-                  break;
-            }
-      }
+      bool bInCache = (pce != NULL);
+      if(bInCache)
+            Ch = (ChartBase *)pce->pChart;
 
       if(bInCache)
       {
@@ -727,22 +1026,19 @@ ChartBase *ChartDB::OpenChartUsingCache(int dbindex, ChartInitFlag init_flag)
           {
               if(Ch->IsReadyToRender())
               {
-                    pce->RecentTime = now.GetTicks();           // chart is OK
-                    pce->b_in_use = true;
+                    TouchCacheEntry(pce);                       // chart is OK
                     return Ch;
               }
               else
               {
                     delete Ch;                                  // chart is not useable
-                    pChartCache->Remove(pce);                   // so remove it
-                    delete pce;
+                    RemoveCacheEntry(pce);                      // so remove it
                     bInCache = false;
               }
           }
           else                                                  // assume if in cache, the chart can do thumbnails
           {
-               pce->RecentTime = now.GetTicks();
-               pce->b_in_use = true;
+               TouchCacheEntry(pce);
                return Ch;
           }
       }
@@ -759,135 +1055,32 @@ ChartBase *ChartDB::OpenChartUsingCache(int dbindex, ChartInitFlag init_flag)
 //                  printf(" ChartdB Mem_total: %d  mem_used: %d  lock: %d\n", mem_total, mem_used, m_b_locked);
                   if((mem_used > g_memCacheLimit) && !m_b_locked)
                   {
-                        // Search the cache for oldest entry that is not Current_Ch
-                        unsigned int nCache = pChartCache->GetCount();
-                        if(nCache > 2)
+                        // Remove the oldest entry that is not Current_Ch
+                        if(pChartCache->GetCount() > 2)
                         {
-                              wxLogMessage(_T("Searching chart cache for oldest entry"));
-                              int LRUTime = now.GetTicks();
-                              int iOldest = 0;
-                              for(unsigned int i=0 ; i<nCache ; i++)
-                              {
-                                    pce = (CacheEntry *)(pChartCache->Item(i));
-                                    if((ChartBase *)(pce->pChart) != Current_Ch)
-                                    {
-                                          if(pce->RecentTime < LRUTime)
-                                          {
-                                                LRUTime = pce->RecentTime;
-                                                iOldest = i;
-                                          }
-                                    }
-                              }
-                              int dt = now.GetTicks() - LRUTime;
-                              wxLogMessage(_T("Oldest cache index is %d, delta t is %d"), iOldest, dt);
-
-                              pce = (CacheEntry *)(pChartCache->Item(iOldest));
-                              ChartBase *pDeleteCandidate =  (ChartBase *)(pce->pChart);
-
-                              if(Current_Ch == pDeleteCandidate)
-                              {
-                                    wxLogMessage(_T("...However, it is Current_Ch"));
-                              }
-                              else
-                              {
-                                    wxString msg(_T("Removing oldest chart from cache: "));
-                                    msg += pDeleteCandidate->GetFullPath();
-                                    wxLogMessage(msg);
-
-                                    //  If this chart should happen to be in the thumbnail window....
-                                    if(pthumbwin)
-                                    {
-                                          if(pthumbwin->pThumbChart == pDeleteCandidate)
-                                                pthumbwin->pThumbChart = NULL;
-                                    }
-
-                                    //    Delete the chart
-                                    delete pDeleteCandidate;
-
-                                    //    The glCanvas may be cacheing some information for this chart
-                                    if(g_bopengl && cc1)
-                                          cc1->PurgeGLCanvasChartCache(pDeleteCandidate);
-
-                                    //remove the cache entry
-                                    pChartCache->Remove(pce);
-
-//                                    GetMemoryStatus(&mem_total, &mem_used);
-//                                    printf("    After delete/purge Mem_total: %d  mem_used: %d\n", mem_total, mem_used);
-
-      //                              pParent->GetMemoryStatus(omem_total, omem_used);
-      //                            int omem_free = omem_total - omem_used;
-      //                            wxLogMessage(_T("oMem_Free after chart removal is %d"), omem_free);
-
-                              }
+                              CacheEntry *pce_old = GetCacheEvictionCandidate();
+                              if(pce_old)
+                                    EvictCacheEntry(pce_old);
                         }
                   }
             }
 
             else        // Use n chart cache policy, if memory-limit  policy is not used
             {
-//      Limit cache to n charts, tossing out the oldest when space is needed
-                  unsigned int nCache = pChartCache->GetCount();
-                  if((nCache >= (unsigned int)g_nCacheLimit) && !m_b_locked)
+//      Limit cache to n charts, tossing out the oldest when space is needed.
+//      Unpinned entries may all go; at most one pinned entry is removed per open.
+                  if(!m_b_locked)
                   {
-
-      ///                  wxLogMessage("Searching chart cache for oldest entry");
-                        int LRUTime = now.GetTicks();
-                        int iOldest = 0;
-                        for(unsigned int i=0 ; i<nCache ; i++)
-                        {
-                              pce = (CacheEntry *)(pChartCache->Item(i));
-                              if((ChartBase *)(pce->pChart) != Current_Ch)
-                              {
-                                    if(pce->RecentTime < LRUTime)
-                                    {
-                                          LRUTime = pce->RecentTime;
-                                          iOldest = i;
-                                    }
-                              }
-                        }
-
-/*
-                        for(unsigned int i=0 ; i<nCache ; i++)
+                        while(pChartCache->GetCount() >= (unsigned int)g_nCacheLimit)
                         {
-                              pce = (CacheEntry *)(pChartCache->Item(i));
-                              if((ChartBase *)(pce->pChart) != Current_Ch)
-                              {
-                                    printf("  Cache %d\n", pce->dbIndex);
-                              }
-                        }
-*/
-                        pce = (CacheEntry *)(pChartCache->Item(iOldest));
-                        ChartBase *pDeleteCandidate =  (ChartBase *)(pce->pChart);
-
-                        if(Current_Ch != pDeleteCandidate)
-                        {
-                              wxString msg(_T("Removing oldest chart from cache "));
-                              wxString ni;
-                              ni.Printf(_T("%d"), pce->dbIndex);
-                              msg += ni;
-                              wxLogMessage(msg);
-//                              printf(" removing %d\n", pce->dbIndex);
-
-                        //  If this chart should happen to be in the thumbnail window....
-                              if(pthumbwin)
-                              {
-                                    if(pthumbwin->pThumbChart == pDeleteCandidate)
-                                          pthumbwin->pThumbChart = NULL;
-                              }
-
-                              wxLogMessage(pDeleteCandidate->GetFullPath());
-                        //    Delete the chart
-                              delete pDeleteCandidate;
-
-                        //remove the cache entry
-                              pChartCache->Remove(pce);
-
-                              if(pthumbwin)
-                              {
-                                    if(pthumbwin->pThumbChart == pDeleteCandidate)
-                                          pthumbwin->pThumbChart = NULL;
-                              }
+                              CacheEntry *pce_old = GetCacheEvictionCandidate();
+                              if(!pce_old)
+                                    break;
 
+                              bool b_pinned = pce_old->b_in_use;
+                              EvictCacheEntry(pce_old);
+                              if(b_pinned)
+                                    break;
                         }
                   }
             }
@@ -1037,7 +1230,9 @@ ChartBase *ChartDB::OpenChartUsingCache(int dbindex, ChartInitFlag init_flag)
                   msg.Append(ChartFullPath);
                   wxLogMessage(msg);
 
+                  m_nOpenDepth++;
                   ir = Ch->Init(ChartFullPath, init_flag);    // using the passed flag
+                  m_nOpenDepth--;
                   Ch->SetColorScheme(pParent->GetColorScheme());
 
                   if(INIT_OK == ir)
@@ -1050,10 +1245,10 @@ ChartBase *ChartDB::OpenChartUsingCache(int dbindex, ChartInitFlag init_flag)
                               pce->FullPath = ChartFullPath;
                               pce->pChart = Ch;
                               pce->dbIndex = dbindex;
+                              pce->b_in_use = true;
 //                              printf("    Adding chart %d\n", dbindex);
-                              pce->RecentTime = now.GetTicks();
 
-                              pChartCache->Add((void *)pce);
+                              AddCacheEntry(pce);
                         }
                   }
                   else if(INIT_FAIL_REMOVE == ir)                 // some problem in chart Init()
@@ -1109,38 +1304,25 @@ bool ChartDB::DeleteCacheChart(ChartBase *pDeleteCandidate)
       {
 
             // Find the chart in the cache
-            CacheEntry *pce = NULL;
-            for(unsigned int i=0 ; i< pChartCache->GetCount() ; i++)
+            for(CacheEntry *pce = m_pLRUOldest ; pce ; pce = pce->pLRUNext)
             {
-                  pce = (CacheEntry *)(pChartCache->Item(i));
                   if((ChartBase *)(pce->pChart) == pDeleteCandidate)
                   {
-                        break;
-                  }
-            }
-
-            if(pce)
-            {
                         //  If this chart should happen to be in the thumbnail window....
-                  if(pthumbwin)
-                  {
-                        if(pthumbwin->pThumbChart == pDeleteCandidate)
-                              pthumbwin->pThumbChart = NULL;
-                  }
+                        if(pthumbwin)
+                        {
+                              if(pthumbwin->pThumbChart == pDeleteCandidate)
+                                    pthumbwin->pThumbChart = NULL;
+                        }
 
                         //    Delete the chart
-                  delete pDeleteCandidate;
+                        delete pDeleteCandidate;
 
                         //remove the cache entry
-                  pChartCache->Remove(pce);
+                        RemoveCacheEntry(pce);
 
-                  if(pthumbwin)
-                  {
-                        if(pthumbwin->pThumbChart == pDeleteCandidate)
-                              pthumbwin->pThumbChart = NULL;
+                        return true;
                   }
-
-                  return true;
             }
       }
 
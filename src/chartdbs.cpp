@@ -37,6 +37,8 @@
 #include <wx/regex.h>
 #include <wx/progdlg.h>
 
+#include <math.h>
+
 #include "chartdbs.h"
 #include "chartbase.h"
 #include "pluginmanager.h"
@@ -629,6 +631,74 @@ ChartTableEntry *ChartDatabase::GetpChartTableEntry(int index) const
             return (ChartTableEntry *)&m_ChartTableEntryDummy;
 }
 
+///////////////////////////////////////////////////////////////////////
+//    Chart position index
+//
+//    Each grid cell lists, in ascending dbIndex order, every chart whose
+//    bounding box touches the cell.  Longitude cells wrap, so charts which
+//    span the dateline (LonMax > 180) are found from either side.
+///////////////////////////////////////////////////////////////////////
+
+static int IndexLatCell(float lat)
+{
+      int ilat = (int)floor((lat + 90.) / DB_INDEX_CELL_DEG);
+      if(ilat < 0)
+            ilat = 0;
+      if(ilat > DB_INDEX_NLAT - 1)
+            ilat = DB_INDEX_NLAT - 1;
+      return ilat;
+}
+
+static int IndexLonCell(float lon)
+{
+      return (int)floor((lon + 180.) / DB_INDEX_CELL_DEG);
+}
+
+static int WrapLonCell(int ilon)
+{
+      ilon %= DB_INDEX_NLON;
+      if(ilon < 0)
+            ilon += DB_INDEX_NLON;
+      return ilon;
+}
+
+void ChartDatabase::BuildSpatialIndex(void)
+{
+      for(int i=0 ; i < DB_INDEX_NLAT * DB_INDEX_NLON ; i++)
+            m_SpatialIndex[i].Clear();
+
+      for(unsigned int db_index=0 ; db_index < chartTable.GetCount() ; db_index++)
+      {
+            const ChartTableEntry &cte = chartTable[db_index];
+
+            int lat0 = IndexLatCell(cte.GetLatMin());
+            int lat1 = IndexLatCell(cte.GetLatMax());
+            int lon0 = IndexLonCell(cte.GetLonMin());
+            int lon1 = IndexLonCell(cte.GetLonMax());
+            if(lat1 < lat0)
+            {
+                  lat0 = 0;
+                  lat1 = DB_INDEX_NLAT - 1;
+            }
+            if((lon1 < lon0) || (lon1 - lon0 >= DB_INDEX_NLON))
+            {
+                  lon0 = 0;
+                  lon1 = DB_INDEX_NLON - 1;
+            }
+
+            for(int ilat = lat0 ; ilat <= lat1 ; ilat++)
+            {
+                  for(int ilon = lon0 ; ilon <= lon1 ; ilon++)
+                        m_SpatialIndex[(ilat * DB_INDEX_NLON) + WrapLonCell(ilon)].Add(db_index);
+            }
+      }
+}
+
+const ArrayOfInts &ChartDatabase::GetIndexCandidates(float lat, float lon) const
+{
+      return m_SpatialIndex[(IndexLatCell(lat) * DB_INDEX_NLON) + WrapLonCell(IndexLonCell(lon))];
+}
+
 
 bool ChartDatabase::Read(const wxString &filePath)
 {
@@ -687,6 +757,7 @@ bool ChartDatabase::Read(const wxString &filePath)
         chartTable.Add(entry);
 
     entry.Clear();
+    BuildSpatialIndex();
     bValid = true;
     return true;
 
@@ -1046,6 +1117,7 @@ bool ChartDatabase::Update(ArrayOfCDI& dir_array, bool bForce, wxProgressDialog
       for(unsigned int i=0 ; i<chartTable.GetCount() ; i++)
             chartTable[i].SetEntryOffset( i );
 
+      BuildSpatialIndex();
 
       bValid = true;
       return true;
@@ -1514,8 +1586,20 @@ int ChartDatabase::SearchDirAndAddCharts(wxString& dir_name_base,
       //    and bthis_dir_in_dB is false.
       bool bthis_dir_in_dB = IsChartDirUsed(dir_name);
 
-      int isearch = 0;              // create a smarter search index
-                                          // indexing the DB starting from the last found item
+      //    Index the existing table by full path and by bare file name,
+      //    so that each candidate file is checked for duplicates without a walk of the table
+      ChartPathHash path_hash;
+      ChartPathHash name_hash;
+      for(unsigned int i=0 ; i<chartTable.GetCount() ; i++)
+      {
+            wxString table_file_name(chartTable[i].GetpFullPath(), wxConvUTF8);
+            if(bthis_dir_in_dB)
+                  path_hash[table_file_name] = i;
+
+            wxFileName table_file(table_file_name);
+            if(name_hash.find(table_file.GetFullName()) == name_hash.end())
+                  name_hash[table_file.GetFullName()] = i;
+      }
 
       if(pprog)
             pprog->SetTitle(_("OpenCPN Chart Add...."));
@@ -1534,6 +1618,26 @@ int ChartDatabase::SearchDirAndAddCharts(wxString& dir_name_base,
             if(pprog)
                   pprog->Update(wxMin((ifile * 100) /nFile, 100), full_name);
 
+            //    If this exact file is already in the database, and has not been modified since,
+            //    keep the existing entry and skip reading the chart header altogether
+            int ipath = -1;
+            if(bthis_dir_in_dB)
+            {
+                  ChartPathHash::iterator it = path_hash.find(full_name);
+                  if(it != path_hash.end())
+                  {
+                        ipath = it->second;
+
+                        time_t t_oldFile = chartTable[ipath].GetFileTime();
+                        time_t t_newFile = file.GetModificationTime().GetTicks();
+
+                        if( t_newFile <= t_oldFile )
+                        {
+                              chartTable[ipath].SetValid(true);
+                              continue;
+                        }
+                  }
+            }
 
             ChartTableEntry *pnewChart = NULL;
             bool bAddFinal = true;
@@ -1547,91 +1651,62 @@ int ChartDatabase::SearchDirAndAddCharts(wxString& dir_name_base,
                   msg.Append(full_name);
                   wxLogMessage(msg);
             }
-            else         // traverse the existing database looking for duplicates, and choosing the right one
+            else if(ipath >= 0)
             {
-                  int nEntry = chartTable.GetCount();
-                  for(int i=0 ; i<nEntry ; i++)
+                  //    The chart full file paths are exactly the same, and this one is newer
+                  b_add_msg++;
+                  chartTable[ipath].SetValid(false);
+                  wxString msg = _T("   Replacing older chart file of same path: ");
+                  msg.Append(full_name);
+                  wxLogMessage(msg);
+            }
+            else
+            {
+                  //  Look at the chart file name (without directory prefix) for a further check for duplicates
+                  //  This catches the case in which the "same" chart is in different locations,
+                  //  and one may be newer than the other.
+                  ChartPathHash::iterator it = name_hash.find(file_name);
+                  if(it != name_hash.end())
                   {
-                        wxString table_file_name(chartTable[isearch].GetpFullPath(), wxConvUTF8);
+                        int isearch = it->second;
+                        wxFileName table_file(wxString(chartTable[isearch].GetpFullPath(), wxConvUTF8));
 
-                        //    If the chart full file paths are exactly the same, select the newer one
-                        if(bthis_dir_in_dB && full_name.IsSameAs(table_file_name))
-                        {
-                              b_add_msg++;
-
-                              //    Check the file modification time
-                              time_t t_oldFile = chartTable[isearch].GetFileTime();
-                              time_t t_newFile = file.GetModificationTime().GetTicks();
+                        b_add_msg++;
 
-                              if( t_newFile <= t_oldFile )
+                        if(pnewChart->IsEarlierThan(chartTable[isearch]))
+                        {
+                              //    Make sure the compare file actually exists
+                              if(table_file.IsFileReadable())
                               {
-                                    bAddFinal = false;
                                     chartTable[isearch].SetValid(true);
-                              }
-                              else
-                              {
-                                    bAddFinal = true;
-                                    chartTable[isearch].SetValid(false);
-                                    wxString msg = _T("   Replacing older chart file of same path: ");
+                                    bAddFinal = false;
+                                    wxString msg = _T("   Retaining newer chart file of same name: ");
                                     msg.Append(full_name);
                                     wxLogMessage(msg);
-                              }
 
-                              break;
+                              }
                         }
-
-
-                  //  Look at the chart file name (without directory prefix) for a further check for duplicates
-                  //  This catches the case in which the "same" chart is in different locations,
-                  //  and one may be newer than the other.
-                        wxFileName table_file(table_file_name);
-
-                        if( table_file.GetFullName() == file_name )
+                        else if(pnewChart->IsEqualTo(chartTable[isearch]))
                         {
-                              b_add_msg++;
-
-                              if(pnewChart->IsEarlierThan(chartTable[isearch]))
-                              {
-                                    //    Make sure the compare file actually exists
-                                    if(table_file.IsFileReadable())
-                                    {
-                                          chartTable[isearch].SetValid(true);
-                                          bAddFinal = false;
-                                          wxString msg = _T("   Retaining newer chart file of same name: ");
-                                          msg.Append(full_name);
-                                          wxLogMessage(msg);
-
-                                    }
-                              }
-                              else if(pnewChart->IsEqualTo(chartTable[isearch]))
-                              {
-                                    //    The file names (without dir prefix) are identical,
-                                    //    and the mod times are identical
-                                    //    Prsume that this is intentional, in order to facilitate
-                                    //    having the same chart in multiple groups.
-                                    //    So, add this chart.
-                                    bAddFinal = true;
-                              }
-
-                              else
-                              {
-                                    chartTable[isearch].SetValid(false);
-                                    bAddFinal = true;
-                                    wxString msg = _T("   Replacing older chart file of same name: ");
-                                    msg.Append(full_name);
-                                    wxLogMessage(msg);
-                              }
+                              //    The file names (without dir prefix) are identical,
+                              //    and the mod times are identical
+                              //    Prsume that this is intentional, in order to facilitate
+                              //    having the same chart in multiple groups.
+                              //    So, add this chart.
+                              bAddFinal = true;
+                        }
 
-                              break;
+                        else
+                        {
+                              chartTable[isearch].SetValid(false);
+                              bAddFinal = true;
+                              wxString msg = _T("   Replacing older chart file of same name: ");
+                              msg.Append(full_name);
+                              wxLogMessage(msg);
                         }
 
                         //TODO    Look at the chart ID as a further check against duplicates
-
-
-                        isearch++;
-                        if(nEntry == isearch)
-                              isearch = 0;
-                  }     // for
+                  }
             }
 
 
@@ -1645,6 +1720,11 @@ int ChartDatabase::SearchDirAndAddCharts(wxString& dir_name_base,
                   }
                   chartTable.Add(pnewChart);
                   nDirEntry++;
+
+                  int inew = chartTable.GetCount() - 1;
+                  path_hash[full_name] = inew;
+                  if(name_hash.find(file_name) == name_hash.end())
+                        name_hash[file_name] = inew;
             }
             else
             {
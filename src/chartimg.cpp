@@ -52,7 +52,11 @@
 #include "wx/filename.h"
 #include <wx/image.h>
 #include <wx/fileconf.h>
+#include <wx/zstream.h>
+#include <wx/hashmap.h>
 #include <sys/stat.h>
+#include <vector>
+#include <algorithm>
 
 
 #include "chartimg.h"
@@ -103,6 +107,140 @@ typedef struct  {
 
 bool G_FloatPtInPolygon(MyFlPoint *rgpts, int wnumpts, float x, float y) ;
 
+extern wxString         g_PrivateDataDir;
+extern int              g_nRasterTileCacheLimit;
+
+// ----------------------------------------------------------------------------
+// Raster tile cache
+// ----------------------------------------------------------------------------
+
+//    Downsampled views are cached on disk as square tiles of scaled pixels,
+//    one set per integer scale factor, scale type and color scheme.
+//    The chart line index is kept alongside, in the same per chart tile directory.
+#define RASTER_TILE_SIZE      256
+
+static const char tile_sig[] = "OCPNTIL1";
+
+typedef struct {
+      char  sig[8];
+      int   mtime;
+      int   size;
+      int   color_scheme;
+      int   scale_type;
+      int   factor;
+      int   bpp;
+      int   tile_size;
+} RasterTileHeader;
+
+static const char line_index_sig[] = "OCPNLIX1";
+
+typedef struct {
+      char  sig[8];
+      int   mtime;
+      int   size;
+      int   size_y;
+      int   data_start;
+      int   line_offset;
+} LineIndexHeader;
+
+//    Integer division rounding towards -infinity
+static int FloorDiv(int a, int b)
+{
+      if(a >= 0)
+            return a / b;
+      return -((-a + b - 1) / b);
+}
+
+//    The tile cache is kept within g_nRasterTileCacheLimit MBytes by removing
+//    the least recently used tiles. Loading a tile touches it, so the file
+//    mtime orders the tiles by last use.
+static bool s_b_tile_cache_counted = false;
+static wxULongLong s_tile_cache_bytes = 0;        // running total, once counted
+
+typedef struct {
+      time_t      mtime;
+      wxULongLong size;
+      wxString    file;
+} TileCacheEntry;
+
+static bool TileCacheEntryOlder(const TileCacheEntry& a, const TileCacheEntry& b)
+{
+      return a.mtime < b.mtime;
+}
+
+static wxString GetTileCacheRoot(void)
+{
+      wxFileName tile_dir(g_PrivateDataDir, wxEmptyString);
+      tile_dir.AppendDir(_T("rastertiles"));
+      return tile_dir.GetPath();
+}
+
+//    Remove the oldest tiles until at most target bytes remain, returns the bytes left
+static wxULongLong TrimTileCache(wxULongLong target)
+{
+      wxString root = GetTileCacheRoot();
+      if(!wxDir::Exists(root))
+            return 0;
+
+      wxArrayString files;
+      wxDir::GetAllFiles(root, &files, _T("*.tile"));
+
+      std::vector<TileCacheEntry> entries;
+      entries.reserve(files.GetCount());
+
+      wxULongLong total = 0;
+      for(unsigned int i=0 ; i < files.GetCount() ; i++)
+      {
+            wxFileName fn(files[i]);
+            TileCacheEntry entry;
+            entry.size = fn.GetSize();
+            if(entry.size == wxInvalidSize)
+                  continue;
+            entry.mtime = fn.GetModificationTime().GetTicks();
+            entry.file = files[i];
+            total += entry.size;
+            entries.push_back(entry);
+      }
+
+      if(total <= target)
+            return total;
+
+      std::sort(entries.begin(), entries.end(), TileCacheEntryOlder);
+
+      for(unsigned int i=0 ; (i < entries.size()) && (total > target) ; i++)
+      {
+            if(::wxRemoveFile(entries[i].file))
+                  total -= entries[i].size;
+      }
+
+      return total;
+}
+
+//    Account for a newly written tile, and trim the cache when it grows past the limit.
+//    Trimming goes well below the limit, so the cache is not walked for every new tile.
+static void NoteTileSaved(const wxString& file)
+{
+      if(g_nRasterTileCacheLimit <= 0)
+            return;
+
+      wxULongLong limit = wxULongLong(g_nRasterTileCacheLimit) * 1024 * 1024;
+
+      if(!s_b_tile_cache_counted)
+      {
+            s_tile_cache_bytes = TrimTileCache(limit);
+            s_b_tile_cache_counted = true;
+      }
+      else
+      {
+            wxULongLong size = wxFileName(file).GetSize();
+            if(size != wxInvalidSize)
+                  s_tile_cache_bytes += size;
+      }
+
+      if(s_tile_cache_bytes > limit)
+            s_tile_cache_bytes = TrimTileCache((limit * 3) / 4);
+}
+
 
 // ----------------------------------------------------------------------------
 // private classes
@@ -1393,6 +1531,13 @@ ChartBaseBSB::ChartBaseBSB()
       pline_table = NULL;
       ifs_buf = NULL;
 
+      m_pBandBuf = NULL;
+      m_BandBufSize = 0;
+      m_band_y0 = 0;
+      m_band_y1 = 0;
+      m_band_file_offset = 0;
+      m_pLineScratch = NULL;
+
       cached_image_ok = 0;
 
       pRefTable = (Refpoint *)malloc(sizeof(Refpoint));
@@ -1444,10 +1589,16 @@ ChartBaseBSB::ChartBaseBSB()
 
       m_b_cdebug = 0;
 
+      m_b_tilecache = true;
+      m_tile_key_mtime = 0;
+      m_tile_key_size = 0;
+      m_pTileBuf = NULL;
+
 #ifdef OCPN_USE_CONFIG
       wxFileConfig *pfc = (wxFileConfig *)pConfig;
       pfc->SetPath ( _T ( "/Settings" ) );
       pfc->Read ( _T ( "DebugBSBImg" ),  &m_b_cdebug, 0 );
+      pfc->Read ( _T ( "RasterTileCache" ),  &m_b_tilecache, true );
 #endif
 
 }
@@ -1464,6 +1615,10 @@ ChartBaseBSB::~ChartBaseBSB()
       if(ifs_buf)
             free(ifs_buf);
 
+      free(m_pBandBuf);
+      free(m_pLineScratch);
+      free(m_pTileBuf);
+
       free(pRefTable);
 //      free(pPlyTable);
 
@@ -1675,111 +1830,120 @@ InitReturn ChartBaseBSB::PostInit(void)
       if(!pline_table)
             return INIT_FAIL_REMOVE;
 
-      ifs_bitmap->SeekI((Size_Y+1) * -4, wxFromEnd);                 // go to Beginning of offset table
-      pline_table[Size_Y] = ifs_bitmap->TellI();                     // fill in useful last table entry
+      //    A line index saved by a previous open saves reading and validating the whole image
+      InitTileCache();
+      m_nLineOffset = 0;
+      bool b_index_cached = LoadLineIndex();
 
-      int offset;
-      for(int ifplt=0 ; ifplt<Size_Y ; ifplt++)
+      if(!b_index_cached)
       {
-          offset = 0;
-          offset += (unsigned char)ifs_bitmap->GetC() * 256 * 256 * 256;
-          offset += (unsigned char)ifs_bitmap->GetC() * 256 * 256 ;
-          offset += (unsigned char)ifs_bitmap->GetC() * 256 ;
-          offset += (unsigned char)ifs_bitmap->GetC();
+            ifs_bitmap->SeekI((Size_Y+1) * -4, wxFromEnd);                 // go to Beginning of offset table
+            pline_table[Size_Y] = ifs_bitmap->TellI();                     // fill in useful last table entry
 
-          pline_table[ifplt] = offset;
-      }
+            int offset;
+            for(int ifplt=0 ; ifplt<Size_Y ; ifplt++)
+            {
+                offset = 0;
+                offset += (unsigned char)ifs_bitmap->GetC() * 256 * 256 * 256;
+                offset += (unsigned char)ifs_bitmap->GetC() * 256 * 256 ;
+                offset += (unsigned char)ifs_bitmap->GetC() * 256 ;
+                offset += (unsigned char)ifs_bitmap->GetC();
 
-      //    Try to validate the line index
+                pline_table[ifplt] = offset;
+            }
 
-      bool bline_index_ok = true;
-      m_nLineOffset = 0;
+            //    Try to validate the line index
 
-      for(int iplt=0 ; iplt<Size_Y - 1 ; iplt++)
-      {
-            if( wxInvalidOffset == ifs_bitmap->SeekI(pline_table[iplt], wxFromStart))
+            bool bline_index_ok = true;
+            m_nLineOffset = 0;
+
+            for(int iplt=0 ; iplt<Size_Y - 1 ; iplt++)
             {
-                  wxString msg(_("   Chart File corrupt in PostInit() on chart "));
-                  msg.Append(m_FullPath);
-                  wxLogMessage(msg);
+                  if( wxInvalidOffset == ifs_bitmap->SeekI(pline_table[iplt], wxFromStart))
+                  {
+                        wxString msg(_("   Chart File corrupt in PostInit() on chart "));
+                        msg.Append(m_FullPath);
+                        wxLogMessage(msg);
 
-                  return INIT_FAIL_REMOVE;
-            }
+                        return INIT_FAIL_REMOVE;
+                  }
 
-            int thisline_size = pline_table[iplt+1] - pline_table[iplt] ;
+                  int thisline_size = pline_table[iplt+1] - pline_table[iplt] ;
 
-            if(thisline_size < 0)
-            {
-                  wxString msg(_("   Chart File corrupt in PostInit() on chart "));
-                  msg.Append(m_FullPath);
-                  wxLogMessage(msg);
+                  if(thisline_size < 0)
+                  {
+                        wxString msg(_("   Chart File corrupt in PostInit() on chart "));
+                        msg.Append(m_FullPath);
+                        wxLogMessage(msg);
 
-                  return INIT_FAIL_REMOVE;
-            }
+                        return INIT_FAIL_REMOVE;
+                  }
 
-            if(thisline_size > ifs_bufsize)
-            {
-                  wxString msg(_T("   ifs_bufsize too small PostInit() on chart "));
-                  msg.Append(m_FullPath);
-                  wxLogMessage(msg);
+                  if(thisline_size > ifs_bufsize)
+                  {
+                        wxString msg(_T("   ifs_bufsize too small PostInit() on chart "));
+                        msg.Append(m_FullPath);
+                        wxLogMessage(msg);
 
-                  return INIT_FAIL_REMOVE;
-            }
+                        return INIT_FAIL_REMOVE;
+                  }
 
-            ifs_bitmap->Read(ifs_buf, thisline_size);
+                  ifs_bitmap->Read(ifs_buf, thisline_size);
 
-            unsigned char *lp = ifs_buf;
+                  unsigned char *lp = ifs_buf;
 
-            unsigned char byNext;
-            int nLineMarker = 0;
-            do
-            {
-                  byNext = *lp++;
-                  nLineMarker = nLineMarker * 128 + (byNext & 0x7f);
-            } while( (byNext & 0x80) != 0 );
+                  unsigned char byNext;
+                  int nLineMarker = 0;
+                  do
+                  {
+                        byNext = *lp++;
+                        nLineMarker = nLineMarker * 128 + (byNext & 0x7f);
+                  } while( (byNext & 0x80) != 0 );
 
 
-            //  Linemarker Correction factor needed here
-            //  Some charts start with LineMarker = 0, some with LineMarker = 1
-            //  Assume the first LineMarker found is the index base, and use
-            //  as a correction offset
+                  //  Linemarker Correction factor needed here
+                  //  Some charts start with LineMarker = 0, some with LineMarker = 1
+                  //  Assume the first LineMarker found is the index base, and use
+                  //  as a correction offset
 
-            if(iplt == 0)
-                m_nLineOffset = nLineMarker;
+                  if(iplt == 0)
+                      m_nLineOffset = nLineMarker;
 
-            if(nLineMarker != iplt + m_nLineOffset)
-            {
-                bline_index_ok = false;
-                break;
-            }
+                  if(nLineMarker != iplt + m_nLineOffset)
+                  {
+                      bline_index_ok = false;
+                      break;
+                  }
 
-      }
-/*
-      if(!bline_index_ok)
-      {
-            wxString msg(_T("   Line Index corrupt on chart "));
-            msg.Append(m_FullPath);
-            wxLogMessage(msg);
+            }
+      /*
+            if(!bline_index_ok)
+            {
+                  wxString msg(_T("   Line Index corrupt on chart "));
+                  msg.Append(m_FullPath);
+                  wxLogMessage(msg);
 
-            wxLogMessage(_T("   Assuming chart data is otherwise OK."));
-            bline_index_ok = true;
-      }
-*/
-        // Recreate the scan line index if the embedded version seems corrupt
-      if(!bline_index_ok)
-      {
-          wxString msg(_("   Line Index corrupt, recreating Index for chart "));
-          msg.Append(m_FullPath);
-          wxLogMessage(msg);
-          if(!CreateLineIndex())
-          {
-                wxString msg(_("   Error creating Line Index for chart "));
+                  wxLogMessage(_T("   Assuming chart data is otherwise OK."));
+                  bline_index_ok = true;
+            }
+      */
+              // Recreate the scan line index if the embedded version seems corrupt
+            if(!bline_index_ok)
+            {
+                wxString msg(_("   Line Index corrupt, recreating Index for chart "));
                 msg.Append(m_FullPath);
                 wxLogMessage(msg);
-                return INIT_FAIL_REMOVE;
-          }
-      }
+                if(!CreateLineIndex())
+                {
+                      wxString msg(_("   Error creating Line Index for chart "));
+                      msg.Append(m_FullPath);
+                      wxLogMessage(msg);
+                      return INIT_FAIL_REMOVE;
+                }
+            }
 
+            SaveLineIndex();
+      }           // !b_index_cached
 
 
       //    Allocate the Line Cache
@@ -3246,7 +3410,8 @@ bool ChartBaseBSB::GetViewUsingCache( wxRect& source, wxRect& dest, const wxRegi
             wxRegionContain rc = Region.Contains(sub_dest);
             if((wxPartRegion == rc) || (wxInRegion == rc))
             {
-                  GetAndScaleData(pPixCache->GetpData(), source, source.width, sub_dest, width, cs1d, pan_scale_type_y);
+                  if(!GetTiledData(pPixCache->GetpData(), source, sub_dest, width, cs1d, pan_scale_type_y))
+                        GetAndScaleData(pPixCache->GetpData(), source, source.width, sub_dest, width, cs1d, pan_scale_type_y);
             }
             pPixCache->Update();
 
@@ -3284,7 +3449,8 @@ bool ChartBaseBSB::GetViewUsingCache( wxRect& source, wxRect& dest, const wxRegi
             wxRegionContain rc = Region.Contains(sub_dest);
             if((wxPartRegion == rc) || (wxInRegion == rc))
             {
-                  GetAndScaleData(pPixCache->GetpData(), source, source.width, sub_dest, width, cs1d, pan_scale_type_x);
+                  if(!GetTiledData(pPixCache->GetpData(), source, sub_dest, width, cs1d, pan_scale_type_x))
+                        GetAndScaleData(pPixCache->GetpData(), source, source.width, sub_dest, width, cs1d, pan_scale_type_x);
             }
 
             pPixCache->Update();
@@ -3512,7 +3678,12 @@ bool ChartBaseBSB::GetView( wxRect& source, wxRect& dest, ScaleTypeEnum scale_ty
            pPixCache = pPixCacheTemp;
       }
 */
-      GetAndScaleData(pPixCache->GetpData(), source, source.width, dest, dest.width, factor, scale_type);
+      bool b_tiled = false;
+      if((factor >= 2.0) && (fabs(factor - wxRound(factor)) < .0001))
+            b_tiled = GetTiledData(pPixCache->GetpData(), source, dest, dest.width, wxRound(factor), scale_type);
+
+      if(!b_tiled)
+            GetAndScaleData(pPixCache->GetpData(), source, source.width, dest, dest.width, factor, scale_type);
       pPixCache->Update();
 
 //    Update cache parameters
@@ -3528,6 +3699,304 @@ bool ChartBaseBSB::GetView( wxRect& source, wxRect& dest, ScaleTypeEnum scale_ty
 }
 
 
+//    Establish the tile cache directory and file signature for this chart.
+//    The line index is kept there too, whether or not tiles are enabled.
+void ChartBaseBSB::InitTileCache(void)
+{
+      m_TileCacheDir.Clear();
+
+      if(g_PrivateDataDir.IsEmpty() || !ifss_bitmap)
+            return;
+
+      wxString bitmap_file = m_FullPath;
+      if(pBitmapFilePath)
+            bitmap_file = *pBitmapFilePath;
+
+      wxFileName fn(bitmap_file);
+      if(!fn.FileExists())
+            return;
+
+      m_tile_key_mtime = (int)fn.GetModificationTime().GetTicks();
+      m_tile_key_size = (int)ifss_bitmap->GetLength();
+
+      //    One directory per chart, named for the chart file and a hash of its full path
+      wxString dir_name;
+      dir_name.Printf(_T("%s_%08lx"), wxFileName(m_FullPath).GetName().c_str(),
+                      wxStringHash::stringHash(m_FullPath.c_str()) & 0xffffffffUL);
+
+      wxFileName tile_dir(GetTileCacheRoot(), wxEmptyString);
+      tile_dir.AppendDir(dir_name);
+      m_TileCacheDir = tile_dir.GetPath();
+}
+
+
+bool ChartBaseBSB::MakeTileCacheDir(void)
+{
+      if(m_TileCacheDir.IsEmpty())
+            return false;
+
+      if(!wxFileName::DirExists(m_TileCacheDir))
+      {
+            if(!wxFileName::Mkdir(m_TileCacheDir, 0777, wxPATH_MKDIR_FULL))
+            {
+                  m_TileCacheDir.Clear();             // don't try again for this chart
+                  return false;
+            }
+      }
+      return true;
+}
+
+
+//    The line index sidecar holds pline_table[0..Size_Y] as validated or
+//    recreated by PostInit(), so that later opens need not scan the image
+bool ChartBaseBSB::LoadLineIndex(void)
+{
+      if(m_TileCacheDir.IsEmpty())
+            return false;
+
+      wxFileName file(m_TileCacheDir, _T("lineindex.dat"));
+      if(!file.FileExists())
+            return false;
+
+      wxFileInputStream fis(file.GetFullPath());
+      if(!fis.IsOk())
+            return false;
+
+      LineIndexHeader hdr;
+      if(fis.Read(&hdr, sizeof(hdr)).LastRead() != sizeof(hdr))
+            return false;
+
+      if(strncmp(hdr.sig, line_index_sig, 8) || (hdr.mtime != m_tile_key_mtime) || (hdr.size != m_tile_key_size)
+         || (hdr.size_y != Size_Y) || (hdr.data_start != nFileOffsetDataStart))
+            return false;
+
+      size_t table_bytes = (Size_Y + 1) * sizeof(int);
+      if(fis.Read(pline_table, table_bytes).LastRead() != table_bytes)
+            return false;
+
+      m_nLineOffset = hdr.line_offset;
+
+      return true;
+}
+
+
+bool ChartBaseBSB::SaveLineIndex(void)
+{
+      if(!MakeTileCacheDir())
+            return false;
+
+      LineIndexHeader hdr;
+      memset(&hdr, 0, sizeof(hdr));
+      memcpy(hdr.sig, line_index_sig, 8);
+      hdr.mtime = m_tile_key_mtime;
+      hdr.size = m_tile_key_size;
+      hdr.size_y = Size_Y;
+      hdr.data_start = nFileOffsetDataStart;
+      hdr.line_offset = m_nLineOffset;
+
+      wxFileName file(m_TileCacheDir, _T("lineindex.dat"));
+      wxString tmp_file = file.GetFullPath();
+      tmp_file += _T(".tmp");
+
+      bool bok;
+      {
+            wxFileOutputStream fos(tmp_file);
+            if(!fos.IsOk())
+                  return false;
+
+            fos.Write(&hdr, sizeof(hdr));
+            fos.Write(pline_table, (Size_Y + 1) * sizeof(int));
+            bok = fos.IsOk() && fos.Close();
+      }
+
+      if(!bok)
+      {
+            ::wxRemoveFile(tmp_file);
+            return false;
+      }
+
+      return ::wxRenameFile(tmp_file, file.GetFullPath());
+}
+
+
+wxString ChartBaseBSB::GetTileFileName(int factor, ScaleTypeEnum scale_type, int tx, int ty)
+{
+      wxString name = wxString::Format(_T("f%d_t%d_c%d_%d_%d.tile"), factor, (int)scale_type,
+                                       (int)m_global_color_scheme, tx, ty);
+      wxFileName file(m_TileCacheDir, name);
+      return file.GetFullPath();
+}
+
+
+bool ChartBaseBSB::LoadTile(const wxString& file, int factor, ScaleTypeEnum scale_type, unsigned char *pTile)
+{
+      if(!wxFileName::FileExists(file))
+            return false;
+
+      wxFileInputStream fis(file);
+      if(!fis.IsOk())
+            return false;
+
+      RasterTileHeader hdr;
+      if(fis.Read(&hdr, sizeof(hdr)).LastRead() != sizeof(hdr))
+            return false;
+
+      //    The tile must belong to the current version of the chart file
+      if(strncmp(hdr.sig, tile_sig, 8) || (hdr.mtime != m_tile_key_mtime) || (hdr.size != m_tile_key_size)
+         || (hdr.color_scheme != (int)m_global_color_scheme) || (hdr.scale_type != (int)scale_type)
+         || (hdr.factor != factor) || (hdr.bpp != BPP) || (hdr.tile_size != RASTER_TILE_SIZE))
+            return false;
+
+      size_t tile_bytes = RASTER_TILE_SIZE * RASTER_TILE_SIZE * BPP/8;
+
+      wxZlibInputStream zis(fis);
+      zis.Read(pTile, tile_bytes);
+
+      if(zis.LastRead() != tile_bytes)
+            return false;
+
+      //    Mark the tile as recently used, for the cache trim
+      wxFileName(file).Touch();
+
+      return true;
+}
+
+
+bool ChartBaseBSB::SaveTile(const wxString& file, int factor, ScaleTypeEnum scale_type, unsigned char *pTile)
+{
+      if(!MakeTileCacheDir())
+            return false;
+
+      RasterTileHeader hdr;
+      memset(&hdr, 0, sizeof(hdr));
+      memcpy(hdr.sig, tile_sig, 8);
+      hdr.mtime = m_tile_key_mtime;
+      hdr.size = m_tile_key_size;
+      hdr.color_scheme = (int)m_global_color_scheme;
+      hdr.scale_type = (int)scale_type;
+      hdr.factor = factor;
+      hdr.bpp = BPP;
+      hdr.tile_size = RASTER_TILE_SIZE;
+
+      //    Write to a temporary file, so that a partial tile is never seen
+      wxString tmp_file = file;
+      tmp_file += _T(".tmp");
+
+      bool bok;
+      {
+            wxFileOutputStream fos(tmp_file);
+            if(!fos.IsOk())
+                  return false;
+
+            fos.Write(&hdr, sizeof(hdr));
+
+            wxZlibOutputStream zos(fos, wxZ_BEST_SPEED);
+            zos.Write(pTile, RASTER_TILE_SIZE * RASTER_TILE_SIZE * BPP/8);
+            bok = zos.Close() && fos.Close();
+      }
+
+      if(!bok)
+      {
+            ::wxRemoveFile(tmp_file);
+            return false;
+      }
+
+      if(!::wxRenameFile(tmp_file, file))
+            return false;
+
+      NoteTileSaved(file);
+
+      return true;
+}
+
+
+//    Fill the dest rectangle of a view from the on-disk tile cache, decoding
+//    and saving any tiles not yet present.
+//    View pixel (x, y) maps to scaled pixel (source.x/factor + x, source.y/factor + y),
+//    so views whose source origin is not a multiple of factor are snapped to the tile grid.
+//    The snap is less than one screen pixel, and is consistent across pans.
+bool ChartBaseBSB::GetTiledData(unsigned char *ppn, wxRect& source, wxRect& dest, int dest_stride,
+                                int factor, ScaleTypeEnum scale_type)
+{
+      if(!m_b_tilecache || m_TileCacheDir.IsEmpty() || (factor < 2))
+            return false;
+
+      if((dest.width <= 0) || (dest.height <= 0))
+            return true;
+
+      int tile_bytes = RASTER_TILE_SIZE * RASTER_TILE_SIZE * BPP/8;
+      if(!m_pTileBuf)
+      {
+            m_pTileBuf = (unsigned char *)malloc(tile_bytes);
+            if(!m_pTileBuf)
+                  return false;
+      }
+
+      //    Scaled pixel extent of the chart and of the requested rectangle
+      int level_width = (Size_X + factor - 1) / factor;
+      int level_height = (Size_Y + factor - 1) / factor;
+
+      int lx0 = FloorDiv(source.x, factor) + dest.x;
+      int ly0 = FloorDiv(source.y, factor) + dest.y;
+      int lx1 = lx0 + dest.width;
+      int ly1 = ly0 + dest.height;
+
+      //    Off chart pixels are black, as GetAndScaleData() renders them
+      for(int y = dest.y ; y < dest.y + dest.height ; y++)
+            memset(ppn + ((y * dest_stride) + dest.x) * BPP/8, 0, dest.width * BPP/8);
+
+      int tx0 = FloorDiv(wxMax(lx0, 0), RASTER_TILE_SIZE);
+      int ty0 = FloorDiv(wxMax(ly0, 0), RASTER_TILE_SIZE);
+      int tx1 = FloorDiv(wxMin(lx1, level_width) - 1, RASTER_TILE_SIZE);
+      int ty1 = FloorDiv(wxMin(ly1, level_height) - 1, RASTER_TILE_SIZE);
+
+      for(int ty = ty0 ; ty <= ty1 ; ty++)
+      {
+            for(int tx = tx0 ; tx <= tx1 ; tx++)
+            {
+                  wxString file = GetTileFileName(factor, scale_type, tx, ty);
+
+                  if(!LoadTile(file, factor, scale_type, m_pTileBuf))
+                  {
+                        wxRect tile_source(tx * RASTER_TILE_SIZE * factor, ty * RASTER_TILE_SIZE * factor,
+                                           RASTER_TILE_SIZE * factor, RASTER_TILE_SIZE * factor);
+                        wxRect tile_dest(0, 0, RASTER_TILE_SIZE, RASTER_TILE_SIZE);
+
+                        memset(m_pTileBuf, 0, tile_bytes);
+                        GetAndScaleData(m_pTileBuf, tile_source, tile_source.width, tile_dest,
+                                        RASTER_TILE_SIZE, factor, scale_type);
+
+                        if(!m_TileCacheDir.IsEmpty())
+                              SaveTile(file, factor, scale_type, m_pTileBuf);
+                  }
+
+                  //    Copy the overlap of this tile and the requested rectangle
+                  int tile_lx = tx * RASTER_TILE_SIZE;
+                  int tile_ly = ty * RASTER_TILE_SIZE;
+
+                  int cx0 = wxMax(lx0, tile_lx);
+                  int cx1 = wxMin(wxMin(lx1, tile_lx + RASTER_TILE_SIZE), level_width);
+                  int cy0 = wxMax(ly0, tile_ly);
+                  int cy1 = wxMin(wxMin(ly1, tile_ly + RASTER_TILE_SIZE), level_height);
+
+                  if((cx1 <= cx0) || (cy1 <= cy0))
+                        continue;
+
+                  for(int ly = cy0 ; ly < cy1 ; ly++)
+                  {
+                        unsigned char *ps = m_pTileBuf +
+                                    (((ly - tile_ly) * RASTER_TILE_SIZE) + (cx0 - tile_lx)) * BPP/8;
+                        unsigned char *pd = ppn +
+                                    (((ly - ly0 + dest.y) * dest_stride) + (cx0 - lx0 + dest.x)) * BPP/8;
+                        memcpy(pd, ps, (cx1 - cx0) * BPP/8);
+                  }
+            }
+      }
+
+      return true;
+}
+
+
 bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, wxRect& source, int source_stride,
                                    wxRect& dest, int dest_stride, double scale_factor, ScaleTypeEnum scale_type)
 {
@@ -3556,8 +4025,15 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, wxRect& source, int sourc
                   int blur_factor = wxMax(2, Factor);
                   int wb_size = (source.width) * (blur_factor * 2) * BPP/8 ;
                   s_data = (unsigned char *) malloc( wb_size ); // work buffer
-                  unsigned char *pixel;
-                  int y_offset;
+
+//    And a row of per-column RGB sums for the box filter
+                  unsigned int *col_sum = (unsigned int *) malloc( source.width * 3 * sizeof(unsigned int) );
+
+//    Fetch the compressed data for the whole source band in one read
+                  PrefetchCompressedBand(source.y + (int)(dest.y * factor),
+                                         source.y + (int)((dest.y + dest.height) * factor) + blur_factor);
+
+                  int x_limit = wxMin(source.width, Size_X - source.x);
 
                   for (int y = dest.y; y < (dest.y + dest.height); y++)
                   {
@@ -3570,39 +4046,51 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, wxRect& source, int sourc
                         s1.height = blur_factor;
                         GetChartBits(s1, s_data, 1);
 
+                  //    Box filter, done separably.
+                  //    First sum the band vertically, a simple contiguous pass over each line...
+                        memset(col_sum, 0, source.width * 3 * sizeof(unsigned int));
+                        for ( int y1 = 0 ; y1 < blur_factor ; ++y1 )
+                        {
+                              unsigned char *pixel = s_data + (y1 * source.width * BPP/8);
+                              unsigned int *psum = col_sum;
+                              for ( int x1 = 0 ; x1 < source.width ; ++x1 )
+                              {
+                                    psum[0] += pixel[0];
+                                    psum[1] += pixel[1];
+                                    psum[2] += pixel[2];
+                                    psum += 3;
+                                    pixel += BPP/8;
+                              }
+                        }
+
+                  //    ...then sum the columns of each block horizontally and average
                         target_data = data + (y * dest_stride * BPP/8);
 
                         for (int x = 0; x < target_width; x++)
                         {
-                              unsigned int avgRed = 0 ;
-                              unsigned int avgGreen = 0;
-                              unsigned int avgBlue = 0;
-                              unsigned int pixel_count = 0;
-                              unsigned char *pix0 = s_data +  BPP/8 * ((int)( x * factor )) ;
-                              y_offset = 0;
+                              int xs = (int)( x * factor );
 
                               if((x * Factor) < (Size_X - source.x))
                               {
-            // determine average
-                                    for ( int y1 = 0 ; y1 < blur_factor ; ++y1 )
+                                    int xe = wxMin(xs + blur_factor, x_limit);
+                                    unsigned int avgRed = 0 ;
+                                    unsigned int avgGreen = 0;
+                                    unsigned int avgBlue = 0;
+
+                                    unsigned int *psum = col_sum + (xs * 3);
+                                    for ( int x1 = xs ; x1 < xe ; ++x1 )
                                     {
-                                        pixel = pix0 + (BPP/8 * y_offset ) ;
-                                        for ( int x1 = 0 ; x1 < blur_factor ; ++x1 )
-                                        {
-                                            avgRed   += pixel[0] ;
-                                            avgGreen += pixel[1] ;
-                                            avgBlue  += pixel[2] ;
-
-                                            pixel += BPP/8;
-
-                                            pixel_count++;
-                                        }
-                                        y_offset += source.width ;
+                                          avgRed   += psum[0];
+                                          avgGreen += psum[1];
+                                          avgBlue  += psum[2];
+                                          psum += 3;
                                     }
 
-                                    target_data[0] = avgRed / pixel_count;     // >> scounter;
-                                    target_data[1] = avgGreen / pixel_count;   // >> scounter;
-                                    target_data[2] = avgBlue / pixel_count;    // >> scounter;
+                                    unsigned int pixel_count = wxMax(xe - xs, 1) * blur_factor;
+
+                                    target_data[0] = avgRed / pixel_count;
+                                    target_data[1] = avgGreen / pixel_count;
+                                    target_data[2] = avgBlue / pixel_count;
                                     target_data += BPP/8;
                               }
                               else
@@ -3617,6 +4105,8 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, wxRect& source, int sourc
 
                   }  // for y
 
+                  free(col_sum);
+
             }           // SCALE_BILINEAR
 
             else if (scale_type == RENDER_LODEF)
@@ -3637,6 +4127,10 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, wxRect& source, int sourc
                         int y = dest.y;                // starting here
                         long ys = dest.y * y_delta;
 
+                        //    Fetch the compressed data for the whole source band in one read
+                        PrefetchCompressedBand(source.y + (ys >> scaler),
+                                               source.y + ((ys + (dest.height * y_delta)) >> scaler) + 1);
+
                         while ( y < dest.y + dest.height)
                         {
                         //    Read 1 line at the right place from the source
@@ -3814,6 +4308,9 @@ bool ChartBaseBSB::GetChartBits(wxRect& source, unsigned char *pPix, int sub_sam
 
 //    Decode the KAP file RLL stream into image pPix
 
+      //    Fetch the compressed data for all the rows needed with one read
+      PrefetchCompressedBand(source.y, source.y + source.height);
+
       unsigned char *pCP;
       pCP = pPix;
 
@@ -4031,6 +4528,74 @@ int   ChartBaseBSB::BSBScanScanline(wxInputStream *pinStream )
 
 
 
+//-----------------------------------------------------------------------
+//    Read the raw compressed data for rows y0 to y1-1 with a single
+//    seek and read, so that BSBGetScanline() need not seek for every line.
+//    Rows at either end already in the line cache are not fetched.
+//    If the line index is not ascending over the range, or the band
+//    would be too large, nothing is fetched and lines are read singly.
+//-----------------------------------------------------------------------
+#define BSB_BAND_MAX    (16 * 1024 * 1024)
+
+void ChartBaseBSB::PrefetchCompressedBand(int y0, int y1)
+{
+      if(!pline_table || !ifs_bitmap)
+            return;
+
+      y0 = wxMax(y0, 0);
+      y1 = wxMin(y1, Size_Y);
+
+      if(bUseLineCache && pLineCache)
+      {
+            while((y0 < y1) && pLineCache[y0].bValid)
+                  y0++;
+            while((y1 > y0) && pLineCache[y1-1].bValid)
+                  y1--;
+      }
+
+      if(y1 - y0 < 2)
+            return;
+
+      //    Already have it?
+      if((y0 >= m_band_y0) && (y1 <= m_band_y1))
+            return;
+
+      for(int y = y0 ; y < y1 ; y++)
+      {
+            if((pline_table[y] == 0) || (pline_table[y+1] < pline_table[y]))
+                  return;
+      }
+
+      int band_size = pline_table[y1] - pline_table[y0];
+      if((band_size <= 0) || (band_size > BSB_BAND_MAX))
+            return;
+
+      if(band_size + 1 > m_BandBufSize)
+      {
+            unsigned char *pnew = (unsigned char *)realloc(m_pBandBuf, band_size + 1);
+            if(!pnew)
+                  return;
+            m_pBandBuf = pnew;
+            m_BandBufSize = band_size + 1;
+      }
+
+      m_band_y0 = m_band_y1 = 0;
+
+      if( wxInvalidOffset == ifs_bitmap->SeekI(pline_table[y0], wxFromStart))
+            return;
+
+      ifs_bitmap->Read(m_pBandBuf, band_size);
+      if(ifs_bitmap->LastRead() != (size_t)band_size)
+            return;
+
+      m_pBandBuf[band_size] = 0;                  // terminate the last line, against corrupt data
+
+      m_band_y0 = y0;
+      m_band_y1 = y1;
+      m_band_file_offset = pline_table[y0];
+}
+
+
 //-----------------------------------------------------------------------
 //    Get a BSB Scan Line Using Cache and scan line index if available
 //-----------------------------------------------------------------------
@@ -4061,7 +4626,11 @@ int   ChartBaseBSB::BSBGetScanline( unsigned char *pLineBuf, int y, int xs, int
             xtemp_line = pt->pPix;
       }
       else
-            xtemp_line = (unsigned char *)malloc(Size_X);
+      {
+            if(!m_pLineScratch)
+                  m_pLineScratch = (unsigned char *)malloc(Size_X);
+            xtemp_line = m_pLineScratch;
+      }
 
 
       if((bUseLineCache && !pt->bValid) || (!bUseLineCache))
@@ -4072,16 +4641,27 @@ int   ChartBaseBSB::BSBGetScanline( unsigned char *pLineBuf, int y, int xs, int
           if(pline_table[y+1] == 0)
               return 0;
 
-            int thisline_size = pline_table[y+1] - pline_table[y] ;
+            if((y >= m_band_y0) && (y < m_band_y1))
+            {
+                  //    Raw line is in the prefetched band
+                  lp = m_pBandBuf + (pline_table[y] - m_band_file_offset);
+            }
+            else
+            {
+                  int thisline_size = pline_table[y+1] - pline_table[y] ;
 
-            if(thisline_size > ifs_bufsize)
-                ifs_buf = (unsigned char *)realloc(ifs_buf, thisline_size);
+                  if(thisline_size > ifs_bufsize)
+                  {
+                        ifs_buf = (unsigned char *)realloc(ifs_buf, thisline_size);
+                        ifs_bufsize = thisline_size;
+                  }
 
-            if( wxInvalidOffset == ifs_bitmap->SeekI(pline_table[y], wxFromStart))
-                  return 0;
+                  if( wxInvalidOffset == ifs_bitmap->SeekI(pline_table[y], wxFromStart))
+                        return 0;
 
-            ifs_bitmap->Read(ifs_buf, thisline_size);
-            lp = ifs_buf;
+                  ifs_bitmap->Read(ifs_buf, thisline_size);
+                  lp = ifs_buf;
+            }
 
 //    At this point, the unexpanded, raw line is at *lp, and the expansion destination is xtemp_line
 
@@ -4123,8 +4703,17 @@ int   ChartBaseBSB::BSBGetScanline( unsigned char *pLineBuf, int y, int xs, int
                       nRunCount = 0;
 
 //          Store nPixValue in the destination
-                  memset(pCL, nPixValue, nRunCount+1);
-                  pCL += nRunCount+1;
+//          Short runs are the norm, and are cheaper stored directly than through memset()
+                  if(nRunCount < 8)
+                  {
+                        for(int ir = 0 ; ir <= nRunCount ; ir++)
+                              *pCL++ = nPixValue;
+                  }
+                  else
+                  {
+                        memset(pCL, nPixValue, nRunCount+1);
+                        pCL += nRunCount+1;
+                  }
                   iPixel += nRunCount+1;
 
             }
@@ -4249,9 +4838,6 @@ int   ChartBaseBSB::BSBGetScanline( unsigned char *pLineBuf, int y, int xs, int
         *prgb_last = a;
       }
 
-      if(!bUseLineCache)
-          free (xtemp_line);
-
       return 1;
 }
 
@@ -7997,8 +7997,7 @@ void ChartCanvas::MouseEvent ( wxMouseEvent& event )
 
                         m_pRoutePointEditTarget->m_lat = m_cursor_lat;     // update the RoutePoint entry
                         m_pRoutePointEditTarget->m_lon = m_cursor_lon;
-                        m_pFoundPoint->m_slat = m_cursor_lat;             // update the SelectList entry
-                        m_pFoundPoint->m_slon = m_cursor_lon;
+                        pSelect->ModifySelectItem ( m_pFoundPoint, m_cursor_lat, m_cursor_lon );    // update the SelectList entry
 
                         if ( CheckEdgePan ( x, y, true ) )
                         {
@@ -8006,8 +8005,7 @@ void ChartCanvas::MouseEvent ( wxMouseEvent& event )
                                 GetCanvasPixPoint ( x, y, new_cursor_lat, new_cursor_lon );
                                 m_pRoutePointEditTarget->m_lat = new_cursor_lat;     // update the RoutePoint entry
                                 m_pRoutePointEditTarget->m_lon = new_cursor_lon;
-                                m_pFoundPoint->m_slat = new_cursor_lat;             // update the SelectList entry
-                                m_pFoundPoint->m_slon = new_cursor_lon;
+                                pSelect->ModifySelectItem ( m_pFoundPoint, new_cursor_lat, new_cursor_lon );    // update the SelectList entry
                         }
 
 
@@ -8026,6 +8024,7 @@ void ChartCanvas::MouseEvent ( wxMouseEvent& event )
                               for(unsigned int ir=0 ; ir < m_pEditRouteArray->GetCount() ; ir++)
                               {
                                     Route *pr = (Route *)m_pEditRouteArray->Item(ir);
+                                    pr->IncModifyCount();
                                     wxRect route_rect;
                                     pr->CalculateDCRect ( m_dc_route, &route_rect, VPoint );
                                     post_rect.Union ( route_rect );
@@ -8084,8 +8083,7 @@ void ChartCanvas::MouseEvent ( wxMouseEvent& event )
 
                         m_pRoutePointEditTarget->m_lat = m_cursor_lat;     // update the RoutePoint entry
                         m_pRoutePointEditTarget->m_lon = m_cursor_lon;
-                        m_pFoundPoint->m_slat = m_cursor_lat;             // update the SelectList entry
-                        m_pFoundPoint->m_slon = m_cursor_lon;
+                        pSelect->ModifySelectItem ( m_pFoundPoint, m_cursor_lat, m_cursor_lon );    // update the SelectList entry
 
                         //    Update the MarkProperties Dialog, if currently shown
                         if ( ( NULL != pMarkPropDialog ) && ( pMarkPropDialog->IsShown() ) )
@@ -542,6 +542,13 @@ static unsigned char Table_0[] =
 static unsigned char Encode_table[256];
 static unsigned char Decode_table[256];
 
+//    A cursor over a decoded cell file held in memory
+typedef struct
+{
+      unsigned char *p;
+      unsigned char *end;
+} cm93_cell_buffer;
+
 static bool  cm93_decode_table_created;
 
 // Case-insensitive cm93 directory tree depth-first traversal to find the dictionary...
@@ -1043,107 +1050,61 @@ void CreateDecodeTable ( void )
 }
 
 
-int   read_and_decode_bytes ( FILE *stream, void *p, int nbytes )
+//    Decode a block of cell data in place
+void decode_bytes ( unsigned char *q, int nbytes )
 {
-      if ( 0 == nbytes )                  // declare victory if no bytes requested
-            return 1;
-
-      //    read into callers buffer
-      if ( !fread ( p, nbytes, 1, stream ) )
-            return 0;
-
-      //    decode inplace
-      unsigned char *q = ( unsigned char * ) p;
+      const unsigned char *table = Decode_table;
+      unsigned char *end = q + nbytes;
 
-      for ( int i=0 ; i < nbytes ; i++ )
+      //    Four at a time, then the remainder
+      while ( q + 4 <= end )
       {
-            unsigned char a = *q;
-            int b = a;
-            unsigned char c = Decode_table[b];
-            *q = c;
-
-            q++;
+            q[0] = table[q[0]];
+            q[1] = table[q[1]];
+            q[2] = table[q[2]];
+            q[3] = table[q[3]];
+            q += 4;
       }
-      return 1;
-}
-
-
-int read_and_decode_double ( FILE *stream, double *p )
-{
-      double t;
-      //    read into temp buffer
-      if ( !fread ( &t, sizeof ( double ), 1, stream ) )
-            return 0;
 
-      //    decode inplace
-      unsigned char *q = ( unsigned char * ) &t;
-
-      for ( unsigned int i=0 ; i < sizeof ( double ) ; i++ )
+      while ( q < end )
       {
-            unsigned char a = *q;
-            int b = a;
-            unsigned char c = Decode_table[b];
-            *q = c;
-
+            *q = table[*q];
             q++;
       }
-
-      //    copy to target
-      *p = t;
-
-      return 1;
 }
 
-int read_and_decode_int ( FILE *stream, int *p )
-{
-      int t;
-      //    read into temp buffer
-      if ( !fread ( &t, sizeof ( int ), 1, stream ) )
-            return 0;
 
-      //    decode inplace
-      unsigned char *q = ( unsigned char * ) &t;
+//    Cell file records are read from a buffer holding the whole decoded cell.
+//    Each reader returns 0 at end of buffer, as fread() would.
 
-      for ( unsigned int i=0 ; i < sizeof ( int ) ; i++ )
-      {
-            unsigned char a = *q;
-            int b = a;
-            unsigned char c = Decode_table[b];
-            *q = c;
+int read_cell_bytes ( cm93_cell_buffer *stream, void *p, int nbytes )
+{
+      if ( 0 == nbytes )                  // declare victory if no bytes requested
+            return 1;
 
-            q++;
-      }
+      if ( ( nbytes < 0 ) || ( stream->end - stream->p < nbytes ) )
+            return 0;
 
-      //    copy to target
-      *p = t;
+      memcpy ( p, stream->p, nbytes );
+      stream->p += nbytes;
 
       return 1;
 }
 
-int read_and_decode_ushort ( FILE *stream, unsigned short *p )
-{
-      unsigned short t;
-      //    read into temp buffer
-      if ( !fread ( &t, sizeof ( unsigned short ), 1, stream ) )
-            return 0;
-
-      //    decode inplace
-      unsigned char *q = ( unsigned char * ) &t;
 
-      for ( unsigned int i=0 ; i < sizeof ( unsigned short ) ; i++ )
-      {
-            unsigned char a = *q;
-            int b = a;
-            unsigned char c = Decode_table[b];
-            *q = c;
-
-            q++;
-      }
+int read_cell_double ( cm93_cell_buffer *stream, double *p )
+{
+      return read_cell_bytes ( stream, p, sizeof ( double ) );
+}
 
-      //    copy to target
-      *p = t;
+int read_cell_int ( cm93_cell_buffer *stream, int *p )
+{
+      return read_cell_bytes ( stream, p, sizeof ( int ) );
+}
 
-      return 1;
+int read_cell_ushort ( cm93_cell_buffer *stream, unsigned short *p )
+{
+      return read_cell_bytes ( stream, p, sizeof ( unsigned short ) );
 }
 
 
@@ -1315,7 +1276,7 @@ int get_dval ( int native_scale )
 }
 
 
-bool read_header_and_populate_cib ( FILE *stream, Cell_Info_Block *pCIB )
+bool read_header_and_populate_cib ( cm93_cell_buffer *stream, Cell_Info_Block *pCIB )
 {
       //    Read header, populate Cell_Info_Block
 
@@ -1327,40 +1288,40 @@ bool read_header_and_populate_cib ( FILE *stream, Cell_Info_Block *pCIB )
 
       memset ( ( void * ) &header, 0, sizeof ( header ) );
 
-      read_and_decode_double ( stream,&header.lon_min );
-      read_and_decode_double ( stream,&header.lat_min );
-      read_and_decode_double ( stream,&header.lon_max );
-      read_and_decode_double ( stream,&header.lat_max );
-
-      read_and_decode_double ( stream,&header.easting_min );
-      read_and_decode_double ( stream,&header.northing_min );
-      read_and_decode_double ( stream,&header.easting_max );
-      read_and_decode_double ( stream,&header.northing_max );
-
-      read_and_decode_ushort ( stream,&header.usn_vector_records );
-      read_and_decode_int ( stream,&header.n_vector_record_points );
-      read_and_decode_int ( stream,&header.m_46 );
-      read_and_decode_int ( stream,&header.m_4a );
-      read_and_decode_ushort ( stream,&header.usn_point3d_records );
-      read_and_decode_int ( stream,&header.m_50 );
-      read_and_decode_int ( stream,&header.m_54 );
-      read_and_decode_ushort ( stream,&header.usn_point2d_records );
-      read_and_decode_ushort ( stream,&header.m_5a );
-      read_and_decode_ushort ( stream,&header.m_5c );
-      read_and_decode_ushort ( stream,&header.usn_feature_records );
-
-      read_and_decode_int ( stream,&header.m_60 );
-      read_and_decode_int ( stream,&header.m_64 );
-      read_and_decode_ushort ( stream,&header.m_68 );
-      read_and_decode_ushort ( stream,&header.m_6a );
-      read_and_decode_ushort ( stream,&header.m_6c );
-      read_and_decode_int ( stream,&header.m_nrelated_object_pointers );
-
-      read_and_decode_int ( stream,&header.m_72 );
-      read_and_decode_ushort ( stream,&header.m_76 );
-
-      read_and_decode_int ( stream,&header.m_78 );
-      read_and_decode_int ( stream,&header.m_7c );
+      read_cell_double ( stream,&header.lon_min );
+      read_cell_double ( stream,&header.lat_min );
+      read_cell_double ( stream,&header.lon_max );
+      read_cell_double ( stream,&header.lat_max );
+
+      read_cell_double ( stream,&header.easting_min );
+      read_cell_double ( stream,&header.northing_min );
+      read_cell_double ( stream,&header.easting_max );
+      read_cell_double ( stream,&header.northing_max );
+
+      read_cell_ushort ( stream,&header.usn_vector_records );
+      read_cell_int ( stream,&header.n_vector_record_points );
+      read_cell_int ( stream,&header.m_46 );
+      read_cell_int ( stream,&header.m_4a );
+      read_cell_ushort ( stream,&header.usn_point3d_records );
+      read_cell_int ( stream,&header.m_50 );
+      read_cell_int ( stream,&header.m_54 );
+      read_cell_ushort ( stream,&header.usn_point2d_records );
+      read_cell_ushort ( stream,&header.m_5a );
+      read_cell_ushort ( stream,&header.m_5c );
+      read_cell_ushort ( stream,&header.usn_feature_records );
+
+      read_cell_int ( stream,&header.m_60 );
+      read_cell_int ( stream,&header.m_64 );
+      read_cell_ushort ( stream,&header.m_68 );
+      read_cell_ushort ( stream,&header.m_6a );
+      read_cell_ushort ( stream,&header.m_6c );
+      read_cell_int ( stream,&header.m_nrelated_object_pointers );
+
+      read_cell_int ( stream,&header.m_72 );
+      read_cell_ushort ( stream,&header.m_76 );
+
+      read_cell_int ( stream,&header.m_78 );
+      read_cell_int ( stream,&header.m_7c );
 
 
       //    Calculate and record the cell coordinate transform coefficients
@@ -1409,7 +1370,7 @@ bool read_header_and_populate_cib ( FILE *stream, Cell_Info_Block *pCIB )
       return true;
 }
 
-bool read_vector_record_table ( FILE *stream, int count, Cell_Info_Block *pCIB )
+bool read_vector_record_table ( cm93_cell_buffer *stream, int count, Cell_Info_Block *pCIB )
 {
       bool brv;
 
@@ -1422,23 +1383,23 @@ bool read_vector_record_table ( FILE *stream, int count, Cell_Info_Block *pCIB )
             p->index = iedge;
 
             unsigned short npoints;
-            brv = ! ( read_and_decode_ushort ( stream, &npoints ) == 0 );
+            brv = ! ( read_cell_ushort ( stream, &npoints ) == 0 );
             if ( !brv )
                   return false;
 
             p->n_points = npoints;
             p->p_points = q;
 
-//           brv = read_and_decode_bytes(stream, q, p->n_points * sizeof(cm93_point));
+//           brv = read_cell_bytes(stream, q, p->n_points * sizeof(cm93_point));
 //            if(!brv)
 //                  return false;
 
             unsigned short x, y;
             for ( int index = 0 ; index <  p->n_points ; index++ )
             {
-                  if ( !read_and_decode_ushort ( stream, &x ) )
+                  if ( !read_cell_ushort ( stream, &x ) )
                         return false;
-                  if ( !read_and_decode_ushort ( stream, &y ) )
+                  if ( !read_cell_ushort ( stream, &y ) )
                         return false;
 
                   q[index].x = x;
@@ -1485,7 +1446,7 @@ bool read_vector_record_table ( FILE *stream, int count, Cell_Info_Block *pCIB )
 }
 
 
-bool read_3dpoint_table ( FILE *stream, int count, Cell_Info_Block *pCIB )
+bool read_3dpoint_table ( cm93_cell_buffer *stream, int count, Cell_Info_Block *pCIB )
 {
       geometry_descriptor *p = pCIB->point3d_descriptor_block;
       cm93_point_3d *q = pCIB->p3dpoint_array;
@@ -1493,7 +1454,7 @@ bool read_3dpoint_table ( FILE *stream, int count, Cell_Info_Block *pCIB )
       for ( int i = 0 ; i < count ; i++ )
       {
             unsigned short npoints;
-            if ( !read_and_decode_ushort ( stream, &npoints ) )
+            if ( !read_cell_ushort ( stream, &npoints ) )
                   return false;
 
             p->n_points = npoints;
@@ -1501,17 +1462,17 @@ bool read_3dpoint_table ( FILE *stream, int count, Cell_Info_Block *pCIB )
 
 //            unsigned short t = p->n_points;
 
-//            if(!read_and_decode_bytes(stream, q, t*6))
+//            if(!read_cell_bytes(stream, q, t*6))
 //                  return false;
 
             unsigned short x, y, z;
             for ( int index = 0 ; index < p->n_points ; index++ )
             {
-                  if ( !read_and_decode_ushort ( stream, &x ) )
+                  if ( !read_cell_ushort ( stream, &x ) )
                         return false;
-                  if ( !read_and_decode_ushort ( stream, &y ) )
+                  if ( !read_cell_ushort ( stream, &y ) )
                         return false;
-                  if ( !read_and_decode_ushort ( stream, &z ) )
+                  if ( !read_cell_ushort ( stream, &z ) )
                         return false;
 
                   q[index].x = x;
@@ -1528,17 +1489,17 @@ bool read_3dpoint_table ( FILE *stream, int count, Cell_Info_Block *pCIB )
 }
 
 
-bool read_2dpoint_table ( FILE *stream, int count, Cell_Info_Block *pCIB )
+bool read_2dpoint_table ( cm93_cell_buffer *stream, int count, Cell_Info_Block *pCIB )
 {
 
-//      int rv = read_and_decode_bytes(stream, pCIB->p2dpoint_array, count * 4);
+//      int rv = read_cell_bytes(stream, pCIB->p2dpoint_array, count * 4);
 
       unsigned short x, y;
       for ( int index = 0 ; index < count ; index++ )
       {
-            if ( !read_and_decode_ushort ( stream, &x ) )
+            if ( !read_cell_ushort ( stream, &x ) )
                   return false;
-            if ( !read_and_decode_ushort ( stream, &y ) )
+            if ( !read_cell_ushort ( stream, &y ) )
                   return false;
 
             pCIB->p2dpoint_array[index].x = x;
@@ -1550,7 +1511,7 @@ bool read_2dpoint_table ( FILE *stream, int count, Cell_Info_Block *pCIB )
 }
 
 
-bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *pCIB )
+bool read_feature_record_table ( cm93_cell_buffer *stream, int n_features, Cell_Info_Block *pCIB )
 {
       try
       {
@@ -1577,9 +1538,9 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
             {
 
                   // read the object definition
-                  read_and_decode_bytes ( stream, &object_type, 1 );           // read the object type
-                  read_and_decode_bytes ( stream, &geom_prim, 1 );             // read the object geometry primitive type
-                  read_and_decode_ushort ( stream, &obj_desc_bytes );          // read the object byte count
+                  read_cell_bytes ( stream, &object_type, 1 );           // read the object type
+                  read_cell_bytes ( stream, &geom_prim, 1 );             // read the object geometry primitive type
+                  read_cell_ushort ( stream, &obj_desc_bytes );          // read the object byte count
 
                   pobj->otype = object_type;
                   pobj->geotype = geom_prim;
@@ -1590,7 +1551,7 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
                         case 4:                                                     // AREA, 408c3d
                         {
 
-                              if ( !read_and_decode_ushort ( stream, &n_elements ) )
+                              if ( !read_cell_ushort ( stream, &n_elements ) )
                                     return false;
 
                               pobj->n_geom_elements = n_elements;
@@ -1601,7 +1562,7 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
 
                               for ( unsigned short i = 0 ; i < pobj->n_geom_elements ; i++ )
                               {
-                                    if ( !read_and_decode_ushort ( stream, &index ) )
+                                    if ( !read_cell_ushort ( stream, &index ) )
                                           return false;
 
                                     if ( ( index & 0x1fff ) > pCIB->m_nvector_records )
@@ -1623,7 +1584,7 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
                         case 2:                                         // LINE geometry
                         {
 
-                              if ( !read_and_decode_ushort ( stream, &n_elements ) )      // read geometry element count
+                              if ( !read_cell_ushort ( stream, &n_elements ) )      // read geometry element count
                                     return false;
 
                               pobj->n_geom_elements = n_elements;
@@ -1636,7 +1597,7 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
                               {
                                     unsigned short geometry_index;
 
-                                    if ( !read_and_decode_ushort ( stream, &geometry_index ) )
+                                    if ( !read_cell_ushort ( stream, &geometry_index ) )
                                           return false;
 
 
@@ -1659,7 +1620,7 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
 
                         case 1:
                         {
-                              if ( !read_and_decode_ushort ( stream, &index ) )
+                              if ( !read_cell_ushort ( stream, &index ) )
                                     return false;
 
                               obj_desc_bytes -= 2;
@@ -1673,7 +1634,7 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
 
                         case 8:
                         {
-                              if ( !read_and_decode_ushort ( stream, &index ) )
+                              if ( !read_cell_ushort ( stream, &index ) )
                                     return false;
                               obj_desc_bytes -= 2;
 
@@ -1691,7 +1652,7 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
                   if ( ( pobj->geotype & 0x10 ) == 0x10 )        // children/related
                   {
                         unsigned char nrelated;
-                        if ( !read_and_decode_bytes ( stream, &nrelated, 1 ) )
+                        if ( !read_cell_bytes ( stream, &nrelated, 1 ) )
                               return false;
 
                         pobj->n_related_objects = nrelated;
@@ -1704,7 +1665,7 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
                         Object **w = ( Object ** ) pobj->p_related_object_pointer_array;
                         for ( unsigned char j = 0 ; j < pobj->n_related_objects ; j++ )
                         {
-                              if ( !read_and_decode_ushort ( stream, &index ) )
+                              if ( !read_cell_ushort ( stream, &index ) )
                                     return false;
 
                               if ( index > pCIB->m_nfeature_records )
@@ -1726,7 +1687,7 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
 //                   *(int *)(0) = 0;                              // cause break error
 
                         unsigned short nrelated;
-                        if ( !read_and_decode_ushort ( stream, &nrelated ) )
+                        if ( !read_cell_ushort ( stream, &nrelated ) )
                               return false;
 
                         pobj->n_related_objects = ( unsigned char ) ( nrelated & 0xFF );
@@ -1744,7 +1705,7 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
 //                      _asm int 3;                               // just after loc_408DE2
 
                         unsigned char nattr;
-                        if ( !read_and_decode_bytes ( stream, &nattr, 1 ) )
+                        if ( !read_cell_bytes ( stream, &nattr, 1 ) )
                               return false;        //m_od
 
                         pobj->n_attributes = nattr;
@@ -1756,7 +1717,7 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
                         puc10count += obj_desc_bytes;
 
 
-                        if ( !read_and_decode_bytes ( stream, pobj->attributes_block, obj_desc_bytes ) )
+                        if ( !read_cell_bytes ( stream, pobj->attributes_block, obj_desc_bytes ) )
                               return false;           // the attributes....
 
                         if ( ( pobj->geotype & 0x0f ) == 1 )
@@ -1792,90 +1753,80 @@ bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *
 
 bool Ingest_CM93_Cell ( const char * cell_file_name, Cell_Info_Block *pCIB )
 {
+      unsigned char *cell_data = NULL;
 
       try
       {
 
             int file_length;
 
-            //    Get the file length
-            FILE *flstream = fopen ( cell_file_name, "rb" );
-            if ( !flstream )
-                  return false;
-
-            fseek ( flstream, 0, SEEK_END );
-            file_length = ftell ( flstream );
-            fclose ( flstream );
-
-            //    Open the file
+            //    Open the file, and get its length
             FILE *stream = fopen ( cell_file_name, "rb" );
             if ( !stream )
                   return false;
 
-            //    Validate the integrity of the cell file
-
-            unsigned short word0 = 0;;
-            int int0 = 0;
-            int int1 = 0;;
-
-            read_and_decode_ushort ( stream, &word0 );     // length of prolog + header (10 + 128)
-            read_and_decode_int ( stream, &int0 );         // length of table 1
-            read_and_decode_int ( stream, &int1 );         // length of table 2
+            fseek ( stream, 0, SEEK_END );
+            file_length = ftell ( stream );
+            fseek ( stream, 0, SEEK_SET );
 
-            int test = word0 + int0 + int1;
-            if ( test != file_length )
+            if ( file_length < 10 )
             {
                   fclose ( stream );
-                  return false;                           // file is corrupt
+                  return false;
             }
 
-            //    Cell is OK, proceed to ingest
-
-
-            if ( !read_header_and_populate_cib ( stream, pCIB ) )
+            //    Read the whole cell with one read, and decode it in one pass
+            cell_data = ( unsigned char * ) malloc ( file_length );
+            if ( !cell_data )
             {
                   fclose ( stream );
                   return false;
             }
 
+            size_t nread = fread ( cell_data, 1, file_length, stream );
+            fclose ( stream );
 
-            if ( !read_vector_record_table ( stream, pCIB->m_nvector_records, pCIB ) )
+            if ( nread != ( size_t ) file_length )
             {
-                  fclose ( stream );
+                  free ( cell_data );
                   return false;
             }
 
-            if ( !read_3dpoint_table ( stream, pCIB->m_n_point3d_records, pCIB ) )
-            {
-                  fclose ( stream );
-                  return false;
-            }
+            decode_bytes ( cell_data, file_length );
 
-            if ( !read_2dpoint_table ( stream, pCIB->m_n_point2d_records, pCIB ) )
-            {
-                  fclose ( stream );
-                  return false;
-            }
+            cm93_cell_buffer cell;
+            cell.p = cell_data;
+            cell.end = cell_data + file_length;
 
-            if ( !read_feature_record_table ( stream, pCIB->m_nfeature_records, pCIB ) )
-            {
-                  fclose ( stream );
-                  return false;
-            }
+            //    Validate the integrity of the cell file
 
-//      int file_end = ftell(stream);
+            unsigned short word0 = 0;;
+            int int0 = 0;
+            int int1 = 0;;
 
-//      wxASSERT(file_end == file_length);
+            read_cell_ushort ( &cell, &word0 );     // length of prolog + header (10 + 128)
+            read_cell_int ( &cell, &int0 );         // length of table 1
+            read_cell_int ( &cell, &int1 );         // length of table 2
 
-            fclose ( stream );
+            int test = word0 + int0 + int1;
+
+            //    Cell is OK, proceed to ingest
+            bool bret = ( test == file_length )
+                        && read_header_and_populate_cib ( &cell, pCIB )
+                        && read_vector_record_table ( &cell, pCIB->m_nvector_records, pCIB )
+                        && read_3dpoint_table ( &cell, pCIB->m_n_point3d_records, pCIB )
+                        && read_2dpoint_table ( &cell, pCIB->m_n_point2d_records, pCIB )
+                        && read_feature_record_table ( &cell, pCIB->m_nfeature_records, pCIB );
 
+            free ( cell_data );
+            cell_data = NULL;
 
-            return true;
+            return bret;
       }
 
       catch ( ... )
       {
-//      int yyp = 5;
+            free ( cell_data );
             return false;
       }
 
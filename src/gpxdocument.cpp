@@ -713,3 +713,491 @@ GpxSimpleElement::GpxSimpleElement(const wxString &element_name, const wxString
       TiXmlText * value = new TiXmlText(element_value.ToUTF8());
       LinkEndChild(value);
 }
+
+//---------------------------------------------------------------------------------
+//    GpxStreamReader Implementation
+//---------------------------------------------------------------------------------
+enum
+{
+      GPX_TOKEN_EOF = 0,
+      GPX_TOKEN_ERROR,
+      GPX_TOKEN_TEXT,
+      GPX_TOKEN_OTHER,                    // comment, processing instruction, CDATA or DOCTYPE
+      GPX_TOKEN_START,
+      GPX_TOKEN_EMPTY,                    // <name/>
+      GPX_TOKEN_END
+};
+
+GpxStreamReader::GpxStreamReader()
+{
+      m_fp = NULL;
+      m_buf = NULL;
+      m_buf_len = 0;
+      m_buf_pos = 0;
+      m_frag = NULL;
+      m_frag_len = 0;
+      m_frag_size = 0;
+      m_bCapture = true;
+      m_utf8_pending = 0;
+      m_depth = 0;
+      m_bChildPending = false;
+      m_bChildEmpty = false;
+      m_bEnteredEmpty = false;
+      m_bError = false;
+}
+
+GpxStreamReader::~GpxStreamReader()
+{
+      Close();
+}
+
+bool GpxStreamReader::Open(const wxString &filename)
+{
+      Close();
+
+      m_fp = fopen((const char*)filename.mb_str(), "rb");
+      if (!m_fp)
+      {
+            m_bError = true;
+            return false;
+      }
+
+      m_buf = (char *)malloc(GPX_STREAM_BUFFER_SIZE);
+      m_bError = false;
+      return true;
+}
+
+void GpxStreamReader::Close(void)
+{
+      if (m_fp)
+            fclose(m_fp);
+      m_fp = NULL;
+
+      free(m_buf);
+      m_buf = NULL;
+      free(m_frag);
+      m_frag = NULL;
+
+      m_buf_len = 0;
+      m_buf_pos = 0;
+      m_frag_len = 0;
+      m_frag_size = 0;
+      m_utf8_pending = 0;
+      m_depth = 0;
+      m_bChildPending = false;
+      m_bChildEmpty = false;
+      m_bEnteredEmpty = false;
+      m_doc.Clear();
+}
+
+void GpxStreamReader::AppendFrag(char c)
+{
+      if (m_frag_len == m_frag_size)
+      {
+            m_frag_size = wxMax(4096, m_frag_size * 2);
+            m_frag = (char *)realloc(m_frag, m_frag_size);
+      }
+      m_frag[m_frag_len++] = c;
+}
+
+int GpxStreamReader::PeekChar(void)
+{
+      if (m_buf_pos == m_buf_len)
+      {
+            m_buf_pos = 0;
+            m_buf_len = fread(m_buf, 1, GPX_STREAM_BUFFER_SIZE, m_fp);
+            if (m_buf_len <= 0)
+            {
+                  m_buf_len = 0;
+                  return EOF;
+            }
+      }
+      return (unsigned char)m_buf[m_buf_pos];
+}
+
+int GpxStreamReader::GetChar(void)
+{
+      int c = PeekChar();
+      if (c == EOF)
+            return EOF;
+      m_buf_pos++;
+
+      //    Only UTF-8 goes to TinyXML from here, anything else is left to GpxDocument::LoadFile()
+      if (m_utf8_pending)
+      {
+            if ((c & 0xC0) == 0x80)
+                  m_utf8_pending--;
+            else
+                  m_bError = true;
+      }
+      else if (c >= 0x80)
+      {
+            if ((c & 0xE0) == 0xC0)
+                  m_utf8_pending = 1;
+            else if ((c & 0xF0) == 0xE0)
+                  m_utf8_pending = 2;
+            else if ((c & 0xF8) == 0xF0)
+                  m_utf8_pending = 3;
+            else
+                  m_bError = true;
+      }
+      else if (c == 0)
+            m_bError = true;
+
+      if (m_bCapture)
+            AppendFrag((char)c);
+
+      return c;
+}
+
+bool GpxStreamReader::SkipPast(const char *terminator)
+{
+      int len = strlen(terminator);
+      char tail[8];
+      memset(tail, 0, sizeof(tail));
+
+      int c;
+      while ((c = GetChar()) != EOF)
+      {
+            memmove(tail, tail + 1, len - 1);
+            tail[len - 1] = (char)c;
+            if (!memcmp(tail, terminator, len))
+                  return true;
+      }
+      return false;
+}
+
+int GpxStreamReader::ReadToken(void)
+{
+      int c = GetChar();
+      if (c == EOF)
+            return GPX_TOKEN_EOF;
+
+      if (c != '<')
+      {
+            while (((c = PeekChar()) != EOF) && (c != '<'))
+                  GetChar();
+            return GPX_TOKEN_TEXT;
+      }
+
+      c = GetChar();
+      if (c == '?')
+            return SkipPast("?>") ? GPX_TOKEN_OTHER : GPX_TOKEN_ERROR;
+
+      if (c == '!')
+      {
+            if (PeekChar() == '-')
+                  return SkipPast("-->") ? GPX_TOKEN_OTHER : GPX_TOKEN_ERROR;
+            if (PeekChar() == '[')
+                  return SkipPast("]]>") ? GPX_TOKEN_OTHER : GPX_TOKEN_ERROR;
+
+            //    DOCTYPE, perhaps with an internal subset
+            int nest = 0;
+            while ((c = GetChar()) != EOF)
+            {
+                  if (c == '[')
+                        nest++;
+                  else if (c == ']')
+                        nest--;
+                  else if ((c == '>') && (nest <= 0))
+                        return GPX_TOKEN_OTHER;
+            }
+            return GPX_TOKEN_ERROR;
+      }
+
+      if (c == '/')
+      {
+            while (((c = GetChar()) != EOF) && (c != '>'))
+                  ;
+            return (c == '>') ? GPX_TOKEN_END : GPX_TOKEN_ERROR;
+      }
+
+      if ((c == EOF) || isspace(c) || (c == '>'))
+            return GPX_TOKEN_ERROR;
+
+      //    Start tag, the name and then the attributes
+      char name[256];
+      int n = 0;
+      name[n++] = (char)c;
+      while (((c = PeekChar()) != EOF) && !isspace(c) && (c != '/') && (c != '>'))
+      {
+            GetChar();
+            if (n < 255)
+                  name[n++] = (char)c;
+      }
+      name[n] = 0;
+      m_tag_name = wxString::FromUTF8(name);
+
+      int last = 0;
+      while ((c = GetChar()) != EOF)
+      {
+            if ((c == '"') || (c == '\''))
+            {
+                  int quote = c;
+                  while (((c = GetChar()) != EOF) && (c != quote))
+                        ;
+                  if (c == EOF)
+                        return GPX_TOKEN_ERROR;
+                  last = quote;
+            }
+            else if (c == '>')
+                  return (last == '/') ? GPX_TOKEN_EMPTY : GPX_TOKEN_START;
+            else if (!isspace(c))
+                  last = c;
+      }
+      return GPX_TOKEN_ERROR;
+}
+
+TiXmlElement *GpxStreamReader::ParseFrag(void)
+{
+      AppendFrag(0);
+
+      m_doc.Clear();
+      m_doc.Parse(m_frag, 0, TIXML_ENCODING_UTF8);
+      if (m_doc.Error())
+      {
+            m_bError = true;
+            return NULL;
+      }
+      return m_doc.RootElement();
+}
+
+bool GpxStreamReader::NextChild(wxString &name)
+{
+      if (m_bEnteredEmpty)
+      {
+            m_bEnteredEmpty = false;
+            return false;
+      }
+
+      if (m_bChildPending)
+            SkipChild();
+
+      while (m_fp && !m_bError)
+      {
+            m_frag_len = 0;
+            m_bCapture = true;
+
+            int token = ReadToken();
+            switch (token)
+            {
+                  case GPX_TOKEN_START:
+                  case GPX_TOKEN_EMPTY:
+                        m_bChildPending = true;
+                        m_bChildEmpty = (token == GPX_TOKEN_EMPTY);
+                        name = m_tag_name;
+                        return true;
+
+                  case GPX_TOKEN_END:
+                        if (m_depth)
+                              m_depth--;
+                        else
+                              m_bError = true;
+                        return false;
+
+                  case GPX_TOKEN_EOF:
+                        if (m_depth || m_utf8_pending)
+                              m_bError = true;
+                        return false;
+
+                  case GPX_TOKEN_ERROR:
+                        m_bError = true;
+                        return false;
+
+                  case GPX_TOKEN_OTHER:
+                        //    Only a UTF-8 declaration is accepted
+                        if (!m_depth && (m_frag_len > 5) && !strncmp(m_frag, "<?xml", 5))
+                        {
+                              AppendFrag(0);
+                              wxString decl = wxString::FromUTF8(m_frag).Lower();
+                              decl.Replace(_T("'"), _T("\""));
+                              int ienc = decl.Find(_T("encoding=\""));
+                              if ((ienc != wxNOT_FOUND) && !decl.Mid(ienc + 10).StartsWith(_T("utf-8\"")) &&
+                                   !decl.Mid(ienc + 10).StartsWith(_T("utf8\"")))
+                                    m_bError = true;
+                        }
+                        break;
+
+                  default:
+                        break;
+            }
+      }
+      return false;
+}
+
+TiXmlElement *GpxStreamReader::ReadChild(void)
+{
+      if (!m_bChildPending)
+            return NULL;
+      m_bChildPending = false;
+
+      //    The start tag is already in the fragment, add everything up to the matching end tag
+      int level = m_bChildEmpty ? 0 : 1;
+      while (level && !m_bError)
+      {
+            switch (ReadToken())
+            {
+                  case GPX_TOKEN_START:
+                        level++;
+                        break;
+                  case GPX_TOKEN_END:
+                        level--;
+                        break;
+                  case GPX_TOKEN_EOF:
+                  case GPX_TOKEN_ERROR:
+                        m_bError = true;
+                        break;
+                  default:
+                        break;
+            }
+      }
+
+      if (m_bError)
+            return NULL;
+
+      return ParseFrag();
+}
+
+TiXmlElement *GpxStreamReader::EnterChild(void)
+{
+      if (!m_bChildPending)
+            return NULL;
+      m_bChildPending = false;
+
+      if (m_bChildEmpty)
+            m_bEnteredEmpty = true;
+      else
+      {
+            //    Parse the start tag alone, as an empty element
+            m_frag_len--;
+            AppendFrag('/');
+            AppendFrag('>');
+            m_depth++;
+      }
+
+      return ParseFrag();
+}
+
+void GpxStreamReader::SkipChild(void)
+{
+      if (!m_bChildPending)
+            return;
+      m_bChildPending = false;
+
+      m_bCapture = false;
+      int level = m_bChildEmpty ? 0 : 1;
+      while (level && !m_bError)
+      {
+            switch (ReadToken())
+            {
+                  case GPX_TOKEN_START:
+                        level++;
+                        break;
+                  case GPX_TOKEN_END:
+                        level--;
+                        break;
+                  case GPX_TOKEN_EOF:
+                  case GPX_TOKEN_ERROR:
+                        m_bError = true;
+                        break;
+                  default:
+                        break;
+            }
+      }
+      m_bCapture = true;
+}
+
+//---------------------------------------------------------------------------------
+//    GpxStreamWriter Implementation
+//---------------------------------------------------------------------------------
+GpxStreamWriter::GpxStreamWriter()
+{
+      m_fp = NULL;
+      m_depth = 0;
+}
+
+GpxStreamWriter::~GpxStreamWriter()
+{
+      if (m_fp)
+            fclose(m_fp);
+}
+
+bool GpxStreamWriter::Open(const wxString &filename)
+{
+      m_fp = fopen((const char*)filename.mb_str(), "w");
+      if (!m_fp)
+            return false;
+
+      //    The declaration and <gpx> root of an empty document, root left open
+      GpxDocument doc;
+      doc.FirstChild()->Print(m_fp, 0);
+      fprintf(m_fp, "\n");
+      BeginElement(doc.RootElement());
+
+      return true;
+}
+
+bool GpxStreamWriter::Close(void)
+{
+      if (!m_fp)
+            return false;
+
+      while (m_depth)
+            EndElement();
+      fprintf(m_fp, "\n");
+
+      bool result = (ferror(m_fp) == 0);
+      if (fclose(m_fp))
+            result = false;
+      m_fp = NULL;
+
+      return result;
+}
+
+void GpxStreamWriter::Indent(int depth)
+{
+      for (int i = 0; i < depth; i++)
+            fprintf(m_fp, "    ");
+}
+
+void GpxStreamWriter::WriteElement(TiXmlNode *node)
+{
+      //    As TiXmlElement::Print() lays out the children of an element
+      if (!node->ToText())
+            fprintf(m_fp, "\n");
+      node->Print(m_fp, m_depth);
+}
+
+void GpxStreamWriter::BeginElement(TiXmlElement *element)
+{
+      if (m_depth)
+            fprintf(m_fp, "\n");
+      Indent(m_depth);
+
+      fprintf(m_fp, "<%s", element->Value());
+      for (const TiXmlAttribute *attrib = element->FirstAttribute(); attrib; attrib = attrib->Next())
+      {
+            fprintf(m_fp, " ");
+            attrib->Print(m_fp, m_depth);
+      }
+      fprintf(m_fp, ">");
+
+      m_open_names.Add(wxString::FromUTF8(element->Value()));
+      m_depth++;
+
+      //    Children already linked to the element are written now
+      for (TiXmlNode *node = element->FirstChild(); node; node = node->NextSibling())
+            WriteElement(node);
+}
+
+void GpxStreamWriter::EndElement(void)
+{
+      if (!m_depth)
+            return;
+      m_depth--;
+
+      fprintf(m_fp, "\n");
+      Indent(m_depth);
+      fprintf(m_fp, "</%s>", (const char*)m_open_names.Last().ToUTF8());
+      m_open_names.RemoveAt(m_open_names.GetCount() - 1);
+}
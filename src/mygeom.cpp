@@ -35,6 +35,7 @@
 
 #include "wx/tokenzr.h"
 #include <wx/mstream.h>
+#include <wx/thread.h>
 
 #include "dychart.h"
 
@@ -168,6 +169,10 @@ static int            tess_orient;
 static wxMemoryOutputStream *ostream1;
 static wxMemoryOutputStream *ostream2;
 
+//    The tesselators and the record writers share the statics above, and S57 charts
+//    may be loaded on a worker thread, so each use of them holds this lock
+static wxMutex        s_TessMutex(wxMUTEX_RECURSIVE);
+
 
 
 //  For __WXMSW__ builds using GLU_TESS and glu32.dll
@@ -285,6 +290,26 @@ PolyTessGeo::PolyTessGeo(Extended_Geometry *pxGeom)
 
 }
 
+//      Build PolyTessGeo Object around a PolyTriGroup read from a binary SENC
+PolyTessGeo::PolyTessGeo(PolyTriGroup *ppg, double x_min, double y_min, double x_max, double y_max,
+                         int n_wkb, int nvertex_max)
+{
+      ErrorCode = 0;
+      m_pxgeom = NULL;
+
+      xmin = x_min;
+      ymin = y_min;
+      xmax = x_max;
+      ymax = y_max;
+
+      m_ppg_head = ppg;
+      m_nvertex_max = nvertex_max;
+      ncnt = ppg->nContours;
+      nwkb = n_wkb;
+
+      m_bOK = true;
+}
+
 //      Build PolyTessGeo Object from OGR Polygon
 PolyTessGeo::PolyTessGeo(OGRPolygon *poly, bool bSENC_SM, double ref_lat, double ref_lon, bool bUseInternalTess)
 {
@@ -295,6 +320,8 @@ PolyTessGeo::PolyTessGeo(OGRPolygon *poly, bool bSENC_SM, double ref_lat, double
     m_ref_lat = ref_lat;
     m_ref_lon = ref_lon;
 
+    wxMutexLocker lock(s_TessMutex);
+
     if(bUseInternalTess)
         ErrorCode = PolyTessGeoTri(poly, bSENC_SM, ref_lat, ref_lon);
     else
@@ -337,6 +364,8 @@ PolyTessGeo::PolyTessGeo(unsigned char *polybuf, int nrecl, int index)
     my_bufgets( hdr_buf, POLY_LINE_HDR_MAX );
     sscanf(hdr_buf, "Contours/nWKB %d %d", &nctr, &twkb_len);
     ppg->nContours = nctr;
+    ncnt = nctr;
+    nwkb = twkb_len;
     ppg->pn_vertex = (int *)malloc(nctr * sizeof(int));
     int *pctr = ppg->pn_vertex;
 
@@ -837,6 +866,8 @@ int PolyTessGeo::PolyTessGeoTri(OGRPolygon *poly, bool bSENC_SM, double ref_lat,
 
 int PolyTessGeo::Write_PolyTriGroup( FILE *ofs)
 {
+    wxMutexLocker lock(s_TessMutex);
+
     wxString    sout;
     wxString    sout1;
     wxString    stemp;
@@ -936,6 +967,8 @@ int PolyTessGeo::Write_PolyTriGroup( FILE *ofs)
 
 int PolyTessGeo::Write_PolyTriGroup( wxOutputStream &out_stream)
 {
+      wxMutexLocker lock(s_TessMutex);
+
       wxString    sout;
       wxString    sout1;
       wxString    stemp;
@@ -1081,6 +1114,7 @@ PolyTessGeo::~PolyTessGeo()
     delete  m_pxgeom;
 
 #ifdef USE_GLU_TESS
+    wxMutexLocker lock(s_TessMutex);
     if(s_pwork_buf)
         free( s_pwork_buf );
     s_pwork_buf = NULL;
@@ -1496,6 +1530,8 @@ int PolyTessGeo::BuildTessGL(void)
       wxString    sout1;
       wxString    stemp;
 
+      wxMutexLocker lock(s_TessMutex);
+
 
 #ifdef __WXMSW__
 //  If using the OpenGL dlls provided with Windows,
@@ -2208,19 +2244,27 @@ PolyTriGroup::PolyTriGroup()
     pgroup_geom = NULL;           // pointer to Raw geometry, used for contour line drawing
     tri_prim_head = NULL;         // head of linked list of TriPrims
     m_bSMSENC = false;
+    m_bMapped = false;
 
 }
 
 PolyTriGroup::~PolyTriGroup()
 {
-    free(pn_vertex);
-    free(pgroup_geom);
+    //  Mapped arrays belong to the binary SENC mapping
+    if(!m_bMapped)
+    {
+        free(pn_vertex);
+        free(pgroup_geom);
+    }
+
     //Walk the list of TriPrims, deleting as we go
     TriPrim *tp_next;
     TriPrim *tp = tri_prim_head;
     while(tp)
     {
         tp_next = tp->p_next;
+        if(m_bMapped)
+            tp->p_vertex = NULL;
         delete tp;
         tp = tp_next;
     }
@@ -109,6 +109,7 @@ extern wxString         g_SData_Locn;
 extern wxString         *pInit_Chart_Dir;
 extern WayPointman      *pWayPointMan;
 extern Routeman         *g_pRouteMan;
+extern Track            *g_pActiveTrack;
 extern ComPortManager   *g_pCommMan;
 extern RouteProp        *pRoutePropDialog;
 
@@ -201,6 +202,8 @@ extern int              gps_watchdog_timeout_ticks;
 
 extern int              g_nCacheLimit;
 extern int              g_memCacheLimit;
+extern int              g_nRasterTileCacheLimit;
+extern bool             g_bPrefetchCharts;
 
 extern bool             g_bGDAL_Debug;
 extern bool             g_bDebugCM93;
@@ -322,6 +325,8 @@ WX_DEFINE_LIST ( LayerList );
 
 SelectItem::SelectItem()
 {
+      m_seq = 0;
+      m_pListNode = NULL;
 }
 
 SelectItem::~SelectItem()
@@ -339,6 +344,281 @@ void  SelectItem::SetUserData ( int data )
       m_Data4 = data;
 }
 
+//-----------------------------------------------------------------------------
+//          Select Type Index
+//-----------------------------------------------------------------------------
+
+#define SELECT_GRID_WIDTH     (360 * SELECT_GRID_CELLS_PER_DEG)
+#define SELECT_GRID_HEIGHT    (180 * SELECT_GRID_CELLS_PER_DEG)
+
+static bool IsSelectSegmentType ( int seltype )
+{
+      return ( ( seltype == SELTYPE_ROUTESEGMENT ) || ( seltype == SELTYPE_TRACKSEGMENT ) );
+}
+
+//    Unwrapped cell column, callers wrap when forming the key
+static int SelectCellX ( double lon )
+{
+      return ( int ) floor ( ( lon + 180. ) * SELECT_GRID_CELLS_PER_DEG );
+}
+
+static int SelectCellY ( double lat )
+{
+      int iy = ( int ) floor ( ( lat + 90. ) * SELECT_GRID_CELLS_PER_DEG );
+      if ( iy < 0 )
+            iy = 0;
+      if ( iy > SELECT_GRID_HEIGHT - 1 )
+            iy = SELECT_GRID_HEIGHT - 1;
+      return iy;
+}
+
+static int SelectCellKey ( int ix, int iy )
+{
+      ix %= SELECT_GRID_WIDTH;
+      if ( ix < 0 )
+            ix += SELECT_GRID_WIDTH;
+      return ( iy * SELECT_GRID_WIDTH ) + ix;
+}
+
+SelectTypeIndex::SelectTypeIndex()
+{
+      m_nitems = 0;
+}
+
+SelectTypeIndex::~SelectTypeIndex()
+{
+      Clear();
+}
+
+//    Cell range covered by an item.
+//    Segments are entered by their lat/lon bounding box, which is what the coarse
+//    test in IsSegmentSelected() admits.  Segments spanning the IDL, or with too
+//    large a footprint, return false and are kept on the oversize list.
+bool SelectTypeIndex::GetItemCells ( SelectItem *pItem, int *ix0, int *iy0, int *ix1, int *iy1 )
+{
+      if ( IsSelectSegmentType ( pItem->m_seltype ) )
+      {
+            if ( fabs ( pItem->m_slon2 - pItem->m_slon ) > 180. )
+                  return false;
+
+            *ix0 = SelectCellX ( fmin ( pItem->m_slon, pItem->m_slon2 ) );
+            *ix1 = SelectCellX ( fmax ( pItem->m_slon, pItem->m_slon2 ) );
+            *iy0 = SelectCellY ( fmin ( pItem->m_slat, pItem->m_slat2 ) );
+            *iy1 = SelectCellY ( fmax ( pItem->m_slat, pItem->m_slat2 ) );
+
+            if ( ( *ix1 - *ix0 + 1 ) * ( *iy1 - *iy0 + 1 ) > SELECT_GRID_MAX_SEG_CELLS )
+                  return false;
+      }
+      else
+      {
+            *ix0 = *ix1 = SelectCellX ( pItem->m_slon );
+            *iy0 = *iy1 = SelectCellY ( pItem->m_slat );
+      }
+
+      return true;
+}
+
+void SelectTypeIndex::AddToMap ( SelectOwnerHash &map, void *key, SelectItem *pItem )
+{
+      SelectOwnerHash::iterator it = map.find ( key );
+      wxArrayPtrVoid *pa;
+      if ( it == map.end() )
+      {
+            pa = new wxArrayPtrVoid;
+            map[key] = pa;
+      }
+      else
+            pa = it->second;
+
+      pa->Add ( pItem );
+}
+
+void SelectTypeIndex::RemoveFromMap ( SelectOwnerHash &map, void *key, SelectItem *pItem )
+{
+      SelectOwnerHash::iterator it = map.find ( key );
+      if ( it == map.end() )
+            return;
+
+      wxArrayPtrVoid *pa = it->second;
+      int i = pa->Index ( pItem, true );          // bulk deletes run newest first
+      if ( i != wxNOT_FOUND )
+            pa->RemoveAt ( i );
+
+      if ( pa->IsEmpty() )
+      {
+            delete pa;
+            map.erase ( it );
+      }
+}
+
+void SelectTypeIndex::ClearMap ( SelectOwnerHash &map )
+{
+      SelectOwnerHash::iterator it;
+      for ( it = map.begin(); it != map.end(); ++it )
+            delete it->second;
+      map.clear();
+}
+
+void SelectTypeIndex::Add ( SelectItem *pItem )
+{
+      int ix0, iy0, ix1, iy1;
+
+      if ( GetItemCells ( pItem, &ix0, &iy0, &ix1, &iy1 ) )
+      {
+            for ( int iy = iy0 ; iy <= iy1 ; iy++ )
+            {
+                  for ( int ix = ix0 ; ix <= ix1 ; ix++ )
+                  {
+                        int key = SelectCellKey ( ix, iy );
+                        SelectCellHash::iterator it = m_cells.find ( key );
+                        wxArrayPtrVoid *pa;
+                        if ( it == m_cells.end() )
+                        {
+                              pa = new wxArrayPtrVoid;
+                              m_cells[key] = pa;
+                        }
+                        else
+                              pa = it->second;
+
+                        pa->Add ( pItem );
+                  }
+            }
+      }
+      else
+            m_oversize.Add ( pItem );
+
+      if ( IsSelectSegmentType ( pItem->m_seltype ) )
+      {
+            AddToMap ( m_owners, pItem->m_pData3, pItem );
+            if ( pItem->m_pData1 )
+                  AddToMap ( m_endpoints, pItem->m_pData1, pItem );
+            if ( pItem->m_pData2 && ( pItem->m_pData2 != pItem->m_pData1 ) )
+                  AddToMap ( m_endpoints, pItem->m_pData2, pItem );
+      }
+      else
+            AddToMap ( m_owners, pItem->m_pData1, pItem );
+
+      m_nitems++;
+}
+
+//    The item's coordinates must be unchanged since it was added
+void SelectTypeIndex::Remove ( SelectItem *pItem )
+{
+      int ix0, iy0, ix1, iy1;
+
+      if ( GetItemCells ( pItem, &ix0, &iy0, &ix1, &iy1 ) )
+      {
+            for ( int iy = iy0 ; iy <= iy1 ; iy++ )
+            {
+                  for ( int ix = ix0 ; ix <= ix1 ; ix++ )
+                  {
+                        SelectCellHash::iterator it = m_cells.find ( SelectCellKey ( ix, iy ) );
+                        if ( it == m_cells.end() )
+                              continue;
+
+                        wxArrayPtrVoid *pa = it->second;
+                        int i = pa->Index ( pItem, true );
+                        if ( i != wxNOT_FOUND )
+                              pa->RemoveAt ( i );
+
+                        if ( pa->IsEmpty() )
+                        {
+                              delete pa;
+                              m_cells.erase ( it );
+                        }
+                  }
+            }
+      }
+      else
+      {
+            int i = m_oversize.Index ( pItem, true );
+            if ( i != wxNOT_FOUND )
+                  m_oversize.RemoveAt ( i );
+      }
+
+      if ( IsSelectSegmentType ( pItem->m_seltype ) )
+      {
+            RemoveFromMap ( m_owners, pItem->m_pData3, pItem );
+            if ( pItem->m_pData1 )
+                  RemoveFromMap ( m_endpoints, pItem->m_pData1, pItem );
+            if ( pItem->m_pData2 && ( pItem->m_pData2 != pItem->m_pData1 ) )
+                  RemoveFromMap ( m_endpoints, pItem->m_pData2, pItem );
+      }
+      else
+            RemoveFromMap ( m_owners, pItem->m_pData1, pItem );
+
+      m_nitems--;
+}
+
+void SelectTypeIndex::Clear ( void )
+{
+      SelectCellHash::iterator it;
+      for ( it = m_cells.begin(); it != m_cells.end(); ++it )
+            delete it->second;
+      m_cells.clear();
+
+      m_oversize.Clear();
+      ClearMap ( m_owners );
+      ClearMap ( m_endpoints );
+
+      m_nitems = 0;
+}
+
+wxArrayPtrVoid *SelectTypeIndex::GetOwnerItems ( void *pOwner )
+{
+      SelectOwnerHash::iterator it = m_owners.find ( pOwner );
+      if ( it == m_owners.end() )
+            return NULL;
+      return it->second;
+}
+
+wxArrayPtrVoid *SelectTypeIndex::GetEndpointItems ( void *pPoint )
+{
+      SelectOwnerHash::iterator it = m_endpoints.find ( pPoint );
+      if ( it == m_endpoints.end() )
+            return NULL;
+      return it->second;
+}
+
+//    Collect the items which may lie within SelectRadius of the given point.
+//    Candidates may repeat, and still need the exact hit test.
+bool SelectTypeIndex::Query ( float slat, float slon, float SelectRadius, wxArrayPtrVoid &candidates )
+{
+      if ( 0 == m_nitems )
+            return true;
+
+      double r = SelectRadius + 1e-5;           // allow for float rounding at the cell edges
+      int ix0 = SelectCellX ( slon - r );
+      int ix1 = SelectCellX ( slon + r );
+      int iy0 = SelectCellY ( slat - r );
+      int iy1 = SelectCellY ( slat + r );
+
+      double ncells = ( double ) ( ix1 - ix0 + 1 ) * ( double ) ( iy1 - iy0 + 1 );
+
+      //    A window larger than the population is cheaper to answer by walking every item
+      if ( ( ( ix1 - ix0 + 1 ) >= SELECT_GRID_WIDTH ) || ( ncells > m_nitems ) )
+      {
+            SelectOwnerHash::iterator it;
+            for ( it = m_owners.begin(); it != m_owners.end(); ++it )
+                  WX_APPEND_ARRAY ( candidates, *(it->second) );
+            return true;
+      }
+
+      for ( int iy = iy0 ; iy <= iy1 ; iy++ )
+      {
+            for ( int ix = ix0 ; ix <= ix1 ; ix++ )
+            {
+                  SelectCellHash::iterator it = m_cells.find ( SelectCellKey ( ix, iy ) );
+                  if ( it != m_cells.end() )
+                        WX_APPEND_ARRAY ( candidates, *(it->second) );
+            }
+      }
+
+      WX_APPEND_ARRAY ( candidates, m_oversize );
+
+      return true;
+}
+
 //-----------------------------------------------------------------------------
 //          Select
 //-----------------------------------------------------------------------------
@@ -346,6 +626,8 @@ void  SelectItem::SetUserData ( int data )
 Select::Select()
 {
       pSelectList = new SelectableItemList;
+      m_seq_front = 0;
+      m_seq_back = 0;
 }
 
 Select::~Select()
@@ -357,6 +639,96 @@ Select::~Select()
 
 }
 
+SelectTypeIndex *Select::GetTypeIndex ( int seltype )
+{
+      for ( int i = 0 ; i < SELECT_NUM_TYPES ; i++ )
+      {
+            if ( seltype == ( 1 << i ) )
+                  return &m_TypeIndex[i];
+      }
+      return NULL;
+}
+
+//    Place a new item at the head (bAppend false) or tail of the select list,
+//    and enter it in the index for its type
+void Select::LinkItem ( SelectItem *pItem, bool bAppend )
+{
+      if ( bAppend )
+      {
+            pItem->m_pListNode = pSelectList->Append ( pItem );
+            pItem->m_seq = m_seq_back++;
+      }
+      else
+      {
+            pItem->m_pListNode = pSelectList->Insert ( pItem );
+            pItem->m_seq = --m_seq_front;
+      }
+
+      SelectTypeIndex *pidx = GetTypeIndex ( pItem->m_seltype );
+      if ( pidx )
+            pidx->Add ( pItem );
+}
+
+//    Take an item off the list and out of the index, the caller deletes it
+void Select::UnlinkItem ( SelectItem *pItem )
+{
+      SelectTypeIndex *pidx = GetTypeIndex ( pItem->m_seltype );
+      if ( pidx )
+            pidx->Remove ( pItem );
+
+      pSelectList->DeleteNode ( pItem->m_pListNode );
+      pItem->m_pListNode = NULL;
+}
+
+void Select::ModifySelectItem ( SelectItem *pItem, float slat, float slon )
+{
+      SelectTypeIndex *pidx = GetTypeIndex ( pItem->m_seltype );
+      if ( pidx )
+            pidx->Remove ( pItem );
+
+      pItem->m_slat = slat;
+      pItem->m_slon = slon;
+
+      if ( pidx )
+            pidx->Add ( pItem );
+}
+
+//    First item in list order of the given type whose m_pData1 is data
+SelectItem *Select::FindOwnedItem ( void *data, int seltype )
+{
+      SelectTypeIndex *pidx = GetTypeIndex ( seltype );
+      if ( NULL == pidx )
+      {
+            wxSelectableItemListNode *node = pSelectList->GetFirst();
+            while ( node )
+            {
+                  SelectItem *pFindSel = node->GetData();
+                  if ( ( pFindSel->m_seltype == seltype ) && ( data == pFindSel->m_pData1 ) )
+                        return pFindSel;
+                  node = node->GetNext();
+            }
+            return NULL;
+      }
+
+      wxArrayPtrVoid *pa;
+      if ( IsSelectSegmentType ( seltype ) )
+            pa = pidx->GetEndpointItems ( data );
+      else
+            pa = pidx->GetOwnerItems ( data );
+
+      SelectItem *pFound = NULL;
+      if ( pa )
+      {
+            for ( unsigned int i = 0 ; i < pa->GetCount() ; i++ )
+            {
+                  SelectItem *pFindSel = ( SelectItem * ) pa->Item ( i );
+                  if ( ( data == pFindSel->m_pData1 ) && ( ( NULL == pFound ) || ( pFindSel->m_seq < pFound->m_seq ) ) )
+                        pFound = pFindSel;
+            }
+      }
+      return pFound;
+}
+
 bool Select::AddSelectableRoutePoint ( float slat, float slon, RoutePoint *pRoutePointAdd )
 {
       SelectItem *pSelItem = new SelectItem;
@@ -366,10 +738,7 @@ bool Select::AddSelectableRoutePoint ( float slat, float slon, RoutePoint *pRout
       pSelItem->m_bIsSelected = false;
       pSelItem->m_pData1 = pRoutePointAdd;
 
-      if (pRoutePointAdd->m_bIsInLayer)
-            pSelectList->Append ( pSelItem );
-      else
-            pSelectList->Insert ( pSelItem );
+      LinkItem ( pSelItem, pRoutePointAdd->m_bIsInLayer );
 
       return true;
 }
@@ -389,86 +758,51 @@ bool Select::AddSelectableRouteSegment ( float slat1, float slon1, float slat2,
       pSelItem->m_pData2 = pRoutePointAdd2;
       pSelItem->m_pData3 = pRoute;
 
-      if (pRoute->m_bIsInLayer)
-            pSelectList->Append ( pSelItem );
-      else
-            pSelectList->Insert ( pSelItem );
+      LinkItem ( pSelItem, pRoute->m_bIsInLayer );
 
       return true;
 }
 
 bool Select::DeleteAllSelectableRouteSegments ( Route *pr )
 {
-      SelectItem *pFindSel;
-
-//    Iterate on the select list
-      wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-      while ( node )
+      wxArrayPtrVoid *pa = GetTypeIndex ( SELTYPE_ROUTESEGMENT )->GetOwnerItems ( pr );
+      if ( pa )
       {
-            pFindSel = node->GetData();
-            if ( pFindSel->m_seltype == SELTYPE_ROUTESEGMENT )
+            wxArrayPtrVoid items = *pa;         // the index entry goes away as we unlink
+            for ( int i = items.GetCount() - 1 ; i >= 0 ; i-- )
             {
-
-//                  RoutePoint *ps1 = (RoutePoint *)pFindSel->m_pData1;
-//                  RoutePoint *ps2 = (RoutePoint *)pFindSel->m_pData2;
-
-                  if ( ( Route * ) pFindSel->m_pData3  == pr )
-                  {
-                        delete pFindSel;
-                        pSelectList->DeleteNode ( node );   //delete node;
-
-                        node = pSelectList->GetFirst();     // reset the top node
-
-                        goto got_next_outer_node;
-                  }
+                  SelectItem *pFindSel = ( SelectItem * ) items.Item ( i );
+                  UnlinkItem ( pFindSel );
+                  delete pFindSel;
             }
-
-            node = node->GetNext();
-      got_next_outer_node:
-            continue;
       }
 
-
       return true;
 }
 
 
 bool Select::DeleteAllSelectableRoutePoints ( Route *pr )
 {
-      SelectItem *pFindSel;
-
-//    Iterate on the select list
-      wxSelectableItemListNode *node = pSelectList->GetFirst();
+      SelectTypeIndex *pidx = GetTypeIndex ( SELTYPE_ROUTEPOINT );
 
-      while ( node )
+      //    Iterate on the route's point list
+      wxRoutePointListNode *pnode = ( pr->pRoutePointList )->GetFirst();
+      while ( pnode )
       {
-            pFindSel = node->GetData();
-            if ( pFindSel->m_seltype == SELTYPE_ROUTEPOINT )
-            {
-                  RoutePoint *ps = ( RoutePoint * ) pFindSel->m_pData1;
+            RoutePoint *prp = pnode->GetData();
 
-                  //    inner loop iterates on the route's point list
-                  wxRoutePointListNode *pnode = ( pr->pRoutePointList )->GetFirst();
-                  while ( pnode )
+            wxArrayPtrVoid *pa = pidx->GetOwnerItems ( prp );
+            if ( pa )
+            {
+                  wxArrayPtrVoid items = *pa;
+                  for ( unsigned int i = 0 ; i < items.GetCount() ; i++ )
                   {
-                        RoutePoint *prp = pnode->GetData();
-
-                        if ( prp == ps )
-                        {
-                              delete pFindSel;
-                              pSelectList->DeleteNode ( node );   //delete node;
-                              node = pSelectList->GetFirst();
-
-                              goto got_next_outer_node;
-                        }
-                        pnode = pnode->GetNext();
+                        SelectItem *pFindSel = ( SelectItem * ) items.Item ( i );
+                        UnlinkItem ( pFindSel );
+                        delete pFindSel;
                   }
             }
-
-            node = node->GetNext();
-      got_next_outer_node:
-            continue;
+            pnode = pnode->GetNext();
       }
       return true;
 }
@@ -564,32 +898,33 @@ bool Select::AddAllSelectableTrackSegments ( Route *pr )
 
 bool Select::UpdateSelectableRouteSegments ( RoutePoint *prp )
 {
-      SelectItem *pFindSel;
+      SelectTypeIndex *pidx = GetTypeIndex ( SELTYPE_ROUTESEGMENT );
       bool ret = false;
 
-//    Iterate on the select list
-      wxSelectableItemListNode *node = pSelectList->GetFirst();
+      wxArrayPtrVoid *pa = pidx->GetEndpointItems ( prp );
+      if ( NULL == pa )
+            return false;
 
-      while ( node )
+      wxArrayPtrVoid items = *pa;
+      for ( unsigned int i = 0 ; i < items.GetCount() ; i++ )
       {
-            pFindSel = node->GetData();
-            if ( pFindSel->m_seltype == SELTYPE_ROUTESEGMENT )
+            SelectItem *pFindSel = ( SelectItem * ) items.Item ( i );
+
+            pidx->Remove ( pFindSel );
+            if ( pFindSel->m_pData1 == prp )
             {
-                  if ( pFindSel->m_pData1 == prp )
-                  {
-                        pFindSel->m_slat = prp->m_lat;
-                        pFindSel->m_slon = prp->m_lon;
-                        ret = true;;
-                  }
+                  pFindSel->m_slat = prp->m_lat;
+                  pFindSel->m_slon = prp->m_lon;
+                  ret = true;
+            }
 
-                  else if ( pFindSel->m_pData2 == prp )
-                  {
-                        pFindSel->m_slat2 = prp->m_lat;
-                        pFindSel->m_slon2 = prp->m_lon;
-                        ret = true;
-                  }
+            else if ( pFindSel->m_pData2 == prp )
+            {
+                  pFindSel->m_slat2 = prp->m_lat;
+                  pFindSel->m_slon2 = prp->m_lon;
+                  ret = true;
             }
-            node = node->GetNext();
+            pidx->Add ( pFindSel );
       }
 
 
@@ -615,7 +950,7 @@ SelectItem *Select::AddSelectablePoint ( float slat, float slon, void *pdata, in
             pSelItem->m_bIsSelected = false;
             pSelItem->m_pData1 = pdata;
 
-            pSelectList->Append ( pSelItem );
+            LinkItem ( pSelItem, true );
       }
 
       return pSelItem;
@@ -625,32 +960,25 @@ bool Select::DeleteAllPoints ( void )
 {
       pSelectList->DeleteContents ( true );
       pSelectList->Clear();
+      pSelectList->DeleteContents ( false );
+
+      for ( int i = 0 ; i < SELECT_NUM_TYPES ; i++ )
+            m_TypeIndex[i].Clear();
+
       return true;
 }
 
 
 bool Select::DeleteSelectablePoint ( void *pdata, int SeltypeToDelete )
 {
-      SelectItem *pFindSel;
-
       if ( NULL != pdata )
       {
-//    Iterate on the list
-            wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-            while ( node )
+            SelectItem *pFindSel = FindOwnedItem ( pdata, SeltypeToDelete );
+            if ( pFindSel )
             {
-                  pFindSel = node->GetData();
-                  if ( pFindSel->m_seltype == SeltypeToDelete )
-                  {
-                        if ( pdata == pFindSel->m_pData1 )
-                        {
-                              delete pFindSel;
-                              delete node;
-                              return true;
-                        }
-                  }
-                  node = node->GetNext();
+                  UnlinkItem ( pFindSel );
+                  delete pFindSel;
+                  return true;
             }
       }
       return false;
@@ -660,6 +988,27 @@ bool Select::DeleteSelectablePoint ( void *pdata, int SeltypeToDelete )
 bool Select::DeleteAllSelectableTypePoints ( int SeltypeToDelete )
 {
       SelectItem *pFindSel;
+      SelectTypeIndex *pidx = GetTypeIndex ( SeltypeToDelete );
+
+      if ( pidx )
+      {
+            //    Every item of the type appears exactly once in the owner map
+            SelectOwnerHash &owners = pidx->GetOwnerHash();
+            SelectOwnerHash::iterator it;
+            for ( it = owners.begin(); it != owners.end(); ++it )
+            {
+                  wxArrayPtrVoid *pa = it->second;
+                  for ( unsigned int i = 0 ; i < pa->GetCount() ; i++ )
+                  {
+                        pFindSel = ( SelectItem * ) pa->Item ( i );
+                        pSelectList->DeleteNode ( pFindSel->m_pListNode );
+                        delete pFindSel;
+                  }
+            }
+            pidx->Clear();
+
+            return true;
+      }
 
 //    Iterate on the list
       wxSelectableItemListNode *node = pSelectList->GetFirst();
@@ -684,25 +1033,11 @@ bool Select::DeleteAllSelectableTypePoints ( int SeltypeToDelete )
 
 bool Select::ModifySelectablePoint ( float lat, float lon, void *data, int SeltypeToModify )
 {
-      SelectItem *pFindSel;
-
-//    Iterate on the list
-      wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-      while ( node )
+      SelectItem *pFindSel = FindOwnedItem ( data, SeltypeToModify );
+      if ( pFindSel )
       {
-            pFindSel = node->GetData();
-            if ( pFindSel->m_seltype == SeltypeToModify )
-            {
-                  if ( data == pFindSel->m_pData1 )
-                  {
-                        pFindSel->m_slat = lat;
-                        pFindSel->m_slon = lon;
-                        return true;
-                  }
-            }
-
-            node = node->GetNext();
+            ModifySelectItem ( pFindSel, lat, lon );
+            return true;
       }
       return false;
 }
@@ -723,10 +1058,7 @@ bool Select::AddSelectableTrackSegment ( float slat1, float slon1, float slat2,
       pSelItem->m_pData2 = pRoutePointAdd2;
       pSelItem->m_pData3 = pRoute;
 
-      if (pRoute->m_bIsInLayer)
-            pSelectList->Append ( pSelItem );
-      else
-            pSelectList->Insert ( pSelItem );
+      LinkItem ( pSelItem, pRoute->m_bIsInLayer );
 
       return true;
 }
@@ -735,37 +1067,18 @@ bool Select::AddSelectableTrackSegment ( float slat1, float slon1, float slat2,
 
 bool Select::DeleteAllSelectableTrackSegments ( Route *pr )
 {
-      SelectItem *pFindSel;
-
-//    Iterate on the select list
-      wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-      while ( node )
+      wxArrayPtrVoid *pa = GetTypeIndex ( SELTYPE_TRACKSEGMENT )->GetOwnerItems ( pr );
+      if ( pa )
       {
-            pFindSel = node->GetData();
-            if ( pFindSel->m_seltype == SELTYPE_TRACKSEGMENT )
+            wxArrayPtrVoid items = *pa;
+            for ( int i = items.GetCount() - 1 ; i >= 0 ; i-- )
             {
-
-//                  RoutePoint *ps1 = (RoutePoint *)pFindSel->m_pData1;
-//                  RoutePoint *ps2 = (RoutePoint *)pFindSel->m_pData2;
-
-                  if ( ( Route * ) pFindSel->m_pData3  == pr )
-                  {
-                        delete pFindSel;
-                        pSelectList->DeleteNode ( node );   //delete node;
-
-                        node = pSelectList->GetFirst();     // reset the top node
-
-                        goto got_next_outer_node;
-                  }
+                  SelectItem *pFindSel = ( SelectItem * ) items.Item ( i );
+                  UnlinkItem ( pFindSel );
+                  delete pFindSel;
             }
-
-            node = node->GetNext();
-      got_next_outer_node:
-                  continue;
       }
 
-
       return true;
 }
 
@@ -822,10 +1135,51 @@ bool IsSegmentSelected(float a,float b, float c, float d,float slat, float slon,
 
 
 
+
+bool Select::IsItemSelected ( SelectItem *pFindSel, float slat, float slon, float SelectRadius )
+{
+      switch ( pFindSel->m_seltype )
+      {
+            case SELTYPE_ROUTEPOINT:
+            case SELTYPE_TIDEPOINT:
+            case SELTYPE_CURRENTPOINT:
+            case SELTYPE_AISTARGET:
+                  return ( ( fabs ( slat - pFindSel->m_slat ) < SelectRadius ) &&
+                           ( fabs ( slon - pFindSel->m_slon ) < SelectRadius ) );
+
+            case SELTYPE_ROUTESEGMENT:
+            case SELTYPE_TRACKSEGMENT:
+                  return IsSegmentSelected ( pFindSel->m_slat, pFindSel->m_slat2,
+                                             pFindSel->m_slon, pFindSel->m_slon2,
+                                             slat, slon, SelectRadius );
+            default:
+                  break;
+      }
+      return false;
+}
+
 SelectItem *Select::FindSelection ( float slat, float slon, int fseltype, float SelectRadius )
 {
-      float a,b,c,d;
       SelectItem *pFindSel;
+      SelectTypeIndex *pidx = GetTypeIndex ( fseltype );
+
+      if ( pidx )
+      {
+            //    Of the hits, return the one nearest the head of the list
+            wxArrayPtrVoid candidates;
+            pidx->Query ( slat, slon, SelectRadius, candidates );
+
+            SelectItem *pFound = NULL;
+            for ( unsigned int i = 0 ; i < candidates.GetCount() ; i++ )
+            {
+                  pFindSel = ( SelectItem * ) candidates.Item ( i );
+                  if ( pFound && ( pFindSel->m_seq >= pFound->m_seq ) )
+                        continue;
+                  if ( IsItemSelected ( pFindSel, slat, slon, SelectRadius ) )
+                        pFound = pFindSel;
+            }
+            return pFound;
+      }
 
 //    Iterate on the list
       wxSelectableItemListNode *node = pSelectList->GetFirst();
@@ -833,45 +1187,13 @@ SelectItem *Select::FindSelection ( float slat, float slon, int fseltype, float
       while ( node )
       {
             pFindSel = node->GetData();
-            if ( pFindSel->m_seltype == fseltype )
-            {
-                  switch ( fseltype )
-                  {
-                        case SELTYPE_ROUTEPOINT:
-                        case SELTYPE_TIDEPOINT:
-                        case SELTYPE_CURRENTPOINT:
-                        case SELTYPE_AISTARGET:
-                              a = fabs ( slat - pFindSel->m_slat );
-                              b = fabs ( slon - pFindSel->m_slon );
-
-                              if ( ( fabs ( slat - pFindSel->m_slat ) < SelectRadius ) &&
-                                      ( fabs ( slon - pFindSel->m_slon ) < SelectRadius ) )
-                                    goto find_ok;
-                              break;
-                        case SELTYPE_ROUTESEGMENT:
-                        case SELTYPE_TRACKSEGMENT:
-                        {
-                              a = pFindSel->m_slat;
-                              b = pFindSel->m_slat2;
-                              c = pFindSel->m_slon;
-                              d = pFindSel->m_slon2;
-
-                              if(IsSegmentSelected(a,b,c,d,slat,slon, SelectRadius))
-                                    goto find_ok;
-                              break;
-                        }
-                        default:
-                              break;
-                  }
-            }
-
+            if ( ( pFindSel->m_seltype == fseltype ) && IsItemSelected ( pFindSel, slat, slon, SelectRadius ) )
+                  return pFindSel;
 
             node = node->GetNext();
       }
 
       return NULL;
-find_ok:
-      return pFindSel;
 }
 
 bool Select::IsSelectableSegmentSelected(float slat, float slon, float SelectRadius, SelectItem *pFindSel)
@@ -884,12 +1206,50 @@ bool Select::IsSelectableSegmentSelected(float slat, float slon, float SelectRad
       return IsSegmentSelected(a,b,c,d,slat,slon, SelectRadius);
 }
 
+static int CompareSelectItemSeq ( const void *p1, const void *p2 )
+{
+      SelectItem *ps1 = * ( SelectItem ** ) p1;
+      SelectItem *ps2 = * ( SelectItem ** ) p2;
+
+      if ( ps1->m_seq < ps2->m_seq )
+            return -1;
+      if ( ps1->m_seq > ps2->m_seq )
+            return 1;
+      return 0;
+}
 
 SelectableItemList Select::FindSelectionList(float slat, float slon, int fseltype, float SelectRadius)
 {
-      float a,b,c,d;
       SelectItem *pFindSel;
       SelectableItemList ret_list;
+      SelectTypeIndex *pidx = GetTypeIndex ( fseltype );
+
+      if ( pidx )
+      {
+            wxArrayPtrVoid candidates;
+            pidx->Query ( slat, slon, SelectRadius, candidates );
+
+            unsigned int n = candidates.GetCount();
+            if ( 0 == n )
+                  return ret_list;
+
+            //    Report hits in list order, once each
+            SelectItem **pitems = ( SelectItem ** ) malloc ( n * sizeof ( SelectItem * ) );
+            for ( unsigned int i = 0 ; i < n ; i++ )
+                  pitems[i] = ( SelectItem * ) candidates.Item ( i );
+            qsort ( pitems, n, sizeof ( SelectItem * ), CompareSelectItemSeq );
+
+            for ( unsigned int i = 0 ; i < n ; i++ )
+            {
+                  if ( ( i > 0 ) && ( pitems[i] == pitems[i - 1] ) )
+                        continue;
+                  if ( IsItemSelected ( pitems[i], slat, slon, SelectRadius ) )
+                        ret_list.Append ( pitems[i] );
+            }
+
+            free ( pitems );
+            return ret_list;
+      }
 
 //    Iterate on the list
       wxSelectableItemListNode *node = pSelectList->GetFirst();
@@ -897,38 +1257,8 @@ SelectableItemList Select::FindSelectionList(float slat, float slon, int fseltyp
       while ( node )
       {
             pFindSel = node->GetData();
-            if ( pFindSel->m_seltype == fseltype )
-            {
-                  switch ( fseltype )
-                  {
-                        case SELTYPE_ROUTEPOINT:
-                        case SELTYPE_TIDEPOINT:
-                        case SELTYPE_CURRENTPOINT:
-                        case SELTYPE_AISTARGET:
-                              if ( ( fabs ( slat - pFindSel->m_slat ) < SelectRadius ) &&
-                                     ( fabs ( slon - pFindSel->m_slon ) < SelectRadius ) )
-                              {
-                                    ret_list.Append(pFindSel);
-                              }
-                              break;
-                        case SELTYPE_ROUTESEGMENT:
-                        case SELTYPE_TRACKSEGMENT:
-                        {
-                              a = pFindSel->m_slat;
-                              b = pFindSel->m_slat2;
-                              c = pFindSel->m_slon;
-                              d = pFindSel->m_slon2;
-
-                              if(IsSegmentSelected(a,b,c,d,slat,slon, SelectRadius))
-                                    ret_list.Append(pFindSel);
-
-                              break;
-                        }
-                        default:
-                              break;
-                  }
-            }
-
+            if ( ( pFindSel->m_seltype == fseltype ) && IsItemSelected ( pFindSel, slat, slon, SelectRadius ) )
+                  ret_list.Append ( pFindSel );
 
             node = node->GetNext();
       }
@@ -1301,6 +1631,7 @@ Route::Route ( void )
       m_bIsBeingCreated = false;
       m_bIsTrack = false;
       m_nPoints = 0;
+      m_nModifyCount = 0;
       m_nm_sequence = 1;
       m_route_length = 0.0;
       m_route_time = 0.0;
@@ -1469,6 +1800,7 @@ void Route::AddPoint ( RoutePoint *pNewPoint, bool b_rename_in_sequence, bool b_
       pRoutePointList->Append ( pNewPoint );
 
       m_nPoints++;
+      m_nModifyCount++;
 
       if(!b_deferBoxCalc)
             CalculateBBox();
@@ -1826,6 +2158,7 @@ RoutePoint *Route::InsertPointBefore ( RoutePoint *pRP, double rlat, double rlon
       RoutePointGUIDList.Insert ( pRP->m_GUID, nRP );
 
       m_nPoints++;
+      m_nModifyCount++;
 
       if ( bRenamePoints )
             RenameRoutePoints();
@@ -1886,6 +2219,7 @@ void Route::DeletePoint ( RoutePoint *rp, bool bRenamePoints )
       delete rp;
 
       m_nPoints -= 1;
+      m_nModifyCount++;
 
       if ( bRenamePoints )
             RenameRoutePoints();
@@ -1915,6 +2249,7 @@ void Route::RemovePoint ( RoutePoint *rp, bool bRenamePoints )
       if(wxNOT_FOUND != RoutePointGUIDList.Index(rp->m_GUID))
             RoutePointGUIDList.Remove ( rp->m_GUID );
       m_nPoints -= 1;
+      m_nModifyCount++;
 
 
 
@@ -2224,6 +2559,7 @@ void Route::Reverse ( bool bRenamePoints )
       pRoutePointList->DeleteContents ( false );
       pRoutePointList->Clear();
       m_nPoints = 0;
+      m_nModifyCount++;
 
       AssembleRoute();                          // Rebuild the route points from the GUID list
 
@@ -2284,81 +2620,462 @@ void Route::AssembleRoute ( void )
       }
 }
 
-void Route::RenameRoutePoints ( void )
+void Route::RenameRoutePoints ( void )
+{
+      //    iterate on the route points.
+      //    If dynamically named, rename according to current list position
+
+      wxRoutePointListNode *node = pRoutePointList->GetFirst();
+
+      int i = 1;
+      while ( node )
+      {
+            RoutePoint *prp = node->GetData();
+            if ( prp->m_bDynamicName )
+            {
+                  wxString name;
+                  name.Printf ( _T ( "%03d" ), i );
+                  prp->SetName(name);
+            }
+
+            node = node->GetNext();
+            i++;
+      }
+}
+
+
+bool Route::SendToGPS ( wxString& com_name, bool bsend_waypoints, wxGauge *pProgress )
+{
+      bool result = false;
+      if(g_pnmea)
+            result = g_pnmea->SendRouteToGPS(this, com_name, bsend_waypoints, pProgress);
+
+      wxString msg;
+      if(result)
+            msg = _("Route Uploaded successfully.");
+      else
+            msg = _("Error on Route Upload.  Please check logfiles...");
+
+      OCPNMessageBox(msg, _("OpenCPN Info"), wxOK | wxICON_INFORMATION);
+
+      return result;
+}
+
+//    Is this route equal to another, meaning,
+//    Do all routepoint positions and names match?
+bool Route::IsEqualTo ( Route *ptargetroute )
+{
+      wxRoutePointListNode *pthisnode = ( this->pRoutePointList )->GetFirst();
+      wxRoutePointListNode *pthatnode = ( ptargetroute->pRoutePointList )->GetFirst();
+
+      if ( NULL == pthisnode )
+            return false;
+
+      if (this->m_bIsInLayer || ptargetroute->m_bIsInLayer) return false;
+
+      if (this->GetnPoints() != ptargetroute->GetnPoints())
+           return false;
+
+      while ( pthisnode )
+      {
+            if ( NULL == pthatnode )
+                  return false;
+
+            RoutePoint *pthisrp = pthisnode->GetData();
+            RoutePoint *pthatrp = pthatnode->GetData();
+
+            if ( ( fabs ( pthisrp->m_lat - pthatrp->m_lat ) > 1.0e-6 ) || ( fabs ( pthisrp->m_lon - pthatrp->m_lon ) > 1.0e-6 ) )
+                  return false;
+
+            if ( !pthisrp->GetName().IsSameAs ( pthatrp->GetName() ) )
+                  return false;
+
+            pthisnode = pthisnode->GetNext();
+            pthatnode = pthatnode->GetNext();
+      }
+
+      return true;                              // success, they are the same
+}
+
+//---------------------------------------------------------------------------------
+//    TrackPointStore Implementation
+//---------------------------------------------------------------------------------
+TrackPointStore::TrackPointStore()
+{
+      m_nfixes = 0;
+}
+
+TrackPointStore::~TrackPointStore()
+{
+      Clear();
+}
+
+void TrackPointStore::Clear ( void )
+{
+      for ( unsigned int i = 0 ; i < m_chunks.GetCount() ; i++ )
+            free ( m_chunks.Item ( i ) );
+      m_chunks.Clear();
+      m_nfixes = 0;
+}
+
+void TrackPointStore::Append ( double lat, double lon, time_t fix_time )
+{
+      TrackFixChunk *pc = NULL;
+      if ( m_chunks.GetCount() )
+            pc = ( TrackFixChunk * ) m_chunks.Last();
+
+      if ( ( NULL == pc ) || ( pc->nfixes == TRACK_STORE_CHUNK_FIXES ) )
+      {
+            pc = ( TrackFixChunk * ) malloc ( sizeof ( TrackFixChunk ) );
+            pc->base_lat = lat;
+            pc->base_lon = lon;
+            pc->base_time = fix_time;
+            pc->nfixes = 0;
+            m_chunks.Add ( pc );
+      }
+
+      //    Keep the longitude offset within +/- 180 across the IDL
+      double dlon = lon - pc->base_lon;
+      if ( dlon > 180. )
+            dlon -= 360.;
+      else if ( dlon < -180. )
+            dlon += 360.;
+
+      int n = pc->nfixes;
+      pc->dlat[n] = ( int ) floor ( ( ( lat - pc->base_lat ) * 1e7 ) + 0.5 );
+      pc->dlon[n] = ( int ) floor ( ( dlon * 1e7 ) + 0.5 );
+      pc->dtime[n] = ( int ) ( fix_time - pc->base_time );
+
+      pc->nfixes++;
+      m_nfixes++;
+}
+
+void TrackPointStore::GetFix ( int index, double *lat, double *lon, time_t *fix_time )
+{
+      TrackFixChunk *pc = ( TrackFixChunk * ) m_chunks.Item ( index / TRACK_STORE_CHUNK_FIXES );
+      int n = index % TRACK_STORE_CHUNK_FIXES;
+
+      if ( lat )
+            *lat = pc->base_lat + ( pc->dlat[n] * 1e-7 );
+
+      if ( lon )
+      {
+            double rlon = pc->base_lon + ( pc->dlon[n] * 1e-7 );
+            if ( rlon < -180. )
+                  rlon += 360.;
+            else if ( rlon > 180. )
+                  rlon -= 360.;
+            *lon = rlon;
+      }
+
+      if ( fix_time )
+            *fix_time = pc->base_time + pc->dtime[n];
+}
+
+//---------------------------------------------------------------------------------
+//    TrackLOD Implementation
+//---------------------------------------------------------------------------------
+TrackLOD::TrackLOD()
+{
+      m_npoints = 0;
+      m_ppoints = NULL;
+      m_plat = NULL;
+      m_plon = NULL;
+      m_pflags = NULL;
+      m_nchunks = 0;
+      m_pchunk_bbox = NULL;
+      m_pchunk_wraps = NULL;
+      m_modify_count = -1;
+      m_coslat = 1.;
+
+      for ( int i = 0 ; i < TRACK_LOD_LEVELS ; i++ )
+      {
+            m_plevel_points[i] = NULL;
+            m_nlevel_points[i] = 0;
+            m_plevel_chunk_start[i] = NULL;
+      }
+}
+
+TrackLOD::~TrackLOD()
+{
+      Clear();
+}
+
+void TrackLOD::Clear ( void )
+{
+      free ( m_ppoints );
+      free ( m_plat );
+      free ( m_plon );
+      free ( m_pflags );
+      free ( m_pchunk_bbox );
+      free ( m_pchunk_wraps );
+
+      m_ppoints = NULL;
+      m_plat = NULL;
+      m_plon = NULL;
+      m_pflags = NULL;
+      m_pchunk_bbox = NULL;
+      m_pchunk_wraps = NULL;
+
+      for ( int i = 0 ; i < TRACK_LOD_LEVELS ; i++ )
+      {
+            free ( m_plevel_points[i] );
+            free ( m_plevel_chunk_start[i] );
+            m_plevel_points[i] = NULL;
+            m_nlevel_points[i] = 0;
+            m_plevel_chunk_start[i] = NULL;
+      }
+
+      m_npoints = 0;
+      m_nchunks = 0;
+      m_modify_count = -1;
+}
+
+bool TrackLOD::IsValidFor ( Route *pRoute )
+{
+      if ( 0 == m_npoints )
+            return false;
+
+      return ( pRoute->GetModifyCount() == m_modify_count );
+}
+
+int TrackLOD::GetLevel ( double view_scale_ppm )
+{
+      //    The coarsest level whose tolerance is still within a pixel
+      int level = 0;
+      double tolerance = TRACK_LOD_BASE_TOLERANCE;
+      for ( int i = 1 ; i < TRACK_LOD_LEVELS ; i++ )
+      {
+            if ( ( tolerance * view_scale_ppm ) > 1.0 )
+                  break;
+            level = i;
+            tolerance *= 4.;
+      }
+
+      return level;
+}
+
+void TrackLOD::Build ( Route *pRoute )
 {
-      //    iterate on the route points.
-      //    If dynamically named, rename according to current list position
+      Clear();
 
-      wxRoutePointListNode *node = pRoutePointList->GetFirst();
+      int n = pRoute->pRoutePointList->GetCount();
+      if ( 0 == n )
+            return;
 
-      int i = 1;
+      m_ppoints = ( RoutePoint ** ) malloc ( n * sizeof ( RoutePoint * ) );
+      m_plat = ( double * ) malloc ( n * sizeof ( double ) );
+      m_plon = ( double * ) malloc ( n * sizeof ( double ) );
+      m_pflags = ( unsigned char * ) malloc ( n );
+
+      double lat_min = 90.;
+      double lat_max = -90.;
+      unsigned short int FromSegNo = 0;
+
+      int i = 0;
+      wxRoutePointListNode *node = pRoute->pRoutePointList->GetFirst();
       while ( node )
       {
             RoutePoint *prp = node->GetData();
-            if ( prp->m_bDynamicName )
-            {
-                  wxString name;
-                  name.Printf ( _T ( "%03d" ), i );
-                  prp->SetName(name);
-            }
 
-            node = node->GetNext();
+            m_ppoints[i] = prp;
+            m_plat[i] = prp->m_lat;
+            m_plon[i] = prp->m_lon;
+
+            unsigned char flags = 0;
+            if ( prp->m_IconName.StartsWith ( _T ( "xmred" ) ) )
+                  flags = 1;
+            else if ( prp->m_IconName.StartsWith ( _T ( "xmblue" ) ) )
+                  flags = 2;
+            else if ( prp->m_IconName.StartsWith ( _T ( "xmgreen" ) ) )
+                  flags = 3;
+
+            if ( ( prp->m_IconName != _T ( "empty" ) ) || prp->m_bShowName )
+                  flags |= TRACK_LOD_DECORATED;
+
+            if ( i && ( prp->m_GPXTrkSegNo != FromSegNo ) )
+                  flags |= TRACK_LOD_BREAK;
+            FromSegNo = prp->m_GPXTrkSegNo;
+
+            m_pflags[i] = flags;
+
+            lat_min = wxMin ( lat_min, prp->m_lat );
+            lat_max = wxMax ( lat_max, prp->m_lat );
+
             i++;
+            node = node->GetNext();
+      }
+
+      //    Segment breaks, pen changes and IDL crossings survive every level,
+      //    together with the point before them, so that what is drawn stays the same
+      m_pflags[0] |= TRACK_LOD_KEEP;
+      m_pflags[n - 1] |= TRACK_LOD_KEEP;
+      for ( i = 1 ; i < n ; i++ )
+      {
+            if ( ( m_pflags[i] & TRACK_LOD_BREAK ) ||
+                 ( ( m_pflags[i] & TRACK_LOD_CLASS_MASK ) != ( m_pflags[i - 1] & TRACK_LOD_CLASS_MASK ) ) ||
+                 ( fabs ( m_plon[i] - m_plon[i - 1] ) > 180. ) )
+            {
+                  m_pflags[i - 1] |= TRACK_LOD_KEEP;
+                  m_pflags[i] |= TRACK_LOD_KEEP;
+            }
       }
-}
 
+      m_coslat = cos ( ( ( lat_min + lat_max ) / 2. ) * PI / 180. );
 
-bool Route::SendToGPS ( wxString& com_name, bool bsend_waypoints, wxGauge *pProgress )
-{
-      bool result = false;
-      if(g_pnmea)
-            result = g_pnmea->SendRouteToGPS(this, com_name, bsend_waypoints, pProgress);
+      //    Chunk extents include the point before the chunk,
+      //    so they also cover the segment leading into it
+      m_nchunks = ( n + TRACK_LOD_CHUNK_POINTS - 1 ) / TRACK_LOD_CHUNK_POINTS;
+      m_pchunk_bbox = ( double * ) malloc ( m_nchunks * 4 * sizeof ( double ) );
+      m_pchunk_wraps = ( bool * ) malloc ( m_nchunks * sizeof ( bool ) );
 
-      wxString msg;
-      if(result)
-            msg = _("Route Uploaded successfully.");
-      else
-            msg = _("Error on Route Upload.  Please check logfiles...");
+      for ( int ic = 0 ; ic < m_nchunks ; ic++ )
+      {
+            int istart = ic * TRACK_LOD_CHUNK_POINTS;
+            int iend = wxMin ( istart + TRACK_LOD_CHUNK_POINTS, n );
+            if ( istart )
+                  istart--;
 
-      OCPNMessageBox(msg, _("OpenCPN Info"), wxOK | wxICON_INFORMATION);
+            double *pbox = &m_pchunk_bbox[ic * 4];
+            pbox[0] = pbox[1] = m_plat[istart];
+            pbox[2] = pbox[3] = m_plon[istart];
+            m_pchunk_wraps[ic] = false;
 
-      return result;
+            for ( i = istart + 1 ; i < iend ; i++ )
+            {
+                  pbox[0] = wxMin ( pbox[0], m_plat[i] );
+                  pbox[1] = wxMax ( pbox[1], m_plat[i] );
+                  pbox[2] = wxMin ( pbox[2], m_plon[i] );
+                  pbox[3] = wxMax ( pbox[3], m_plon[i] );
+
+                  if ( fabs ( m_plon[i] - m_plon[i - 1] ) > 180. )
+                        m_pchunk_wraps[ic] = true;
+            }
+      }
+
+      m_npoints = n;
+      m_modify_count = pRoute->GetModifyCount();
+
+      double tolerance = TRACK_LOD_BASE_TOLERANCE;
+      for ( int level = 1 ; level < TRACK_LOD_LEVELS ; level++ )
+      {
+            Simplify ( level, tolerance / ( 1852. * 60. ) );            // meters to degrees
+            tolerance *= 4.;
+      }
 }
 
-//    Is this route equal to another, meaning,
-//    Do all routepoint positions and names match?
-bool Route::IsEqualTo ( Route *ptargetroute )
+void TrackLOD::Simplify ( int level, double tolerance )
 {
-      wxRoutePointListNode *pthisnode = ( this->pRoutePointList )->GetFirst();
-      wxRoutePointListNode *pthatnode = ( ptargetroute->pRoutePointList )->GetFirst();
+      //    Each level simplifies the one below it, so the work shrinks as the tolerance grows
+      int nin = GetCount ( level - 1 );
 
-      if ( NULL == pthisnode )
-            return false;
+      int *pout = ( int * ) malloc ( nin * sizeof ( int ) );
+      int *pstack = ( int * ) malloc ( 2 * nin * sizeof ( int ) );
+      bool *pkeep = ( bool * ) malloc ( nin * sizeof ( bool ) );
 
-      if (this->m_bIsInLayer || ptargetroute->m_bIsInLayer) return false;
+      double tol2 = tolerance * tolerance;
 
-      if (this->GetnPoints() != ptargetroute->GetnPoints())
-           return false;
+      for ( int ip = 0 ; ip < nin ; ip++ )
+            pkeep[ip] = ( m_pflags[GetIndex ( level - 1, ip )] & TRACK_LOD_KEEP ) != 0;
 
-      while ( pthisnode )
+      //    Douglas-Peucker over each run between points that must be kept
+      int run_start = 0;
+      for ( int run_end = 1 ; run_end < nin ; run_end++ )
       {
-            if ( NULL == pthatnode )
-                  return false;
+            if ( !pkeep[run_end] )
+                  continue;
 
-            RoutePoint *pthisrp = pthisnode->GetData();
-            RoutePoint *pthatrp = pthatnode->GetData();
+            int nstack = 0;
+            if ( run_end - run_start > 1 )
+            {
+                  pstack[nstack++] = run_start;
+                  pstack[nstack++] = run_end;
+            }
 
-            if ( ( fabs ( pthisrp->m_lat - pthatrp->m_lat ) > 1.0e-6 ) || ( fabs ( pthisrp->m_lon - pthatrp->m_lon ) > 1.0e-6 ) )
-                  return false;
+            while ( nstack )
+            {
+                  int pe = pstack[--nstack];
+                  int ps = pstack[--nstack];
+
+                  int is = GetIndex ( level - 1, ps );
+                  int ie = GetIndex ( level - 1, pe );
+                  double ax = m_plon[is] * m_coslat;
+                  double ay = m_plat[is];
+                  double dx = ( m_plon[ie] * m_coslat ) - ax;
+                  double dy = m_plat[ie] - ay;
+                  double len2 = ( dx * dx ) + ( dy * dy );
+
+                  double dmax = -1.;
+                  int pmax = ps;
+                  for ( int ip = ps + 1 ; ip < pe ; ip++ )
+                  {
+                        int ii = GetIndex ( level - 1, ip );
+                        double px = ( m_plon[ii] * m_coslat ) - ax;
+                        double py = m_plat[ii] - ay;
 
-            if ( !pthisrp->GetName().IsSameAs ( pthatrp->GetName() ) )
-                  return false;
+                        double t = 0.;
+                        if ( len2 > 0. )
+                        {
+                              t = ( ( px * dx ) + ( py * dy ) ) / len2;
+                              if ( t < 0. )
+                                    t = 0.;
+                              else if ( t > 1. )
+                                    t = 1.;
+                        }
 
-            pthisnode = pthisnode->GetNext();
-            pthatnode = pthatnode->GetNext();
+                        double ex = px - ( t * dx );
+                        double ey = py - ( t * dy );
+                        double d2 = ( ex * ex ) + ( ey * ey );
+                        if ( d2 > dmax )
+                        {
+                              dmax = d2;
+                              pmax = ip;
+                        }
+                  }
+
+                  if ( dmax > tol2 )
+                  {
+                        pkeep[pmax] = true;
+                        if ( pmax - ps > 1 )
+                        {
+                              pstack[nstack++] = ps;
+                              pstack[nstack++] = pmax;
+                        }
+                        if ( pe - pmax > 1 )
+                        {
+                              pstack[nstack++] = pmax;
+                              pstack[nstack++] = pe;
+                        }
+                  }
+            }
+
+            run_start = run_end;
       }
 
-      return true;                              // success, they are the same
+      int nout = 0;
+      for ( int ip = 0 ; ip < nin ; ip++ )
+      {
+            if ( pkeep[ip] )
+                  pout[nout++] = GetIndex ( level - 1, ip );
+      }
+
+      free ( pstack );
+      free ( pkeep );
+
+      m_plevel_points[level] = ( int * ) realloc ( pout, nout * sizeof ( int ) );
+      m_nlevel_points[level] = nout;
+
+      //    First position at or beyond the start of each chunk, with a sentinel at the end
+      int *pcs = ( int * ) malloc ( ( m_nchunks + 1 ) * sizeof ( int ) );
+      int ip = 0;
+      for ( int ic = 0 ; ic <= m_nchunks ; ic++ )
+      {
+            int ichunk = ic * TRACK_LOD_CHUNK_POINTS;
+            while ( ( ip < nout ) && ( m_plevel_points[level][ip] < ichunk ) )
+                  ip++;
+            pcs[ic] = ip;
+      }
+      m_plevel_chunk_start[level] = pcs;
 }
 
 //---------------------------------------------------------------------------------
@@ -2389,11 +3106,15 @@ Track::Track ( void )
       m_ConfigRouteNum = now.GetTicks();        // a unique number....
 
       m_track_run = 0;
+      m_prev_pTrackPoint = NULL;
+      m_fixes_length = 0.;
 }
 
 Track::~Track()
 {
-      Stop();
+      //    No closing point here, the track and its selectables are going away
+      m_TimerTrack.Stop();
+      m_bRunning = false;
 }
 
 
@@ -2417,6 +3138,8 @@ void Track::Stop ( bool do_add_point )
       m_TimerTrack.Stop();
       m_bRunning = false;
       m_track_run = 0;
+
+      MaterializeFixes();
 }
 
 bool Track::DoExtendDaily()
@@ -2490,7 +3213,7 @@ void Track::OnTimerTrack ( wxTimerEvent& event )
 
       if ( b_addpoint )
             AddPointNow();
-      else if ( ( GetnPoints() < 2 ) && (delta < m_DeltaDistance) && !g_bTrackDaily)  //continuously update track beginning point timestamp if no movement.
+      else if ( ( ( GetnPoints() + m_Fixes.GetCount() ) < 2 ) && (delta < m_DeltaDistance) && !g_bTrackDaily)  //continuously update track beginning point timestamp if no movement.
       {
             wxDateTime now = wxDateTime::Now();
             pRoutePointList->GetFirst()->GetData()->m_CreateTime = now.ToUTC();
@@ -2517,27 +3240,97 @@ void Track::AddPointNow(bool do_add_point)
         //imsg = now.FormatISODate()+now.FormatISOTime()+_T("Adding Point Now");
         //wxLogMessage(imsg);
 
-      RoutePoint *pTrackPoint = new RoutePoint ( gLat, gLon, wxString ( _T ( "empty" ) ), wxString ( _T ( "" ) ), GPX_EMPTY_STRING );
-      pTrackPoint->m_bShowName = false;
-      pTrackPoint->m_bIsVisible  = true;                    // pjotrc 2010.02.11
-      pTrackPoint->m_GPXTrkSegNo = 1;                       // pjotrc 2010.02.28
+      //    The first fix is made a RoutePoint at once, it anchors the track
+      //    for the route manager and the daily extend logic.
+      //    Later fixes go to the compact store until MaterializeFixes().
+      if ( GetnPoints() == 0 )
+      {
+            RoutePoint *pTrackPoint = new RoutePoint ( gLat, gLon, wxString ( _T ( "empty" ) ), wxString ( _T ( "" ) ), GPX_EMPTY_STRING );
+            pTrackPoint->m_bShowName = false;
+            pTrackPoint->m_bIsVisible  = true;                    // pjotrc 2010.02.11
+            pTrackPoint->m_GPXTrkSegNo = 1;                       // pjotrc 2010.02.28
+
+            pTrackPoint->m_CreateTime = now.ToUTC();
 
-      pTrackPoint->m_CreateTime = now.ToUTC();
+            AddPoint ( pTrackPoint );
+
+            //    This is a hack, need to undo the action of Route::AddPoint
+            pTrackPoint->m_bIsInRoute = false;
+            pTrackPoint->m_bIsInTrack = true;
 
-      AddPoint ( pTrackPoint );
+            m_prev_pTrackPoint = pTrackPoint;
+      }
+      else
+      {
+            m_Fixes.Append ( gLat, gLon, now.ToUTC().GetTicks() );
 
-      //    This is a hack, need to undo the action of Route::AddPoint
-      pTrackPoint->m_bIsInRoute = false;
-      pTrackPoint->m_bIsInTrack = true;
+            double seg_len = DistGreatCircle ( m_prev_glat, m_prev_glon, gLat, gLon );
+            m_fixes_length += seg_len;
+            m_route_length += seg_len;
 
-      if ( GetnPoints() > 1 )
+            //    Selectable without RoutePoints, MaterializeFixes() rebuilds these
             pSelect->AddSelectableTrackSegment ( m_prev_glat, m_prev_glon, gLat, gLon,
-                                                 m_prev_pTrackPoint, pTrackPoint, this );
+                                                 NULL, NULL, this );
+
+            //    Grow the bounding box, or let CalculateBBox() switch to its IDL form
+            if ( ( ( m_prev_glon < -150. ) && ( gLon > 150. ) ) || ( ( m_prev_glon > 150. ) && ( gLon < -150. ) ) )
+                  MaterializeFixes();
+            else
+            {
+                  double lon = gLon;
+                  if ( CrossesIDL() && ( lon < 0. ) )
+                        lon += 360.;
+                  RBBox.Expand ( lon, gLat );
+            }
+      }
 
       m_prev_glon = gLon;
       m_prev_glat = gLat;
 
       m_prev_time = now;
+
+      //    Each fix is journaled, navobj.xml is not rewritten for it
+      pConfig->StoreTrackFix ( this, gLat, gLon, now.ToUTC().GetTicks() );
+}
+
+void Track::MaterializeFixes ( void )
+{
+      int nfixes = m_Fixes.GetCount();
+      if ( 0 == nfixes )
+            return;
+
+      m_route_length -= m_fixes_length;               // AddPoint() counts these legs again
+
+      for ( int i = 0 ; i < nfixes ; i++ )
+      {
+            double lat, lon;
+            time_t fix_time;
+            m_Fixes.GetFix ( i, &lat, &lon, &fix_time );
+
+            RoutePoint *pTrackPoint = new RoutePoint ( lat, lon, wxString ( _T ( "empty" ) ), wxString ( _T ( "" ) ), GPX_EMPTY_STRING );
+            pTrackPoint->m_bShowName = false;
+            pTrackPoint->m_bIsVisible  = true;
+            pTrackPoint->m_GPXTrkSegNo = 1;
+
+            pTrackPoint->m_CreateTime = wxDateTime ( fix_time );
+
+            AddPoint ( pTrackPoint, true, true );           // defer BBox calculation
+
+            pTrackPoint->m_bIsInRoute = false;
+            pTrackPoint->m_bIsInTrack = true;
+
+            m_prev_pTrackPoint = pTrackPoint;
+      }
+
+      m_Fixes.Clear();
+      m_fixes_length = 0.;
+      IncModifyCount();
+
+      CalculateBBox();
+
+      //    Replace the point-less segments with ones referring to the new RoutePoints
+      pSelect->DeleteAllSelectableTrackSegments ( this );
+      pSelect->AddAllSelectableTrackSegments ( this );
 }
 
 
@@ -2546,89 +3339,185 @@ void Track::Draw ( ocpnDC& dc, ViewPort &VP )
       if ( !IsVisible() || GetnPoints() == 0 )
             return;
 
-      if (m_bRunning) {                                       // pjotrc 2010.02.26
-            dc.SetBrush ( wxBrush ( GetGlobalColor ( _T ( "URED" ) ) ) );
-            wxPen dPen ( GetGlobalColor ( _T ( "URED" ) ), g_track_line_width ) ;
-            dc.SetPen ( dPen );
-      } else {
-            dc.SetBrush ( wxBrush ( GetGlobalColor ( _T ( "CHMGD" ) ) ) );
-            wxPen dPen ( GetGlobalColor ( _T ( "CHMGD" ) ), g_track_line_width ) ;
-            dc.SetPen ( dPen );
-      }
-
       double radius_meters = 20;//Current_Ch->GetNativeScale() * .0015;         // 1.5 mm at original scale
       double radius = radius_meters * VP.view_scale_ppm;
 
       if(!g_bHighliteTracks)
             radius = 0;                         // disable highlights
 
-      unsigned short int FromSegNo = 1;
+      //    One pen for each point colour class, chosen once rather than per point
+      //    Class 0 is the default, 1-3 follow the xmred, xmblue and xmgreen icons   // pjotrc 2010.02.26
+      int style = wxSOLID;
+      int width = g_route_line_width;
+      if (m_style != STYLE_UNDEFINED)
+            style = m_style;
+      if (m_width != STYLE_UNDEFINED)
+            width = m_width;
 
-      wxPoint rpt, rptn;
-      DrawPointWhich ( dc, 1, &rpt );
+      wxColour class_col[4];
+      class_col[0] = GetGlobalColor ( _T ( "CHMGD" ) );
+      class_col[1] = GetGlobalColor ( _T ( "URED" ) );
+      class_col[2] = GetGlobalColor ( _T ( "BLUE3" ) );
+      class_col[3] = GetGlobalColor ( _T ( "UGREN" ) );
+      if (m_bRunning)
+      {
+            for ( int i = 0 ; i < 4 ; i++ )
+                  class_col[i] = class_col[1];
+      }
+      if ( m_Colour != wxEmptyString )
+      {
+            for (unsigned int i = 0; i < sizeof( ::GpxxColorNames ) / sizeof( wxString ); i++)
+            {
+                  if ( m_Colour == ::GpxxColorNames[i] )
+                  {
+                        for ( int j = 0 ; j < 4 ; j++ )
+                              class_col[j] = ::GpxxColors[i];
+                        break;
+                  }
+            }
+      }
 
-      wxRoutePointListNode *node = pRoutePointList->GetFirst();
-      node = node->GetNext();
+      wxPen *class_pen[4];
+      wxBrush *class_brush[4];
+      for ( int i = 0 ; i < 4 ; i++ )
+      {
+            class_pen[i] = wxThePenList->FindOrCreatePen(class_col[i], width, style);
+            class_brush[i] = wxTheBrushList->FindOrCreateBrush(class_col[i], wxSOLID);
+      }
 
-      while ( node )
+      //    Pick the simplification level for this scale, and the chunks on screen
+      if ( !m_LOD.IsValidFor ( this ) )
+            m_LOD.Build ( this );
+
+      int level = m_LOD.GetLevel ( VP.view_scale_ppm );
+      int nchunks = m_LOD.m_nchunks;
+
+      //    A few pixels margin, so wide pens and highlights at the edge are not lost
+      double margin = 0.;
+      if ( VP.view_scale_ppm > 0. )
+            margin = ( ( radius + 8. ) / VP.view_scale_ppm ) / ( 1852. * 60. );
+
+      LLBBox &vpbox = VP.GetBBox();
+      double vp_lat_min = vpbox.GetMinY() - margin;
+      double vp_lat_max = vpbox.GetMaxY() + margin;
+      double vp_lon_min = vpbox.GetMinX() - ( margin / wxMax ( m_LOD.m_coslat, .01 ) );
+      double vp_lon_max = vpbox.GetMaxX() + ( margin / wxMax ( m_LOD.m_coslat, .01 ) );
+
+      //    pnvisible[ic] counts the visible chunks before chunk ic
+      int *pnvisible = ( int * ) malloc ( ( nchunks + 1 ) * sizeof ( int ) );
+      pnvisible[0] = 0;
+      for ( int ic = 0 ; ic < nchunks ; ic++ )
       {
-            RoutePoint *prp = node->GetData();
-            unsigned short int ToSegNo = prp->m_GPXTrkSegNo;
-
-            if (m_bRunning || prp->m_IconName.StartsWith(_T("xmred"))){              // pjotrc 2010.02.26
-                  dc.SetBrush ( wxBrush ( GetGlobalColor ( _T ( "URED" ) ) ) );
-                  wxPen dPen ( GetGlobalColor ( _T ( "URED" ) ), g_track_line_width ) ;
-                  dc.SetPen ( dPen );
-            } else
-                  if (prp->m_IconName.StartsWith(_T("xmblue"))){                     // pjotrc 2010.02.26
-                        dc.SetBrush ( wxBrush ( GetGlobalColor ( _T ( "BLUE3" ) ) ) );
-                        wxPen dPen ( GetGlobalColor ( _T ( "BLUE3" ) ), g_track_line_width ) ;
-                        dc.SetPen ( dPen );
-                  } else
-                        if (prp->m_IconName.StartsWith(_T("xmgreen"))){               // pjotrc 2010.02.26
-                              dc.SetBrush ( wxBrush ( GetGlobalColor ( _T ( "UGREN" ) ) ) );
-                              wxPen dPen ( GetGlobalColor ( _T ( "UGREN" ) ), g_track_line_width ) ;
-                              dc.SetPen ( dPen );
-                        } else {                                                      // pjotrc 2010.03.02
-                              dc.SetBrush ( wxBrush ( GetGlobalColor ( _T ( "CHMGD" ) ) ) );
-                              wxPen dPen ( GetGlobalColor ( _T ( "CHMGD" ) ), g_track_line_width ) ;
-                              dc.SetPen ( dPen );
+            double *pbox = &m_LOD.m_pchunk_bbox[ic * 4];
+            bool b_vis = m_LOD.m_pchunk_wraps[ic];
+
+            if ( !b_vis && ( pbox[1] >= vp_lat_min ) && ( pbox[0] <= vp_lat_max ) )
+            {
+                  //    The viewport may itself extend beyond +/- 180
+                  for ( double xlate = -360. ; xlate <= 360. ; xlate += 360. )
+                  {
+                        if ( ( pbox[3] + xlate >= vp_lon_min ) && ( pbox[2] + xlate <= vp_lon_max ) )
+                        {
+                              b_vis = true;
+                              break;
                         }
-            int style = wxSOLID;
-            int width = g_route_line_width;
-            wxColour col;
-            if (m_style != STYLE_UNDEFINED)
-                  style = m_style;
-            if (m_width != STYLE_UNDEFINED)
-                  width = m_width;
-            if ( m_Colour == wxEmptyString )
+                  }
+            }
+
+            pnvisible[ic + 1] = pnvisible[ic] + ( b_vis ? 1 : 0 );
+      }
+
+      //    Walk the kept points of the visible chunks.
+      //    A simplified segment stays close to the points it replaces,
+      //    so it is drawn if any chunk it spans is visible.
+      wxPoint rpt, rptn;
+      int ipt = -1;                       // point index currently projected in rpt
+      int cur_class = -1;
+
+      for ( int ic = 0 ; ic < nchunks ; ic++ )
+      {
+            int pstart = m_LOD.GetChunkStart ( level, ic );
+            int pend = m_LOD.GetChunkStart ( level, ic + 1 );
+
+            int pfirst = wxMax ( pstart, 1 );
+            if ( pfirst < pend )
             {
-                  col = dc.GetPen().GetColour();
+                  int ic_from = m_LOD.GetIndex ( level, pfirst - 1 ) / TRACK_LOD_CHUNK_POINTS;
+                  if ( pnvisible[ic + 1] - pnvisible[ic_from] )
+                  {
+                        for ( int ip = pfirst ; ip < pend ; ip++ )
+                        {
+                              int ia = m_LOD.GetIndex ( level, ip - 1 );
+                              int ib = m_LOD.GetIndex ( level, ip );
+
+                              unsigned char flags = m_LOD.m_pflags[ib];
+                              if ( flags & TRACK_LOD_BREAK )                  // pjotrc 2010.02.27
+                                    continue;
+
+                              ic_from = ia / TRACK_LOD_CHUNK_POINTS;
+                              if ( 0 == ( pnvisible[ic + 1] - pnvisible[ic_from] ) )
+                                    continue;
+
+                              if ( ia != ipt )
+                                    cc1->GetCanvasPointPix ( m_LOD.m_plat[ia], m_LOD.m_plon[ia], &rpt );
+                              cc1->GetCanvasPointPix ( m_LOD.m_plat[ib], m_LOD.m_plon[ib], &rptn );
+
+                              int seg_class = flags & TRACK_LOD_CLASS_MASK;
+                              if ( seg_class != cur_class )
+                              {
+                                    dc.SetPen ( *class_pen[seg_class] );
+                                    dc.SetBrush ( *class_brush[seg_class] );
+                                    cur_class = seg_class;
+                              }
+
+                              RenderSegment ( dc, rpt.x, rpt.y, rptn.x, rptn.y, VP, false, ( int ) radius );      // no arrows, with hilite
+
+                              rpt = rptn;
+                              ipt = ib;
+                        }
+                  }
             }
-            else
+
+            //    Points with an icon, a name or a highlight still draw themselves, at any scale
+            if ( pnvisible[ic + 1] - pnvisible[ic] )
             {
-                  for (unsigned int i = 0; i < sizeof( ::GpxxColorNames ) / sizeof( wxString ); i++)
+                  int istart = ic * TRACK_LOD_CHUNK_POINTS;
+                  int iend = wxMin ( istart + TRACK_LOD_CHUNK_POINTS, m_LOD.m_npoints );
+                  for ( int i = istart ; i < iend ; i++ )
                   {
-                        if ( m_Colour == ::GpxxColorNames[i] )
+                        RoutePoint *prp = m_LOD.m_ppoints[i];
+                        if ( ( m_LOD.m_pflags[i] & TRACK_LOD_DECORATED ) || prp->m_bPtIsSelected )
                         {
-                              col = ::GpxxColors[i];
-                              break;
+                              prp->Draw ( dc );
+                              cur_class = -1;           // RoutePoint::Draw sets its own pen
                         }
                   }
             }
-            dc.SetPen ( *wxThePenList->FindOrCreatePen(col, width, style) );
-            dc.SetBrush ( *wxTheBrushList->FindOrCreateBrush(col, wxSOLID) );
+      }
 
-            prp->Draw ( dc, &rptn );
+      free ( pnvisible );
 
-            if (ToSegNo == FromSegNo)                                        // pjotrc 2010.02.27
-                  RenderSegment ( dc, rpt.x, rpt.y, rptn.x, rptn.y, VP, false, ( int ) radius );      // no arrows, with hilite
+      //    The store and the dynamic segment continue from the last point
+      int ilast = m_LOD.m_npoints - 1;
+      if ( ipt != ilast )
+            cc1->GetCanvasPointPix ( m_LOD.m_plat[ilast], m_LOD.m_plon[ilast], &rpt );
 
-            rpt = rptn;
+      //    Fixes still in the compact store follow on from the last RoutePoint
+      dc.SetPen ( *class_pen[0] );
+      dc.SetBrush ( *class_brush[0] );
 
-            node = node->GetNext();
-            FromSegNo = ToSegNo;                                  // pjotrc 2010.02.27
+      int nfixes = m_Fixes.GetCount();
+      if ( nfixes )
+      {
+            for ( int i = 0 ; i < nfixes ; i++ )
+            {
+                  double lat, lon;
+                  m_Fixes.GetFix ( i, &lat, &lon, NULL );
+                  cc1->GetCanvasPointPix ( lat, lon, &rptn );
 
+                  RenderSegment ( dc, rpt.x, rpt.y, rptn.x, rptn.y, VP, false, ( int ) radius );
+                  rpt = rptn;
+            }
       }
 
       //    Draw last segment, dynamically, maybe.....
@@ -2645,11 +3534,38 @@ Route *Track::RouteFromTrack(wxProgressDialog *pprog)
 {
 
       Route *route = new Route();
+
+      //    Gather the track positions, including the running track's unmaterialised fixes.
+      //    Tracks imported as plain Routes arrive here too, so only the active track has a store.
+      int nPoints = pRoutePointList->GetCount();
+      int nfixes = 0;
+      if ( this == g_pActiveTrack )
+            nfixes = m_Fixes.GetCount();
+
+      int ntotal = nPoints + nfixes;
+      double *plat = ( double * ) malloc ( ntotal * sizeof ( double ) );
+      double *plon = ( double * ) malloc ( ntotal * sizeof ( double ) );
+
+      int k = 0;
       wxRoutePointListNode *prpnode = pRoutePointList->GetFirst();
-      RoutePoint *pWP_src = prpnode->GetData();
-      wxRoutePointListNode *prpnodeX;
+      while ( prpnode )
+      {
+            RoutePoint *prp = prpnode->GetData();
+            plat[k] = prp->m_lat;
+            plon[k] = prp->m_lon;
+            k++;
+            prpnode = prpnode->GetNext();
+      }
+      for ( int i = 0 ; i < nfixes ; i++, k++ )
+            m_Fixes.GetFix ( i, &plat[k], &plon[k], NULL );
+
+      nPoints = ntotal;
+
+      RoutePoint *pWP_src;
       RoutePoint *pWP_dst;
-      RoutePoint *prp_OK = NULL;  // last routepoint known not to exceed xte limit, if not yet added
+      int ip;                 // current track position
+      int ipX;                // position being tested for xte, -1 when done
+      int ip_OK = -1;         // last position known not to exceed xte limit, if not yet added
 
       wxString icon = _T("xmblue");
       if (g_TrackDeltaDistance >= 0.1) icon = _T("diamond");
@@ -2657,7 +3573,6 @@ Route *Track::RouteFromTrack(wxProgressDialog *pprog)
       int ic = 0;
       int next_ic = 0;
       int back_ic = 0;
-      int nPoints = pRoutePointList->GetCount();
       bool isProminent = true;
       double delta_dist, delta_hdg, xte;
       double leg_speed = 0.1;
@@ -2667,30 +3582,31 @@ Route *Track::RouteFromTrack(wxProgressDialog *pprog)
 
 // add first point
 
-      pWP_dst = new RoutePoint ( pWP_src->m_lat, pWP_src->m_lon,  icon , _T ( "" ) , GPX_EMPTY_STRING );
+      pWP_dst = new RoutePoint ( plat[0], plon[0],  icon , _T ( "" ) , GPX_EMPTY_STRING );
       route->AddPoint(pWP_dst);
 
       pWP_dst->m_bShowName = false;
 
       pSelect->AddSelectableRoutePoint ( pWP_dst->m_lat, pWP_dst->m_lon, pWP_dst );
 
+      pWP_src = pWP_dst;
+
 // add intermediate points as needed
 
-      prpnode = prpnode->GetNext();
+      ip = 1;
 
-      while ( prpnode )
+      while ( ip < ntotal )
       {
-            RoutePoint *prp = prpnode->GetData();
-            prpnodeX = prpnode;
+            ipX = ip;
             pWP_dst = pWP_src;
 
             delta_dist = 0.0;
             delta_hdg = 0.0;
             back_ic = next_ic;
 
-            DistanceBearingMercator(prp->m_lat, prp->m_lon, pWP_src->m_lat, pWP_src->m_lon, &delta_hdg, &delta_dist);
+            DistanceBearingMercator(plat[ip], plon[ip], pWP_src->m_lat, pWP_src->m_lon, &delta_hdg, &delta_dist);
 
-            if ((delta_dist > (leg_speed * 6.0)) && !prp_OK) {
+            if ((delta_dist > (leg_speed * 6.0)) && (ip_OK < 0)) {
                   int delta_inserts = floor(delta_dist/(leg_speed * 4.0));
                   delta_dist = delta_dist/(delta_inserts+1);
                   double tlat = 0.0;
@@ -2707,27 +3623,30 @@ Route *Track::RouteFromTrack(wxProgressDialog *pprog)
 
                         pWP_src = pWP_dst;
                   }
-                  prpnodeX = prpnode;
+                  ipX = ip;
                   pWP_dst = pWP_src;
                   next_ic = 0;
                   delta_dist = 0.0;
                   back_ic = next_ic;
-                  prp_OK = prp;
+                  ip_OK = ip;
                   isProminent = true;
             }
             else {
                   isProminent = false;
                   if (delta_dist >= (leg_speed * 4.0)) isProminent = true;
-                  if (!prp_OK) prp_OK = prp;
+                  if (ip_OK < 0) ip_OK = ip;
             }
 
-            while (prpnodeX) {
+            while (ipX >= 0) {
+
+                  if (ipX == ip)
+                        xte = 0.0;
+                  else
+                        xte = GetXTE(pWP_src->m_lat, pWP_src->m_lon, plat[ipX], plon[ipX], plat[ip], plon[ip]);
 
-                  RoutePoint *prpX = prpnodeX->GetData();
-                  xte = GetXTE(pWP_src, prpX, prp);
                   if (isProminent || (xte > g_TrackDeltaDistance)) {
 
-                        pWP_dst = new RoutePoint ( prp_OK->m_lat, prp_OK->m_lon,  icon , _T ( "" ) , GPX_EMPTY_STRING );
+                        pWP_dst = new RoutePoint ( plat[ip_OK], plon[ip_OK],  icon , _T ( "" ) , GPX_EMPTY_STRING );
 
                         route->AddPoint(pWP_dst);
                         pWP_dst->m_bShowName = false;
@@ -2738,24 +3657,24 @@ Route *Track::RouteFromTrack(wxProgressDialog *pprog)
 
                         pWP_src = pWP_dst;
                         next_ic = 0;
-                        prpnodeX = NULL;
-                        prp_OK = NULL;
+                        ipX = -1;
+                        ip_OK = -1;
                   }
 
-                  if (prpnodeX) prpnodeX = prpnodeX->GetPrevious();
+                  if (ipX >= 0) ipX--;
                   if (back_ic-- <= 0) {
-                         prpnodeX = NULL;
+                         ipX = -1;
                   }
             }
 
-            if (prp_OK) {
-                  prp_OK = prp;
+            if (ip_OK >= 0) {
+                  ip_OK = ip;
             }
 
-            DistanceBearingMercator(prp->m_lat, prp->m_lon, pWP_src->m_lat, pWP_src->m_lon, NULL, &delta_dist);
+            DistanceBearingMercator(plat[ip], plon[ip], pWP_src->m_lat, pWP_src->m_lon, NULL, &delta_dist);
 
-            if (!((delta_dist > (g_TrackDeltaDistance)) && !prp_OK)) {
-                  prpnode = prpnode->GetNext(); //RoutePoint
+            if (!((delta_dist > (g_TrackDeltaDistance)) && (ip_OK < 0))) {
+                  ip++; //RoutePoint
                   next_ic++;
             }
             ic++;
@@ -2765,7 +3684,7 @@ Route *Track::RouteFromTrack(wxProgressDialog *pprog)
 
 // add last point, if needed
       if (delta_dist >= g_TrackDeltaDistance) {
-            pWP_dst = new RoutePoint ( pRoutePointList->GetLast()->GetData()->m_lat, pRoutePointList->GetLast()->GetData()->m_lon,  icon , _T ( "" ) , GPX_EMPTY_STRING );
+            pWP_dst = new RoutePoint ( plat[ntotal - 1], plon[ntotal - 1],  icon , _T ( "" ) , GPX_EMPTY_STRING );
             route->AddPoint(pWP_dst);
 
             pWP_dst->m_bShowName = false;
@@ -2779,6 +3698,9 @@ Route *Track::RouteFromTrack(wxProgressDialog *pprog)
       route->m_RouteEndString = m_RouteEndString;
       route->m_bDeleteOnArrival = false;
 
+      free ( plat );
+      free ( plon );
+
       return route;
 }
 
@@ -2787,15 +3709,21 @@ double Track::GetXTE(RoutePoint *fm1, RoutePoint *fm2, RoutePoint *to)
       if (!fm1 || !fm2 || !to) return 0.0;
       if (fm1 == to) return 0.0;
       if (fm2 == to) return 0.0;
-//      Get the XTE vector for prp, normal to segment between pWP_src and prpX
+
+      return GetXTE(fm1->m_lat, fm1->m_lon, fm2->m_lat, fm2->m_lon, to->m_lat, to->m_lon);
+}
+
+double Track::GetXTE(double fm1Lat, double fm1Lon, double fm2Lat, double fm2Lon, double toLat, double toLon)
+{
+//      Get the XTE vector, normal to segment between fm1 and fm2
           VECTOR2D va, vb, vn;
 
           double brg1, dist1, brg2, dist2;
-          DistanceBearingMercator(to->m_lat, to->m_lon, fm1->m_lat, fm1->m_lon, &brg1, &dist1);
+          DistanceBearingMercator(toLat, toLon, fm1Lat, fm1Lon, &brg1, &dist1);
           vb.x = dist1 * sin(brg1 * PI / 180.);
           vb.y = dist1 * cos(brg1 * PI / 180.);
 
-          DistanceBearingMercator(to->m_lat, to->m_lon, fm2->m_lat, fm2->m_lon, &brg2, &dist2);
+          DistanceBearingMercator(toLat, toLon, fm2Lat, fm2Lon, &brg2, &dist2);
           va.x = dist2 * sin(brg2 * PI / 180.);
           va.y = dist2 * cos(brg2 * PI / 180.);
 
@@ -2860,12 +3788,97 @@ MyConfig::MyConfig ( const wxString &appName, const wxString &vendorName, const
       m_sNavObjSetFile = config_file.GetPath ( wxPATH_GET_VOLUME | wxPATH_GET_SEPARATOR );
       m_sNavObjSetFile += _T ( "navobj.xml" );
       m_sNavObjSetChangesFile = m_sNavObjSetFile + _T ( ".changes" );
+      m_sNavObjJournalFile = m_sNavObjSetFile + _T ( ".journal" );
+
+      m_pNavObjectInputSet = NULL;
+      m_pNavObjJournal = new NavObjectJournal ( m_sNavObjJournalFile );
+      m_navobj_update_time = time ( NULL );
+      m_bNavObjDirty = false;
+
+      m_bIsImporting = false;
+      g_bIsNewLayer = false;
+}
+
+//    One child of the <gpx> root of an imported file, l is the new layer if any
+void MyConfig::ImportGPXElement ( TiXmlNode *child, Layer *l )
+{
+      wxString ChildName = wxString::FromUTF8( child->Value());
+      if ( ChildName == _T ( "wpt" ) )
+      {
+            RoutePoint *pWp = ::LoadGPXWaypoint((GpxWptElement *)child, _T("circle"), true);          // Full Viz
+            RoutePoint *pExisting = WaypointExists( pWp->GetName(), pWp->m_lat, pWp->m_lon);
+            if(!pExisting)
+            {
+                  if (WaypointExists(pWp->m_GUID)) //We try to import a waypoint with the same guid but different properties, so we assign it a new guid to keep them both
+                        pWp->m_GUID = pWayPointMan->CreateGUID ( pWp );
+
+                  if ( NULL != pWayPointMan )
+                        pWayPointMan->m_pWayPointList->Append ( pWp );
+
+                  pWp->m_bIsolatedMark = true;      // This is an isolated mark
+                  pWp->m_bIsInLayer = g_bIsNewLayer;
+                  AddNewWayPoint ( pWp,m_NextWPNum );   // use auto next num
+                  if (g_bIsNewLayer) {
+                        pWp->m_LayerID = g_LayerIdx;
+                        pWp->m_bIsVisible = g_bLayerViz;
+                  }
+                  else
+                        pWp->m_LayerID = 0;
+                  pSelect->AddSelectableRoutePoint ( pWp->m_lat, pWp->m_lon, pWp );
+                  pWp->m_ConfigWPNum = m_NextWPNum;
+                  m_NextWPNum++;
+            }
+            if ( l )
+                  l->m_NoOfItems++;
+      }
+      else if ( ChildName == _T ( "rte" ) )
+      {
+            ::GPXLoadRoute ( (GpxRteElement *)child, m_NextRouteNum, true );        // Full visibility
+            m_NextRouteNum++;
+            if ( l )
+                  l->m_NoOfItems++;
+      }
+      else if ( ChildName == _T ( "trk" ) )
+      {
+            ::GPXLoadTrack ( (GpxTrkElement *)child, true );                        // Full visibility
+            if ( l )
+                  l->m_NoOfItems++;
+      }
+}
+
+bool MyConfig::ImportGPXStream ( const wxString &path, Layer *l, int *pnloaded )
+{
+      *pnloaded = 0;
+
+      GpxStreamReader reader;
+      if ( !reader.Open ( path ) )
+            return false;
+
+      wxString RootName;
+      if ( reader.NextChild ( RootName ) && ( RootName == _T ( "gpx" ) ) && reader.EnterChild() )
+      {
+            wxString ChildName;
+            while ( reader.NextChild ( ChildName ) )
+            {
+                  if ( ChildName == _T ( "trk" ) )
+                  {
+                        ::GPXStreamLoadTrack ( reader, true );                      // Full visibility
+                        if ( l && !reader.HasError() )
+                              l->m_NoOfItems++;
+                  }
+                  else
+                  {
+                        TiXmlElement *child = reader.ReadChild();
+                        if ( child )
+                              ImportGPXElement ( child, l );
+                  }
 
-      m_pNavObjectInputSet = NULL;
-      m_pNavObjectChangesSet = new NavObjectCollection();
+                  if ( !reader.HasError() )
+                        ( *pnloaded )++;
+            }
+      }
 
-      m_bIsImporting = false;
-      g_bIsNewLayer = false;
+      return !reader.HasError();
 }
 
 
@@ -2889,6 +3902,142 @@ void MyConfig::CreateRotatingNavObjBackup()
                   break;
 }
 
+//    Redo one change kept by the journal, or by the .changes file of earlier versions
+void MyConfig::ReplayNavObjChange ( TiXmlElement *gpx_element, wxArrayPtrVoid *pAppendedTracks )
+{
+      wxString ChildName = wxString::FromUTF8( gpx_element->Value() );
+
+      wxString action;
+      TiXmlElement *exts = gpx_element->FirstChildElement("extensions");
+      TiXmlElement *action_element = exts ? exts->FirstChildElement("opencpn:action") : NULL;
+      if ( action_element && action_element->GetText() )
+            action = wxString::FromUTF8( action_element->GetText() );
+
+      if ( ChildName == _T ( "rte" ) )
+      {
+            Route *pRt = ::LoadGPXRoute((GpxRteElement *)gpx_element, 0);
+            Route *pExisting = RouteExists( pRt->m_GUID );
+            if (action == _T("add"))
+            {
+                  m_bIsImporting = true;
+                  ::InsertRoute(pRt, -1);
+                  m_bIsImporting = false;
+            }
+            else if (action == _T("update"))
+            {
+                  m_bIsImporting = true;
+                  ::UpdateRoute(pRt);
+                  m_bIsImporting = false;
+            }
+            else if (action == _T("delete"))
+            {
+                  m_bIsImporting = true;
+                  if(pExisting)
+                  {
+                        g_pRouteMan->DeleteRoute(pExisting);
+                  }
+                  m_bIsImporting = false;
+            }
+      }
+      else if ( ChildName == _T ( "trk" ) )
+      {
+            Route *pTrk = ::LoadGPXTrack((GpxTrkElement *)gpx_element);
+            Route *pExisting = RouteExists( pTrk->m_GUID );
+            //no adds here - the only possible way is logging the gps data
+            if (action == _T("update"))
+            {
+                  m_bIsImporting = true;
+                  if(pExisting)
+                  {
+                        pExisting->m_RouteNameString = pTrk->m_RouteNameString;
+                        pExisting->m_RouteStartString = pTrk->m_RouteStartString;
+                        pExisting->m_RouteEndString = pTrk->m_RouteEndString;
+                  }
+                  m_bIsImporting = false;
+            }
+            else if (action == _T("delete"))
+            {
+                  m_bIsImporting = true;
+                  if(pExisting)
+                  {
+                        g_pRouteMan->DeleteTrack(pExisting);
+                  }
+                  m_bIsImporting = false;
+            }
+      }
+      else if ( ChildName == _T ( "wpt" ) )
+      {
+            RoutePoint *pWp = ::LoadGPXWaypoint((GpxWptElement *)gpx_element, g_default_wp_icon);
+            RoutePoint *pExisting = WaypointExists( pWp->m_GUID );
+            if (action == wxString(_T("add")))
+            {
+                  m_bIsImporting = true;
+                  if(!pExisting) //Should not be needed...
+                        if ( NULL != pWayPointMan )
+                              pWayPointMan->m_pWayPointList->Append ( pWp );
+                  pWp->m_bIsolatedMark = true;
+                  AddNewWayPoint ( pWp,m_NextWPNum );
+                  pSelect->AddSelectableRoutePoint ( pWp->m_lat, pWp->m_lon, pWp );
+                  m_bIsImporting = false;
+            }
+            else if (action == wxString(_T("update")))
+            {
+                  m_bIsImporting = true;
+                  if(pExisting)
+                        pWayPointMan->m_pWayPointList->DeleteObject(pExisting);
+                  pWayPointMan->m_pWayPointList->Append ( pWp );
+                  pWp->m_bIsolatedMark = true;
+                  AddNewWayPoint ( pWp,m_NextWPNum );
+                  pSelect->AddSelectableRoutePoint ( pWp->m_lat, pWp->m_lon, pWp );
+                  m_bIsImporting = false;
+            }
+            else if (action == wxString(_T("delete")))
+            {
+                  m_bIsImporting = true;
+                  if(pExisting)
+                  {
+                        pWayPointMan->DestroyWaypoint(pExisting);
+                  }
+                  m_bIsImporting = false;
+            }
+      }
+      else if ( ChildName == _T ( "trkpt" ) && ( action == _T("append") ) )
+      {
+            //    A fix logged by a running track, which may not have reached navobj.xml at all
+            wxString TrackGUID;
+            TiXmlElement *track_element = exts->FirstChildElement("opencpn:track");
+            if ( track_element && track_element->GetText() )
+                  TrackGUID = wxString::FromUTF8( track_element->GetText() );
+
+            Route *pTrack = RouteExists( TrackGUID );
+            if ( !pTrack )
+            {
+                  pTrack = new Track();
+                  pTrack->m_GUID = TrackGUID;
+                  pRouteList->Append ( pTrack );
+            }
+
+            RoutePoint *pWp = ::LoadGPXWaypoint ( (GpxWptElement *)gpx_element, _T("empty"), false );
+            RoutePoint *pLast = pTrack->GetnPoints() ? pTrack->GetLastPoint() : NULL;
+
+            //    Fixes the last save of navobj.xml has already written are not added twice
+            if ( pLast && !pWp->m_CreateTime.IsLaterThan ( pLast->m_CreateTime ) )
+                  delete pWp;
+            else
+            {
+                  pTrack->AddPoint ( pWp, false, true );            // defer BBox calculation
+                  pWp->m_bIsInRoute = false;                      // Hack
+                  pWp->m_bIsInTrack = true;
+                  pWp->m_GPXTrkSegNo = pLast ? pLast->m_GPXTrkSegNo : 1;
+                  pWayPointMan->m_pWayPointList->Append ( pWp );
+
+                  if ( pAppendedTracks && ( wxNOT_FOUND == pAppendedTracks->Index ( pTrack ) ) )
+                        pAppendedTracks->Add ( pTrack );
+            }
+      }
+}
+
+
 int MyConfig::LoadMyConfig ( int iteration )
 {
 
@@ -2916,6 +4065,10 @@ int MyConfig::LoadMyConfig ( int iteration )
       if(mem_limit > 0)
             g_memCacheLimit = mem_limit * 1024;       // convert to MBytes
 
+      Read ( _T ( "RasterTileCacheLimit" ), &g_nRasterTileCacheLimit, RASTER_TILE_CACHE_LIMIT_DEFAULT );    // MBytes, 0 for no limit
+
+      Read ( _T ( "PrefetchCharts" ), &g_bPrefetchCharts, 0 );
+
       Read ( _T ( "DebugGDAL" ), &g_bGDAL_Debug, 0 );
       Read ( _T ( "DebugNMEA" ), &g_nNMEADebug, 0 );
       Read ( _T ( "DebugOpenGL" ), &g_bDebugOGL, 0 );
@@ -3731,123 +4884,83 @@ int MyConfig::LoadMyConfig ( int iteration )
 
             if ( ::wxFileExists ( m_sNavObjSetFile ) )
             {
-		      m_pNavObjectInputSet->LoadFile ( m_sNavObjSetFile );
-                  m_pNavObjectInputSet->LoadAllGPXObjects();
+                  //    Only if the file cannot be streamed, the DOM picks up after the objects already loaded
+                  int nloaded;
+                  if ( !NavObjectCollection::StreamLoadAllGPXObjects ( m_sNavObjSetFile, &nloaded ) )
+                  {
+                        wxLogMessage ( _T ( "Streamed load of navobj failed, loading through the DOM" ) );
+                        m_pNavObjectInputSet->LoadFile ( m_sNavObjSetFile );
+                        m_pNavObjectInputSet->LoadAllGPXObjects ( nloaded );
+                  }
             }
 
             m_pNavObjectInputSet->Clear();
             delete m_pNavObjectInputSet;
 
+            //    A journal left over means we crashed last time, replay the changes it kept.
+            //    The .changes file of earlier versions is replayed as it always was, by type.
+            bool b_replayed = false;
             if ( ::wxFileExists ( m_sNavObjSetChangesFile ) )
             {
-                  //We crashed last time :(
-                  //That's why this file still exists...
-                  //Let's reconstruct the unsaved changes
                   NavObjectCollection *pNavObjectChangesSet = new NavObjectCollection();
                   pNavObjectChangesSet->LoadFile ( m_sNavObjSetChangesFile );
-                  //reconstruct route changes
-                  TiXmlElement *gpx_element = pNavObjectChangesSet->RootElement()->FirstChildElement("rte");
-                  while (gpx_element)
+                  TiXmlElement *gpx_root = pNavObjectChangesSet->RootElement();
+                  const char *types[] = { "rte", "trk", "wpt" };
+                  for ( int itype = 0 ; gpx_root && ( itype < 3 ) ; itype++ )
                   {
-                        Route *pRt = ::LoadGPXRoute((GpxRteElement *)gpx_element, 0);
-                        wxString action = wxString::FromUTF8( gpx_element->FirstChildElement("extensions")->FirstChildElement("opencpn:action")->GetText());
-                        Route *pExisting = RouteExists( pRt->m_GUID );
-                        if (action == _T("add"))
+                        TiXmlElement *gpx_element = gpx_root->FirstChildElement ( types[itype] );
+                        while ( gpx_element )
                         {
-                              m_bIsImporting = true;
-                              ::InsertRoute(pRt, -1);
-                              m_bIsImporting = false;
+                              ReplayNavObjChange ( gpx_element );
+                              gpx_element = gpx_element->NextSiblingElement ( types[itype] );
                         }
-                        else if (action == _T("update"))
-                        {
-                              m_bIsImporting = true;
-                              ::UpdateRoute(pRt);
-                              m_bIsImporting = false;
-                        }
-                        else if (action == _T("delete"))
-                        {
-                              m_bIsImporting = true;
-                              if(pExisting)
-                              {
-                                    g_pRouteMan->DeleteRoute(pExisting);
-                              }
-                              m_bIsImporting = false;
-                        }
-                        gpx_element = gpx_element->NextSiblingElement("rte");
                   }
-                  //reconstruct tracks
-                  gpx_element = pNavObjectChangesSet->RootElement()->FirstChildElement("trk");
-                  while (gpx_element)
+                  delete pNavObjectChangesSet;
+                  b_replayed = true;
+            }
+
+            if ( m_pNavObjJournal->OpenReplay() )
+            {
+                  int nrecords = 0;
+                  wxArrayPtrVoid AppendedTracks;
+                  TiXmlElement *gpx_element;
+                  while ( ( gpx_element = m_pNavObjJournal->NextRecord() ) )
                   {
-                        Route *pTrk = ::LoadGPXTrack((GpxTrkElement *)gpx_element);
-                        wxString action = wxString::FromUTF8( gpx_element->FirstChildElement("extensions")->FirstChildElement("opencpn:action")->GetText());
-                        Route *pExisting = RouteExists( pTrk->m_GUID );
-                        //no adds here - the only possible way is logging the gps data
-                        if (action == _T("update"))
-                        {
-                              m_bIsImporting = true;
-                              if(pExisting)
-                              {
-                                    pExisting->m_RouteNameString = pTrk->m_RouteNameString;
-                                    pExisting->m_RouteStartString = pTrk->m_RouteStartString;
-                                    pExisting->m_RouteEndString = pTrk->m_RouteEndString;
-                              }
-                              m_bIsImporting = false;
-                        }
-                        else if (action == _T("delete"))
-                        {
-                              m_bIsImporting = true;
-                              if(pExisting)
-                              {
-                                    g_pRouteMan->DeleteTrack(pExisting);
-                              }
-                              m_bIsImporting = false;
-                        }
-                        gpx_element = gpx_element->NextSiblingElement("trk");
+                        ReplayNavObjChange ( gpx_element, &AppendedTracks );
+                        nrecords++;
                   }
-                  //reconstruct wpt changes
-                  gpx_element = pNavObjectChangesSet->RootElement()->FirstChildElement("wpt");
-                  while (gpx_element)
+                  m_pNavObjJournal->CloseReplay();
+
+                  wxString msg;
+                  msg.Printf ( _T ( "Replayed %d navobj journal records" ), nrecords );
+                  wxLogMessage ( msg );
+
+                  //    The logged fixes were added with deferred BBox calculation.
+                  //    Look the tracks up in the route list, a later record may have deleted one.
+                  wxRouteListNode *node = pRouteList->GetFirst();
+                  while ( node )
                   {
-                        RoutePoint *pWp = ::LoadGPXWaypoint((GpxWptElement *)gpx_element, g_default_wp_icon);
-                        wxString action = wxString::FromUTF8( gpx_element->FirstChildElement("extensions")->FirstChildElement("opencpn:action")->GetText());
-                        RoutePoint *pExisting = WaypointExists( pWp->m_GUID );
-                        if (action == wxString(_T("add")))
-                        {
-                              m_bIsImporting = true;
-                              if(!pExisting) //Should not be needed...
-                                    if ( NULL != pWayPointMan )
-                                          pWayPointMan->m_pWayPointList->Append ( pWp );
-                              pWp->m_bIsolatedMark = true;
-                              AddNewWayPoint ( pWp,m_NextWPNum );
-                              pSelect->AddSelectableRoutePoint ( pWp->m_lat, pWp->m_lon, pWp );
-                              m_bIsImporting = false;
-                        }
-                        else if (action == wxString(_T("update")))
-                        {
-                              m_bIsImporting = true;
-                              if(pExisting)
-                                    pWayPointMan->m_pWayPointList->DeleteObject(pExisting);
-                              pWayPointMan->m_pWayPointList->Append ( pWp );
-                              pWp->m_bIsolatedMark = true;
-                              AddNewWayPoint ( pWp,m_NextWPNum );
-                              pSelect->AddSelectableRoutePoint ( pWp->m_lat, pWp->m_lon, pWp );
-                              m_bIsImporting = false;
-                        }
-                        else if (action == wxString(_T("delete")))
+                        Route *pTrack = node->GetData();
+                        node = node->GetNext();
+                        if ( wxNOT_FOUND == AppendedTracks.Index ( pTrack ) )
+                              continue;
+
+                        m_bIsImporting = true;
+                        if ( pTrack->GetnPoints() < 2 )
+                              g_pRouteMan->DeleteRoute ( pTrack );
+                        else
                         {
-                              m_bIsImporting = true;
-                              if(pExisting)
-                              {
-                                    pWayPointMan->DestroyWaypoint(pExisting);
-                              }
-                              m_bIsImporting = false;
+                              pTrack->CalculateBBox();
+                              pSelect->DeleteAllSelectableTrackSegments ( pTrack );
+                              pSelect->AddAllSelectableTrackSegments ( pTrack );
                         }
-                        gpx_element = gpx_element->NextSiblingElement("wpt");
+                        m_bIsImporting = false;
                   }
-                  UpdateNavObj(); //We save the data before we throw away the log
-                  delete pNavObjectChangesSet;
+                  b_replayed = true;
             }
+
+            if ( b_replayed )
+                  UpdateNavObj(); //We save the data before we throw away the log
       }
 
       SetPath ( _T ( "/Settings/Others" ) );
@@ -4000,10 +5113,10 @@ bool MyConfig::AddNewRoute ( Route *pr, int crm )
       {
             GpxRteElement * rte = ::CreateGPXRte( pr );
             rte->SetSimpleExtension(wxString(_T("opencpn:action")), wxString(_T("add")));
-            GpxRootElement * rt = (GpxRootElement *) m_pNavObjectChangesSet->RootElement();
-            rt->AddRoute(rte);
-            StoreNavObjChanges();
+            StoreNavObjChange(rte);
       }
+      else
+            m_bNavObjDirty = true;            // saved by the next compaction
       return true;
 }
 
@@ -4018,10 +5131,10 @@ bool MyConfig::UpdateRoute ( Route *pr )
             {
                   GpxTrkElement * trk = ::CreateGPXTrk( pr );
                   trk->SetSimpleExtension(wxString(_T("opencpn:action")), wxString(_T("update")));
-                  GpxRootElement * rt = (GpxRootElement *) m_pNavObjectChangesSet->RootElement();
-                  rt->AddTrack(trk);
-                  StoreNavObjChanges();
+                  StoreNavObjChange(trk);
             }
+            else
+                  m_bNavObjDirty = true;            // saved by the next compaction
             return false;
       }
 
@@ -4037,10 +5150,10 @@ bool MyConfig::UpdateRoute ( Route *pr )
       {
             GpxRteElement * rte = ::CreateGPXRte( pr );
             rte->SetSimpleExtension(wxString(_T("opencpn:action")), wxString(_T("update")));
-            GpxRootElement * rt = (GpxRootElement *) m_pNavObjectChangesSet->RootElement();
-            rt->AddRoute(rte);
-            StoreNavObjChanges();
+            StoreNavObjChange(rte);
       }
+      else
+            m_bNavObjDirty = true;            // saved by the next compaction
 	return true;
 }
 
@@ -4065,19 +5178,17 @@ bool MyConfig::DeleteConfigRoute ( Route *pr )
             {
                   GpxRteElement * rte = ::CreateGPXRte( pr );
                   rte->SetSimpleExtension(wxString(_T("opencpn:action")), wxString(_T("delete")));
-                  GpxRootElement * rt = (GpxRootElement *) m_pNavObjectChangesSet->RootElement();
-                  rt->AddRoute(rte);
+                  StoreNavObjChange(rte);
             }
             else
             {
                   GpxTrkElement * trk = ::CreateGPXTrk( pr );
                   trk->SetSimpleExtension(wxString(_T("opencpn:action")), wxString(_T("delete")));
-                  GpxRootElement * rt = (GpxRootElement *) m_pNavObjectChangesSet->RootElement();
-                  rt->AddTrack(trk);
+                  StoreNavObjChange(trk);
             }
-
-            StoreNavObjChanges();
       }
+      else
+            m_bNavObjDirty = true;            // saved by the next compaction
       return true;
 }
 
@@ -4101,10 +5212,10 @@ bool MyConfig::AddNewWayPoint ( RoutePoint *pWP, int crm )
       {
             GpxWptElement * wpt = ::CreateGPXWpt( pWP, GPX_WPT_WAYPOINT );
             wpt->SetSimpleExtension(wxString(_T("opencpn:action")), wxString(_T("add")));
-            GpxRootElement * rt = (GpxRootElement *) m_pNavObjectChangesSet->RootElement();
-            rt->AddWaypoint(wpt);
-            StoreNavObjChanges();
+            StoreNavObjChange(wpt);
       }
+      else
+            m_bNavObjDirty = true;            // saved by the next compaction
       return true;
 }
 
@@ -4125,10 +5236,10 @@ bool MyConfig::UpdateWayPoint ( RoutePoint *pWP )
       {
             GpxWptElement * wpt = ::CreateGPXWpt( pWP, GPX_WPT_WAYPOINT );
             wpt->SetSimpleExtension(wxString(_T("opencpn:action")), wxString(_T("update")));
-            GpxRootElement * rt = (GpxRootElement *) m_pNavObjectChangesSet->RootElement();
-            rt->AddWaypoint(wpt);
-            StoreNavObjChanges();
+            StoreNavObjChange(wpt);
       }
+      else
+            m_bNavObjDirty = true;            // saved by the next compaction
 	return true;
 }
 
@@ -4151,10 +5262,10 @@ bool MyConfig::DeleteWayPoint ( RoutePoint *pWP )
       {
             GpxWptElement * wpt = ::CreateGPXWpt( pWP, GPX_WPT_WAYPOINT );
             wpt->SetSimpleExtension(wxString(_T("opencpn:action")), wxString(_T("delete")));
-            GpxRootElement * rt = (GpxRootElement *) m_pNavObjectChangesSet->RootElement();
-            rt->AddWaypoint(wpt);
-            StoreNavObjChanges();
+            StoreNavObjChange(wpt);
       }
+      else
+            m_bNavObjDirty = true;            // saved by the next compaction
       return true;
 }
 
@@ -4635,28 +5746,76 @@ void MyConfig::UpdateSettings()
 
 void MyConfig::UpdateNavObj(void)
 {
- //   Create the NavObjectCollection, and save to specified file
-      NavObjectCollection *pNavObjectSet = new NavObjectCollection (  );
+      //    Save to a temporary file and rename it over navobj.xml, so that a crash
+      //    part way through leaves the previous navobj.xml and the journal intact
+      wxString tmp_file = m_sNavObjSetFile + _T ( ".tmp" );
+
+      //    Write the objects out one at a time.
+      //    Only if that fails, create the NavObjectCollection, and save to specified file
+      bool bok = NavObjectCollection::StreamSaveAllGPXObjects ( tmp_file );
+      if ( !bok )
+      {
+            wxLogMessage ( _T ( "Streamed save of navobj failed, saving through the DOM" ) );
+
+            NavObjectCollection *pNavObjectSet = new NavObjectCollection (  );
+
+            pNavObjectSet->CreateNavObjGPXPoints();
+            pNavObjectSet->CreateNavObjGPXRoutes();
+            pNavObjectSet->CreateNavObjGPXTracks();
+
+            bok = pNavObjectSet->SaveFile( tmp_file );
 
-      pNavObjectSet->CreateNavObjGPXPoints();
-      pNavObjectSet->CreateNavObjGPXRoutes();
-      pNavObjectSet->CreateNavObjGPXTracks();
+            pNavObjectSet->Clear();
+            delete pNavObjectSet;
+      }
 
-	pNavObjectSet->SaveFile( m_sNavObjSetFile );
+      if ( !bok || !::wxRenameFile ( tmp_file, m_sNavObjSetFile ) )
+      {
+            wxLogMessage ( _T ( "Could not save navobj, the journal is kept" ) );
+            ::wxRemoveFile ( tmp_file );
+            m_bNavObjDirty = true;                    // try again on the next autosave tick
+            return;
+      }
 
-      pNavObjectSet->Clear();
-      delete pNavObjectSet;
+      if ( ::wxFileExists ( m_sNavObjSetChangesFile ) )
+            ::wxRemoveFile ( m_sNavObjSetChangesFile );
+      m_pNavObjJournal->Remove();
+      m_navobj_update_time = time ( NULL );
+      m_bNavObjDirty = false;
+}
 
-      ::wxRemoveFile(m_sNavObjSetChangesFile);
-      m_pNavObjectChangesSet->Clear();
-      delete m_pNavObjectChangesSet;
-      m_pNavObjectChangesSet = new NavObjectCollection();
+//    Called on the autosave tick, navobj.xml is rewritten when there are changes that did
+//    not go to the journal, once the journal has grown, or now and then regardless
+void MyConfig::CompactNavObj(void)
+{
+      if ( m_bNavObjDirty
+             || ( m_pNavObjJournal->GetSize() >= NAVOBJ_JOURNAL_COMPACT_SIZE )
+             || ( time ( NULL ) - m_navobj_update_time >= NAVOBJ_JOURNAL_COMPACT_SECONDS ) )
+            UpdateNavObj();
+}
 
+//    Record one change in the journal, the element is deleted
+void MyConfig::StoreNavObjChange(TiXmlElement *element)
+{
+      if ( !m_pNavObjJournal->Append ( element ) )
+      {
+            wxLogMessage ( _T ( "Could not append to the navobj journal, saving navobj" ) );
+            UpdateNavObj();
+      }
+      delete element;
 }
 
-void MyConfig::StoreNavObjChanges(void)
+void MyConfig::StoreTrackFix(Route *pTrack, double lat, double lon, time_t fix_time)
 {
-      m_pNavObjectChangesSet->SaveFile( m_sNavObjSetChangesFile );
+      GpxExtensionsElement *exts = new GpxExtensionsElement();
+      exts->LinkEndChild(new GpxSimpleElement(wxString(_T("opencpn:action")), wxString(_T("append"))));
+      exts->LinkEndChild(new GpxSimpleElement(wxString(_T("opencpn:track")), pTrack->m_GUID));
+
+      wxDateTime fix_dt ( fix_time );                 // as MaterializeFixes() will time it
+      GpxWptElement *trkpt = new GpxWptElement ( GPX_WPT_TRACKPOINT, lat, lon, 0, &fix_dt, 0, -1,
+                  GPX_EMPTY_STRING, GPX_EMPTY_STRING, GPX_EMPTY_STRING, GPX_EMPTY_STRING, NULL, GPX_EMPTY_STRING,
+                  GPX_EMPTY_STRING, fix_undefined, -1, -1, -1, -1, -1, -1, exts );
+      StoreNavObjChange(trkpt);
 }
 
 bool MyConfig::ExportGPXRoute ( wxWindow* parent, Route *pRoute )
@@ -4913,7 +6072,8 @@ GpxRteElement *CreateGPXRte ( Route *pRoute )
       return rte;
 }
 
-GpxTrkElement *CreateGPXTrk ( Route *pRoute )
+//    With a writer, the track is written out one point at a time and NULL is returned
+GpxTrkElement *CreateGPXTrk ( Route *pRoute, GpxStreamWriter *pWriter )
 {
       GpxExtensionsElement *exts = new GpxExtensionsElement();
       exts->LinkEndChild(new GpxSimpleElement(wxString(_T("opencpn:start")), pRoute->m_RouteStartString));
@@ -4937,24 +6097,42 @@ GpxTrkElement *CreateGPXTrk ( Route *pRoute )
       }
 
       GpxTrkElement *trk = new GpxTrkElement(pRoute->m_RouteNameString, GPX_EMPTY_STRING, GPX_EMPTY_STRING, GPX_EMPTY_STRING, NULL, -1, GPX_EMPTY_STRING, exts, NULL);
+      if ( pWriter )
+            pWriter->BeginElement ( trk );
 
       RoutePointList *pRoutePointList = pRoute->pRoutePointList;
       wxRoutePointListNode *node2 = pRoutePointList->GetFirst();
       RoutePoint *prp;
 
       unsigned short int GPXTrkSegNo1 = 1;
+      GpxTrksegElement *trkseg = NULL;
 
       do {
             unsigned short int GPXTrkSegNo2 = GPXTrkSegNo1;
-            GpxTrksegElement *trkseg = new GpxTrksegElement();
-            trk->AppendTrkSegment(trkseg);
+            if ( pWriter && trkseg )
+            {
+                  pWriter->EndElement();
+                  delete trkseg;
+            }
+            trkseg = new GpxTrksegElement();
+            if ( pWriter )
+                  pWriter->BeginElement ( trkseg );
+            else
+                  trk->AppendTrkSegment(trkseg);
 
             int i=1;
             while ( node2 && (GPXTrkSegNo2 == GPXTrkSegNo1))
             {
                   prp = node2->GetData();
 //                  trkseg->AppendTrkPoint(::CreateGPXWpt ( prp, GPX_WPT_TRACKPOINT, true));
-                  trkseg->AppendTrkPoint(::CreateGPXWpt ( prp, GPX_WPT_TRACKPOINT, true, true));
+                  GpxWptElement *trkpt = ::CreateGPXWpt ( prp, GPX_WPT_TRACKPOINT, true, true);
+                  if ( pWriter )
+                  {
+                        pWriter->WriteElement ( trkpt );
+                        delete trkpt;
+                  }
+                  else
+                        trkseg->AppendTrkPoint(trkpt);
                   node2=node2->GetNext();
                   if (node2) {
                         prp = node2->GetData();
@@ -4965,6 +6143,43 @@ GpxTrkElement *CreateGPXTrk ( Route *pRoute )
             GPXTrkSegNo1 = GPXTrkSegNo2;
       } while (node2);
 
+      //    The running track's fixes not yet materialised as RoutePoints,
+      //    written as MaterializeFixes() would have named them
+      if ( pRoute == g_pActiveTrack )
+      {
+            TrackPointStore *pfixes = g_pActiveTrack->GetFixStore();
+            int np = pRoute->GetnPoints();
+            for ( int i = 0 ; i < pfixes->GetCount() ; i++ )
+            {
+                  double lat, lon;
+                  time_t fix_time;
+                  pfixes->GetFix ( i, &lat, &lon, &fix_time );
+
+                  wxDateTime fix_dt ( fix_time );
+                  wxString name;
+                  name.Printf ( _T ( "%03d" ), np + i + 1 );
+
+                  GpxWptElement *trkpt = new GpxWptElement ( GPX_WPT_TRACKPOINT, lat, lon, 0, &fix_dt, 0, -1, name,
+                                         GPX_EMPTY_STRING, GPX_EMPTY_STRING, GPX_EMPTY_STRING, NULL, _T ( "empty" ) );
+                  if ( pWriter )
+                  {
+                        pWriter->WriteElement ( trkpt );
+                        delete trkpt;
+                  }
+                  else
+                        trkseg->AppendTrkPoint(trkpt);
+            }
+      }
+
+      if ( pWriter )
+      {
+            pWriter->EndElement();                    // trkseg
+            pWriter->EndElement();                    // trk
+            delete trkseg;
+            delete trk;
+            return NULL;
+      }
+
       return trk;
 }
 
@@ -5051,71 +6266,45 @@ void MyConfig::ImportGPX ( wxWindow* parent, bool islayer, wxString dirpath, boo
                     //gpxmsg.Printf(wxT("Reading layer file %d: %s"), i, path.c_str());
                     //wxLogMessage(gpxmsg);
 
-                        GpxDocument *pXMLNavObj = new GpxDocument();
-				if ( pXMLNavObj->LoadFile ( path ) )
+                        //    Stream the file in one object at a time.
+                        //    Only if that fails, the DOM picks up after the objects already loaded.
+                        int nloaded;
+                        if ( !ImportGPXStream ( path, l, &nloaded ) )
                         {
-					TiXmlElement *root = pXMLNavObj->RootElement();
+                              wxLogMessage ( _T ( "Streamed import failed, loading through the DOM: " ) + path );
 
-					wxString RootName = wxString::FromUTF8( root->Value() );
-                              if ( RootName == _T ( "gpx" ) )
+                              GpxDocument *pXMLNavObj = new GpxDocument();
+                              if ( pXMLNavObj->LoadFile ( path ) )
                               {
-                                    //wxString RootContent = root->GetNodeContent();
+                                    TiXmlElement *root = pXMLNavObj->RootElement();
 
-                                    TiXmlNode *child;
-                                    for ( child = root->FirstChild(); child != 0; child = child->NextSibling())
+                                    wxString RootName = wxString::FromUTF8( root->Value() );
+                                    if ( RootName == _T ( "gpx" ) )
                                     {
-                                           wxString ChildName = wxString::FromUTF8( child->Value());
-                                          if ( ChildName == _T ( "wpt" ) )
+                                          TiXmlNode *child;
+                                          for ( child = root->FirstChild(); child != 0; child = child->NextSibling())
                                           {
-                                                RoutePoint *pWp = ::LoadGPXWaypoint((GpxWptElement *)child, _T("circle"), true);          // Full Viz
-                                                RoutePoint *pExisting = WaypointExists( pWp->GetName(), pWp->m_lat, pWp->m_lon);
-                                                if(!pExisting)
+                                                if ( nloaded && child->ToElement() )
                                                 {
-                                                      if (WaypointExists(pWp->m_GUID)) //We try to import a waypoint with the same guid but different properties, so we assign it a new guid to keep them both
-                                                            pWp->m_GUID = pWayPointMan->CreateGUID ( pWp );
-
-                                                      if ( NULL != pWayPointMan )
-                                                            pWayPointMan->m_pWayPointList->Append ( pWp );
-
-                                                      pWp->m_bIsolatedMark = true;      // This is an isolated mark
-                                                      pWp->m_bIsInLayer = g_bIsNewLayer;
-                                                      AddNewWayPoint ( pWp,m_NextWPNum );   // use auto next num
-                                                      if (g_bIsNewLayer) {
-                                                            pWp->m_LayerID = g_LayerIdx;
-                                                            pWp->m_bIsVisible = g_bLayerViz;
-                                                      }
-                                                      else
-                                                            pWp->m_LayerID = 0;
-                                                      pSelect->AddSelectableRoutePoint ( pWp->m_lat, pWp->m_lon, pWp );
-                                                      pWp->m_ConfigWPNum = m_NextWPNum;
-                                                      m_NextWPNum++;
+                                                      nloaded--;
+                                                      continue;
                                                 }
-                                                if (islayer)
-                                                      l->m_NoOfItems++;
-                                          }
-                                          else if ( ChildName == _T ( "rte" ) )
-                                          {
-                                                ::GPXLoadRoute ( (GpxRteElement *)child, m_NextRouteNum, true );        // Full visibility
-                                                m_NextRouteNum++;
-                                                if (islayer)
-                                                      l->m_NoOfItems++;
-                                          }
-                                          else if ( ChildName == _T ( "trk" ) )
-                                          {
-                                                ::GPXLoadTrack ( (GpxTrkElement *)child, true );                        // Full visibility
-                                                if (islayer)
-                                                      l->m_NoOfItems++;
+                                                ImportGPXElement ( child, l );
                                           }
                                     }
                               }
+                              pXMLNavObj->Clear();
+                              delete pXMLNavObj;
                         }
-                        pXMLNavObj->Clear();
-                        delete pXMLNavObj;
                   }
             }
       }
       m_bIsImporting = false;
       g_bIsNewLayer = false;
+
+      //    Imported objects are not journaled, they go to navobj.xml in one write
+      if ( ( response == wxID_OK ) && !islayer )
+            UpdateNavObj();
 }
 
 //-------------------------------------------------------------------------
@@ -5905,31 +7094,227 @@ RoutePoint *LoadGPXWaypoint (GpxWptElement *wptnode, wxString def_symbol_name, b
       else if(b_fullviz)
             pWP->m_bShowName = true;
       else
-            pWP->m_bShowName = false;
+            pWP->m_bShowName = false;
+
+      if(b_propviz)
+            pWP->m_bIsVisible = bviz;
+      else if(b_fullviz)
+            pWP->m_bIsVisible = true;
+
+      pWP->m_bKeepXRoute = bshared;
+      pWP->m_bDynamicName = bauto_name;
+
+      if ( dt.IsValid() )
+            pWP->m_CreateTime = dt;
+      else
+            pWP->m_CreateTime = wxInvalidDateTime;
+
+      if(linklist)
+      {
+            delete pWP->m_HyperlinkList;                    // created in RoutePoint ctor
+            pWP->m_HyperlinkList = linklist;
+      }
+
+      return ( pWP );
+}
+
+
+//    The children of <trk> other than its segments
+static void GPXLoadTrackProperty ( Track *pTentTrack, TiXmlNode *tschild, wxString &RouteName, bool &b_propviz, bool &b_viz )
+{
+      wxString ChildName = wxString::FromUTF8(tschild->Value());
+      if ( ChildName == _T ( "name" ) )
+      {
+            TiXmlNode *child1 = tschild->FirstChild();
+            if( child1 )                                    // name will always be in first child??
+                  RouteName = wxString::FromUTF8 ( child1->ToText()->Value() );
+      }
+
+      else if ( ChildName == _T ( "extensions" ) )
+      {
+            TiXmlNode *ext_child;
+            for ( ext_child = tschild->FirstChild(); ext_child != 0; ext_child = ext_child->NextSibling())
+            {
+                  wxString ext_name = wxString::FromUTF8 ( ext_child->Value() );
+                  if ( ext_name == _T ( "opencpn:start" ) )
+                  {
+								    TiXmlNode *s_child = ext_child->FirstChild();
+                        if ( s_child != NULL )
+                              pTentTrack->m_RouteStartString = wxString::FromUTF8( s_child->ToText()->Value() );
+                  }
+                  else if ( ext_name == _T ( "opencpn:end" ) )
+                  {
+                        TiXmlNode *e_child = ext_child->FirstChild();
+                        if ( e_child != NULL )
+                              pTentTrack->m_RouteEndString = wxString::FromUTF8 ( e_child->ToText()->Value() );
+                  }
+
+                  else if ( ext_name == _T ( "opencpn:viz" ) )
+                  {
+                        TiXmlNode *v_child = ext_child->FirstChild();
+                        if ( v_child != NULL )
+                        {
+                              b_propviz = true;
+                              wxString viz = wxString::FromUTF8 ( v_child->ToText()->Value() );
+                              b_viz = (viz == _T("1"));
+                        }
+                  }
+                  else if ( ext_name == _T ( "opencpn:style" ) )
+                  {
+                        TiXmlAttribute * attr;
+                        for ( attr = ((TiXmlElement*)ext_child)->FirstAttribute(); attr != 0; attr = attr->Next())
+                        {
+                              if (attr)
+                              {
+                                    if (strcmp(attr->Name(), "style") == 0)
+                                          pTentTrack->m_style = atoi(attr->Value());
+                                    else if (strcmp(attr->Name(), "width") == 0)
+                                          pTentTrack->m_width = atoi(attr->Value());
+                              }
+                        }
+
+
+                  }
+                  else if ( ext_name == _T ( "opencpn:guid" ) )
+                  {
+						TiXmlNode *g_child = ext_child->FirstChild();
+                        if ( g_child != NULL && (!g_bIsNewLayer))
+                              pTentTrack->m_GUID = wxString::FromUTF8 ( g_child->ToText()->Value() );
+                  }
+                  else if ( ext_name.EndsWith ( _T ( "TrackExtension" ) ) ) //Parse GPXX color
+                  {
+                        TiXmlNode *gpxx_child;
+					      for ( gpxx_child = ext_child->FirstChild(); gpxx_child != 0; gpxx_child = gpxx_child->NextSibling())
+                        {
+                              wxString gpxx_name = wxString::FromUTF8 ( gpxx_child->Value() );
+                              if ( gpxx_name.EndsWith ( _T ( "DisplayColor" ) ) )
+                              {
+                                    TiXmlNode *s_child = gpxx_child->FirstChild();
+                                    if ( s_child != NULL )
+					                        pTentTrack->m_Colour = wxString::FromUTF8 ( s_child->ToText()->Value() );
+                              }
+                        }
+                  }
+            }
+      }
+}
+
+static void GPXLoadTrackPoint ( Track *pTentTrack, GpxWptElement *tpnode, unsigned short int GPXSeg )
+{
+      RoutePoint *pWp = ::LoadGPXWaypoint ( tpnode, _T("empty"), false/*b_fullviz*/ );
+      pTentTrack->AddPoint ( pWp, false, true );            // defer BBox calculation
+      pWp->m_bIsInRoute = false;                      // Hack
+      pWp->m_bIsInTrack = true;
+      pWp->m_GPXTrkSegNo = GPXSeg;
+      pWayPointMan->m_pWayPointList->Append ( pWp );
+}
+
+//    Add a loaded track to the route list, unless it duplicates one already there
+static void GPXAddTentativeTrack ( Track *pTentTrack, bool bAddtrack, bool b_propviz, bool b_viz, bool b_fullviz )
+{
+      //    Search for an identical route/track already in place.  If found, discard this one
+
+      wxRouteListNode *route_node = pRouteList->GetFirst();
+      while ( route_node )
+      {
+            Route *proute = route_node->GetData();
+
+            if ( proute->IsEqualTo ( pTentTrack ) )
+            {
+                  if(proute->m_bIsTrack)
+                  {
+                        bAddtrack = false;
+                        break;
+                  }
+            }
+            route_node = route_node->GetNext();                         // next route
+      }
+
+      //    If the track has only 1 point, don't load it.
+      //    This usually occurs if some points were dscarded above as being co-incident.
+      if(pTentTrack->GetnPoints() < 2)
+            bAddtrack = false;
+
+//    TODO  All this trouble for a tentative route.......Should make some Route methods????
+      if ( bAddtrack )
+      {
+            if (::RouteExists(pTentTrack->m_GUID)) { //We are importing a different route with the same guid, so let's generate it a new guid
+                  pTentTrack->m_GUID = pWayPointMan->CreateGUID ( NULL );
+                  //Now also change guids for the routepoints
+                  wxRoutePointListNode *pthisnode = ( pTentTrack->pRoutePointList )->GetFirst();
+                  while ( pthisnode )
+                  {
+                        pthisnode->GetData()->m_GUID = pWayPointMan->CreateGUID ( NULL );
+                        pthisnode = pthisnode->GetNext();
+                        //FIXME: !!!!!! the shared waypoint gets part of both the routes -> not  goood at all
+                  }
+            }
+            pRouteList->Append ( pTentTrack );
+
+            if (g_bIsNewLayer)
+                  pTentTrack->SetVisible(g_bLayerViz);
+            else
+            if(b_propviz)
+                  pTentTrack->SetVisible(b_viz);
+            else if(b_fullviz)
+                  pTentTrack->SetVisible();
+
+            //    Do the (deferred) calculation of Track BBox
+            pTentTrack->CalculateBBox();
+
+            //    Add the selectable points and segments
+
+            int ip = 0;
+            float prev_rlat = 0., prev_rlon = 0.;
+            RoutePoint *prev_pConfPoint = NULL;
+
+            wxRoutePointListNode *node = pTentTrack->pRoutePointList->GetFirst();
+            while ( node )
+            {
+
+                  RoutePoint *prp = node->GetData();
+
+                  if ( ip )
+                        pSelect->AddSelectableTrackSegment ( prev_rlat, prev_rlon, prp->m_lat, prp->m_lon,prev_pConfPoint, prp, pTentTrack );
+
+                  prev_rlat = prp->m_lat;
+                  prev_rlon = prp->m_lon;
+                  prev_pConfPoint = prp;
+
+                  ip++;
+
+                  node = node->GetNext();
+            }
+      }
+      else
+      {
 
-      if(b_propviz)
-            pWP->m_bIsVisible = bviz;
-      else if(b_fullviz)
-            pWP->m_bIsVisible = true;
+            // walk the route, deleting points used only by this route
+            wxRoutePointListNode *pnode = ( pTentTrack->pRoutePointList )->GetFirst();
+            while ( pnode )
+            {
+                  RoutePoint *prp = pnode->GetData();
 
-      pWP->m_bKeepXRoute = bshared;
-      pWP->m_bDynamicName = bauto_name;
+                  // check all other routes to see if this point appears in any other route
+                  Route *pcontainer_route = g_pRouteMan->FindRouteContainingWaypoint ( prp );
 
-      if ( dt.IsValid() )
-            pWP->m_CreateTime = dt;
-      else
-            pWP->m_CreateTime = wxInvalidDateTime;
+                  if ( pcontainer_route == NULL )
+                  {
+                        prp->m_bIsInRoute = false;          // Take this point out of this (and only) track/route
+                        if ( !prp->m_bKeepXRoute )
+                        {
+                              pConfig->DeleteWayPoint ( prp );
+                              delete prp;
+                        }
+                  }
 
-      if(linklist)
-      {
-            delete pWP->m_HyperlinkList;                    // created in RoutePoint ctor
-            pWP->m_HyperlinkList = linklist;
-      }
+                  pnode = pnode->GetNext();
+            }
 
-      return ( pWP );
+            delete pTentTrack;
+      }
 }
 
-
 void GPXLoadTrack ( GpxTrkElement* trknode, bool b_fullviz )
 {
 //    CALLGRIND_START_INSTRUMENTATION
@@ -5949,8 +7334,6 @@ void GPXLoadTrack ( GpxTrkElement* trknode, bool b_fullviz )
 
 		TiXmlNode *tschild;
 
-            RoutePoint *pWp = NULL;
-
             for ( tschild = trknode->FirstChild(); tschild != 0; tschild = tschild->NextSibling())
             {
                   wxString ChildName = wxString::FromUTF8(tschild->Value());
@@ -5964,200 +7347,70 @@ void GPXLoadTrack ( GpxTrkElement* trknode, bool b_fullviz )
                         {
                               wxString tpChildName = wxString::FromUTF8(tpchild->Value());
                               if(tpChildName == _T("trkpt"))
-                              {
-                                    pWp = ::LoadGPXWaypoint ( (GpxWptElement *)tpchild, _T("empty"), false/*b_fullviz*/ );
-						pTentTrack->AddPoint ( pWp, false, true );            // defer BBox calculation
-                                    pWp->m_bIsInRoute = false;                      // Hack
-                                    pWp->m_bIsInTrack = true;
-                                    pWp->m_GPXTrkSegNo = GPXSeg;
-                                    pWayPointMan->m_pWayPointList->Append ( pWp );
-                               }
-                        }
-                  }
-                  else if ( ChildName == _T ( "name" ) )
-                  {
-                        TiXmlNode *child1 = tschild->FirstChild();
-                        if( child1 )                                    // name will always be in first child??
-                              RouteName = wxString::FromUTF8 ( child1->ToText()->Value() );
-                  }
-
-                  else if ( ChildName == _T ( "extensions" ) )
-                  {
-                        TiXmlNode *ext_child;
-                        for ( ext_child = tschild->FirstChild(); ext_child != 0; ext_child = ext_child->NextSibling())
-                        {
-                              wxString ext_name = wxString::FromUTF8 ( ext_child->Value() );
-                              if ( ext_name == _T ( "opencpn:start" ) )
-                              {
-								    TiXmlNode *s_child = ext_child->FirstChild();
-                                    if ( s_child != NULL )
-                                          pTentTrack->m_RouteStartString = wxString::FromUTF8( s_child->ToText()->Value() );
-                              }
-                              else if ( ext_name == _T ( "opencpn:end" ) )
-                              {
-                                    TiXmlNode *e_child = ext_child->FirstChild();
-                                    if ( e_child != NULL )
-                                          pTentTrack->m_RouteEndString = wxString::FromUTF8 ( e_child->ToText()->Value() );
-                              }
-
-                              else if ( ext_name == _T ( "opencpn:viz" ) )
-                              {
-                                    TiXmlNode *v_child = ext_child->FirstChild();
-                                    if ( v_child != NULL )
-                                    {
-                                          b_propviz = true;
-                                          wxString viz = wxString::FromUTF8 ( v_child->ToText()->Value() );
-                                          b_viz = (viz == _T("1"));
-                                    }
-                              }
-                              else if ( ext_name == _T ( "opencpn:style" ) )
-                              {
-                                    TiXmlAttribute * attr;
-                                    for ( attr = ((TiXmlElement*)ext_child)->FirstAttribute(); attr != 0; attr = attr->Next())
-                                    {
-                                          if (attr)
-                                          {
-                                                if (strcmp(attr->Name(), "style") == 0)
-                                                      pTentTrack->m_style = atoi(attr->Value());
-                                                else if (strcmp(attr->Name(), "width") == 0)
-                                                      pTentTrack->m_width = atoi(attr->Value());
-                                          }
-                                    }
-
-
-                              }
-                              else if ( ext_name == _T ( "opencpn:guid" ) )
-                              {
-						TiXmlNode *g_child = ext_child->FirstChild();
-                                    if ( g_child != NULL && (!g_bIsNewLayer))
-                                          pTentTrack->m_GUID = wxString::FromUTF8 ( g_child->ToText()->Value() );
-                              }
-                              else if ( ext_name.EndsWith ( _T ( "TrackExtension" ) ) ) //Parse GPXX color
-                              {
-                                    TiXmlNode *gpxx_child;
-					      for ( gpxx_child = ext_child->FirstChild(); gpxx_child != 0; gpxx_child = gpxx_child->NextSibling())
-                                    {
-                                          wxString gpxx_name = wxString::FromUTF8 ( gpxx_child->Value() );
-                                          if ( gpxx_name.EndsWith ( _T ( "DisplayColor" ) ) )
-                                          {
-                                                TiXmlNode *s_child = gpxx_child->FirstChild();
-                                                if ( s_child != NULL )
-					                        pTentTrack->m_Colour = wxString::FromUTF8 ( s_child->ToText()->Value() );
-                                          }
-                                    }
-                              }
+                                    GPXLoadTrackPoint ( pTentTrack, (GpxWptElement *)tpchild, GPXSeg );
                         }
                   }
+                  else
+                        GPXLoadTrackProperty ( pTentTrack, tschild, RouteName, b_propviz, b_viz );
             }
 
             pTentTrack->m_RouteNameString = RouteName;
 
-            //    Search for an identical route/track already in place.  If found, discard this one
-
-            bool  bAddtrack = true;
-            wxRouteListNode *route_node = pRouteList->GetFirst();
-            while ( route_node )
-            {
-                  Route *proute = route_node->GetData();
-
-                  if ( proute->IsEqualTo ( pTentTrack ) )
-                  {
-                        if(proute->m_bIsTrack)
-                        {
-                              bAddtrack = false;
-                              break;
-                        }
-                  }
-                  route_node = route_node->GetNext();                         // next route
-            }
-
-            //    If the track has only 1 point, don't load it.
-            //    This usually occurs if some points were dscarded above as being co-incident.
-            if(pTentTrack->GetnPoints() < 2)
-                  bAddtrack = false;
-
-//    TODO  All this trouble for a tentative route.......Should make some Route methods????
-            if ( bAddtrack )
-            {
-                  if (::RouteExists(pTentTrack->m_GUID)) { //We are importing a different route with the same guid, so let's generate it a new guid
-                        pTentTrack->m_GUID = pWayPointMan->CreateGUID ( NULL );
-                        //Now also change guids for the routepoints
-                        wxRoutePointListNode *pthisnode = ( pTentTrack->pRoutePointList )->GetFirst();
-                        while ( pthisnode )
-                        {
-                              pthisnode->GetData()->m_GUID = pWayPointMan->CreateGUID ( NULL );
-                              pthisnode = pthisnode->GetNext();
-                              //FIXME: !!!!!! the shared waypoint gets part of both the routes -> not  goood at all
-                        }
-                  }
-                  pRouteList->Append ( pTentTrack );
-
-                  if (g_bIsNewLayer)
-                        pTentTrack->SetVisible(g_bLayerViz);
-                  else
-                  if(b_propviz)
-                        pTentTrack->SetVisible(b_viz);
-                  else if(b_fullviz)
-                        pTentTrack->SetVisible();
-
-                  //    Do the (deferred) calculation of Track BBox
-                  pTentTrack->CalculateBBox();
-
-                  //    Add the selectable points and segments
+            GPXAddTentativeTrack ( pTentTrack, true, b_propviz, b_viz, b_fullviz );
+      }
 
-                  int ip = 0;
-                  float prev_rlat = 0., prev_rlon = 0.;
-                  RoutePoint *prev_pConfPoint = NULL;
+ //   CALLGRIND_STOP_INSTRUMENTATION
 
-                  wxRoutePointListNode *node = pTentTrack->pRoutePointList->GetFirst();
-                  while ( node )
-                  {
+}
 
-                        RoutePoint *prp = node->GetData();
+//    As GPXLoadTrack(), with the reader positioned at a <trk>.
+//    The track is built one point at a time, never held as a whole element.
+void GPXStreamLoadTrack ( GpxStreamReader &reader, bool b_fullviz )
+{
+      wxString RouteName;
+      unsigned short int GPXSeg = 0;
 
-                        if ( ip )
-                              pSelect->AddSelectableTrackSegment ( prev_rlat, prev_rlon, prp->m_lat, prp->m_lon,prev_pConfPoint, prp, pTentTrack );
+      bool b_propviz = false;
+      bool b_viz = true;
 
-                        prev_rlat = prp->m_lat;
-                        prev_rlon = prp->m_lon;
-                        prev_pConfPoint = prp;
+      if ( !reader.EnterChild() )
+            return;
 
-                        ip++;
+      Track *pTentTrack = new Track();
 
-                        node = node->GetNext();
-                  }
-            }
-            else
+      wxString ChildName;
+      while ( reader.NextChild ( ChildName ) )
+      {
+            if ( ChildName == _T ( "trkseg" ) )
             {
+                  GPXSeg += 1;
+                  reader.EnterChild();
 
-                  // walk the route, deleting points used only by this route
-                  wxRoutePointListNode *pnode = ( pTentTrack->pRoutePointList )->GetFirst();
-                  while ( pnode )
+                  wxString tpChildName;
+                  while ( reader.NextChild ( tpChildName ) )
                   {
-                        RoutePoint *prp = pnode->GetData();
-
-                        // check all other routes to see if this point appears in any other route
-                        Route *pcontainer_route = g_pRouteMan->FindRouteContainingWaypoint ( prp );
-
-                        if ( pcontainer_route == NULL )
+                        if ( tpChildName == _T ( "trkpt" ) )
                         {
-                              prp->m_bIsInRoute = false;          // Take this point out of this (and only) track/route
-                              if ( !prp->m_bKeepXRoute )
-                              {
-                                    pConfig->DeleteWayPoint ( prp );
-                                    delete prp;
-                              }
+                              TiXmlElement *tpchild = reader.ReadChild();
+                              if ( tpchild )
+                                    GPXLoadTrackPoint ( pTentTrack, (GpxWptElement *)tpchild, GPXSeg );
                         }
-
-                        pnode = pnode->GetNext();
+                        else
+                              reader.SkipChild();
                   }
-
-                  delete pTentTrack;
+            }
+            else
+            {
+                  TiXmlElement *tschild = reader.ReadChild();
+                  if ( tschild )
+                        GPXLoadTrackProperty ( pTentTrack, tschild, RouteName, b_propviz, b_viz );
             }
       }
 
- //   CALLGRIND_STOP_INSTRUMENTATION
+      pTentTrack->m_RouteNameString = RouteName;
 
+      //    A track cut short by a read error is dropped, the caller reloads the file by DOM
+      GPXAddTentativeTrack ( pTentTrack, !reader.HasError(), b_propviz, b_viz, b_fullviz );
 }
 
 Route *LoadGPXTrack (GpxTrkElement *trknode, bool b_fullviz)
@@ -6404,6 +7657,7 @@ void UpdateRoute(Route *pTentRoute)
                         ex_rp->m_IconName = prp->m_IconName;
                         ex_rp->m_MarkDescription = prp->m_MarkDescription;
                         ex_rp->SetName(prp->GetName());
+                        rt->IncModifyCount();
                   }
                   else
                   {
@@ -6582,7 +7836,35 @@ bool NavObjectCollection::CreateNavObjGPXTracks ( void )
       return true;
 }
 
-bool NavObjectCollection::LoadAllGPXObjects()
+//    One child of the <gpx> root of the navobj file
+static void LoadNavObjGPXElement ( TiXmlNode *child )
+{
+      wxString ChildName = wxString::FromUTF8( child->Value());
+      if ( ChildName == _T ( "trk" ) )
+            ::GPXLoadTrack ( (GpxTrkElement *)child );
+      else if ( ChildName == _T ( "rte" ) )
+      {
+            int m_NextRouteNum = 0; //FIXME: we do not need it for GPX
+            ::GPXLoadRoute ( (GpxRteElement *)child, m_NextRouteNum );
+      }
+      else if ( ChildName == _T ( "wpt" ) )
+      {
+            int m_NextWPNum = 0; //FIXME: we do not need it for GPX
+            RoutePoint *pWp = ::LoadGPXWaypoint((GpxWptElement *)child, _T("circle"));
+            RoutePoint *pExisting = WaypointExists( pWp->GetName(), pWp->m_lat, pWp->m_lon);
+            if(!pExisting)
+            {
+                  if ( NULL != pWayPointMan )
+                        pWayPointMan->m_pWayPointList->Append ( pWp );
+                  pWp->m_bIsolatedMark = true;      // This is an isolated mark
+                  pSelect->AddSelectableRoutePoint ( pWp->m_lat, pWp->m_lon, pWp );
+                  pWp->m_ConfigWPNum = m_NextWPNum;
+                  m_NextWPNum++;
+            }
+      }
+}
+
+bool NavObjectCollection::LoadAllGPXObjects( int nskip )
 {
       //FIXME: unite with MyConfig::ImportGPX
 	TiXmlNode *root = RootElement();
@@ -6593,35 +7875,251 @@ bool NavObjectCollection::LoadAllGPXObjects()
             TiXmlNode *child;
             for ( child = root->FirstChild(); child != 0; child = child->NextSibling())
             {
-		      wxString ChildName = wxString::FromUTF8( child->Value());
-                  if ( ChildName == _T ( "trk" ) )
-                        ::GPXLoadTrack ( (GpxTrkElement *)child );
-                  else if ( ChildName == _T ( "rte" ) )
+                  if ( nskip && child->ToElement() )
                   {
-                        int m_NextRouteNum = 0; //FIXME: we do not need it for GPX
-                        ::GPXLoadRoute ( (GpxRteElement *)child, m_NextRouteNum );
-			}
-			else if ( ChildName == _T ( "wpt" ) )
-                  {
-			      int m_NextWPNum = 0; //FIXME: we do not need it for GPX
-                        RoutePoint *pWp = ::LoadGPXWaypoint((GpxWptElement *)child, _T("circle"));
-                        RoutePoint *pExisting = WaypointExists( pWp->GetName(), pWp->m_lat, pWp->m_lon);
-                        if(!pExisting)
-                        {
-                              if ( NULL != pWayPointMan )
-                                    pWayPointMan->m_pWayPointList->Append ( pWp );
-                              pWp->m_bIsolatedMark = true;      // This is an isolated mark
-                              pSelect->AddSelectableRoutePoint ( pWp->m_lat, pWp->m_lon, pWp );
-                              pWp->m_ConfigWPNum = m_NextWPNum;
-                              m_NextWPNum++;
-                        }
-			}
+                        nskip--;
+                        continue;
+                  }
+                  LoadNavObjGPXElement ( child );
             }
       }
 
       return true;
 }
 
+bool NavObjectCollection::StreamLoadAllGPXObjects ( const wxString &filename, int *pnloaded )
+{
+      *pnloaded = 0;
+
+      GpxStreamReader reader;
+      if ( !reader.Open ( filename ) )
+            return false;
+
+      wxString RootName;
+      if ( reader.NextChild ( RootName ) && ( RootName == _T ( "gpx" ) ) && reader.EnterChild() )
+      {
+            wxString ChildName;
+            while ( reader.NextChild ( ChildName ) )
+            {
+                  if ( ChildName == _T ( "trk" ) )
+                        ::GPXStreamLoadTrack ( reader );
+                  else
+                  {
+                        TiXmlElement *child = reader.ReadChild();
+                        if ( child )
+                              LoadNavObjGPXElement ( child );
+                  }
+
+                  if ( !reader.HasError() )
+                        ( *pnloaded )++;
+            }
+      }
+
+      return !reader.HasError();
+}
+
+bool NavObjectCollection::StreamSaveAllGPXObjects ( const wxString &filename )
+{
+      GpxStreamWriter writer;
+      if ( !writer.Open ( filename ) )
+            return false;
+
+      //    The same objects, in the same order, as CreateNavObjGPXPoints(), ...Routes() and ...Tracks()
+      wxRoutePointListNode *node = pWayPointMan->m_pWayPointList->GetFirst();
+      while ( node )
+      {
+            RoutePoint *pr = node->GetData();
+            if (( pr->m_bIsolatedMark) && !(pr->m_bIsInLayer))
+            {
+                  GpxWptElement *wpt = CreateGPXWpt(pr, GPX_WPT_WAYPOINT);
+                  writer.WriteElement ( wpt );
+                  delete wpt;
+            }
+            node = node->GetNext();
+      }
+
+      wxRouteListNode *node1 = pRouteList->GetFirst();
+      while ( node1 )
+      {
+            Route *pRoute = node1->GetData();
+            if ( !pRoute->m_bIsTrack && !(pRoute->m_bIsInLayer) )
+            {
+                  GpxRteElement *rte = CreateGPXRte(pRoute);
+                  writer.WriteElement ( rte );
+                  delete rte;
+            }
+            node1 = node1->GetNext();
+      }
+
+      node1 = pRouteList->GetFirst();
+      while ( node1 )
+      {
+            Route *pRoute = node1->GetData();
+            if ( pRoute->pRoutePointList->GetCount() && pRoute->m_bIsTrack && !(pRoute->m_bIsInLayer))
+                  CreateGPXTrk(pRoute, &writer);                  // written point by point
+            node1 = node1->GetNext();
+      }
+
+      return writer.Close();
+}
+
+//---------------------------------------------------------------------------------
+//          NavObjectJournal Implementation
+//---------------------------------------------------------------------------------
+static unsigned int s_journal_crc_table[256];
+static bool s_journal_crc_table_valid;
+
+static unsigned int JournalCRC32 ( const char *data, int len )
+{
+      if ( !s_journal_crc_table_valid )
+      {
+            for ( unsigned int n = 0 ; n < 256 ; n++ )
+            {
+                  unsigned int c = n;
+                  for ( int k = 0 ; k < 8 ; k++ )
+                        c = ( c & 1 ) ? ( 0xEDB88320 ^ ( c >> 1 ) ) : ( c >> 1 );
+                  s_journal_crc_table[n] = c;
+            }
+            s_journal_crc_table_valid = true;
+      }
+
+      unsigned int crc = 0xFFFFFFFF;
+      for ( int i = 0 ; i < len ; i++ )
+            crc = s_journal_crc_table[( crc ^ ( unsigned char ) data[i] ) & 0xFF] ^ ( crc >> 8 );
+
+      return crc ^ 0xFFFFFFFF;
+}
+
+NavObjectJournal::NavObjectJournal ( const wxString &filename )
+{
+      m_filename = filename;
+      m_fp = NULL;
+      m_fp_replay = NULL;
+      m_size = -1;                                    // not known until asked for
+      m_line = NULL;
+      m_line_size = 0;
+}
+
+NavObjectJournal::~NavObjectJournal()
+{
+      if ( m_fp )
+            fclose ( m_fp );
+      CloseReplay();
+      free ( m_line );
+}
+
+bool NavObjectJournal::Append ( TiXmlElement *element )
+{
+      //    Stream printing puts the element on one line, line breaks in text are character references
+      TiXmlPrinter printer;
+      printer.SetStreamPrinting();
+      element->Accept ( &printer );
+
+      if ( !m_fp )
+      {
+            m_fp = fopen((const char*)m_filename.mb_str(), "ab");
+            if ( !m_fp )
+                  return false;
+            fseek ( m_fp, 0, SEEK_END );
+            m_size = ftell ( m_fp );
+      }
+
+      int len = printer.Size();
+      fprintf ( m_fp, "%08x ", JournalCRC32 ( printer.CStr(), len ) );
+      fwrite ( printer.CStr(), 1, len, m_fp );
+      fputc ( '\n', m_fp );
+      m_size += 9 + len + 1;
+
+      //    The record must be in the file before the change counts as stored
+      return ( 0 == fflush ( m_fp ) ) && !ferror ( m_fp );
+}
+
+void NavObjectJournal::Remove ( void )
+{
+      if ( m_fp )
+      {
+            fclose ( m_fp );
+            m_fp = NULL;
+      }
+
+      if ( ::wxFileExists ( m_filename ) )
+            ::wxRemoveFile ( m_filename );
+      m_size = 0;
+}
+
+long NavObjectJournal::GetSize ( void )
+{
+      if ( m_size < 0 )
+      {
+            m_size = 0;
+            FILE *fp = fopen((const char*)m_filename.mb_str(), "rb");
+            if ( fp )
+            {
+                  fseek ( fp, 0, SEEK_END );
+                  m_size = ftell ( fp );
+                  fclose ( fp );
+            }
+      }
+
+      return m_size;
+}
+
+bool NavObjectJournal::OpenReplay ( void )
+{
+      CloseReplay();
+      m_fp_replay = fopen((const char*)m_filename.mb_str(), "rb");
+      return ( NULL != m_fp_replay );
+}
+
+void NavObjectJournal::CloseReplay ( void )
+{
+      if ( m_fp_replay )
+            fclose ( m_fp_replay );
+      m_fp_replay = NULL;
+      m_doc.Clear();
+}
+
+TiXmlElement *NavObjectJournal::NextRecord ( void )
+{
+      if ( !m_fp_replay )
+            return NULL;
+
+      //    One whole line, the buffer grows for long records such as tracks
+      int len = 0;
+      for ( ;; )
+      {
+            if ( m_line_size - len < 2 )
+            {
+                  m_line_size = m_line_size ? m_line_size * 2 : 4096;
+                  m_line = (char *) realloc ( m_line, m_line_size );
+            }
+            if ( !fgets ( m_line + len, m_line_size - len, m_fp_replay ) )
+                  break;
+            len += strlen ( m_line + len );
+            if ( m_line[len - 1] == '\n' )
+                  break;
+      }
+
+      //    A last line without its newline was still being written
+      if ( ( len < 10 ) || ( m_line[len - 1] != '\n' ) || ( m_line[8] != ' ' ) )
+            return NULL;
+      m_line[--len] = 0;
+
+      unsigned int crc;
+      if ( ( 1 != sscanf ( m_line, "%8x", &crc ) ) || ( crc != JournalCRC32 ( m_line + 9, len - 9 ) ) )
+      {
+            wxLogMessage ( _T ( "navobj journal record fails its CRC, replay stopped" ) );
+            return NULL;
+      }
+
+      m_doc.Clear();
+      m_doc.Parse ( m_line + 9, 0, TIXML_ENCODING_UTF8 );
+      if ( m_doc.Error() )
+            return NULL;
+
+      return m_doc.RootElement();
+}
+
 //---------------------------------------------------------------------------------
 //          Private Font Manager and Helpers
 //---------------------------------------------------------------------------------
@@ -104,6 +104,7 @@ static const long long lNaN = 0xfff8000000000000;
 //------------------------------------------------------------------------------
 
 const wxEventType wxEVT_OCPN_NMEA = wxNewEventType();
+const wxEventType wxEVT_OCPN_NMEA_QUEUE = wxNewEventType();
 
 OCPN_NMEAEvent::OCPN_NMEAEvent( wxEventType commandType, int id )
       :wxEvent(id, commandType)
@@ -124,6 +125,155 @@ wxEvent* OCPN_NMEAEvent::Clone() const
       return newevent;
 }
 
+//------------------------------------------------------------------------------
+//    NMEASentenceQueue Implementation
+//------------------------------------------------------------------------------
+
+#ifdef __WXMSW__
+#define NMEA_QUEUE_BARRIER()    MemoryBarrier()
+#else
+#define NMEA_QUEUE_BARRIER()    __sync_synchronize()
+#endif
+
+NMEASentenceQueue::NMEASentenceQueue(bool b_check_sum)
+{
+      m_slots = (NMEAQueueSlot *)calloc(NMEA_QUEUE_SIZE, sizeof(NMEAQueueSlot));
+      m_b_check_sum = b_check_sum;
+      m_put = 0;
+      m_take = 0;
+      m_wakeup_armed = 0;
+      m_n_dropped = 0;
+      m_n_bad = 0;
+}
+
+NMEASentenceQueue::~NMEASentenceQueue()
+{
+      free(m_slots);
+}
+
+static int NMEAHexDigit(char c)
+{
+      if((c >= '0') && (c <= '9'))
+            return c - '0';
+      if((c >= 'A') && (c <= 'F'))
+            return c - 'A' + 10;
+      if((c >= 'a') && (c <= 'f'))
+            return c - 'a' + 10;
+      return -1;
+}
+
+//    Validate, classify and queue one sentence.
+//    Returns false if the sentence was rejected or dropped.
+bool NMEASentenceQueue::Push(const char *sentence)
+{
+      //    Skip any leading noise up to the start delimiter
+      const char *ps = sentence;
+      while(*ps && (*ps != '$') && (*ps != '!'))
+            ps++;
+      if(!*ps)
+      {
+            m_n_bad++;
+            return false;
+      }
+
+      int len = strlen(ps);
+      if(len > NMEA_QUEUE_MAX_SENTENCE)
+      {
+            m_n_bad++;
+            return false;
+      }
+
+      //    Verify the checksum, if present
+      const char *pc = ps + 1;
+      unsigned char sum = 0;
+      while(*pc && (*pc != '*') && (*pc != 0x0d) && (*pc != 0x0a))
+            sum ^= (unsigned char)*pc++;
+
+      if(m_b_check_sum && (*pc == '*'))
+      {
+            int hi = NMEAHexDigit(pc[1]);
+            int lo = (hi >= 0) ? NMEAHexDigit(pc[2]) : -1;
+            if((lo < 0) || (((hi << 4) | lo) != sum))
+            {
+                  m_n_bad++;
+                  return false;
+            }
+      }
+
+      //    The sentence formatter is the last three characters of the address field
+      char id[4] = { 0, 0, 0, 0 };
+      const char *pa = ps + 1;
+      while(*pa && (*pa != ',') && (*pa != '*'))
+            pa++;
+      if((pa - ps) >= 4)
+            memcpy(id, pa - 3, 3);
+
+      //    High rate navigation sentences only need the latest of each batch.
+      //    Encapsulated (AIS) and multi-part (e.g. GSV) sentences are never coalesced.
+      NMEAQueuePolicy policy = NMEA_QUEUE_KEEP;
+      if(*ps == '$')
+      {
+            if(!strcmp(id, "RMC") || !strcmp(id, "GGA") || !strcmp(id, "GLL") ||
+               !strcmp(id, "VTG") || !strcmp(id, "HDT") || !strcmp(id, "HDG") ||
+               !strcmp(id, "HDM"))
+                  policy = NMEA_QUEUE_COALESCE;
+      }
+
+      //    Drop coalescable sentences first as the queue fills
+      unsigned int used = m_put - m_take;
+      if((used >= NMEA_QUEUE_SIZE) ||
+         ((policy == NMEA_QUEUE_COALESCE) && (used >= (NMEA_QUEUE_SIZE * 3) / 4)))
+      {
+            m_n_dropped++;
+            return false;
+      }
+
+      NMEAQueueSlot *pslot = &m_slots[m_put & (NMEA_QUEUE_SIZE - 1)];
+      memcpy(pslot->sentence, ps, len + 1);
+      memcpy(pslot->id, id, 4);
+      pslot->policy = policy;
+
+      NMEA_QUEUE_BARRIER();               // slot contents before the index
+      m_put++;
+
+      return true;
+}
+
+//    Returns true if the caller should post a wakeup event to the consumer
+bool NMEASentenceQueue::ArmWakeup(void)
+{
+      NMEA_QUEUE_BARRIER();
+      if(m_wakeup_armed)
+            return false;
+
+      m_wakeup_armed = 1;
+      return true;
+}
+
+void NMEASentenceQueue::ClearWakeup(void)
+{
+      m_wakeup_armed = 0;
+      NMEA_QUEUE_BARRIER();               // clear the flag before looking for data
+}
+
+int NMEASentenceQueue::Available(void)
+{
+      int n = m_put - m_take;
+      NMEA_QUEUE_BARRIER();               // index before the slot contents
+      return n;
+}
+
+NMEAQueueSlot *NMEASentenceQueue::Peek(int i)
+{
+      return &m_slots[(m_take + i) & (NMEA_QUEUE_SIZE - 1)];
+}
+
+void NMEASentenceQueue::Pop(int n)
+{
+      NMEA_QUEUE_BARRIER();               // finish with the slots before releasing them
+      m_take += n;
+}
+
 #ifdef __WXMSW__
 
 class       GARMIN_IO_Thread;
@@ -310,6 +460,8 @@ NMEAHandler::NMEAHandler(int handler_id, wxFrame *frame, const wxString& NMEADat
 {
       m_handler_id = handler_id;
 
+      m_pSentenceQueue = new NMEASentenceQueue;
+
       m_parent_frame = frame;
       m_pParentEventHandler = m_parent_frame->GetEventHandler();
 
@@ -750,6 +902,7 @@ NMEAHandler::NMEAHandler(int handler_id, wxFrame *frame, const wxString& NMEADat
 
 NMEAHandler::~NMEAHandler()
 {
+      delete m_pSentenceQueue;
 }
 
 void NMEAHandler::Close()
@@ -2234,6 +2387,7 @@ OCP_NMEA_Thread::OCP_NMEA_Thread(NMEAHandler *Launcher, wxWindow *MessageTarget,
                                  const wxString& PortName, ComPortManager *pComMan, const wxString& strBaudRate, bool bGarmin)
 {
       m_launcher = Launcher;                        // This thread's immediate "parent"
+      m_pSentenceQueue = Launcher->GetSentenceQueue();
 
       m_pMainEventHandler = MessageTarget->GetEventHandler();
 
@@ -2452,8 +2606,7 @@ void *OCP_NMEA_Thread::Entry()
                         tak_ptr = tptr;
 
       //    Message is ready to parse and send out
-                        wxString str_temp_buf(temp_buf, wxConvUTF8);
-                        Parse_And_Send_Posn(str_temp_buf);
+                        Parse_And_Send_Posn(temp_buf);
                   }
 
                   }                   //if nl
@@ -2814,8 +2967,7 @@ HandleASuccessfulRead:
                               tak_ptr = tptr;
 
       // parse and send the message
-                              wxString str_temp_buf(temp_buf, wxConvUTF8);
-                              Parse_And_Send_Posn(str_temp_buf);
+                              Parse_And_Send_Posn(temp_buf);
                         }
                         else
                         {
@@ -2975,8 +3127,7 @@ HandleASuccessfulRead:
       // parse and send the message
                               if(g_bShowOutlines)
                               {
-                                    wxString str_temp_buf(temp_buf, wxConvUTF8);
-                                    Parse_And_Send_Posn(str_temp_buf);
+                                    Parse_And_Send_Posn(temp_buf);
                               }
                         }
                         else
@@ -3011,20 +3162,26 @@ thread_exit:
 #endif            // __WXMSW__
 
 
-void OCP_NMEA_Thread::Parse_And_Send_Posn(wxString &str_temp_buf)
+void OCP_NMEA_Thread::Parse_And_Send_Posn(char *sentence)
 {
       if( g_nNMEADebug && (g_total_NMEAerror_messages < g_nNMEADebug) )
       {
             g_total_NMEAerror_messages++;
             wxString msg(_T("NMEA Sentence received..."));
-            msg.Append(str_temp_buf);
+            msg.Append(wxString(sentence, wxConvUTF8));
             ThreadMessage(msg);
       }
 
-
-      OCPN_NMEAEvent Nevent(wxEVT_OCPN_NMEA, 0);
-      Nevent.SetNMEAString(str_temp_buf);
-      m_pMainEventHandler->AddPendingEvent(Nevent);
+      //    Queue the sentence, and wake the main thread if it is not already
+      //    due to drain the queue
+      if(m_pSentenceQueue->Push(sentence))
+      {
+            if(m_pSentenceQueue->ArmWakeup())
+            {
+                  wxCommandEvent event(wxEVT_OCPN_NMEA_QUEUE, 0);
+                  m_pMainEventHandler->AddPendingEvent(event);
+            }
+      }
 
       return;
 }
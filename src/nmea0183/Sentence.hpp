@@ -77,6 +77,8 @@ class SENTENCE
       virtual REFERENCE Reference( int field_number ) const;
       virtual TRANSDUCER_TYPE TransducerType( int field_number ) const;
 
+      const char *FieldData( int field_number, int *length ) const;
+
       /*
       ** Operators
       */
@@ -93,6 +95,24 @@ class SENTENCE
       virtual const SENTENCE& operator += ( TRANSDUCER_TYPE transducer );
       virtual const SENTENCE& operator += ( NMEA0183_BOOLEAN boolean );
       virtual const SENTENCE& operator += ( LATLONG& source );
+
+   private:
+
+      void Tokenize( void ) const;
+      int SingleCharacter( int field_number ) const;
+
+      /*
+      ** The sentence as split into fields, rebuilt when the sentence changes
+      */
+
+      mutable bool   m_Tokenized;
+      mutable size_t m_TokenizedLength;
+      mutable char   m_Ascii[ NMEA0183_MAX_SENTENCE + 1 ];
+      mutable int    m_AsciiLength;
+      mutable int    m_FieldStart[ NMEA0183_MAX_FIELDS ];
+      mutable int    m_FieldLength[ NMEA0183_MAX_FIELDS ];
+      mutable int    m_NumberOfFields;
+      mutable int    m_NumberOfDataFields;
 };
  
 #endif // SENTENCE_CLASS_HEADER
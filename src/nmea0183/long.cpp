@@ -70,8 +70,30 @@ bool LONGITUDE::IsDataValid( void )
 
 void LONGITUDE::Parse( int position_field_number, int east_or_west_field_number, const SENTENCE& sentence )
 {
-   wxString w_or_e = sentence.Field( east_or_west_field_number );
-   Set( sentence.Double( position_field_number ), w_or_e );
+   Longitude = sentence.Double( position_field_number );
+
+   //    As for Set(), the first non-blank character gives the hemisphere
+   int length;
+   const char *field_data = sentence.FieldData( east_or_west_field_number, &length );
+
+   while( length && *field_data == ' ' )
+   {
+      field_data++;
+      length--;
+   }
+
+   if ( length && *field_data == 'E' )
+   {
+      Easting = East;
+   }
+   else if ( length && *field_data == 'W' )
+   {
+      Easting = West;
+   }
+   else
+   {
+      Easting = EW_Unknown;
+   }
 }
 
 void LONGITUDE::Set( double position, const wxString& east_or_west )
@@ -31,6 +31,8 @@
 
 
 #include "nmea0183.h"
+#include <string.h>
+#include <stdlib.h>
 #include <math.h>
 
 #if !defined(NAN)
@@ -54,90 +56,197 @@ static const long long lNaN = 0xfff8000000000000;
 ** You can use it any way you like.
 */
 
+/*
+** Sentences are split into fields once, over a plain char copy of the
+** sentence, and the fields are then decoded in place.
+*/
 
-SENTENCE::SENTENCE()
+static int DecodeHex( const char *p, int length )
 {
-   Sentence.Empty();
-}
+   int value = 0;
 
-SENTENCE::~SENTENCE()
-{
-   Sentence.Empty();
-}
+   while( length && *p == ' ' )
+   {
+      p++;
+      length--;
+   }
 
-NMEA0183_BOOLEAN SENTENCE::Boolean( int field_number ) const
-{
-//   ASSERT_VALID( this );
+   while( length )
+   {
+      char c = *p++;
 
-   wxString field_data;
+      if ( c >= '0' && c <= '9' )
+         value = ( value << 4 ) + ( c - '0' );
+      else if ( c >= 'A' && c <= 'F' )
+         value = ( value << 4 ) + ( c - 'A' + 10 );
+      else if ( c >= 'a' && c <= 'f' )
+         value = ( value << 4 ) + ( c - 'a' + 10 );
+      else
+         break;
+
+      length--;
+   }
 
-   field_data = Field( field_number );
+   return( value );
+}
+
+static int DecodeInteger( const char *p, int length )
+{
+   int value = 0;
+   bool negative = false;
 
-   if ( field_data.StartsWith(_T("A")) )
+   while( length && ( *p == ' ' || *p == '\t' ) )
    {
-      return( NTrue );
+      p++;
+      length--;
    }
-   else if ( field_data.StartsWith(_T("V")) )
+
+   if ( length && ( *p == '-' || *p == '+' ) )
    {
-      return( NFalse );
+      negative = ( *p == '-' );
+      p++;
+      length--;
    }
-   else
+
+   while( length && *p >= '0' && *p <= '9' )
    {
-      return( Unknown0183 );
+      value = ( value * 10 ) + ( *p++ - '0' );
+      length--;
    }
+
+   return( negative ? -value : value );
 }
 
-COMMUNICATIONS_MODE SENTENCE::CommunicationsMode( int field_number ) const
+static const double PowersOfTen[] =
 {
-//   ASSERT_VALID( this );
-
-   wxString field_data;
+   1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+   1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+};
 
-   field_data = Field( field_number );
+static double DecodeDouble( const char *p, int length )
+{
+   const char *start = p;
+   int remaining = length;
 
-   if ( field_data == _T("d") )
-   {
-      return( F3E_G3E_SimplexTelephone );
-   }
-   else if ( field_data == _T("e") )
+   while( remaining && ( *p == ' ' || *p == '\t' ) )
    {
-      return( F3E_G3E_DuplexTelephone );
+      p++;
+      remaining--;
    }
-   else if ( field_data == _T("m") )
-   {
-      return( J3E_Telephone );
-   }
-   else if ( field_data == _T("o") )
-   {
-      return( H3E_Telephone );
-   }
-   else if ( field_data == _T("q") )
+
+   bool negative = false;
+
+   if ( remaining && ( *p == '-' || *p == '+' ) )
    {
-      return( F1B_J2B_FEC_NBDP_TelexTeleprinter );
+      negative = ( *p == '-' );
+      p++;
+      remaining--;
    }
-   else if ( field_data == _T("s") )
+
+   /*
+   ** Mantissa and scale are both exact, so one division rounds exactly as atof() would
+   */
+
+   wxLongLong_t mantissa = 0;
+   int digits = 0;
+   int decimals = 0;
+   bool in_fraction = false;
+
+   while( remaining )
    {
-      return( F1B_J2B_ARQ_NBDP_TelexTeleprinter );
+      char c = *p;
+
+      if ( c >= '0' && c <= '9' )
+      {
+         if ( mantissa || c != '0' )
+            digits++;
+
+         mantissa = ( mantissa * 10 ) + ( c - '0' );
+
+         if ( in_fraction )
+            decimals++;
+      }
+      else if ( c == '.' && !in_fraction )
+      {
+         in_fraction = true;
+      }
+      else
+      {
+         break;
+      }
+
+      p++;
+      remaining--;
    }
-   else if ( field_data == _T("w") )
+
+   /*
+   ** Exponents and very long fields are rare enough to leave to the C library
+   */
+
+   if ( digits > 15 || decimals > 15 || ( remaining && ( *p == 'e' || *p == 'E' ) ) )
    {
-      return( F1B_J2B_ReceiveOnlyTeleprinterDSC );
+      char buffer[ NMEA0183_MAX_SENTENCE + 1 ];
+      memcpy( buffer, start, length );
+      buffer[ length ] = 0;
+      return( ::atof( buffer ) );
    }
-   else if ( field_data == _T("x") )
+
+   double value = (double) mantissa / PowersOfTen[ decimals ];
+
+   return( negative ? -value : value );
+}
+
+
+SENTENCE::SENTENCE()
+{
+   Sentence.Empty();
+   m_Tokenized = false;
+   m_TokenizedLength = 0;
+}
+
+SENTENCE::~SENTENCE()
+{
+   Sentence.Empty();
+}
+
+NMEA0183_BOOLEAN SENTENCE::Boolean( int field_number ) const
+{
+//   ASSERT_VALID( this );
+
+   int length;
+   const char *field_data = FieldData( field_number, &length );
+
+   if ( length && field_data[ 0 ] == 'A' )
    {
-      return( A1A_MorseTapeRecorder );
+      return( NTrue );
    }
-   else if ( field_data == _T("{") )
+   else if ( length && field_data[ 0 ] == 'V' )
    {
-      return( A1A_MorseKeyHeadset );
+      return( NFalse );
    }
-   else if ( field_data == _T("|") )
+   else
    {
-      return( F1C_F2C_F3C_FaxMachine );
+      return( Unknown0183 );
    }
-   else
+}
+
+COMMUNICATIONS_MODE SENTENCE::CommunicationsMode( int field_number ) const
+{
+//   ASSERT_VALID( this );
+
+   switch( SingleCharacter( field_number ) )
    {
-      return( CommunicationsModeUnknown );
+      case 'd': return( F3E_G3E_SimplexTelephone );
+      case 'e': return( F3E_G3E_DuplexTelephone );
+      case 'm': return( J3E_Telephone );
+      case 'o': return( H3E_Telephone );
+      case 'q': return( F1B_J2B_FEC_NBDP_TelexTeleprinter );
+      case 's': return( F1B_J2B_ARQ_NBDP_TelexTeleprinter );
+      case 'w': return( F1B_J2B_ReceiveOnlyTeleprinterDSC );
+      case 'x': return( A1A_MorseTapeRecorder );
+      case '{': return( A1A_MorseKeyHeadset );
+      case '|': return( F1C_F2C_F3C_FaxMachine );
+      default:  return( CommunicationsModeUnknown );
    }
 }
 
@@ -145,19 +254,16 @@ unsigned char SENTENCE::ComputeChecksum( void ) const
 {
    unsigned char checksum_value = 0;
 
-   char str_ascii[101];
-   strncpy(str_ascii, (const char *)Sentence.mb_str(), 99);
-   str_ascii[100] = '\0';
+   Tokenize();
 
-   int string_length = strlen(str_ascii);
    int index = 1; // Skip over the $ at the begining of the sentence
 
-   while( index < string_length    &&
-          str_ascii[ index ] != '*' &&
-          str_ascii[ index ] != CARRIAGE_RETURN &&
-          str_ascii[ index ] != LINE_FEED )
+   while( index < m_AsciiLength    &&
+          m_Ascii[ index ] != '*' &&
+          m_Ascii[ index ] != CARRIAGE_RETURN &&
+          m_Ascii[ index ] != LINE_FEED )
    {
-         checksum_value ^= str_ascii[ index ];
+         checksum_value ^= m_Ascii[ index ];
          index++;
    }
 
@@ -167,10 +273,14 @@ unsigned char SENTENCE::ComputeChecksum( void ) const
 double SENTENCE::Double( int field_number ) const
 {
  //  ASSERT_VALID( this );
-      if(Field( field_number ).Len() == 0)
+      int length;
+      const char *field_data = FieldData( field_number, &length );
+
+      if(length == 0)
             return (NAN);
 
-      return( ::atof( Field( field_number ).mb_str() ) );
+      return( DecodeDouble( field_data, length ) );
+
 }
 
 
@@ -178,21 +288,11 @@ EASTWEST SENTENCE::EastOrWest( int field_number ) const
 {
 //   ASSERT_VALID( this );
 
-   wxString field_data;
-
-   field_data = Field( field_number );
-
-   if ( field_data == _T("E") )
-   {
-      return( East );
-   }
-   else if ( field_data == _T("W") )
+   switch( SingleCharacter( field_number ) )
    {
-      return( West );
-   }
-   else
-   {
-      return( EW_Unknown );
+      case 'E': return( East );
+      case 'W': return( West );
+      default:  return( EW_Unknown );
    }
 }
 
@@ -201,66 +301,133 @@ const wxString& SENTENCE::Field( int desired_field_number ) const
 //   ASSERT_VALID( this );
 
    static wxString return_string;
-   return_string.Empty();
 
-   int index                = 1; // Skip over the $ at the begining of the sentence
-   int current_field_number = 0;
-   int string_length        = 0;
+   int length;
+   const char *field_data = FieldData( desired_field_number, &length );
 
-   string_length = Sentence.Len();
+   if ( length )
+      return_string = wxString( field_data, wxConvISO8859_1, length );
+   else
+      return_string.Empty();
 
-   while( current_field_number < desired_field_number && index < string_length )
+   return( return_string );
+}
+
+/*
+** Split the sentence into fields, if it has changed since it was last split.
+** Fields are delimited by ',' and '*', as for Field().
+*/
+
+void SENTENCE::Tokenize( void ) const
+{
+   if ( m_Tokenized && m_TokenizedLength == Sentence.Len() )
    {
-      if ( Sentence[ index ] == ',' || Sentence[ index ] == '*' )
-      {
-         current_field_number++;
-      }
+      return;
+   }
+
+   m_Tokenized = true;
+   m_TokenizedLength = Sentence.Len();
+
+   const wxChar *source = Sentence.c_str();
 
+   int length = (int) m_TokenizedLength;
+
+   if ( length > NMEA0183_MAX_SENTENCE )
+   {
+      length = NMEA0183_MAX_SENTENCE;
+   }
+
+   int index = 0;
+
+   while( index < length && source[ index ] != 0 )
+   {
+      wxChar c = source[ index ];
+      m_Ascii[ index ] = ( c < 0x80 ) ? (char) c : '?';
       index++;
    }
 
-   if ( current_field_number == desired_field_number )
+   m_Ascii[ index ] = 0;
+   m_AsciiLength = index;
+
+   m_NumberOfFields = 0;
+   m_NumberOfDataFields = -1;
+
+   int field_start = 1; // Skip over the $ at the begining of the sentence
+
+   for( index = 1; index < m_AsciiLength; index++ )
    {
-      while( index < string_length    &&
-             Sentence[ index ] != ',' &&
-             Sentence[ index ] != '*' &&
-             Sentence[ index ] != 0x00 )
+      char c = m_Ascii[ index ];
+
+      if ( c == ',' || c == '*' )
       {
-         return_string += Sentence[ index ];
-         index++;
+         if ( c == '*' && m_NumberOfDataFields < 0 )
+         {
+            m_NumberOfDataFields = m_NumberOfFields;
+         }
+
+         if ( m_NumberOfFields < NMEA0183_MAX_FIELDS )
+         {
+            m_FieldStart[ m_NumberOfFields ] = field_start;
+            m_FieldLength[ m_NumberOfFields ] = index - field_start;
+            m_NumberOfFields++;
+         }
+
+         field_start = index + 1;
       }
    }
 
+   if ( m_NumberOfFields < NMEA0183_MAX_FIELDS && field_start <= m_AsciiLength )
+   {
+      m_FieldStart[ m_NumberOfFields ] = field_start;
+      m_FieldLength[ m_NumberOfFields ] = m_AsciiLength - field_start;
+      m_NumberOfFields++;
+   }
 
-   return( return_string );
+   if ( m_NumberOfDataFields < 0 )
+   {
+      m_NumberOfDataFields = ( m_NumberOfFields > 0 ) ? m_NumberOfFields - 1 : 0;
+   }
 }
 
-int SENTENCE::GetNumberOfDataFields( void ) const
+/*
+** Returns a pointer into the split sentence, which is not NUL terminated at the field end
+*/
+
+const char *SENTENCE::FieldData( int field_number, int *length ) const
 {
-//   ASSERT_VALID( this );
+   Tokenize();
 
-   int index                = 1; // Skip over the $ at the begining of the sentence
-   int current_field_number = 0;
-   int string_length        = 0;
+   if ( field_number < 0 || field_number >= m_NumberOfFields )
+   {
+      *length = 0;
+      return( "" );
+   }
 
-   string_length = Sentence.Len();
+   *length = m_FieldLength[ field_number ];
 
-   while( index < string_length )
-   {
-      if ( Sentence[ index ] == '*' )
-      {
-         return( (int) current_field_number );
-      }
+   return( &m_Ascii[ m_FieldStart[ field_number ] ] );
+}
 
-      if ( Sentence[ index ] == ',' )
-      {
-         current_field_number++;
-      }
+int SENTENCE::SingleCharacter( int field_number ) const
+{
+   int length;
+   const char *field_data = FieldData( field_number, &length );
 
-      index++;
+   if ( length != 1 )
+   {
+      return( 0 );
    }
 
-   return( (int) current_field_number );
+   return( field_data[ 0 ] );
+}
+
+int SENTENCE::GetNumberOfDataFields( void ) const
+{
+//   ASSERT_VALID( this );
+
+   Tokenize();
+
+   return( m_NumberOfDataFields );
 }
 
 void SENTENCE::Finish( void )
@@ -273,13 +440,17 @@ void SENTENCE::Finish( void )
 
    temp_string.Printf(_T("*%02X%c%c"), (int) checksum, CARRIAGE_RETURN, LINE_FEED );
    Sentence += temp_string;
+   m_Tokenized = false;
 }
 
 int SENTENCE::Integer( int field_number ) const
 {
 //   ASSERT_VALID( this );
 
-    return( ::atoi( Field( field_number ).mb_str() ) );
+   int length;
+   const char *field_data = FieldData( field_number, &length );
+
+   return( DecodeInteger( field_data, length ) );
 }
 
 NMEA0183_BOOLEAN SENTENCE::IsChecksumBad( int checksum_field_number ) const
@@ -290,14 +461,15 @@ NMEA0183_BOOLEAN SENTENCE::IsChecksumBad( int checksum_field_number ) const
    ** Checksums are optional, return TRUE if an existing checksum is known to be bad
    */
 
-   wxString checksum_in_sentence = Field( checksum_field_number );
+   int length;
+   const char *checksum_in_sentence = FieldData( checksum_field_number, &length );
 
-   if ( checksum_in_sentence == _T("") )
+   if ( length == 0 )
    {
       return( Unknown0183 );
    }
 
-   if ( ComputeChecksum() != HexValue( checksum_in_sentence ) )
+   if ( ComputeChecksum() != DecodeHex( checksum_in_sentence, length ) )
    {
       return( NTrue );
    }
@@ -309,21 +481,11 @@ LEFTRIGHT SENTENCE::LeftOrRight( int field_number ) const
 {
 //   ASSERT_VALID( this );
 
-   wxString field_data;
-
-   field_data = Field( field_number );
-
-   if ( field_data == _T("L") )
-   {
-      return( Left );
-   }
-   else if ( field_data == _T("R") )
-   {
-      return( Right );
-   }
-   else
+   switch( SingleCharacter( field_number ) )
    {
-      return( LR_Unknown );
+      case 'L': return( Left );
+      case 'R': return( Right );
+      default:  return( LR_Unknown );
    }
 }
 
@@ -331,21 +493,11 @@ NORTHSOUTH SENTENCE::NorthOrSouth( int field_number ) const
 {
 //   ASSERT_VALID( this );
 
-   wxString field_data;
-
-   field_data = Field( field_number );
-
-   if ( field_data == _T("N") )
-   {
-      return( North );
-   }
-   else if ( field_data == _T("S") )
+   switch( SingleCharacter( field_number ) )
    {
-      return( South );
-   }
-   else
-   {
-      return( NS_Unknown );
+      case 'N': return( North );
+      case 'S': return( South );
+      default:  return( NS_Unknown );
    }
 }
 
@@ -353,33 +505,14 @@ REFERENCE SENTENCE::Reference( int field_number ) const
 {
 //   ASSERT_VALID( this );
 
-   wxString field_data;
-
-   field_data = Field( field_number );
-
-   if ( field_data == _T("B") )
-   {
-      return( BottomTrackingLog );
-   }
-   else if ( field_data == _T("M") )
-   {
-      return( ManuallyEntered );
-   }
-   else if ( field_data == _T("W") )
-   {
-      return( WaterReferenced );
-   }
-   else if ( field_data == _T("R") )
-   {
-      return( RadarTrackingOfFixedTarget );
-   }
-   else if ( field_data == _T("P") )
-   {
-      return( PositioningSystemGroundReference );
-   }
-   else
+   switch( SingleCharacter( field_number ) )
    {
-      return( ReferenceUnknown );
+      case 'B': return( BottomTrackingLog );
+      case 'M': return( ManuallyEntered );
+      case 'W': return( WaterReferenced );
+      case 'R': return( RadarTrackingOfFixedTarget );
+      case 'P': return( PositioningSystemGroundReference );
+      default:  return( ReferenceUnknown );
    }
 }
 
@@ -387,53 +520,19 @@ TRANSDUCER_TYPE SENTENCE::TransducerType( int field_number ) const
 {
 //   ASSERT_VALID( this );
 
-   wxString field_data;
-
-   field_data = Field( field_number );
-
-   if ( field_data == _T("A") )
-   {
-      return( AngularDisplacementTransducer );
-   }
-   else if ( field_data == _T("D") )
-   {
-      return( LinearDisplacementTransducer );
-   }
-   else if ( field_data == _T("C") )
-   {
-      return( TemperatureTransducer );
-   }
-   else if ( field_data == _T("F") )
-   {
-      return( FrequencyTransducer );
-   }
-   else if ( field_data == _T("N") )
-   {
-      return( ForceTransducer );
-   }
-   else if ( field_data == _T("P") )
-   {
-      return( PressureTransducer );
-   }
-   else if ( field_data == _T("R") )
-   {
-      return( FlowRateTransducer );
-   }
-   else if ( field_data == _T("T") )
-   {
-      return( TachometerTransducer );
-   }
-   else if ( field_data == _T("H") )
-   {
-      return( HumidityTransducer );
-   }
-   else if ( field_data == _T("V") )
-   {
-      return( VolumeTransducer );
-   }
-   else
+   switch( SingleCharacter( field_number ) )
    {
-      return( TransducerUnknown );
+      case 'A': return( AngularDisplacementTransducer );
+      case 'D': return( LinearDisplacementTransducer );
+      case 'C': return( TemperatureTransducer );
+      case 'F': return( FrequencyTransducer );
+      case 'N': return( ForceTransducer );
+      case 'P': return( PressureTransducer );
+      case 'R': return( FlowRateTransducer );
+      case 'T': return( TachometerTransducer );
+      case 'H': return( HumidityTransducer );
+      case 'V': return( VolumeTransducer );
+      default:  return( TransducerUnknown );
    }
 }
 
@@ -452,6 +551,7 @@ const SENTENCE& SENTENCE::operator = ( const SENTENCE& source )
 {
 //   ASSERT_VALID( this );
 
+   m_Tokenized = false;
    Sentence = source.Sentence;
 
    return( *this );
@@ -461,6 +561,7 @@ const SENTENCE& SENTENCE::operator = ( const wxString& source )
 {
 //   ASSERT_VALID( this );
 
+   m_Tokenized = false;
    Sentence = source;
 
    return( *this );
@@ -470,6 +571,7 @@ const SENTENCE& SENTENCE::operator += ( const wxString& source )
 {
 //   ASSERT_VALID( this );
 
+   m_Tokenized = false;
     Sentence += _T(",");
    Sentence += source;
 
@@ -480,6 +582,7 @@ const SENTENCE& SENTENCE::operator += ( double value )
 {
 //   ASSERT_VALID( this );
 
+   m_Tokenized = false;
    wxString temp_string;
 
    temp_string.Printf(_T("%.3f"), value );
@@ -494,6 +597,7 @@ const SENTENCE& SENTENCE::operator += ( COMMUNICATIONS_MODE mode )
 {
 //   ASSERT_VALID( this );
 
+   m_Tokenized = false;
     Sentence += _T(",");
 
    switch( mode )
@@ -560,6 +664,7 @@ const SENTENCE& SENTENCE::operator += ( TRANSDUCER_TYPE transducer )
 {
 //   ASSERT_VALID( this );
 
+   m_Tokenized = false;
     Sentence += _T(",");
 
    switch( transducer )
@@ -628,6 +733,7 @@ const SENTENCE& SENTENCE::operator += ( NORTHSOUTH northing )
 {
 //   ASSERT_VALID( this );
 
+   m_Tokenized = false;
     Sentence += _T(",");
 
    if ( northing == North )
@@ -646,6 +752,7 @@ const SENTENCE& SENTENCE::operator += ( int value )
 {
 //   ASSERT_VALID( this );
 
+   m_Tokenized = false;
    wxString temp_string;
 
    temp_string.Printf(_T("%d"), value );
@@ -660,6 +767,7 @@ const SENTENCE& SENTENCE::operator += ( EASTWEST easting )
 {
 //   ASSERT_VALID( this );
 
+   m_Tokenized = false;
     Sentence += _T(",");
 
    if ( easting == East )
@@ -678,6 +786,7 @@ const SENTENCE& SENTENCE::operator += ( NMEA0183_BOOLEAN boolean )
 {
 //   ASSERT_VALID( this );
 
+   m_Tokenized = false;
     Sentence += _T(",");
 
    if ( boolean == NTrue )
@@ -696,6 +805,7 @@ const SENTENCE& SENTENCE::operator += ( LATLONG& source )
 {
 //   ASSERT_VALID( this );
 
+   m_Tokenized = false;
    source.Write( *this );
 
    return( *this );
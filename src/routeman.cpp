@@ -801,6 +801,7 @@ void Routeman::DeleteRoute(Route *pRoute)
                                     pRoute->pRoutePointList->DeleteNode(pdnode);
                                     pdnode = pRoute->pRoutePointList->Find(prp);
                               }
+                              pRoute->IncModifyCount();
 
                               pnode = NULL;
                               delete prp;
@@ -945,6 +946,7 @@ void Routeman::DeleteTrack(Route *pRoute)
                               pConfig->m_bIsImporting = false;
 
                               pRoute->pRoutePointList->DeleteNode(pnode);
+                              pRoute->IncModifyCount();
 /*
                               // Remove all instances of this point from the list.
                               wxRoutePointListNode *pdnode = pnode;
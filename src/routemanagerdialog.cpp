@@ -1370,6 +1370,7 @@ void RouteManagerDialog::OnTrkToggleVisibility(wxMouseEvent &event)
             m_pTrkListCtrl->SetItemImage(clicked_index, route->IsVisible() ? 0 : -1);
 
 //            pConfig->UpdateRoute(route);
+            pConfig->SetNavObjDirty();
             cc1->Refresh();
       }
 
@@ -2146,6 +2147,7 @@ void RouteManagerDialog::ToggleLayerContentsNames (Layer *layer)
                               prp1->m_bShowName = layer->HasVisibleNames();
                               node = node->GetNext();
                         }
+                        pRoute->IncModifyCount();
                   }
                   node1 = node1->GetNext();
             }
@@ -1025,6 +1025,11 @@ void RouteProp::SetRouteAndUpdate(Route *pR)
 
     m_pRoute = pR;
 
+    //  Track editing, splitting and extending work on RoutePoints,
+    //  so bring the running track's compact fixes into its point list
+    if (m_pRoute->m_bIsTrack && g_pActiveTrack)
+        g_pActiveTrack->MaterializeFixes();
+
 
     pDispTz->SetSelection(m_tz_selection);
 
@@ -2436,6 +2441,19 @@ void MarkInfoImpl::OnExtDescriptionClick( wxCommandEvent& event )
       event.Skip();
 }
 
+//    Routes and tracks cache the properties of their points for drawing,
+//    tell every one using this point that it has changed
+static void NoteRoutePointModified( RoutePoint *prp )
+{
+    wxArrayPtrVoid *pRouteArray = g_pRouteMan->GetRouteArrayContaining(prp);
+    if ( pRouteArray )
+    {
+        for(unsigned int ir=0 ; ir < pRouteArray->GetCount() ; ir++)
+            ((Route *)pRouteArray->Item(ir))->IncModifyCount();
+        delete pRouteArray;
+    }
+}
+
 bool MarkInfoImpl::SaveChanges()
 {
     if(m_pRoutePoint)
@@ -2473,6 +2491,7 @@ bool MarkInfoImpl::SaveChanges()
         else
             m_pRoutePoint->m_bDynamicName = false;
 
+        NoteRoutePointModified(m_pRoutePoint);
 
         if(m_pRoutePoint->m_bIsInRoute)
         {
@@ -2527,6 +2546,7 @@ void MarkInfoImpl::OnMarkInfoCancelClick( wxCommandEvent& event )
       m_pRoutePoint->SetPosition(m_lat_save, m_lon_save);
       m_pRoutePoint->m_IconName = m_IconName_save;
       m_pRoutePoint->ReLoadIcon();
+      NoteRoutePointModified(m_pRoutePoint);
 
       m_pRoutePoint->m_HyperlinkList->Clear();
 
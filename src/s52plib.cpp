@@ -51,6 +51,7 @@
 #include <stdlib.h>                             // 261, min() becomes __min(), etc.
 #include "wx/image.h"                   // Missing from wxprec.h
 #include "wx/tokenzr.h"
+#include "wx/thread.h"
 
 #ifdef __MSVC__
 #define _CRTDBG_MAP_ALLOC
@@ -87,6 +88,8 @@ s52plib::s52plib( const wxString& PLib, bool b_forceLegacy ) {
       pointPaperLUPArray = NULL; // points: PAPER_CHART
       condSymbolLUPArray = NULL; // Dynamic Conditional Symbology
 
+      m_pSymbolAtlas = new SymbolAtlas( SYMBOL_ATLAS_MAX_BYTES );
+
       _symb_sym = NULL;
 
       m_txf_ready = false;
@@ -96,6 +99,8 @@ s52plib::s52plib( const wxString& PLib, bool b_forceLegacy ) {
 
       m_bOK = !( S52_load_Plib( PLib, b_forceLegacy ) == 0 );
 
+      GenerateLUPHash();
+
       m_bShowS57Text = false;
       m_bShowS57ImportantTextOnly = false;
       m_colortable_index = 0;
@@ -114,6 +119,11 @@ s52plib::s52plib( const wxString& PLib, bool b_forceLegacy ) {
       ledge = new int[2000];
       redge = new int[2000];
 
+      m_bDeferAreaRaster = false;
+      m_pAreaOps = NULL;
+      m_nAreaOps = 0;
+      m_nAreaOpsMax = 0;
+
       //    Defaults
       m_VersionMajor = 3;
       m_VersionMinor = 2;
@@ -129,6 +139,10 @@ s52plib::s52plib( const wxString& PLib, bool b_forceLegacy ) {
       //        Set up some default flags
       m_bDeClutterText = false;
       m_bShowAtonText = true;
+      m_bShowLdisText = false;
+
+      m_cs_generation = 0;
+      GenerateStateHash();
 
       HPGL = new RenderFromHPGL( this );
 }
@@ -145,6 +159,10 @@ s52plib::~s52plib() {
       delete[] ledge;
       delete[] redge;
 
+      free( m_pAreaOps );
+
+      delete m_pSymbolAtlas;
+
       if( m_txf ) txfUnloadFont( m_txf );
 	  ChartSymbols::DeleteGlobals();
 
@@ -172,6 +190,93 @@ void s52plib::UpdateMarinerParams( void ) {
 
 void s52plib::GenerateStateHash() {
       m_state_hash = ::wxGetUTCTime();
+      GenerateCSStateHash();
+}
+
+static unsigned int HashCSState( unsigned int hash, const void *data, int len ) {
+      const unsigned char *p = (const unsigned char *) data;
+      for( int i = 0; i < len; i++ ) {
+            hash ^= p[i];
+            hash *= 16777619; // FNV-1a
+      }
+      return hash;
+}
+
+/*
+ Hash the library state that the conditional symbology procedures depend upon.
+ Unlike the general state hash, this is reproducible from run to run, and
+ does not include the colour scheme, which CS results do not depend upon.
+ */
+void s52plib::GenerateCSStateHash() {
+      unsigned int hash = 2166136261U;
+
+      for( int i = S52_MAR_SHOW_TEXT; i < S52_MAR_NUM; i++ ) {
+            if( S52_MAR_COLOR_PALETTE == i ) continue;
+            double val = S52_getMarinerParam( (S52_MAR_param_t) i );
+            hash = HashCSState( hash, &val, sizeof( val ) );
+      }
+
+      int state[4];
+      state[0] = m_nSymbolStyle;
+      state[1] = m_nBoundaryStyle;
+      state[2] = m_nDepthUnitDisplay;
+      state[3] = m_bShowLdisText ? 1 : 0;
+      hash = HashCSState( hash, state, sizeof( state ) );
+
+      m_cs_state_hash = (long) hash;
+}
+
+//    Display priority of an object, as set by its conditional symbology,
+//    else that of its LUP
+static DisPrio GetObjDisplayPriority( ObjRazRules *rzRules ) {
+      if( rzRules->obj->m_DPRI >= 0 ) return (DisPrio) rzRules->obj->m_DPRI;
+      return rzRules->LUP->DPRI;
+}
+
+/*
+ Hash the static lookup tables of the loaded library, so that results derived
+ from them, such as cached conditional symbology, can be tied to one library.
+ */
+void s52plib::GenerateLUPHash() {
+      unsigned int hash = 2166136261U;
+
+      wxArrayOfLUPrec *tables[5];
+      tables[0] = lineLUPArray;
+      tables[1] = areaPlaineLUPArray;
+      tables[2] = areaSymbolLUPArray;
+      tables[3] = pointSimplLUPArray;
+      tables[4] = pointPaperLUPArray;
+
+      for( int it = 0; it < 5; it++ ) {
+            if( !tables[it] ) continue;
+
+            for( unsigned int i = 0; i < tables[it]->GetCount(); i++ ) {
+                  LUPrec *LUP = tables[it]->Item( i );
+
+                  int fields[5];
+                  fields[0] = LUP->FTYP;
+                  fields[1] = LUP->DPRI;
+                  fields[2] = LUP->RPRI;
+                  fields[3] = LUP->TNAM;
+                  fields[4] = LUP->DISC;
+                  hash = HashCSState( hash, LUP->OBCL, strlen( LUP->OBCL ) );
+                  hash = HashCSState( hash, fields, sizeof( fields ) );
+
+                  if( LUP->INST ) {
+                        wxCharBuffer inst = LUP->INST->mb_str( wxConvUTF8 );
+                        hash = HashCSState( hash, inst.data(), strlen( inst.data() ) );
+                  }
+
+                  if( LUP->ATTCArray ) {
+                        for( unsigned int ia = 0; ia < LUP->ATTCArray->GetCount(); ia++ ) {
+                              wxCharBuffer attc = LUP->ATTCArray->Item( ia ).mb_str( wxConvUTF8 );
+                              hash = HashCSState( hash, attc.data(), strlen( attc.data() ) );
+                        }
+                  }
+            }
+      }
+
+      m_lup_hash = (long) hash;
 }
 
 wxArrayOfLUPrec* s52plib::SelectLUPARRAY( LUPname TNAM ) {
@@ -709,6 +814,9 @@ void s52plib::DestroyRuleNode( Rule *pR ) {
 
 void s52plib::DestroyRules( RuleHash *rh ) {
 
+      //    The atlas is keyed on Rule pointers, which are about to go stale
+      m_pSymbolAtlas->Flush();
+
       RuleHash::iterator it;
       wxString key;
       Rule *pR;
@@ -732,6 +840,8 @@ void s52plib::DestroyRules( RuleHash *rh ) {
 }
 
 void s52plib::FlushSymbolCaches( void ) {
+      m_pSymbolAtlas->Flush();
+
       RuleHash *rh = _symb_sym;
 
       if( !rh ) return;
@@ -869,6 +979,10 @@ void s52plib::ClearCNSYLUPArray( void ) {
 
             condSymbolLUPArray->Clear();
       }
+
+      //    Any object CS rules referring to these LUPs are now stale
+      m_CSLUP_hashmap.clear();
+      m_cs_generation++;
 }
 
 bool s52plib::S52_flush_Plib() {
@@ -888,6 +1002,8 @@ bool s52plib::S52_flush_Plib() {
       DestroyLUPArray( areaPlaineLUPArray );
       DestroyLUPArray( areaSymbolLUPArray );
       DestroyLUPArray( condSymbolLUPArray );
+      m_CSLUP_hashmap.clear();
+      m_cs_generation++;
 
 //      Destroy Rules
       DestroyRules( _line_sym );
@@ -1467,18 +1583,7 @@ bool s52plib::RenderText( wxDC *pdc, S52_TextC *ptext, int x, int y,
 
 //    Return true if test_rect overlaps any rect in the current text rectangle list, except itself
 bool s52plib::CheckTextRectList( const wxRect &test_rect, S57Obj *pobj ) {
-      //    Iterate over the current object list, looking at rText
-
-      for( ObjList::Node *node = m_textObjList.GetFirst(); node;
-                  node = node->GetNext() ) {
-            wxRect *pcurrent_rect = &( node->GetData()->rText );
-
-            if( pcurrent_rect->Intersects( test_rect ) ) {
-                  if( node->GetData() != pobj ) return true;
-
-            }
-      }
-      return false;
+      return m_TextGrid.Intersects( test_rect, pobj );
 }
 
 bool s52plib::TextRenderCheck( ObjRazRules *rzRules ) {
@@ -1576,21 +1681,10 @@ int s52plib::RenderT_All( ObjRazRules *rzRules, Rules *rules, ViewPort *vp,
 
             rzRules->obj->rText = rect;
 
-            //      If this text was actually drawn, add a pointer to its rect to the de-clutter list if it doesn't already exist
+            //      If this text was actually drawn, add its rect to the de-clutter grid,
+            //      replacing any earlier rect for the same object
             if( m_bDeClutterText ) {
-                  if( bwas_drawn ) {
-                        bool b_found = false;
-                        for( ObjList::Node *node = m_textObjList.GetFirst(); node;
-                                    node = node->GetNext() ) {
-                              S57Obj *oc = node->GetData();
-
-                              if( oc == rzRules->obj ) {
-                                    b_found = true;
-                                    break;
-                              }
-                        }
-                        if( !b_found ) m_textObjList.Append( rzRules->obj );
-                  }
+                  if( bwas_drawn ) m_TextGrid.Add( rzRules->obj, rect );
             }
 
             //  Update the object Bounding box
@@ -1667,6 +1761,136 @@ unsigned char *GetRGBA_Array( wxImage &Image ) {
       return e;
 }
 
+//-----------------------------------------------------------------------------
+//    SymbolAtlas implementation
+//-----------------------------------------------------------------------------
+
+SymbolAtlas::SymbolAtlas( int max_bytes ) {
+      m_lru_head = NULL;
+      m_lru_tail = NULL;
+      m_bytes = 0;
+      m_max_bytes = max_bytes;
+}
+
+SymbolAtlas::~SymbolAtlas() {
+      Flush();
+}
+
+long SymbolAtlas::MakeKey( Rule *prule, int colortable_index, int rot,
+            int scale_key, int type ) {
+      unsigned long key = (unsigned long) prule;
+      key = ( key * 31 ) + colortable_index;
+      key = ( key * 31 ) + rot;
+      key = ( key * 31 ) + scale_key;
+      key = ( key * 31 ) + type;
+      return (long) key;
+}
+
+SymbolAtlasEntry *SymbolAtlas::Find( Rule *prule, int colortable_index, int rot,
+            int scale_key, int type ) {
+      SymbolAtlasHash::iterator it = m_hash.find(
+                  MakeKey( prule, colortable_index, rot, scale_key, type ) );
+      if( it == m_hash.end() ) return NULL;
+
+      SymbolAtlasEntry *pe = it->second;
+      while( pe ) {
+            if( ( pe->prule == prule ) && ( pe->colortable_index == colortable_index )
+                        && ( pe->rot == rot ) && ( pe->scale_key == scale_key )
+                        && ( pe->type == type ) ) break;
+            pe = pe->hash_next;
+      }
+
+      //    Move to the head of the LRU list
+      if( pe && ( pe != m_lru_head ) ) {
+            pe->lru_prev->lru_next = pe->lru_next;
+            if( pe->lru_next ) pe->lru_next->lru_prev = pe->lru_prev;
+            else m_lru_tail = pe->lru_prev;
+
+            pe->lru_prev = NULL;
+            pe->lru_next = m_lru_head;
+            m_lru_head->lru_prev = pe;
+            m_lru_head = pe;
+      }
+
+      return pe;
+}
+
+//    Take ownership of a rendered symbol, dropping the least recently used
+//    symbols if the atlas is full
+SymbolAtlasEntry *SymbolAtlas::Add( Rule *prule, int colortable_index, int rot,
+            int scale_key, int type, void *pixels, int orgx, int orgy, int width,
+            int height ) {
+      SymbolAtlasEntry *pe = (SymbolAtlasEntry *) calloc( 1, sizeof(SymbolAtlasEntry) );
+      pe->prule = prule;
+      pe->colortable_index = colortable_index;
+      pe->rot = rot;
+      pe->scale_key = scale_key;
+      pe->type = type;
+      pe->pixels = pixels;
+      pe->orgx = orgx;
+      pe->orgy = orgy;
+      pe->width = width;
+      pe->height = height;
+      pe->nbytes = width * height * 4 + sizeof(SymbolAtlasEntry);
+
+      long key = MakeKey( prule, colortable_index, rot, scale_key, type );
+      SymbolAtlasHash::iterator it = m_hash.find( key );
+      pe->hash_next = ( it == m_hash.end() ) ? NULL : it->second;
+      m_hash[key] = pe;
+
+      pe->lru_prev = NULL;
+      pe->lru_next = m_lru_head;
+      if( m_lru_head ) m_lru_head->lru_prev = pe;
+      m_lru_head = pe;
+      if( !m_lru_tail ) m_lru_tail = pe;
+
+      m_bytes += pe->nbytes;
+
+      //    Never evict the entry just added
+      while( ( m_bytes > m_max_bytes ) && ( m_lru_tail != pe ) )
+            Remove( m_lru_tail );
+
+      return pe;
+}
+
+void SymbolAtlas::Remove( SymbolAtlasEntry *pe ) {
+      //    Unlink from the hash chain
+      long key = MakeKey( pe->prule, pe->colortable_index, pe->rot, pe->scale_key,
+                  pe->type );
+      SymbolAtlasHash::iterator it = m_hash.find( key );
+      if( it != m_hash.end() ) {
+            if( it->second == pe ) {
+                  if( pe->hash_next ) it->second = pe->hash_next;
+                  else m_hash.erase( it );
+            } else {
+                  SymbolAtlasEntry *pc = it->second;
+                  while( pc && ( pc->hash_next != pe ) )
+                        pc = pc->hash_next;
+                  if( pc ) pc->hash_next = pe->hash_next;
+            }
+      }
+
+      //    Unlink from the LRU list
+      if( pe->lru_prev ) pe->lru_prev->lru_next = pe->lru_next;
+      else m_lru_head = pe->lru_next;
+      if( pe->lru_next ) pe->lru_next->lru_prev = pe->lru_prev;
+      else m_lru_tail = pe->lru_prev;
+
+      m_bytes -= pe->nbytes;
+
+      if( ID_wxBitmap == pe->type ) delete (wxBitmap *) pe->pixels;
+      else free( pe->pixels );
+
+      free( pe );
+}
+
+void SymbolAtlas::Flush( void ) {
+      while( m_lru_head )
+            Remove( m_lru_head );
+
+      m_hash.clear();
+}
+
 bool s52plib::RenderHPGL( ObjRazRules *rzRules, Rule *prule, wxPoint &r,
             ViewPort *vp, float rot_angle ) {
       float fsf = 100 / canvas_pix_per_mm;
@@ -1682,22 +1906,18 @@ bool s52plib::RenderHPGL( ObjRazRules *rzRules, Rule *prule, wxPoint &r,
       int pivot_x = prule->pos.symb.pivot_x.SYCL;
       int pivot_y = prule->pos.symb.pivot_y.SYRW;
 
-      //    Check to see if any cached data is valid
-      bool b_dump_cache = false;
-      if( prule->pixelPtr ) {
-            if( m_pdc ) {
-                  if( prule->parm0 != ID_wxBitmap ) b_dump_cache = true;
-            } else {
-                  if( prule->parm0 != ID_RGBA ) b_dump_cache = true;
-            }
-      }
+      //    Symbols are cached per colour table, whole degree of rotation,
+      //    display scale and renderer
+      int irot = (int) floor( rot_angle + 0.5 ) % 360;
+      if( irot < 0 ) irot += 360;
+      int scale_key = (int) ( canvas_pix_per_mm * 1000 );
+      int type = m_pdc ? ID_wxBitmap : ID_RGBA;
 
-      //Instantiate the symbol if necessary
-      if( ( prule->pixelPtr == NULL ) || ( prule->parm1 != m_colortable_index )
-                  || b_dump_cache ) {
-            // delete any old private data
-            ClearRulesCache( prule );
+      SymbolAtlasEntry *pae = m_pSymbolAtlas->Find( prule, m_colortable_index, irot,
+                  scale_key, type );
 
+      //Instantiate the symbol if necessary
+      if( !pae ) {
 //            if((width == 0) || (height == 0))
 //                  int yyp = 4;
 
@@ -1713,7 +1933,7 @@ bool s52plib::RenderHPGL( ObjRazRules *rzRules, Rule *prule, wxPoint &r,
             wxPoint r0( (int) ( pivot_x / fsf ), (int) ( pivot_y / fsf ) );
 
             HPGL->SetTargetDC( &mdc );
-            HPGL->Render( str, col, r0, pivot, (double) rot_angle );
+            HPGL->Render( str, col, r0, pivot, (double) irot );
 
             int bm_width = ( mdc.MaxX() - mdc.MinX() ) + 1;
             int bm_height = ( mdc.MaxY() - mdc.MinY() ) + 1;
@@ -1738,6 +1958,9 @@ bool s52plib::RenderHPGL( ObjRazRules *rzRules, Rule *prule, wxPoint &r,
             //      Associate the mask with the bitmap
             sbm->SetMask( pmask );
 
+            int orgx = bm_orgx - (int) ( pivot_x / fsf );
+            int orgy = bm_orgy - (int) ( pivot_y / fsf );
+
             if( !m_pdc ) // opengl
             {
                   //    Create a byte data accessible wxImage from the wxBitmap
@@ -1747,117 +1970,31 @@ bool s52plib::RenderHPGL( ObjRazRules *rzRules, Rule *prule, wxPoint &r,
                   //    Get the glRGBA format data from the wxImage
                   unsigned char *e = GetRGBA_Array( Image );
 
-                  //      Save the byte array ptr and aux parms in the rule
-                  prule->pixelPtr = e;
-                  prule->parm0 = ID_RGBA;
-                  prule->parm1 = m_colortable_index;
-                  prule->parm2 = bm_orgx - (int) ( pivot_x / fsf );
-                  prule->parm3 = bm_orgy - (int) ( pivot_y / fsf );
-                  prule->parm4 = (int) rot_angle;
-                  prule->parm5 = Image.GetWidth();
-                  prule->parm6 = Image.GetHeight();
+                  //      The atlas now owns the byte array
+                  pae = m_pSymbolAtlas->Add( prule, m_colortable_index, irot, scale_key,
+                              type, e, orgx, orgy, Image.GetWidth(), Image.GetHeight() );
             } else // wxDC render
             {
-                  //      Save the bitmap ptr and aux parms in the rule
-                  prule->pixelPtr = sbm;
-                  prule->parm0 = ID_wxBitmap;
-                  prule->parm1 = m_colortable_index;
-                  prule->parm2 = bm_orgx - (int) ( pivot_x / fsf );
-                  prule->parm3 = bm_orgy - (int) ( pivot_y / fsf );
-                  prule->parm4 = (int) rot_angle;
-                  prule->parm5 = bm_width;
-                  prule->parm6 = bm_height;
+                  //      The atlas now owns the bitmap
+                  pae = m_pSymbolAtlas->Add( prule, m_colortable_index, irot, scale_key,
+                              type, sbm, orgx, orgy, bm_width, bm_height );
             }
 
       } // instantiation
 
-      //    If the rotation angle of the cached symbol is not equal to the request,
-      //    then render the symbol directly in HPGL
-      if( (int) rot_angle != prule->parm4 ) {
-            if( m_pdc ) {
-                  char *str = prule->vector.LVCT;
-                  char *col = prule->colRef.LCRF;
-                  wxPoint pivot( prule->pos.line.pivot_x.LICL,
-                              prule->pos.line.pivot_y.LIRW );
-
-                  HPGL->SetTargetDC( m_pdc );
-                  HPGL->Render( str, col, r, pivot, (double) rot_angle );
-            } else {
-                  wxBitmap *pbm = new wxBitmap( width, height );
-                  wxMemoryDC mdc;
-                  mdc.SelectObject( *pbm );
-                  mdc.SetBackground( wxBrush( m_unused_wxColor ) );
-                  mdc.Clear();
-
-                  char *str = prule->vector.LVCT;
-                  char *col = prule->colRef.LCRF;
-                  wxPoint pivot( pivot_x, pivot_y );
-                  wxPoint r0( (int) ( pivot_x / fsf ), (int) ( pivot_y / fsf ) );
-
-                  HPGL->SetTargetDC( &mdc );
-                  HPGL->Render( str, col, r0, pivot, (double) rot_angle );
-
-                  int bm_width = ( mdc.MaxX() - mdc.MinX() ) + 1;
-                  int bm_height = ( mdc.MaxY() - mdc.MinY() ) + 1;
-                  int bm_orgx = wxMax ( 0, mdc.MinX() );
-                  int bm_orgy = wxMax ( 0, mdc.MinY() );
-
-                  //      Pre-clip the sub-bitmap to avoid assert errors
-                  if( ( bm_height + bm_orgy ) > height ) bm_height = height - bm_orgy;
-                  if( ( bm_width + bm_orgx ) > width ) bm_width = width - bm_orgx;
-
-                  mdc.SelectObject( wxNullBitmap );
-
-                  //          Get smallest containing bitmap
-                  wxBitmap *sbm = new wxBitmap(
-                              pbm->GetSubBitmap(
-                                          wxRect( bm_orgx, bm_orgy, bm_width, bm_height ) ) );
-                  delete pbm;
-
-                  //      Make the mask
-                  wxMask *pmask = new wxMask( *sbm, m_unused_wxColor );
-                  //      Associate the mask with the bitmap
-                  sbm->SetMask( pmask );
-
-                  //    Create a byte data accessible wxImage from the wxBitmap
-                  wxImage Image = sbm->ConvertToImage();
-                  delete sbm; // done with this
-
-                  unsigned char *e = GetRGBA_Array( Image );
-
-                  //   And Render
-                  glColor4f( 1, 1, 1, 1 );
-
-                  glEnable( GL_BLEND );
-                  glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-                  glRasterPos2i( r.x + ( bm_orgx - (int) ( pivot_x / fsf ) ),
-                              r.y + ( bm_orgy - (int) ( pivot_y / fsf ) ) );
-                  glPixelZoom( 1, -1 );
-                  glDrawPixels( Image.GetWidth(), Image.GetHeight(), GL_RGBA,
-                              GL_UNSIGNED_BYTE, e );
-                  glPixelZoom( 1, 1 );
-                  glDisable( GL_BLEND );
-
-                  free( e );
-
-            }
-
-            return true;
-      }
-
       //        Get the bounding box for the as-drawn symbol
-      int b_width = prule->parm5;
-      int b_height = prule->parm6;
+      int b_width = pae->width;
+      int b_height = pae->height;
 
       wxBoundingBox symbox;
       double plat, plon;
 
-      rzRules->chart->GetPixPoint( r.x + prule->parm2,
-                  r.y + prule->parm3 + b_height, &plat, &plon, vp );
+      rzRules->chart->GetPixPoint( r.x + pae->orgx,
+                  r.y + pae->orgy + b_height, &plat, &plon, vp );
       symbox.SetMin( plon, plat );
 
-      rzRules->chart->GetPixPoint( r.x + prule->parm2 + b_width,
-                  r.y + prule->parm3, &plat, &plon, vp );
+      rzRules->chart->GetPixPoint( r.x + pae->orgx + b_width,
+                  r.y + pae->orgy, &plat, &plon, vp );
       symbox.SetMax( plon, plat );
 
       /*
@@ -1876,20 +2013,20 @@ bool s52plib::RenderHPGL( ObjRazRules *rzRules, Rule *prule, wxPoint &r,
 
             glEnable( GL_BLEND );
             glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-            glRasterPos2i( r.x + prule->parm2, r.y + prule->parm3 );
+            glRasterPos2i( r.x + pae->orgx, r.y + pae->orgy );
             glPixelZoom( 1, -1 );
             glDrawPixels( b_width, b_height, GL_RGBA, GL_UNSIGNED_BYTE,
-                        prule->pixelPtr );
+                        pae->pixels );
             glPixelZoom( 1, 1 );
             glDisable( GL_BLEND );
       } else {
             //      Get the bitmap into a memory dc
             wxMemoryDC mdc;
             mdc.SelectObject(
-                        (wxBitmap &) ( *( (wxBitmap *) ( prule->pixelPtr ) ) ) );
+                        (wxBitmap &) ( *( (wxBitmap *) ( pae->pixels ) ) ) );
 
             //      Blit  it into the target dc
-            m_pdc->Blit( r.x + prule->parm2, r.y + prule->parm3, b_width, b_height,
+            m_pdc->Blit( r.x + pae->orgx, r.y + pae->orgy, b_width, b_height,
                         &mdc, 0, 0, wxCOPY, true );
 
             mdc.SelectObject( wxNullBitmap );
@@ -1975,33 +2112,25 @@ bool s52plib::RenderRasterSymbol( ObjRazRules *rzRules, Rule *prule, wxPoint &r,
             ViewPort *vp, float rot_angle )
 {
 
-      //    Check to see if any cached data is valid
-      bool b_dump_cache = false;
-      if( prule->pixelPtr ) {
-            if( m_pdc ) {
-                  if( prule->parm0 != ID_wxBitmap ) b_dump_cache = true;
-            } else {
-                  if( prule->parm0 != ID_RGBA ) b_dump_cache = true;
-            }
-      }
-
       wxBitmap *pbm = NULL;
       wxImage Image;
 
       int pivot_x = prule->pos.line.pivot_x.SYCL;
       int pivot_y = prule->pos.line.pivot_y.SYRW;
 
+      //    Raster symbols are drawn unrotated at native size, so the atlas
+      //    keeps one entry per colour table and renderer
+      int type = m_pdc ? ID_wxBitmap : ID_RGBA;
+      SymbolAtlasEntry *pae = m_pSymbolAtlas->Find( prule, m_colortable_index, 0, 0,
+                  type );
+
       //Instantiate the symbol if necessary
-      if( ( prule->pixelPtr == NULL ) || ( prule->parm1 != m_colortable_index )
-                  || b_dump_cache ) {
+      if( !pae ) {
             Image =
                         useLegacyRaster ?
                                           RuleXBMToImage( prule ) :
                                           ChartSymbols::GetImage( prule->name.SYNM );
 
-            // delete any old private data
-            ClearRulesCache( prule );
-
             int w = Image.GetWidth();
             int h = Image.GetHeight();
 
@@ -2038,12 +2167,9 @@ bool s52plib::RenderRasterSymbol( ObjRazRules *rzRules, Rule *prule, wxPoint &r,
                         }
                   }
 
-                  //      Save the bitmap ptr and aux parms in the rule
-                  prule->pixelPtr = e;
-                  prule->parm0 = ID_RGBA;
-                  prule->parm1 = m_colortable_index;
-                  prule->parm2 = w;
-                  prule->parm3 = h;
+                  //      The atlas now owns the byte array
+                  pae = m_pSymbolAtlas->Add( prule, m_colortable_index, 0, 0, type, e,
+                              -pivot_x, -pivot_y, w, h );
             } else {
                   //      Make the masked Bitmap
                   if( useLegacyRaster ) {
@@ -2094,20 +2220,18 @@ bool s52plib::RenderRasterSymbol( ObjRazRules *rzRules, Rule *prule, wxPoint &r,
 
 
 
-                  //      Save the bitmap ptr and aux parms in the rule
-                  prule->pixelPtr = pbm;
-                  prule->parm0 = ID_wxBitmap;
-                  prule->parm1 = m_colortable_index;
-                  prule->parm2 = w;
-                  prule->parm3 = h;
+                  //      The atlas now owns the bitmap.
+                  //      A NULL bitmap marks a symbol that needs manual alpha blending
+                  pae = m_pSymbolAtlas->Add( prule, m_colortable_index, 0, 0, type, pbm,
+                              -pivot_x, -pivot_y, w, h );
 
             }
       }               // instantiation
 
       //        Get the bounding box for the to-be-drawn symbol
       int b_width, b_height;
-      b_width = prule->parm2;
-      b_height = prule->parm3;
+      b_width = pae->width;
+      b_height = pae->height;
 
       wxBoundingBox symbox;
       double plat, plon;
@@ -2142,13 +2266,13 @@ bool s52plib::RenderRasterSymbol( ObjRazRules *rzRules, Rule *prule, wxPoint &r,
             glRasterPos2f( r.x - ddx, r.y - ddy );
             glPixelZoom( 1, -1 );
             glDrawPixels( b_width, b_height, GL_RGBA, GL_UNSIGNED_BYTE,
-                        prule->pixelPtr );
+                        pae->pixels );
             glPixelZoom( 1, 1 );
             glDisable( GL_BLEND );
 
       } else {
 
-            if(!( prule->pixelPtr ))                // This symbol requires manual alpha blending
+            if(!( pae->pixels ))                // This symbol requires manual alpha blending
             {
                   // Get the current screen contents
                   wxBitmap b1(b_width, b_height, -1);
@@ -2198,7 +2322,7 @@ bool s52plib::RenderRasterSymbol( ObjRazRules *rzRules, Rule *prule, wxPoint &r,
             {
             //      Get the symbol bitmap into a memory dc
                   wxMemoryDC mdc;
-                  mdc.SelectObject((wxBitmap &) ( *( (wxBitmap *) ( prule->pixelPtr ) ) ) );
+                  mdc.SelectObject((wxBitmap &) ( *( (wxBitmap *) ( pae->pixels ) ) ) );
 
             //      Blit it into the target dc
                   m_pdc->Blit( r.x - pivot_x, r.y - pivot_y, b_width, b_height, &mdc, 0,
@@ -2334,7 +2458,7 @@ int s52plib::RenderLS( ObjRazRules *rzRules, Rules *rules, ViewPort *vp ) {
       int x0, y0, x1, y1;
 
       //  Get the current display priority from the LUP
-      int priority_current = rzRules->LUP->DPRI - '0'; //TODO fix this hack by putting priority into object during _insertRules
+      int priority_current = GetObjDisplayPriority( rzRules ) - '0'; //TODO fix this hack by putting priority into object during _insertRules
 
       if( rzRules->obj->m_n_lsindex ) {
             VE_Hash &ve_hash = rzRules->chart->Get_ve_hash();
@@ -2395,14 +2519,22 @@ int s52plib::RenderLS( ObjRazRules *rzRules, Rules *rules, ViewPort *vp ) {
                   //  That is, if this segment is going to be drawn at a higher priority later, then "continue", and don't draw it here.
                   if( pedge->max_priority != priority_current ) continue;
 
-                  int nls = pedge->nCount;
-
-                  ppt = pedge->pPoints;
-                  for( int ip = 0; ip < nls; ip++ ) {
-                        easting = *ppt++;
-                        northing = *ppt++;
-                        rzRules->chart->GetPointPix( rzRules, (float) northing,
-                                    (float) easting, &ptp[ip + 1] );
+                  //  Use the retained edge geometry if the chart keeps it, else project directly
+                  int nls;
+                  wxPoint *pedge_pix = rzRules->chart->GetEdgePix( pedge, &nls );
+                  if( pedge_pix ) {
+                        wxPoint pix_offset = rzRules->chart->GetPixOffset();
+                        for( int ip = 0; ip < nls; ip++ )
+                              ptp[ip + 1] = pedge_pix[ip] + pix_offset;
+                  } else {
+                        nls = pedge->nCount;
+                        ppt = pedge->pPoints;
+                        for( int ip = 0; ip < nls; ip++ ) {
+                              easting = *ppt++;
+                              northing = *ppt++;
+                              rzRules->chart->GetPointPix( rzRules, (float) northing,
+                                          (float) easting, &ptp[ip + 1] );
+                        }
                   }
 
                   //  Get last connected node
@@ -2624,7 +2756,7 @@ int s52plib::RenderLC( ObjRazRules *rzRules, Rules *rules, ViewPort *vp ) {
       wxColour color( c->R, c->G, c->B );
 
       //  Get the current display priority from the LUP
-      int priority_current = rzRules->LUP->DPRI - '0'; //TODO fix this hack by putting priority into object during _insertRules
+      int priority_current = GetObjDisplayPriority( rzRules ) - '0'; //TODO fix this hack by putting priority into object during _insertRules
 
       if( rzRules->obj->m_n_lsindex ) {
             VE_Hash &ve_hash = rzRules->chart->Get_ve_hash();
@@ -2684,14 +2816,22 @@ int s52plib::RenderLC( ObjRazRules *rzRules, Rules *rules, ViewPort *vp ) {
                   //  That is, if this segment is going to be drawn at a higher priority later, then don't draw it here.
                   if( pedge->max_priority != priority_current ) continue;
 
-                  int nls = pedge->nCount;
-
-                  ppt = pedge->pPoints;
-                  for( int ip = 0; ip < nls; ip++ ) {
-                        easting = *ppt++;
-                        northing = *ppt++;
-                        rzRules->chart->GetPointPix( rzRules, (float) northing,
-                                    (float) easting, &ptp[ip + 1] );
+                  //  Use the retained edge geometry if the chart keeps it, else project directly
+                  int nls;
+                  wxPoint *pedge_pix = rzRules->chart->GetEdgePix( pedge, &nls );
+                  if( pedge_pix ) {
+                        wxPoint pix_offset = rzRules->chart->GetPixOffset();
+                        for( int ip = 0; ip < nls; ip++ )
+                              ptp[ip + 1] = pedge_pix[ip] + pix_offset;
+                  } else {
+                        nls = pedge->nCount;
+                        ppt = pedge->pPoints;
+                        for( int ip = 0; ip < nls; ip++ ) {
+                              easting = *ppt++;
+                              northing = *ppt++;
+                              rzRules->chart->GetPointPix( rzRules, (float) northing,
+                                          (float) easting, &ptp[ip + 1] );
+                        }
                   }
 
                   //  Get last connected node
@@ -3586,11 +3726,7 @@ int s52plib::DoRenderObject( wxDC *pdcin, ObjRazRules *rzRules, ViewPort *vp ) {
                         break; // Circular Arc, 2 colors
 
                   case RUL_CND_SY: {
-                        if( !rzRules->obj->bCS_Added ) {
-                              rzRules->obj->CSrules = NULL;
-                              GetAndAddCSRules( rzRules, rules );
-                              rzRules->obj->bCS_Added = 1; // mark the object
-                        }
+                        UpdateCSRules( rzRules, rules );
 
                         //    The CS procedure may have changed the Display Category of the Object, need to check again for visibility
                         if( ObjectRenderCheckCat( rzRules, vp ) ) {
@@ -3603,7 +3739,7 @@ int s52plib::DoRenderObject( wxDC *pdcin, ObjRazRules *rzRules, ViewPort *vp ) {
                                           case RUL_SIM_LN:
                                                 case RUL_COM_LN: {
                                                 PrioritizeLineFeature( rzRules,
-                                                            rzRules->LUP->DPRI - '0' );
+                                                            GetObjDisplayPriority( rzRules ) - '0' );
                                                 break;
                                           }
                                           default:
@@ -3786,11 +3922,7 @@ int s52plib::SetLineFeaturePriority( ObjRazRules *rzRules, int npriority ) {
                         break; // LC
 
                   case RUL_CND_SY: {
-                        if( !rzRules->obj->bCS_Added ) {
-                              rzRules->obj->CSrules = NULL;
-                              GetAndAddCSRules( rzRules, rules );
-                              rzRules->obj->bCS_Added = 1; // mark the object
-                        }
+                        UpdateCSRules( rzRules, rules );
                         Rules *rules_last = rules;
                         rules = rzRules->obj->CSrules;
 
@@ -4015,7 +4147,7 @@ bool s52plib::inter_tri_rect( wxPoint *ptp, render_canvas_parms *pb_spec ) {
 //
 //----------------------------------------------------------------------------------
 int s52plib::dda_tri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
-            render_canvas_parms *pPatt_spec ) {
+            render_canvas_parms *pPatt_spec, int *pledge, int *predge ) {
       unsigned char r = 0;
       unsigned char g = 0;
       unsigned char b = 0;
@@ -4090,7 +4222,7 @@ int s52plib::dda_tri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
                   x = xmin << 8;
 
                   for( count = ymin; count <= ymax; count++ ) {
-                        if( ( count >= 0 ) && ( count < 1500 ) ) ledge[count] = x >> 8;
+                        if( ( count >= 0 ) && ( count < 1500 ) ) pledge[count] = x >> 8;
                         x += m;
                   }
             }
@@ -4103,7 +4235,7 @@ int s52plib::dda_tri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
                   x = xmin << 8;
 
                   for( count = ymin; count <= ymid; count++ ) {
-                        if( ( count >= 0 ) && ( count < 1500 ) ) redge[count] = x >> 8;
+                        if( ( count >= 0 ) && ( count < 1500 ) ) predge[count] = x >> 8;
                         x += m;
                   }
             }
@@ -4116,7 +4248,7 @@ int s52plib::dda_tri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
                   x = xmid << 8;
 
                   for( count = ymid; count <= ymax; count++ ) {
-                        if( ( count >= 0 ) && ( count < 1500 ) ) redge[count] = x >> 8;
+                        if( ( count >= 0 ) && ( count < 1500 ) ) predge[count] = x >> 8;
                         x += m;
                   }
             }
@@ -4138,7 +4270,7 @@ int s52plib::dda_tri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
                   x = xmin << 16;
 
                   for( count = ymin; count <= ymax; count++ ) {
-                        if( ( count >= 0 ) && ( count < 1500 ) ) ledge[count] = x >> 16;
+                        if( ( count >= 0 ) && ( count < 1500 ) ) pledge[count] = x >> 16;
                         x += m;
                   }
             }
@@ -4151,7 +4283,7 @@ int s52plib::dda_tri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
                   x = xmin << 16;
 
                   for( count = ymin; count <= ymid; count++ ) {
-                        if( ( count >= 0 ) && ( count < 1500 ) ) redge[count] = x >> 16;
+                        if( ( count >= 0 ) && ( count < 1500 ) ) predge[count] = x >> 16;
                         x += m;
                   }
             }
@@ -4164,7 +4296,7 @@ int s52plib::dda_tri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
                   x = xmid << 16;
 
                   for( count = ymid; count <= ymax; count++ ) {
-                        if( ( count >= 0 ) && ( count < 1500 ) ) redge[count] = x >> 16;
+                        if( ( count >= 0 ) && ( count < 1500 ) ) predge[count] = x >> 16;
                         x += m;
                   }
             }
@@ -4179,7 +4311,7 @@ int s52plib::dda_tri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
 
       } // else
 
-      //      if cw is true, redge is actually on the right
+      //      if cw is true, predge is actually on the right
 
       int y1 = ymax;
       int y2 = ymin;
@@ -4199,26 +4331,26 @@ int s52plib::dda_tri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
       //              Clip the triangle
       if( cw ) {
             for( int iy = y2; iy <= y1; iy++ ) {
-                  if( ledge[iy] < lclip ) {
-                        if( redge[iy] < lclip ) ledge[iy] = -1;
-                        else ledge[iy] = lclip;
+                  if( pledge[iy] < lclip ) {
+                        if( predge[iy] < lclip ) pledge[iy] = -1;
+                        else pledge[iy] = lclip;
                   }
 
-                  if( redge[iy] > rclip ) {
-                        if( ledge[iy] > rclip ) ledge[iy] = -1;
-                        else redge[iy] = rclip;
+                  if( predge[iy] > rclip ) {
+                        if( pledge[iy] > rclip ) pledge[iy] = -1;
+                        else predge[iy] = rclip;
                   }
             }
       } else {
             for( int iy = y2; iy <= y1; iy++ ) {
-                  if( redge[iy] < lclip ) {
-                        if( ledge[iy] < lclip ) ledge[iy] = -1;
-                        else redge[iy] = lclip;
+                  if( predge[iy] < lclip ) {
+                        if( pledge[iy] < lclip ) pledge[iy] = -1;
+                        else predge[iy] = lclip;
                   }
 
-                  if( ledge[iy] > rclip ) {
-                        if( redge[iy] > rclip ) ledge[iy] = -1;
-                        else ledge[iy] = rclip;
+                  if( pledge[iy] > rclip ) {
+                        if( predge[iy] > rclip ) pledge[iy] = -1;
+                        else pledge[iy] = rclip;
                   }
             }
       }
@@ -4248,14 +4380,14 @@ int s52plib::dda_tri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
 
                         int ix, ixm;
                         if( cw ) {
-                              ix = ledge[iyp];
-                              ixm = redge[iyp];
+                              ix = pledge[iyp];
+                              ixm = predge[iyp];
                         } else {
-                              ixm = ledge[iyp];
-                              ix = redge[iyp];
+                              ixm = pledge[iyp];
+                              ix = predge[iyp];
                         }
 
-                        if( ledge[iyp] != -1 ) {
+                        if( pledge[iyp] != -1 ) {
 
                               //    This would be considered a failure of the dda algorithm
                               //    Happens on very high zoom, with very large triangles.
@@ -4378,14 +4510,14 @@ __asm__ __volatile__ ( \
 
                         int ix, ixm;
                         if( cw ) {
-                              ix = ledge[iyp];
-                              ixm = redge[iyp];
+                              ix = pledge[iyp];
+                              ixm = predge[iyp];
                         } else {
-                              ixm = ledge[iyp];
-                              ix = redge[iyp];
+                              ixm = pledge[iyp];
+                              ix = predge[iyp];
                         }
 
-                        if( ledge[iyp] != -1 ) {
+                        if( pledge[iyp] != -1 ) {
                               //    This would be considered a failure of the dda algorithm
                               //    Happens on very high zoom, with very large triangles.
                               //    The integers of the dda algorithm don't have enough bits...
@@ -4477,7 +4609,7 @@ __asm__ __volatile__ ( \
 //----------------------------------------------------------------------------------
 inline int s52plib::dda_trap( wxPoint *segs, int lseg, int rseg, int ytop,
             int ybot, S52color *c, render_canvas_parms *pb_spec,
-            render_canvas_parms *pPatt_spec ) {
+            render_canvas_parms *pPatt_spec, int *pledge, int *predge ) {
       unsigned char r = 0, g = 0, b = 0;
 
       if( NULL != c ) {
@@ -4532,12 +4664,12 @@ inline int s52plib::dda_trap( wxPoint *segs, int lseg, int rseg, int ytop,
       y_dda_limit = wxMin ( y_dda_limit, 1499 ); // don't overrun edge array
 
       //    Some peephole optimization:
-      //    if xmax and xmin are both < 0, arrange to simply fill the ledge array with 0
+      //    if xmax and xmin are both < 0, arrange to simply fill the pledge array with 0
       if( ( xmax < 0 ) && ( xmin < 0 ) ) {
             xmax = -2;
             xmin = -2;
       }
-      //    if xmax and xmin are both > rclip, arrange to simply fill the ledge array with rclip + 1
+      //    if xmax and xmin are both > rclip, arrange to simply fill the pledge array with rclip + 1
       //    This may induce special clip case below, and cause trap not to be rendered
       else if( ( xmax > rclip ) && ( xmin > rclip ) ) {
             xmax = rclip + 1;
@@ -4559,14 +4691,14 @@ inline int s52plib::dda_trap( wxPoint *segs, int lseg, int rseg, int ytop,
             }
 
             while( count < y_dda_limit ) {
-                  ledge[count] = x >> 16;
+                  pledge[count] = x >> 16;
                   x += m;
                   count++;
             }
       }
 
       if( ( ytop < ymin ) || ( ybot > ymax ) ) {
-//            printf ( "### ledge out of range\n" );
+//            printf ( "### pledge out of range\n" );
             ret_val = 1;
 //            r=255;
 //            g=0;
@@ -4591,14 +4723,14 @@ inline int s52plib::dda_trap( wxPoint *segs, int lseg, int rseg, int ytop,
       }
 
       //    Some peephole optimization:
-      //    if xmax and xmin are both < 0, arrange to simply fill the redge array with -1
+      //    if xmax and xmin are both < 0, arrange to simply fill the predge array with -1
       //    This may induce special clip case below, and cause trap not to be rendered
       if( ( xmax < 0 ) && ( xmin < 0 ) ) {
             xmax = -1;
             xmin = -1;
       }
 
-      //    if xmax and xmin are both > rclip, arrange to simply fill the redge array with rclip + 1
+      //    if xmax and xmin are both > rclip, arrange to simply fill the predge array with rclip + 1
       //    This may induce special clip case below, and cause trap not to be rendered
       else if( ( xmax > rclip ) && ( xmin > rclip ) ) {
             xmax = rclip + 1;
@@ -4622,14 +4754,14 @@ inline int s52plib::dda_trap( wxPoint *segs, int lseg, int rseg, int ytop,
             }
 
             while( count < y_dda_limit ) {
-                  redge[count] = x >> 16;
+                  predge[count] = x >> 16;
                   x += m;
                   count++;
             }
       }
 
       if( ( ytop < ymin ) || ( ybot > ymax ) ) {
-//            printf ( "### redge out of range\n" );
+//            printf ( "### predge out of range\n" );
             ret_val = 1;
 //            r=255;
 //            g=0;
@@ -4651,14 +4783,14 @@ inline int s52plib::dda_trap( wxPoint *segs, int lseg, int rseg, int ytop,
 
       //   Clip the trapezoid to width
       for( int iy = y2; iy <= y1; iy++ ) {
-            if( ledge[iy] < lclip ) {
-                  if( redge[iy] < lclip ) ledge[iy] = -1;
-                  else ledge[iy] = lclip;
+            if( pledge[iy] < lclip ) {
+                  if( predge[iy] < lclip ) pledge[iy] = -1;
+                  else pledge[iy] = lclip;
             }
 
-            if( redge[iy] > rclip ) {
-                  if( ledge[iy] > rclip ) ledge[iy] = -1;
-                  else redge[iy] = rclip;
+            if( predge[iy] > rclip ) {
+                  if( pledge[iy] > rclip ) pledge[iy] = -1;
+                  else predge[iy] = rclip;
             }
       }
 
@@ -4688,13 +4820,13 @@ inline int s52plib::dda_trap( wxPoint *segs, int lseg, int rseg, int ytop,
                         unsigned char *py = pix_buff + yoff;
 
                         int ix, ixm;
-                        ix = ledge[iyp];
-                        ixm = redge[iyp];
+                        ix = pledge[iyp];
+                        ixm = predge[iyp];
 
 //                        if(debug) printf("iyp %d, ix %d, ixm %d\n", iyp, ix, ixm);
-//                           int ix = ledge[iyp];
+//                           int ix = pledge[iyp];
 //                            if(ix != -1)                    // special clip case
-                        if( ledge[iyp] != -1 ) {
+                        if( pledge[iyp] != -1 ) {
                               int xoff = ( ix - pb_spec->x ) * 3;
 
                               unsigned char *px = py + xoff;
@@ -4806,10 +4938,10 @@ inline int s52plib::dda_trap( wxPoint *segs, int lseg, int rseg, int ytop,
                         unsigned char *py = pix_buff + yoff;
 
                         int ix, ixm;
-                        ix = ledge[iyp];
-                        ixm = redge[iyp];
+                        ix = pledge[iyp];
+                        ixm = predge[iyp];
 
-                        if( ledge[iyp] != -1 ) {
+                        if( pledge[iyp] != -1 ) {
                               int xoff = ( ix - pb_spec->x ) * pb_spec->depth / 8;
 
                               unsigned char *px = py + xoff;
@@ -4887,6 +5019,193 @@ inline int s52plib::dda_trap( wxPoint *segs, int lseg, int rseg, int ytop,
       return ret_val;
 }
 
+//----------------------------------------------------------------------------------
+//
+//              Deferred, band parallel area rasterising
+//
+//    Between BeginAreaRaster() and FlushAreaRaster(), the area fill primitives
+//    are collected in display priority order instead of being drawn. The flush
+//    splits the render buffer into horizontal bands, and rasterises the whole
+//    list into each band on its own thread. Bands share no pixels, and each
+//    replays the list in order, so the result is the same as a serial render.
+//
+//----------------------------------------------------------------------------------
+
+#define AREA_OP_TRI             0
+#define AREA_OP_TRAP            1
+
+#define AREA_RASTER_THREADS_MAX 4
+#define AREA_RASTER_BAND_MIN    64              // rows
+#define AREA_RASTER_OPS_MIN     256             // not worth the threads below this
+
+class AreaRasterThread: public wxThread {
+public:
+      AreaRasterThread( s52plib *plib, render_canvas_parms *pband ) :
+                  wxThread( wxTHREAD_JOINABLE ) {
+            m_plib = plib;
+            m_pband = pband;
+      }
+
+      void *Entry() {
+            int *pledge = new int[2000];
+            int *predge = new int[2000];
+
+            m_plib->RasterAreaOps( m_pband, pledge, predge );
+
+            delete[] pledge;
+            delete[] predge;
+            return 0;
+      }
+
+private:
+      s52plib *m_plib;
+      render_canvas_parms *m_pband;
+};
+
+void s52plib::BeginAreaRaster( void ) {
+      m_nAreaOps = 0;
+      m_bDeferAreaRaster = true;
+}
+
+AreaRasterOp *s52plib::AddAreaOp( void ) {
+      if( m_nAreaOps == m_nAreaOpsMax ) {
+            int new_max = wxMax( 1024, m_nAreaOpsMax * 2 );
+            AreaRasterOp *pnew = (AreaRasterOp *) realloc( m_pAreaOps,
+                        new_max * sizeof(AreaRasterOp) );
+            if( !pnew ) return NULL;
+
+            m_pAreaOps = pnew;
+            m_nAreaOpsMax = new_max;
+      }
+
+      return &m_pAreaOps[m_nAreaOps++];
+}
+
+void s52plib::RasterTri( wxPoint *ptp, S52color *c, render_canvas_parms *pb_spec,
+            render_canvas_parms *pPatt_spec ) {
+      AreaRasterOp *pop = NULL;
+      if( m_bDeferAreaRaster ) pop = AddAreaOp();
+
+      if( !pop ) {
+            dda_tri( ptp, c, pb_spec, pPatt_spec, ledge, redge );
+            return;
+      }
+
+      pop->type = AREA_OP_TRI;
+      for( int i = 0; i < 3; i++ )
+            pop->pts[i] = ptp[i];
+      pop->color = *c;
+      pop->ppatt = pPatt_spec;
+      if( pPatt_spec ) {
+            pop->patt_x = pPatt_spec->x;
+            pop->patt_y = pPatt_spec->y;
+      }
+}
+
+void s52plib::RasterTrap( wxPoint *segs, int lseg, int rseg, int ytop, int ybot,
+            S52color *c, render_canvas_parms *pb_spec, render_canvas_parms *pPatt_spec ) {
+      AreaRasterOp *pop = NULL;
+      if( m_bDeferAreaRaster ) pop = AddAreaOp();
+
+      if( !pop ) {
+            dda_trap( segs, lseg, rseg, ytop, ybot, c, pb_spec, pPatt_spec, ledge, redge );
+            return;
+      }
+
+      //    Keep just the two edges used, the segment array is transient
+      pop->type = AREA_OP_TRAP;
+      pop->pts[0] = segs[lseg];
+      pop->pts[1] = segs[lseg + 1];
+      pop->pts[2] = segs[rseg];
+      pop->pts[3] = segs[rseg + 1];
+      pop->ytop = ytop;
+      pop->ybot = ybot;
+      pop->color = *c;
+      pop->ppatt = pPatt_spec;
+      if( pPatt_spec ) {
+            pop->patt_x = pPatt_spec->x;
+            pop->patt_y = pPatt_spec->y;
+      }
+}
+
+//    Rasterise the whole op list into one band, using the caller's edge arrays
+void s52plib::RasterAreaOps( render_canvas_parms *pband, int *pledge, int *predge ) {
+      AreaRasterOp *pop = m_pAreaOps;
+
+      for( int i = 0; i < m_nAreaOps; i++, pop++ ) {
+            //    Pattern buffers are shared by all objects of a rule, with the
+            //    reference point set per object, so use a private copy
+            render_canvas_parms patt;
+            render_canvas_parms *ppatt = NULL;
+            if( pop->ppatt ) {
+                  patt = *pop->ppatt;
+                  patt.x = pop->patt_x;
+                  patt.y = pop->patt_y;
+                  ppatt = &patt;
+            }
+
+            if( AREA_OP_TRI == pop->type )
+                  dda_tri( pop->pts, &pop->color, pband, ppatt, pledge, predge );
+            else
+                  dda_trap( pop->pts, 0, 2, pop->ytop, pop->ybot, &pop->color, pband, ppatt,
+                              pledge, predge );
+      }
+}
+
+void s52plib::FlushAreaRaster( render_canvas_parms *pb_spec ) {
+      m_bDeferAreaRaster = false;
+
+      if( 0 == m_nAreaOps ) return;
+
+      int n_bands = 1;
+      if( m_nAreaOps >= AREA_RASTER_OPS_MIN ) {
+            n_bands = wxMin ( wxThread::GetCPUCount(), AREA_RASTER_THREADS_MAX );
+            n_bands = wxMin ( n_bands, pb_spec->height / AREA_RASTER_BAND_MIN );
+            if( n_bands < 1 ) n_bands = 1;
+      }
+
+      if( 1 == n_bands ) {
+            RasterAreaOps( pb_spec, ledge, redge );
+            m_nAreaOps = 0;
+            return;
+      }
+
+      //    Split the buffer into bands of whole rows
+      render_canvas_parms *bands = new render_canvas_parms[n_bands];
+      int band_height = ( pb_spec->height + n_bands - 1 ) / n_bands;
+
+      for( int i = 0; i < n_bands; i++ ) {
+            int y0 = i * band_height;
+            bands[i] = *pb_spec;
+            bands[i].y = pb_spec->y + y0;
+            bands[i].height = wxMin ( band_height, pb_spec->height - y0 );
+            bands[i].pix_buff = pb_spec->pix_buff + ( y0 * pb_spec->pb_pitch );
+      }
+
+      //    Band 0 is done here, the rest on worker threads
+      wxArrayPtrVoid threads;
+      for( int i = 1; i < n_bands; i++ ) {
+            AreaRasterThread *pt = new AreaRasterThread( this, &bands[i] );
+            if( ( wxTHREAD_NO_ERROR == pt->Create() ) && ( wxTHREAD_NO_ERROR == pt->Run() ) )
+                  threads.Add( pt );
+            else {
+                  delete pt;
+                  RasterAreaOps( &bands[i], ledge, redge );
+            }
+      }
+
+      RasterAreaOps( &bands[0], ledge, redge );
+
+      for( unsigned int i = 0; i < threads.GetCount(); i++ ) {
+            AreaRasterThread *pt = (AreaRasterThread *) threads.Item( i );
+            pt->Wait();
+            delete pt;
+      }
+
+      delete[] bands;
+      m_nAreaOps = 0;
+}
+
 void s52plib::RenderToBufferFilledPolygon( ObjRazRules *rzRules, S57Obj *obj,
             S52color *c, wxBoundingBox &BBView, render_canvas_parms *pb_spec,
             render_canvas_parms *pPatt_spec ) {
@@ -4948,7 +5267,7 @@ void s52plib::RenderToBufferFilledPolygon( ObjRazRules *rzRules, S57Obj *obj,
                                           pp3[2].x = ptp[it + 2].x;
                                           pp3[2].y = ptp[it + 2].y;
 
-                                          dda_tri( pp3, &cp, pb_spec, pPatt_spec );
+                                          RasterTri( pp3, &cp, pb_spec, pPatt_spec );
                                     }
                                     break;
                               }
@@ -4963,7 +5282,7 @@ void s52plib::RenderToBufferFilledPolygon( ObjRazRules *rzRules, S57Obj *obj,
                                           pp3[2].x = ptp[it + 2].x;
                                           pp3[2].y = ptp[it + 2].y;
 
-                                          dda_tri( pp3, &cp, pb_spec, pPatt_spec );
+                                          RasterTri( pp3, &cp, pb_spec, pPatt_spec );
                                     }
                                     break;
                               }
@@ -4979,7 +5298,7 @@ void s52plib::RenderToBufferFilledPolygon( ObjRazRules *rzRules, S57Obj *obj,
                                           pp3[2].x = ptp[it + 2].x;
                                           pp3[2].y = ptp[it + 2].y;
 
-                                          dda_tri( pp3, &cp, pb_spec, pPatt_spec );
+                                          RasterTri( pp3, &cp, pb_spec, pPatt_spec );
                                     }
                                     break;
 
@@ -5054,7 +5373,7 @@ void s52plib::RenderToBufferFilledPolygon( ObjRazRules *rzRules, S57Obj *obj,
                                */
 //                              if((lseg == 66) && (trap_y_top < 0))
                               //                                    cs.B = 128;
-                              dda_trap( ptp, lseg, rseg, trap_y_top, trap_y_bot, cd,
+                              RasterTrap( ptp, lseg, rseg, trap_y_top, trap_y_bot, cd,
                                           pb_spec, pPatt_spec );
 
                         }
@@ -5495,11 +5814,7 @@ int s52plib::RenderAreaToGL( const wxGLContext &glcc, ObjRazRules *rzRules,
                         break; // AP
 
                   case RUL_CND_SY: {
-                        if( !rzRules->obj->bCS_Added ) {
-                              rzRules->obj->CSrules = NULL;
-                              GetAndAddCSRules( rzRules, rules );
-                              rzRules->obj->bCS_Added = 1; // mark the object
-                        }
+                        UpdateCSRules( rzRules, rules );
                         Rules *rules_last = rules;
                         rules = rzRules->obj->CSrules;
 
@@ -5817,11 +6132,7 @@ int s52plib::RenderAreaToDC( wxDC *pdcin, ObjRazRules *rzRules, ViewPort *vp,
                         break; // AP
 
                   case RUL_CND_SY: {
-                        if( !rzRules->obj->bCS_Added ) {
-                              rzRules->obj->CSrules = NULL;
-                              GetAndAddCSRules( rzRules, rules );
-                              rzRules->obj->bCS_Added = 1; // mark the object
-                        }
+                        UpdateCSRules( rzRules, rules );
                         Rules *rules_last = rules;
                         rules = rzRules->obj->CSrules;
 
@@ -5863,40 +6174,49 @@ int s52plib::RenderAreaToDC( wxDC *pdcin, ObjRazRules *rzRules, ViewPort *vp,
 
 }
 
-void s52plib::GetAndAddCSRules( ObjRazRules *rzRules, Rules *rules ) {
+//    Evaluate the conditional symbology of an object, unless the result
+//    for the current CS state is already known
+void s52plib::UpdateCSRules( ObjRazRules *rzRules, Rules *rules ) {
+      S57Obj *obj = rzRules->obj;
 
-      LUPrec *NewLUP;
-      LUPrec *LUP;
-      LUPrec *LUPCandidate;
+      if( obj->bCS_Added && ( obj->CS_state_hash == m_cs_state_hash )
+                  && ( obj->CS_generation == m_cs_generation ) ) return;
+
+      obj->CSrules = NULL;
+      obj->m_DPRI = -1; // the CS may set it again
+      GetAndAddCSRules( rzRules, rules );
+      obj->bCS_Added = 1; // mark the object
+}
+
+void s52plib::GetAndAddCSRules( ObjRazRules *rzRules, Rules *rules ) {
 
       char *rule_str1 = RenderCS( rzRules, rules );
       wxString cs_string( rule_str1, wxConvUTF8 );
       free( rule_str1 ); //delete rule_str1;
 
+      SetCSRules( rzRules, cs_string );
+}
+
+//    Attach the rules for a CS instruction string to an object,
+//    creating the dynamic LUP if this string has not been seen before
+void s52plib::SetCSRules( ObjRazRules *rzRules, const wxString &cs_string ) {
+
+      LUPrec *NewLUP;
+      LUPrec *LUP;
+
 //  Try to find a match for this object/attribute set in dynamic CS LUP Table
 
-//  Do this by checking each LUP in the CS LUPARRAY and checking....
-//  a) is Object Name the same? and
-//  b) was LUP created earlier by exactly the same INSTruction string?
-//  c) does LUP have same Display Category and Priority?
+//  The LUP must match....
+//  a) Object Name, and
+//  b) exactly the same INSTruction string, and
+//  c) the same Display Category
 
-      wxArrayOfLUPrec *la = condSymbolLUPArray;
-      int index = 0;
-      int index_max = la->GetCount();
-      LUP = NULL;
+      wxString key( rzRules->LUP->OBCL, wxConvUTF8 );
+      key << _T(":") << (int) rzRules->LUP->DISC << _T(":") << cs_string;
 
-      while( ( index < index_max ) ) {
-            LUPCandidate = la->Item( index );
-            if( !strcmp( rzRules->LUP->OBCL, LUPCandidate->OBCL ) ) {
-                  if( LUPCandidate->INST->IsSameAs( cs_string ) ) {
-                        if( LUPCandidate->DISC == rzRules->LUP->DISC ) {
-                              LUP = LUPCandidate;
-                              break;
-                        }
-                  }
-            }
-            index++;
-      }
+      LUP = NULL;
+      CSLUP_Hash::iterator it = m_CSLUP_hashmap.find( key );
+      if( it != m_CSLUP_hashmap.end() ) LUP = it->second;
 
 //  If not found, need to create a dynamic LUP and add to CS LUP Table
 
@@ -5976,6 +6296,7 @@ void s52plib::GetAndAddCSRules( ObjRazRules *rzRules, Rules *rules ) {
             wxArrayOfLUPrec *pLUPARRAYtyped = condSymbolLUPArray;
 
             pLUPARRAYtyped->Add( NewLUP );
+            m_CSLUP_hashmap[key] = NewLUP;
 
             LUP = NewLUP;
 
@@ -5984,6 +6305,9 @@ void s52plib::GetAndAddCSRules( ObjRazRules *rzRules, Rules *rules ) {
       Rules *top = LUP->ruleList;
 
       rzRules->obj->CSrules = top; // patch in a new rule set
+      rzRules->obj->CSLUP = LUP;
+      rzRules->obj->CS_state_hash = m_cs_state_hash;
+      rzRules->obj->CS_generation = m_cs_generation;
 
 }
 
@@ -6096,7 +6420,7 @@ bool s52plib::ObjectRenderCheckCat( ObjRazRules *rzRules, ViewPort *vp ) {
 
             if( m_bUseSCAMIN ) {
                   if( ( DISPLAYBASE == rzRules->LUP->DISC )
-                              || ( PRIO_GROUP1 == rzRules->LUP->DPRI ) ) b_visible = true;
+                              || ( PRIO_GROUP1 == GetObjDisplayPriority( rzRules ) ) ) b_visible = true;
                   else if( vp->chart_scale > rzRules->obj->Scamin ) b_visible = false;
 
                   //      On the other hand, $TEXTS features need not really be displayed at all scales, always
@@ -6114,32 +6438,165 @@ bool s52plib::ObjectRenderCheckCat( ObjRazRules *rzRules, ViewPort *vp ) {
 
 //    Do all those things necessary to prepare for a new rendering
 void s52plib::PrepareForRender() {
-
+      //    Mariner parameters may be set directly, so pick them up here
+      GenerateCSStateHash();
 }
 
 void s52plib::ClearTextList( void ) {
       //      Clear the current text rectangle list
-      m_textObjList.Clear();
+      m_TextGrid.Clear();
 
 }
 
 void s52plib::AdjustTextList( int dx, int dy, int screenw, int screenh ) {
-      wxRect rScreen( 0, 0, screenw, screenh );
-      //    Iterate over the text rectangle list
-      //        1.  Apply the specified offset to the list elements
-      //        2.. Remove any list elements that are off screen after applied offset
+      m_TextGrid.Translate( dx, dy, screenw, screenh );
+}
 
-      ObjList::Node *node = m_textObjList.GetFirst();
-      while( node ) {
-            wxRect *pcurrent = &( node->GetData()->rText );
-            pcurrent->Offset( dx, dy );
+//-----------------------------------------------------------------------------
+//    TextGrid implementation
+//-----------------------------------------------------------------------------
 
-            if( !pcurrent->Intersects( rScreen ) ) {
-                  m_textObjList.DeleteNode( node );
+static inline int TextGridCell( int v ) {
+      //    Round towards minus infinity
+      return ( v >= 0 ) ? v / TEXT_GRID_CELL : -( ( -v - 1 ) / TEXT_GRID_CELL ) - 1;
+}
+
+static inline long TextGridCellKey( int cx, int cy ) {
+      //    Aliased cells only cost an extra rectangle test
+      return (long) ( ( ( (unsigned int) cy & 0xffff ) << 16 )
+                  | ( (unsigned int) cx & 0xffff ) );
+}
+
+TextGrid::TextGrid() {
+      m_orgx = 0;
+      m_orgy = 0;
+}
+
+TextGrid::~TextGrid() {
+      Clear();
+}
 
-                  node = m_textObjList.GetFirst();
-            } else node = node->GetNext();
+void TextGrid::Link( TextGridEntry *pe ) {
+      int cx0 = TextGridCell( pe->rect.x );
+      int cx1 = TextGridCell( pe->rect.x + pe->rect.width - 1 );
+      int cy0 = TextGridCell( pe->rect.y );
+      int cy1 = TextGridCell( pe->rect.y + pe->rect.height - 1 );
+
+      for( int cy = cy0; cy <= cy1; cy++ ) {
+            for( int cx = cx0; cx <= cx1; cx++ ) {
+                  long key = TextGridCellKey( cx, cy );
+                  TextGridCellHash::iterator it = m_cells.find( key );
+                  wxArrayPtrVoid *pcell;
+                  if( it == m_cells.end() ) {
+                        pcell = new wxArrayPtrVoid;
+                        m_cells[key] = pcell;
+                  } else
+                        pcell = it->second;
+
+                  //    Aliased cells may already hold this entry
+                  if( pcell->Index( pe ) == wxNOT_FOUND ) pcell->Add( pe );
+            }
+      }
+}
+
+void TextGrid::Unlink( TextGridEntry *pe ) {
+      int cx0 = TextGridCell( pe->rect.x );
+      int cx1 = TextGridCell( pe->rect.x + pe->rect.width - 1 );
+      int cy0 = TextGridCell( pe->rect.y );
+      int cy1 = TextGridCell( pe->rect.y + pe->rect.height - 1 );
+
+      for( int cy = cy0; cy <= cy1; cy++ ) {
+            for( int cx = cx0; cx <= cx1; cx++ ) {
+                  TextGridCellHash::iterator it = m_cells.find( TextGridCellKey( cx, cy ) );
+                  if( it == m_cells.end() ) continue;
+
+                  wxArrayPtrVoid *pcell = it->second;
+                  pcell->Remove( pe );
+                  if( pcell->IsEmpty() ) {
+                        delete pcell;
+                        m_cells.erase( it );
+                  }
+            }
+      }
+}
+
+void TextGrid::Add( S57Obj *pobj, const wxRect &rect ) {
+      wxRect grect( rect.x - m_orgx, rect.y - m_orgy, rect.width, rect.height );
+
+      TextGridEntryHash::iterator it = m_entries.find( (long) pobj );
+      TextGridEntry *pe;
+      if( it != m_entries.end() ) {
+            pe = it->second;
+            if( pe->rect == grect ) return;
+            Unlink( pe );
+      } else {
+            pe = new TextGridEntry;
+            pe->obj = pobj;
+            m_entries[(long) pobj] = pe;
       }
+
+      pe->rect = grect;
+      Link( pe );
+}
+
+//    Return true if test_rect overlaps any rect in the grid, except that of pobj
+bool TextGrid::Intersects( const wxRect &test_rect, S57Obj *pobj ) {
+      if( m_entries.empty() ) return false;
+
+      wxRect grect( test_rect.x - m_orgx, test_rect.y - m_orgy, test_rect.width,
+                  test_rect.height );
+
+      int cx0 = TextGridCell( grect.x );
+      int cx1 = TextGridCell( grect.x + grect.width - 1 );
+      int cy0 = TextGridCell( grect.y );
+      int cy1 = TextGridCell( grect.y + grect.height - 1 );
+
+      for( int cy = cy0; cy <= cy1; cy++ ) {
+            for( int cx = cx0; cx <= cx1; cx++ ) {
+                  TextGridCellHash::iterator it = m_cells.find( TextGridCellKey( cx, cy ) );
+                  if( it == m_cells.end() ) continue;
+
+                  wxArrayPtrVoid *pcell = it->second;
+                  for( unsigned int i = 0; i < pcell->GetCount(); i++ ) {
+                        TextGridEntry *pe = (TextGridEntry *) pcell->Item( i );
+                        if( ( pe->obj != pobj ) && pe->rect.Intersects( grect ) ) return true;
+                  }
+            }
+      }
+      return false;
+}
+
+void TextGrid::Translate( int dx, int dy, int screenw, int screenh ) {
+      //    Move the grid with the chart, then drop any rects now off screen
+      m_orgx += dx;
+      m_orgy += dy;
+
+      wxRect rScreen( -m_orgx, -m_orgy, screenw, screenh );
+
+      wxArrayPtrVoid off_screen;
+      for( TextGridEntryHash::iterator it = m_entries.begin(); it != m_entries.end(); ++it ) {
+            if( !it->second->rect.Intersects( rScreen ) ) off_screen.Add( it->second );
+      }
+
+      for( unsigned int i = 0; i < off_screen.GetCount(); i++ ) {
+            TextGridEntry *pe = (TextGridEntry *) off_screen.Item( i );
+            Unlink( pe );
+            m_entries.erase( (long) pe->obj );
+            delete pe;
+      }
+}
+
+void TextGrid::Clear( void ) {
+      for( TextGridCellHash::iterator it = m_cells.begin(); it != m_cells.end(); ++it )
+            delete it->second;
+      m_cells.clear();
+
+      for( TextGridEntryHash::iterator it = m_entries.begin(); it != m_entries.end(); ++it )
+            delete it->second;
+      m_entries.clear();
+
+      m_orgx = 0;
+      m_orgy = 0;
 }
 
 void DrawAALine( wxDC *pDC, int x0, int y0, int x1, int y1, wxColour clrLine,
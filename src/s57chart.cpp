@@ -36,6 +36,8 @@
 #include "wx/image.h"                           // for some reason, needed for msvc???
 #include "wx/tokenzr.h"
 #include <wx/textfile.h>
+#include <wx/mstream.h>
+#include <wx/thread.h>
 
 #include "dychart.h"
 
@@ -49,12 +51,20 @@
 #include "georef.h"
 #include "navutil.h"                            // for LogMessageOnce
 #include "ocpn_pixel.h"
+#include <version.h>
 
 #include "cpl_csv.h"
 #include "setjmp.h"
 
 #include "mygdal/ogr_s57.h"
 
+#ifndef __WXMSW__
+#include <sys/mman.h>                           // for the binary SENC mapping
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #ifdef __MSVC__
 #define _CRTDBG_MAP_ALLOC
 #include <stdlib.h>
@@ -108,6 +118,75 @@ WX_DEFINE_OBJARRAY(ArrayOfVC_Elements);
 #define S57_THUMB_SIZE  200
 
 static int              s_bInS57;         // Exclusion flag to prvent recursion in this class init call.
+
+//    GDAL/OGR keeps global state (the error handler stack, the class registrar selection),
+//    and SENC files may be built on a worker thread, so all use of it here is serialized
+static wxMutex          s_OGRMutex(wxMUTEX_RECURSIVE);
+
+//    SENC files smaller than this are read into memory with a single read before parsing
+#define SENC_MEMORY_LOAD_MAX    (128 * 1024 * 1024)
+
+//------------------------------------------------------------------------------
+//      fgets for Binary Mode (SENC) input streams
+//      A memory stream is scanned in place, any other stream a byte at a time
+//------------------------------------------------------------------------------
+static int SENC_fgets( char *buf, int buf_len_max, wxInputStream& ifs )
+{
+    char        chNext;
+    int         nLineLen = 0;
+    char        *lbuf = buf;
+
+    wxMemoryInputStream *pmis = dynamic_cast<wxMemoryInputStream *>(&ifs);
+    if(pmis)
+    {
+        wxStreamBuffer *psb = pmis->GetInputStreamBuffer();
+        char *pin = psb->GetBufferPos();
+        char *pend = psb->GetBufferEnd();
+
+        while( (pin < pend) && (nLineLen < buf_len_max) )
+        {
+            chNext = *pin++;
+
+            /* each CR/LF (or LF/CR) as if just "CR" */
+            if( chNext == 10 || chNext == 13 )
+                chNext = '\n';
+
+            *lbuf++ = chNext;
+            nLineLen++;
+
+            if( chNext == '\n' )
+                break;
+        }
+
+        psb->SetIntPosition(pin - psb->GetBufferStart());
+
+        *lbuf = '\0';
+        return nLineLen;
+    }
+
+    while( !ifs.Eof() && nLineLen < buf_len_max )
+    {
+        chNext = (char)ifs.GetC();
+
+        /* each CR/LF (or LF/CR) as if just "CR" */
+        if( chNext == 10 || chNext == 13 )
+        {
+            chNext = '\n';
+        }
+
+        *lbuf = chNext; lbuf++, nLineLen++;
+
+        if( chNext == '\n' )
+        {
+            *lbuf = '\0';
+            return nLineLen;
+        }
+    }
+
+    *(lbuf) = '\0';
+
+    return nLineLen;
+}
                                           // Init() is not reentrant due to static wxProgressDialog callback....
 
 int s_cnt;
@@ -138,12 +217,17 @@ S57Obj::S57Obj()
 
         bCS_Added = 0;
         CSrules = NULL;
+        CSLUP = NULL;
+        CS_state_hash = 0;
+        CS_generation = 0;
+        m_DPRI = -1;
         FText = NULL;
         bFText_Added = 0;
         geoPtMulti = NULL;
         geoPtz = NULL;
         geoPt = NULL;
         bIsClone = false;
+        bIsMapped = false;
         Scamin = 10000000;                              // ten million enough?
         nRef = 0;
 
@@ -175,8 +259,11 @@ S57Obj::~S57Obj()
         for(unsigned int iv = 0 ; iv < attVal->GetCount() ; iv++)
         {
             S57attVal *vv =  attVal->Item(iv);
-            void *v2 = vv->value;
-            free(v2);
+            if(!bIsMapped)
+            {
+                void *v2 = vv->value;
+                free(v2);
+            }
             delete vv;
         }
         delete attVal;
@@ -189,14 +276,18 @@ S57Obj::~S57Obj()
 
         delete FText;
 
-        if(geoPt)
-            free(geoPt);
-        if(geoPtz)
-            free(geoPtz);
-        if(geoPtMulti)
-            free(geoPtMulti);
-
-        free (m_lsindex_array);
+        //  Mapped arrays belong to the binary SENC mapping of the chart
+        if(!bIsMapped)
+        {
+            if(geoPt)
+                free(geoPt);
+            if(geoPtz)
+                free(geoPtz);
+            if(geoPtMulti)
+                free(geoPtMulti);
+
+            free (m_lsindex_array);
+        }
     }
 }
 
@@ -204,7 +295,7 @@ S57Obj::~S57Obj()
 //      S57Obj CTOR from SENC file
 //----------------------------------------------------------------------------------
 
-S57Obj::S57Obj(char *first_line, wxInputStream *pfpx, double dummy, double dummy2)
+S57Obj::S57Obj(char *first_line, wxInputStream *pfpx, wxMemoryBuffer &scratch, double dummy, double dummy2)
 {
     attList = NULL;
     attVal = NULL;
@@ -212,9 +303,14 @@ S57Obj::S57Obj(char *first_line, wxInputStream *pfpx, double dummy, double dummy
     pPolyTrapGeo = NULL;
     bCS_Added = 0;
     CSrules = NULL;
+    CSLUP = NULL;
+    CS_state_hash = 0;
+    CS_generation = 0;
+    m_DPRI = -1;
     FText = NULL;
     bFText_Added = 0;
     bIsClone = false;
+    bIsMapped = false;
 
     geoPtMulti = NULL;
     geoPtz = NULL;
@@ -222,8 +318,11 @@ S57Obj::S57Obj(char *first_line, wxInputStream *pfpx, double dummy, double dummy
     Scamin = 10000000;                              // ten million enough?
     nRef = 0;
     bIsAton = false;
+    bIsAssociable = false;
+    bBBObj_valid = false;
     m_n_lsindex = 0;
     m_lsindex_array = NULL;
+    m_n_edge_max_points = 0;
 
     //        Set default (unity) auxiliary transform coefficients
     x_rate   = 1.0;
@@ -238,7 +337,7 @@ S57Obj::S57Obj(char *first_line, wxInputStream *pfpx, double dummy, double dummy
     int FEIndex;
 
     int MAX_LINE = 499999;
-    char *buf = (char *)malloc(MAX_LINE + 1);
+    char *buf = (char *)scratch.GetWriteBuf(MAX_LINE + 1);
     int llmax = 0;
 
     char szFeatureName[20];
@@ -541,6 +640,8 @@ S57Obj::S57Obj(char *first_line, wxInputStream *pfpx, double dummy, double dummy
 
                         my_fgets(buf, MAX_LINE, *pfpx);
                         int wkb_len = atoi(buf+2);
+                        if(wkb_len > MAX_LINE)
+                              buf = (char *)scratch.GetWriteBuf(wkb_len + 1);
                         pfpx->Read(buf,  wkb_len);
 
                         npt = *((int *)(buf + 5));
@@ -748,7 +849,6 @@ S57Obj::S57Obj(char *first_line, wxInputStream *pfpx, double dummy, double dummy
         }               //OGRF
     }                       //while(!dun)
 
-    free( buf );
     free(hdr_buf);
 
 }
@@ -849,37 +949,8 @@ bool S57Obj::IsUsefulAttribute(char *buf)
 //      Local version of fgets for Binary Mode (SENC) file
 //------------------------------------------------------------------------------
  int S57Obj::my_fgets( char *buf, int buf_len_max, wxInputStream& ifs )
-
 {
-    char        chNext;
-    int         nLineLen = 0;
-    char            *lbuf;
-
-    lbuf = buf;
-
-
-    while( !ifs.Eof() && nLineLen < buf_len_max )
-    {
-        chNext = (char)ifs.GetC();
-
-        /* each CR/LF (or LF/CR) as if just "CR" */
-        if( chNext == 10 || chNext == 13 )
-        {
-            chNext = '\n';
-        }
-
-        *lbuf = chNext; lbuf++, nLineLen++;
-
-        if( chNext == '\n' )
-        {
-            *lbuf = '\0';
-            return nLineLen;
-        }
-    }
-
-    *(lbuf) = '\0';
-
-    return nLineLen;
+    return SENC_fgets(buf, buf_len_max, ifs);
 }
 
 //------------------------------------------------------------------------------
@@ -1049,6 +1120,253 @@ render_canvas_parms::~render_canvas_parms(void)
 }
 
 
+//----------------------------------------------------------------------------------
+//      S57ObjIndex Implementation
+//----------------------------------------------------------------------------------
+
+static ObjIndexEntry *s_pIndexSortEntries;
+
+static int CompareIndexEntryX(const void *a, const void *b)
+{
+      ObjIndexEntry *pa = &s_pIndexSortEntries[*(const int *)a];
+      ObjIndexEntry *pb = &s_pIndexSortEntries[*(const int *)b];
+      double ca = pa->minx + pa->maxx;
+      double cb = pb->minx + pb->maxx;
+      return (ca < cb) ? -1 : ((ca > cb) ? 1 : 0);
+}
+
+static int CompareIndexEntryY(const void *a, const void *b)
+{
+      ObjIndexEntry *pa = &s_pIndexSortEntries[*(const int *)a];
+      ObjIndexEntry *pb = &s_pIndexSortEntries[*(const int *)b];
+      double ca = pa->miny + pa->maxy;
+      double cb = pb->miny + pb->maxy;
+      return (ca < cb) ? -1 : ((ca > cb) ? 1 : 0);
+}
+
+static int wxCMPFUNC_CONV CompareIndexHits(int *a, int *b)
+{
+      return *a - *b;
+}
+
+S57ObjIndex::S57ObjIndex()
+{
+      m_pentries = NULL;
+      m_nentries = 0;
+      m_nentries_max = 0;
+
+      m_pleaf_entries = NULL;
+      m_pentry_stamp = NULL;
+      m_stamp = 0;
+
+      m_pnodes = NULL;
+      m_nnodes = 0;
+}
+
+S57ObjIndex::~S57ObjIndex()
+{
+      free(m_pentries);
+      free(m_pleaf_entries);
+      free(m_pentry_stamp);
+      free(m_pnodes);
+}
+
+void S57ObjIndex::AddRules(ObjRazRules *rzRules, int bucket)
+{
+      if(m_nentries == m_nentries_max)
+      {
+            m_nentries_max = wxMax(1024, m_nentries_max * 2);
+            m_pentries = (ObjIndexEntry *)realloc(m_pentries, m_nentries_max * sizeof(ObjIndexEntry));
+      }
+
+      ObjIndexEntry *pe = &m_pentries[m_nentries++];
+      S57Obj *obj = rzRules->obj;
+
+      if(obj->bBBObj_valid)
+      {
+            pe->minx = obj->BBObj.GetMinX();
+            pe->miny = obj->BBObj.GetMinY();
+            pe->maxx = obj->BBObj.GetMaxX();
+            pe->maxy = obj->BBObj.GetMaxY();
+      }
+      else
+      {
+            //    No extent known, so always report it and let the caller decide
+            pe->minx = -1000.;
+            pe->miny = -1000.;
+            pe->maxx = 1000.;
+            pe->maxy = 1000.;
+      }
+
+      pe->rzRules = rzRules;
+      pe->bucket = bucket;
+}
+
+void S57ObjIndex::Build(void)
+{
+      free(m_pleaf_entries);
+      free(m_pentry_stamp);
+      free(m_pnodes);
+      m_pleaf_entries = NULL;
+      m_pentry_stamp = NULL;
+      m_pnodes = NULL;
+      m_nnodes = 0;
+
+      int n = m_nentries;
+      if(0 == n)
+            return;
+
+      m_pentry_stamp = (int *)calloc(n, sizeof(int));
+      m_stamp = 0;
+
+      //    Sort-Tile-Recursive packing of the leaves:
+      //    sort by x, cut into vertical slices, then sort each slice by y
+      m_pleaf_entries = (int *)malloc(n * sizeof(int));
+      for(int i = 0 ; i < n ; i++)
+            m_pleaf_entries[i] = i;
+
+      s_pIndexSortEntries = m_pentries;
+      qsort(m_pleaf_entries, n, sizeof(int), CompareIndexEntryX);
+
+      int nleaves = (n + OBJ_INDEX_NODE_SIZE - 1) / OBJ_INDEX_NODE_SIZE;
+      int nslices = (int)ceil(sqrt((double)nleaves));
+      int slice_size = nslices * OBJ_INDEX_NODE_SIZE;
+      for(int is = 0 ; is < n ; is += slice_size)
+            qsort(&m_pleaf_entries[is], wxMin(slice_size, n - is), sizeof(int), CompareIndexEntryY);
+
+      //    Count the nodes of all levels
+      int ntotal = nleaves;
+      int nlevel = nleaves;
+      while(nlevel > 1)
+      {
+            nlevel = (nlevel + OBJ_INDEX_NODE_SIZE - 1) / OBJ_INDEX_NODE_SIZE;
+            ntotal += nlevel;
+      }
+
+      m_pnodes = (ObjIndexNode *)malloc(ntotal * sizeof(ObjIndexNode));
+
+      //    Leaves
+      for(int il = 0 ; il < nleaves ; il++)
+      {
+            ObjIndexNode *pn = &m_pnodes[m_nnodes++];
+            pn->first = il * OBJ_INDEX_NODE_SIZE;
+            pn->count = wxMin(OBJ_INDEX_NODE_SIZE, n - pn->first);
+            pn->bleaf = true;
+
+            ObjIndexEntry *pe = &m_pentries[m_pleaf_entries[pn->first]];
+            pn->minx = pe->minx;
+            pn->miny = pe->miny;
+            pn->maxx = pe->maxx;
+            pn->maxy = pe->maxy;
+            for(int ie = 1 ; ie < pn->count ; ie++)
+            {
+                  pe = &m_pentries[m_pleaf_entries[pn->first + ie]];
+                  pn->minx = wxMin(pn->minx, pe->minx);
+                  pn->miny = wxMin(pn->miny, pe->miny);
+                  pn->maxx = wxMax(pn->maxx, pe->maxx);
+                  pn->maxy = wxMax(pn->maxy, pe->maxy);
+            }
+      }
+
+      //    Upper levels, packing runs of the (already spatially ordered) level below
+      int level_first = 0;
+      nlevel = nleaves;
+      while(nlevel > 1)
+      {
+            int next_first = m_nnodes;
+            for(int ic = 0 ; ic < nlevel ; ic += OBJ_INDEX_NODE_SIZE)
+            {
+                  ObjIndexNode *pn = &m_pnodes[m_nnodes++];
+                  pn->first = level_first + ic;
+                  pn->count = wxMin(OBJ_INDEX_NODE_SIZE, nlevel - ic);
+                  pn->bleaf = false;
+
+                  ObjIndexNode *pc = &m_pnodes[pn->first];
+                  pn->minx = pc->minx;
+                  pn->miny = pc->miny;
+                  pn->maxx = pc->maxx;
+                  pn->maxy = pc->maxy;
+                  for(int jc = 1 ; jc < pn->count ; jc++)
+                  {
+                        pc = &m_pnodes[pn->first + jc];
+                        pn->minx = wxMin(pn->minx, pc->minx);
+                        pn->miny = wxMin(pn->miny, pc->miny);
+                        pn->maxx = wxMax(pn->maxx, pc->maxx);
+                        pn->maxy = wxMax(pn->maxy, pc->maxy);
+                  }
+            }
+            level_first = next_first;
+            nlevel = m_nnodes - next_first;
+      }
+}
+
+//    Collect the entries whose box intersects the given box, sorted by entry number.
+//    With b_append, add to the hits of the previous query without duplicates.
+void S57ObjIndex::Query(double minx, double miny, double maxx, double maxy, wxArrayInt &hits, bool b_append)
+{
+      if(!b_append)
+      {
+            hits.Clear();
+            m_stamp++;
+      }
+
+      if(0 == m_nnodes)
+            return;
+
+      //    The tree is at most a few levels deep, so a small fixed stack will do
+      int stack[256];
+      int sp = 0;
+      stack[sp++] = m_nnodes - 1;                     // root
+
+      while(sp)
+      {
+            ObjIndexNode *pn = &m_pnodes[stack[--sp]];
+
+            if((pn->minx > maxx) || (pn->maxx < minx) || (pn->maxy < miny) || (pn->miny > maxy))
+                  continue;
+
+            if(pn->bleaf)
+            {
+                  for(int ie = 0 ; ie < pn->count ; ie++)
+                  {
+                        int index = m_pleaf_entries[pn->first + ie];
+                        ObjIndexEntry *pe = &m_pentries[index];
+                        if((pe->minx > maxx) || (pe->maxx < minx) || (pe->maxy < miny) || (pe->miny > maxy))
+                              continue;
+
+                        if(m_pentry_stamp[index] != m_stamp)
+                        {
+                              m_pentry_stamp[index] = m_stamp;
+                              hits.Add(index);
+                        }
+                  }
+            }
+            else
+            {
+                  for(int ic = 0 ; ic < pn->count ; ic++)
+                        stack[sp++] = pn->first + ic;
+            }
+      }
+
+      hits.Sort(CompareIndexHits);
+}
+
+//    Find where each bucket starts in a sorted hit list.
+//    Hits of bucket b are hits[pfirst[b]] .. hits[pfirst[b + 1] - 1]
+void S57ObjIndex::GetBucketRanges(const wxArrayInt &hits, int *pfirst)
+{
+      int nhits = hits.GetCount();
+      int ih = 0;
+      for(int ib = 0 ; ib < OBJ_INDEX_BUCKETS ; ib++)
+      {
+            pfirst[ib] = ih;
+            while((ih < nhits) && (m_pentries[hits[ih]].bucket == ib))
+                  ih++;
+      }
+      pfirst[OBJ_INDEX_BUCKETS] = nhits;
+}
+
+
 //----------------------------------------------------------------------------------
 //      s57chart Implementation
 //----------------------------------------------------------------------------------
@@ -1063,6 +1381,8 @@ s57chart::s57chart()
             for(int j=0 ; j<LUPNAME_NUM ; j++)
                     razRules[i][j] = NULL;
 
+    m_pObjIndex = NULL;
+
     m_Chart_Scale = 1;                              // Will be fetched during Init()
     m_Chart_Skew = 0.0;
 
@@ -1088,8 +1408,18 @@ s57chart::s57chart()
     m_nvaldco_alloc = 0;
     m_pvaldco_array = NULL;
 
+    m_pSENCBin = NULL;
+    m_SENCBin_len = 0;
+    m_bSENCBin_mapped = false;
+    m_bWorkerLoad = false;
+
     m_bExtentSet = false;
 
+    m_pix_offset_x = 0;
+    m_pix_offset_y = 0;
+
+    m_n_cs_loaded = 0;
+
     m_pDIBThumbDay = NULL;
     m_pDIBThumbDim = NULL;
     m_pDIBThumbOrphan = NULL;
@@ -1109,6 +1439,7 @@ s57chart::s57chart()
 s57chart::~s57chart()
 {
 
+    SaveCSCache();
     FreeObjectsAndRules();
 
     delete pDIB;
@@ -1133,7 +1464,9 @@ s57chart::~s57chart()
           VE_Element *value = it->second;
           if(value)
           {
-            free(value->pPoints);
+            if(!m_pSENCBin)
+                  free(value->pPoints);
+            free(value->pPix);
             delete value;
           }
     }
@@ -1146,12 +1479,24 @@ s57chart::~s57chart()
           VC_Element *value = itc->second;
           if(value)
           {
-                free(value->pPoint);
+                if(!m_pSENCBin)
+                      free(value->pPoint);
                 delete value;
           }
     }
     m_vc_hash.clear();
 
+    //  Objects loaded, but never attached to rules
+    ListOfS57ObjNode *node = m_SENCObjList.GetFirst();
+    while(node)
+    {
+          delete node->GetData();
+          node = node->GetNext();
+    }
+    m_SENCObjList.Clear();
+
+    //  Last, as the objects and edge tables point into it
+    ReleaseSENCBinary();
 
 }
 
@@ -1274,6 +1619,9 @@ void s57chart::FreeObjectsAndRules()
 //      The LUPs of base elements are deleted elsewhere ( void s52plib::DestroyLUPArray ( wxArrayOfLUPrec *pLUPArray ))
 //      But we need to manually destroy any LUPS related to children
 
+    delete m_pObjIndex;
+    m_pObjIndex = NULL;
+
     ObjRazRules *top;
     ObjRazRules *nxx;
     for (int i=0; i<PRIO_NUM; ++i)
@@ -1377,19 +1725,139 @@ void s57chart::FreeObjectsAndRules()
 //              Pixel to Lat/Long Conversion helpers
 //-----------------------------------------------------------------------
 
+//    Points are scaled and rounded first, then offset by the integer pixel position
+//    of the SM origin, so that a pure pan moves every point by the same whole pixels.
+//    This lets GetEdgePix() retain scaled edges across pans.
 void s57chart::GetPointPix(ObjRazRules *rzRules, float north, float east, wxPoint *r)
 {
-      r->x = (int)round(((east - m_easting_vp_center) * m_view_scale_ppm) + m_pixx_vp_center);
-      r->y = (int)round(m_pixy_vp_center - ((north - m_northing_vp_center) * m_view_scale_ppm));
+      r->x = (int)round(east * m_view_scale_ppm) + m_pix_offset_x;
+      r->y = m_pix_offset_y - (int)round(north * m_view_scale_ppm);
 }
 
 void s57chart::GetPointPix(ObjRazRules *rzRules, wxPoint2DDouble *en, wxPoint *r, int nPoints)
 {
       for(int i=0 ; i < nPoints ; i++)
       {
-            r[i].x = (int)round(((en[i].m_x - m_easting_vp_center) * m_view_scale_ppm) + m_pixx_vp_center);
-            r[i].y = (int)round(m_pixy_vp_center - ((en[i].m_y - m_northing_vp_center) * m_view_scale_ppm));
+            r[i].x = (int)round(en[i].m_x * m_view_scale_ppm) + m_pix_offset_x;
+            r[i].y = m_pix_offset_y - (int)round(en[i].m_y * m_view_scale_ppm);
+      }
+}
+
+//    Douglas-Peucker simplification of an integer polyline, in place
+//    The end points are always kept.  Returns the new point count.
+static int SimplifyPolyline(wxPoint *pts, int n, double tolerance)
+{
+      if(n < 3)
+            return n;
+
+      unsigned char *keep = (unsigned char *)calloc(n, 1);
+      int *stack = (int *)malloc(2 * n * sizeof(int));
+      if(!keep || !stack)
+      {
+            free(keep);
+            free(stack);
+            return n;
+      }
+
+      double tol2 = tolerance * tolerance;
+      keep[0] = 1;
+      keep[n - 1] = 1;
+
+      int sp = 0;
+      stack[sp++] = 0;
+      stack[sp++] = n - 1;
+
+      while(sp)
+      {
+            int last = stack[--sp];
+            int first = stack[--sp];
+
+            double dx = pts[last].x - pts[first].x;
+            double dy = pts[last].y - pts[first].y;
+            double len2 = (dx * dx) + (dy * dy);
+
+            double dist_max = 0.;
+            int imax = 0;
+            for(int i = first + 1 ; i < last ; i++)
+            {
+                  double px = pts[i].x - pts[first].x;
+                  double py = pts[i].y - pts[first].y;
+                  double d2;
+                  if(len2 > 0.)
+                  {
+                        double cross = (px * dy) - (py * dx);
+                        d2 = (cross * cross) / len2;
+                  }
+                  else
+                        d2 = (px * px) + (py * py);
+
+                  if(d2 > dist_max)
+                  {
+                        dist_max = d2;
+                        imax = i;
+                  }
+            }
+
+            if(dist_max > tol2)
+            {
+                  keep[imax] = 1;
+                  stack[sp++] = first;
+                  stack[sp++] = imax;
+                  stack[sp++] = imax;
+                  stack[sp++] = last;
+            }
+      }
+
+      int nkeep = 0;
+      for(int i = 0 ; i < n ; i++)
+      {
+            if(keep[i])
+                  pts[nkeep++] = pts[i];
+      }
+
+      free(keep);
+      free(stack);
+
+      return nkeep;
+}
+
+//    Get the retained, simplified pixel geometry of an edge at the current scale.
+//    Add GetPixOffset() to each point to get screen pixels.
+//    The points are rebuilt only when the scale changes.
+wxPoint *s57chart::GetEdgePix(VE_Element *pedge, int *pnPoints)
+{
+      if(pedge->nCount <= 0)
+      {
+            *pnPoints = 0;
+            return pedge->pPix;
+      }
+
+      if(!pedge->pPix || (pedge->pix_ppm != m_view_scale_ppm))
+      {
+            if(!pedge->pPix)
+                  pedge->pPix = (wxPoint *)malloc(pedge->nCount * sizeof(wxPoint));
+            if(!pedge->pPix)
+                  return NULL;
+
+            //    Scale exactly as GetPointPix() does, including the float conversion
+            double *ppt = pedge->pPoints;
+            wxPoint *pr = pedge->pPix;
+            for(int ip = 0 ; ip < pedge->nCount ; ip++)
+            {
+                  float easting = (float)*ppt++;
+                  float northing = (float)*ppt++;
+                  pr->x = (int)round(easting * m_view_scale_ppm);
+                  pr->y = -(int)round(northing * m_view_scale_ppm);
+                  pr++;
+            }
+
+            //    Half a pixel of simplification is invisible, but drops most points at small scale
+            pedge->nPix = SimplifyPolyline(pedge->pPix, pedge->nCount, 0.5);
+            pedge->pix_ppm = m_view_scale_ppm;
       }
+
+      *pnPoints = pedge->nPix;
+      return pedge->pPix;
 }
 
 
@@ -1426,6 +1894,9 @@ void s57chart::SetVPParms(const ViewPort &vpt)
       m_view_scale_ppm = vpt.view_scale_ppm;
 
       toSM ( vpt.clat, vpt.clon, ref_lat, ref_lon, &m_easting_vp_center, &m_northing_vp_center );
+
+      m_pix_offset_x = (int)round(m_pixx_vp_center - (m_easting_vp_center * m_view_scale_ppm));
+      m_pix_offset_y = (int)round(m_pixy_vp_center + (m_northing_vp_center * m_view_scale_ppm));
 }
 
 bool s57chart::AdjustVP(ViewPort &vp_last, ViewPort &vp_proposed)
@@ -2451,7 +2922,6 @@ int s57chart::DCRenderRect(wxMemoryDC& dcinput, const ViewPort& vp, wxRect* rect
 {
 
     int i;
-    ObjRazRules *top;
     ObjRazRules *crnt;
 
     wxASSERT(rect);
@@ -2515,21 +2985,29 @@ int s57chart::DCRenderRect(wxMemoryDC& dcinput, const ViewPort& vp, wxRect* rect
 
 
 //      Render the areas quickly
+//      The fills are collected in priority order, then rasterised in bands in parallel
+//      Only the areas found in the spatial index for this view are visited
+    wxArrayInt vis_hits;
+    int vis_first[OBJ_INDEX_BUCKETS + 1];
+    QueryVisibleRules(tvp, vis_hits, vis_first);
+    S57ObjIndex *pidx = GetObjIndex();
+
+    int area_type = (ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES) ? 4 : 3;   // Area Symbolized or Plain Boundaries
+
+    ps52plib->BeginAreaRaster();
+
     for (i=0; i<PRIO_NUM; ++i)
     {
-          if(ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES)
-                top = razRules[i][4];           // Area Symbolized Boundaries
-          else
-                top = razRules[i][3];           // Area Plain Boundaries
-
-          while ( top != NULL)
+          int bucket = (i * LUPNAME_NUM) + area_type;
+          for(int ih = vis_first[bucket] ; ih < vis_first[bucket + 1] ; ih++)
           {
-                crnt = top;
-                top  = top->next;               // next object
+                crnt = pidx->GetEntry(vis_hits[ih])->rzRules;
                 ps52plib->RenderAreaToDC(&dcinput, crnt, &tvp, &pb_spec);
           }
     }
 
+    ps52plib->FlushAreaRaster(&pb_spec);
+
 
 
 //      Convert the Private render canvas into a bitmap
@@ -2576,7 +3054,14 @@ bool s57chart::DCRenderLPB(wxMemoryDC& dcinput, const ViewPort& vp, wxRect* rect
     ObjRazRules *crnt;
     ViewPort tvp = vp;                    // undo const  TODO fix this in PLIB
 
+//      Areas and lines are taken from the spatial index
+//      Points have render-time extents, so they are still walked in full
+    wxArrayInt vis_hits;
+    int vis_first[OBJ_INDEX_BUCKETS + 1];
+    QueryVisibleRules(tvp, vis_hits, vis_first);
+    S57ObjIndex *pidx = GetObjIndex();
 
+    int area_type = (ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES) ? 4 : 3;   // Area Symbolized or Plain Boundaries
 
     for (i=0; i<PRIO_NUM; ++i)
     {
@@ -2588,23 +3073,18 @@ bool s57chart::DCRenderLPB(wxMemoryDC& dcinput, const ViewPort& vp, wxRect* rect
 //         pdcc = new wxDCClipper(dcinput, nr);
         }
 
-        if(ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES)
-              top = razRules[i][4];           // Area Symbolized Boundaries
-        else
-              top = razRules[i][3];           // Area Plain Boundaries
-        while ( top != NULL)
+        int bucket = (i * LUPNAME_NUM) + area_type;
+        for(int ih = vis_first[bucket] ; ih < vis_first[bucket + 1] ; ih++)
         {
-              crnt = top;
-              top  = top->next;               // next object
+              crnt = pidx->GetEntry(vis_hits[ih])->rzRules;
               ps52plib->RenderObjectToDC(&dcinput, crnt, &tvp);
         }
 
-        top = razRules[i][2];           //LINES
-        while ( top != NULL)
+        bucket = (i * LUPNAME_NUM) + 2;           //LINES
+        for(int ih = vis_first[bucket] ; ih < vis_first[bucket + 1] ; ih++)
         {
-            ObjRazRules *crnt = top;
-            top  = top->next;
-            ps52plib->RenderObjectToDC(&dcinput, crnt, &tvp);
+              crnt = pidx->GetEntry(vis_hits[ih])->rzRules;
+              ps52plib->RenderObjectToDC(&dcinput, crnt, &tvp);
         }
 
 
@@ -2733,51 +3213,102 @@ InitReturn s57chart::Init( const wxString& name, ChartInitFlag flags )
 
     //      Full initialization from here
 
-    if(!m_bbase_file_attr_known)
-    {
-          if(!GetBaseFileAttr(fn))
-                ret_value = INIT_FAIL_REMOVE;
-          else
-                m_bbase_file_attr_known = true;
-    }
-
+    ::wxBeginBusyCursor();
 
-    if(fn.GetExt() == _T("000"))
-    {
-         if(m_bbase_file_attr_known)
-         {
-                ::wxBeginBusyCursor();
+    ret_value = LoadInit(name);
+    if(INIT_OK == ret_value)
+          ret_value = FinishInit();
 
-                int sret = FindOrCreateSenc(name);
-                if(sret != BUILD_SENC_OK)
-                {
-                      if(sret == BUILD_SENC_NOK_RETRY)
-                            ret_value = INIT_FAIL_RETRY;
-                      else
-                            ret_value = INIT_FAIL_REMOVE;
-                }
-                else
-                      ret_value = PostInit(flags, m_global_color_scheme);
+    ::wxEndBusyCursor();
 
-                ::wxEndBusyCursor();
-         }
+    s_bInS57--;
+    return ret_value;
 
-   }
+}
 
-    else if(fn.GetExt() == _T("S57"))
-    {
-          ::wxBeginBusyCursor();
+//-----------------------------------------------------------------------------------------------
+//    First part of the full initialization: find or build the SENC, and read it
+//    No GDI and no S52 library here, so with b_worker set this may run on a worker thread,
+//    and any SENC build is then done without progress dialog or message box
+//-----------------------------------------------------------------------------------------------
+InitReturn s57chart::LoadInit( const wxString& name, bool b_worker )
+{
+    InitReturn ret_value = INIT_OK;
+
+    m_FullPath = name;
+    m_Description = m_FullPath;
+
+    wxFileName fn(name);
+
+    //      Get the "Usage" character
+    wxString cname = fn.GetName();
+    m_usage_char = cname[2];
+
+        //  Establish a common reference point for the chart
+    ref_lat = (m_FullExtent.NLAT + m_FullExtent.SLAT) /2.;
+    ref_lon = (m_FullExtent.WLON + m_FullExtent.ELON) /2.;
+
+    m_bWorkerLoad = b_worker;
+
+    if(!m_bbase_file_attr_known)
+    {
+          if(!GetBaseFileAttr(fn))
+                ret_value = INIT_FAIL_REMOVE;
+          else
+                m_bbase_file_attr_known = true;
+    }
 
+    if(fn.GetExt() == _T("000"))
+    {
+          if(m_bbase_file_attr_known)
+          {
+                int sret = FindOrCreateSenc(name);
+                if(sret != BUILD_SENC_OK)
+                {
+                      if(sret == BUILD_SENC_NOK_RETRY)
+                            ret_value = INIT_FAIL_RETRY;
+                      else
+                            ret_value = INIT_FAIL_REMOVE;
+                }
+          }
+          else
+                ret_value = INIT_FAIL_REMOVE;
+    }
+    else if(fn.GetExt() == _T("S57"))
+    {
           m_SENCFileName = name;
-          ret_value = PostInit(flags, m_global_color_scheme);
+          ret_value = INIT_OK;
+    }
+    else
+          ret_value = INIT_FAIL_REMOVE;
+
+    m_bWorkerLoad = false;
 
-          ::wxEndBusyCursor();
+//    SENC file is ready, so read the objects
+    if(INIT_OK == ret_value)
+    {
+          if(0 != LoadSENCObjects( m_SENCFileName.GetFullPath()) )
+          {
+                wxString msg(_T("   Cannot load SENC file "));
+                msg.Append(m_SENCFileName.GetFullPath());
+                wxLogMessage(msg);
 
+                ret_value = INIT_FAIL_RETRY;
+          }
     }
 
-    s_bInS57--;
     return ret_value;
+}
+
+//-----------------------------------------------------------------------------------------------
+//    Second part of the full initialization, on the UI thread:
+//    attach the S52 rules to the objects read by LoadInit(), then thumbnail and colors
+//-----------------------------------------------------------------------------------------------
+InitReturn s57chart::FinishInit( void )
+{
+    AttachSENCObjects();
 
+    return PostInit(FULL_INIT, m_global_color_scheme);
 }
 
 
@@ -2792,7 +3323,8 @@ InitReturn s57chart::FindOrCreateSenc( const wxString& name )
     m_SENCFileName.SetExt(_T("S57"));
 
     //      Set the proper directory for the SENC files
-    wxString SENCdir = g_SENCPrefix;
+    //      A deep copy, as this may run on the prefetch worker and wxString reference counts are not thread safe
+    wxString SENCdir(g_SENCPrefix.c_str());
 
     if(SENCdir.Last() != m_SENCFileName.GetPathSeparator())
          SENCdir.Append(m_SENCFileName.GetPathSeparator());
@@ -2980,18 +3512,7 @@ InitReturn s57chart::FindOrCreateSenc( const wxString& name )
 
 InitReturn s57chart::PostInit( ChartInitFlag flags, ColorScheme cs )
 {
-
-
-//    SENC file is ready, so build the RAZ structure
-        if(0 != BuildRAZFromSENCFile( m_SENCFileName.GetFullPath()) )
-        {
-              wxString msg(_T("   Cannot load SENC file "));
-              msg.Append(m_SENCFileName.GetFullPath());
-              wxLogMessage(msg);
-
-              return INIT_FAIL_RETRY;
-        }
-
+//      The objects are attached to their rules by FinishInit()
 
 //      Check for and if necessary rebuild Thumbnail
 //      Going to be in the global (user) SENC file directory
@@ -3034,11 +3555,241 @@ InitReturn s57chart::PostInit( ChartInitFlag flags, ColorScheme cs )
 //    Build array of contour values for later use by conditional symbology
 
     BuildDepthContourArray();
+
+//    Restore the conditional symbology results of an earlier session
+    LoadCSCache();
+
         bReadyToRender = true;
 
         return INIT_OK;
 }
 
+//----------------------------------------------------------------------------------
+//      Conditional Symbology cache file
+//
+//      The CS instruction strings of a chart, valid for one plib CS state,
+//      are kept in a file alongside the SENC, so that reopening the chart
+//      does not need to run the CS procedures again.
+//----------------------------------------------------------------------------------
+
+typedef struct {
+      char        sig[8];                       // "OCPNCSC2"
+      wxInt32     program_version;              // version of the CS procedures
+      wxInt32     plib_hash;                    // s52plib::GetLUPHash() of the lookup tables
+      wxInt32     cs_state_hash;                // s52plib::GetCSStateHash() of the results
+      wxInt32     senc_mtime;                   // SENC file the results belong to
+      wxInt32     senc_size;
+      wxInt32     nrecords;
+} CSCacheHeader;
+
+typedef struct {
+      wxInt32     index;                        // S57Obj::Index
+      wxInt32     display_cat;                  // S57Obj::m_DisplayCat, as set by the CS
+      wxInt32     dpri;                         // S57Obj::m_DPRI, as set by the CS
+      wxInt32     len;                          // length of the UTF8 CS string which follows
+} CSCacheRecord;
+
+WX_DECLARE_HASH_MAP( int, int, wxIntegerHash, wxIntegerEqual, CSCacheHash );
+
+static wxInt32 CSCacheProgramVersion(void)
+{
+      return (VERSION_MAJOR * 10000) + (VERSION_MINOR * 100) + VERSION_PATCH;
+}
+
+static bool HasCSRule(LUPrec *LUP)
+{
+      Rules *rules = LUP->ruleList;
+      while(rules)
+      {
+            if(RUL_CND_SY == rules->ruleType)
+                  return true;
+            rules = rules->next;
+      }
+      return false;
+}
+
+static bool GetCSCacheKey(const wxFileName &SENCFileName, wxFileName &cache_file, wxInt32 *pmtime, wxInt32 *psize)
+{
+      if(!SENCFileName.FileExists())
+            return false;
+
+      cache_file = SENCFileName;
+      cache_file.SetExt(_T("CSC"));
+
+      *pmtime = (wxInt32)SENCFileName.GetModificationTime().GetTicks();
+      *psize = (wxInt32)SENCFileName.GetSize().GetLo();
+
+      return true;
+}
+
+void s57chart::LoadCSCache(void)
+{
+      m_n_cs_loaded = 0;
+
+      wxFileName cache_file;
+      wxInt32 mtime, size;
+      if(!ps52plib || !GetCSCacheKey(m_SENCFileName, cache_file, &mtime, &size) || !cache_file.FileExists())
+            return;
+
+      wxFile file(cache_file.GetFullPath());
+      if(!file.IsOpened())
+            return;
+
+      CSCacheHeader hdr;
+      if(file.Read(&hdr, sizeof(hdr)) != sizeof(hdr))
+            return;
+
+      ps52plib->GenerateCSStateHash();
+
+      if(strncmp(hdr.sig, "OCPNCSC2", 8) || (hdr.program_version != CSCacheProgramVersion())
+         || (hdr.plib_hash != (wxInt32)ps52plib->GetLUPHash())
+         || (hdr.cs_state_hash != (wxInt32)ps52plib->GetCSStateHash())
+         || (hdr.senc_mtime != mtime) || (hdr.senc_size != size) || (hdr.nrecords <= 0))
+            return;
+
+      //    Read the records in one block, and index them by object
+      int data_len = file.Length() - sizeof(hdr);
+      if(data_len <= 0)
+            return;
+
+      unsigned char *data = (unsigned char *)malloc(data_len);
+      if(!data)
+            return;
+
+      if(file.Read(data, data_len) != data_len)
+      {
+            free(data);
+            return;
+      }
+
+      CSCacheHash record_hash;
+      int offset = 0;
+      for(int ir = 0 ; ir < hdr.nrecords ; ir++)
+      {
+            if(offset + (int)sizeof(CSCacheRecord) > data_len)
+                  break;
+            CSCacheRecord *prec = (CSCacheRecord *)(data + offset);
+            if((prec->len < 0) || (offset + (int)sizeof(CSCacheRecord) + prec->len > data_len))
+                  break;
+
+            record_hash[prec->index] = offset;
+            offset += sizeof(CSCacheRecord) + prec->len;
+      }
+
+      //    Apply them to the objects with conditional symbology
+      for(int i=0 ; i<PRIO_NUM ; i++)
+      {
+            for(int j=0 ; j<LUPNAME_NUM ; j++)
+            {
+                  ObjRazRules *top = razRules[i][j];
+                  while(top != NULL)
+                  {
+                        S57Obj *obj = top->obj;
+                        if(!obj->bCS_Added && HasCSRule(top->LUP))
+                        {
+                              CSCacheHash::iterator it = record_hash.find(obj->Index);
+                              if(it != record_hash.end())
+                              {
+                                    CSCacheRecord *prec = (CSCacheRecord *)(data + it->second);
+                                    wxString cs_string((const char *)(prec + 1), wxConvUTF8, prec->len);
+
+                                    obj->m_DisplayCat = (DisCat)prec->display_cat;
+                                    obj->m_DPRI = prec->dpri;
+                                    ps52plib->SetCSRules(top, cs_string);
+                                    obj->bCS_Added = 1;
+                                    m_n_cs_loaded++;
+                              }
+                        }
+
+                        top = top->next;
+                  }
+            }
+      }
+
+      free(data);
+}
+
+void s57chart::SaveCSCache(void)
+{
+      wxFileName cache_file;
+      wxInt32 mtime, size;
+      if(!ps52plib || !GetCSCacheKey(m_SENCFileName, cache_file, &mtime, &size))
+            return;
+
+      ps52plib->GenerateCSStateHash();
+      long cs_state_hash = ps52plib->GetCSStateHash();
+      int cs_generation = ps52plib->GetCSGeneration();
+
+      //    Collect the CS results which are valid for the current CS state
+      wxMemoryOutputStream records;
+      CSCacheHash done_hash;
+      int nrecords = 0;
+
+      for(int i=0 ; i<PRIO_NUM ; i++)
+      {
+            for(int j=0 ; j<LUPNAME_NUM ; j++)
+            {
+                  ObjRazRules *top = razRules[i][j];
+                  while(top != NULL)
+                  {
+                        S57Obj *obj = top->obj;
+                        if(obj->bCS_Added && obj->CSLUP && (obj->CS_generation == cs_generation)
+                           && obj->CSLUP->INST && (obj->CS_state_hash == cs_state_hash)
+                           && (done_hash.find(obj->Index) == done_hash.end()))
+                        {
+                              done_hash[obj->Index] = 1;
+
+                              wxCharBuffer buf = obj->CSLUP->INST->mb_str(wxConvUTF8);
+                              CSCacheRecord rec;
+                              rec.index = obj->Index;
+                              rec.display_cat = obj->m_DisplayCat;
+                              rec.dpri = obj->m_DPRI;
+                              rec.len = strlen(buf.data());
+
+                              records.Write(&rec, sizeof(rec));
+                              records.Write(buf.data(), rec.len);
+                              nrecords++;
+                        }
+
+                        top = top->next;
+                  }
+            }
+      }
+
+      //    Nothing learned since the chart was loaded
+      if(nrecords <= m_n_cs_loaded)
+            return;
+
+      CSCacheHeader hdr;
+      memcpy(hdr.sig, "OCPNCSC2", 8);
+      hdr.program_version = CSCacheProgramVersion();
+      hdr.plib_hash = (wxInt32)ps52plib->GetLUPHash();
+      hdr.cs_state_hash = (wxInt32)cs_state_hash;
+      hdr.senc_mtime = mtime;
+      hdr.senc_size = size;
+      hdr.nrecords = nrecords;
+
+      wxString tmp_file = cache_file.GetFullPath() + _T(".tmp");
+      wxFile file(tmp_file, wxFile::write);
+      if(!file.IsOpened())
+            return;
+
+      bool bok = (file.Write(&hdr, sizeof(hdr)) == sizeof(hdr));
+
+      wxStreamBuffer *psb = records.GetOutputStreamBuffer();
+      size_t len = records.GetSize();
+      if(bok && len)
+            bok = (file.Write(psb->GetBufferStart(), len) == len);
+
+      file.Close();
+
+      if(bok)
+            bok = ::wxRenameFile(tmp_file, cache_file.GetFullPath());
+
+      if(!bok)
+            ::wxRemoveFile(tmp_file);
+}
+
 void s57chart::BuildDepthContourArray(void)
 {
       //    Build array of contour values for later use by conditional symbology
@@ -3249,6 +4000,8 @@ WX_DEFINE_ARRAY(float*, MyFloatPtrArray);
 //    Read the .000 ENC file and create required Chartbase data structures
 bool s57chart::CreateHeaderDataFromENC(void)
 {
+      wxMutexLocker lock(s_OGRMutex);
+
       if(!InitENCMinimal(m_FullPath))
       {
             wxString msg(_T("   Cannot initialize ENC file "));
@@ -3710,50 +4463,38 @@ ListOfS57Obj *s57chart::GetAssociatedObjects(S57Obj *obj)
                   }
 */
 
-                  gotit = false;
-                  top = razRules[disPrioIdx][3];     // PLAIN_BOUNDARIES
-                  while ( top != NULL)
-                  {
-                        if(top->obj->bIsAssociable)
-                        {
-                              if(top->obj->BBObj.PointInBox( lon, lat, 0.0))
-                              {
-                                    if(IsPointInObjArea(lat, lon, 0.0, top->obj))
-                                    {
-                                          pobj_list->Append(top->obj);
-                                          gotit = true;
-                                          break;
-                                    }
-                              }
-                        }
-
-                        ObjRazRules *nxx  = top->next;
-                        top = nxx;
-                  }
-
-                  if(!gotit)
+                  //    Candidate areas come from the spatial index, in list order,
+                  //    so the first containing area of each list is the same one a list walk would find
                   {
-                        top = razRules[disPrioIdx][4];     // SYMBOLIZED_BOUNDARIES
-                        while ( top != NULL)
+                        S57ObjIndex *pidx = GetObjIndex();
+                        wxArrayInt hits;
+                        int hit_first[OBJ_INDEX_BUCKETS + 1];
+                        pidx->Query(lon, lat, lon, lat, hits);
+                        pidx->GetBucketRanges(hits, hit_first);
+
+                        gotit = false;
+                        for(int j = 3 ; (j <= 4) && !gotit ; j++)         // PLAIN_BOUNDARIES, then SYMBOLIZED_BOUNDARIES
                         {
-                              if(top->obj->bIsAssociable)
+                              int bucket = (disPrioIdx * LUPNAME_NUM) + j;
+                              for(int ih = hit_first[bucket] ; ih < hit_first[bucket + 1] ; ih++)
                               {
-                                    if(top->obj->BBObj.PointInBox( lon, lat, 0.0))
+                                    top = pidx->GetEntry(hits[ih])->rzRules;
+                                    if(top->obj->bIsAssociable)
                                     {
-                                          if(IsPointInObjArea(lat, lon, 0.0, top->obj))
+                                          if(top->obj->BBObj.PointInBox( lon, lat, 0.0))
                                           {
-                                                pobj_list->Append(top->obj);
-                                                break;
+                                                if(IsPointInObjArea(lat, lon, 0.0, top->obj))
+                                                {
+                                                      pobj_list->Append(top->obj);
+                                                      gotit = true;
+                                                      break;
+                                                }
                                           }
                                     }
                               }
-
-                              ObjRazRules *nxx  = top->next;
-                              top = nxx;
                         }
                   }
 
-
                   break;
 
             case GEO_LINE:
@@ -3880,6 +4621,8 @@ static int ExtensionCompare(const wxString& first, const wxString& second)
 
 int s57chart::GetUpdateFileArray(const wxFileName file000, wxArrayString *UpFiles)
 {
+        wxMutexLocker lock(s_OGRMutex);
+
         wxString DirName000 = file000.GetPath((int)(wxPATH_GET_SEPARATOR | wxPATH_GET_VOLUME));
         wxDir dir(DirName000);
         wxString ext;
@@ -4157,6 +4900,8 @@ wxString s57chart::GetISDT(void)
 
 bool s57chart::GetBaseFileAttr(wxFileName fn)
 {
+      wxMutexLocker lock(s_OGRMutex);
+
       if(!wxFileName::FileExists(fn.GetFullPath()))
             return false;
 
@@ -4259,6 +5004,8 @@ int s57chart::BuildSENCFile(const wxString& FullPath000, const wxString& SENCFil
     wxString nice_name;
     int bbad_update = false;
 
+    wxMutexLocker lock(s_OGRMutex);
+
     wxString msg0(_T("Building SENC file for "));
     msg0.Append(FullPath000);
     msg0.Append(_T(" to "));
@@ -4339,7 +5086,9 @@ int s57chart::BuildSENCFile(const wxString& FullPath000, const wxString& SENCFil
     Title.append(SENCfile.GetFullPath());
 
 
-    s_ProgDialog = new wxProgressDialog(  Title, Message, m_nGeoRecords, NULL,
+    //  No progress dialog when building on a worker thread
+    if(!m_bWorkerLoad)
+          s_ProgDialog = new wxProgressDialog(  Title, Message, m_nGeoRecords, NULL,
                                        wxPD_AUTO_HIDE | wxPD_ELAPSED_TIME |
                                        wxPD_ESTIMATED_TIME |
                                        wxPD_REMAINING_TIME  | wxPD_SMOOTH | wxSTAY_ON_TOP);
@@ -4374,7 +5123,8 @@ int s57chart::BuildSENCFile(const wxString& FullPath000, const wxString& SENCFil
     OGRwkbGeometryType geoType;
     wxString sobj;
 
-    bcont = s_ProgDialog->Update(1, _T(""));
+    if(s_ProgDialog)
+          bcont = s_ProgDialog->Update(1, _T(""));
 
 
     //  Here comes the actual ISO8211 file reading
@@ -4396,7 +5146,8 @@ int s57chart::BuildSENCFile(const wxString& FullPath000, const wxString& SENCFil
     if(open_return == BAD_UPDATE)         ///172
           bbad_update = true;
 
-    bcont = s_ProgDialog->Update(2, _T(""));
+    if(s_ProgDialog)
+          bcont = s_ProgDialog->Update(2, _T(""));
     if(!bcont)
           goto abort_point;
 
@@ -4603,8 +5354,11 @@ abort_point:
 
 //    VSIFClose( s_fpdebug);
 
-    delete s_ProgDialog;
-    s_ProgDialog = NULL;
+    if(!m_bWorkerLoad)
+    {
+          delete s_ProgDialog;
+          s_ProgDialog = NULL;
+    }
 
     fclose(fps57);
 
@@ -4661,165 +5415,781 @@ abort_point:
 */
 
        if(bbad_update)
-             OCPNMessageBox(_T("Errors encountered processing ENC update file(s).\nENC features may be incomplete or inaccurate."),
+       {
+             if(m_bWorkerLoad)
+                   wxLogMessage(_T("   Errors encountered processing ENC update file(s) for ") + FullPath000);
+             else
+                   OCPNMessageBox(_T("Errors encountered processing ENC update file(s).\nENC features may be incomplete or inaccurate."),
                           _T("OpenCPN Create SENC"), wxOK | wxICON_EXCLAMATION);
+       }
 
       return ret_code;
 }
 
-int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
-{
-      int ret_val = 0;                    // default is OK
+//----------------------------------------------------------------------------------
+//      Binary SENC file
+//
+//      The text SENC is converted once into a fixed layout file alongside it,
+//      which is then mapped into memory (or read whole where mapping is not
+//      available) and used in place: the object geometry, attribute values and
+//      edge/node tables of the chart point into it.  Records and arrays are
+//      8 byte aligned, and all offsets are from the start of the file.
+//      The file is rebuilt from the text SENC whenever its own version, or the
+//      version or modification of the text SENC it was built from, changes.
+//----------------------------------------------------------------------------------
 
-      //    Sanity check for existence of file
-      wxFileName SENCFileName( FullPath );
+#define SENC_BIN_VERSION            1
+#define SENC_BIN_BYTE_ORDER         0x01020304
+#define SENC_BIN_ALIGN(n)           (((n) + 7) & ~((size_t)7))
+
+#define SENC_BIN_OBJ_BBOX_VALID     0x01
+#define SENC_BIN_OBJ_ASSOCIABLE     0x02
+#define SENC_BIN_OBJ_GEOPT          0x04
+#define SENC_BIN_OBJ_MULTI          0x08
+
+typedef struct {
+      char        sig[8];                       // "OCPNSENB"
+      wxInt32     bin_version;                  // SENC_BIN_VERSION
+      wxInt32     senc_version;                 // CURRENT_SENC_FORMAT_VERSION of the text SENC
+      wxInt32     senc_mtime;                   // text SENC the file was built from
+      wxInt32     senc_size;
+      wxInt32     byte_order;                   // SENC_BIN_BYTE_ORDER, as written
+      wxInt32     scale;
+      wxInt32     nobjects;
+      wxInt32     nve;
+      wxInt32     nvc;
+      wxInt32     pad;
+      wxInt64     file_length;
+      wxInt64     obj_table;                    // wxInt64[nobjects], offsets of the SENCBinObject records
+      wxInt64     ve_table;                     // SENCBinVE[nve]
+      wxInt64     vc_table;                     // SENCBinVC[nvc]
+      char        name[128];                    // UTF8, zero terminated
+      char        date000[16];
+      char        dateupd[16];
+} SENCBinHeader;
+
+typedef struct {
+      char        feature_name[8];
+      wxInt32     primitive_type;
+      wxInt32     index;
+      wxInt32     npt;
+      wxInt32     scamin;
+      wxInt32     flags;                        // SENC_BIN_OBJ_xxx
+      wxInt32     nattr;
+      wxInt32     n_lsindex;
+      wxInt32     pad;
+      double      x, y, z;
+      double      lat, lon;
+      double      bbox[4];                      // lon/lat min x, min y, max x, max y
+      wxInt64     attr_offset;                  // nattr SENCBinAttr records, each followed by its value
+      wxInt64     geom_offset;                  // pt[npt], or double[3 * npt] and double[2 * npt] for multipoints
+      wxInt64     lsindex_offset;               // int[3 * n_lsindex]
+      wxInt64     poly_offset;                  // SENCBinPoly, 0 for none
+} SENCBinObject;
+
+typedef struct {
+      char        name[16];                     // attribute acronym
+      wxInt32     type;                         // OGRatt_t
+      wxInt32     len;                          // length of the value which follows
+} SENCBinAttr;
+
+typedef struct {
+      double      xmin, ymin, xmax, ymax;
+      wxInt32     ncontours;
+      wxInt32     nwkb;
+      wxInt32     ntriprim;
+      wxInt32     nvertex_max;
+      wxInt32     bsmsenc;
+      wxInt32     pad;
+      wxInt64     contour_offset;               // int[ncontours]
+      wxInt64     geom_offset;                  // nwkb bytes of raw contour geometry
+      wxInt64     triprim_offset;               // ntriprim SENCBinTriPrim records, each followed by its vertices
+} SENCBinPoly;
+
+typedef struct {
+      wxInt32     type;
+      wxInt32     nvert;
+      double      bbox[4];                      // lon/lat min x, min y, max x, max y
+} SENCBinTriPrim;
+
+typedef struct {
+      wxInt32     index;
+      wxInt32     count;
+      wxInt64     points_offset;                // double[2 * count]
+} SENCBinVE;
+
+typedef struct {
+      wxInt32     index;
+      wxInt32     pad;
+      double      point[2];
+} SENCBinVC;
+
+static bool GetSENCBinKey(const wxFileName &SENCFileName, wxInt32 *pmtime, wxInt32 *psize)
+{
       if(!SENCFileName.FileExists())
-      {
-            wxString msg(_T("   Cannot open SENC file "));
-            msg.Append(SENCFileName.GetFullPath());
-            wxLogMessage(msg);
-
-            return 1;
-      }
+            return false;
 
-        int nProg = 0;
+      *pmtime = (wxInt32)SENCFileName.GetModificationTime().GetTicks();
+      *psize = (wxInt32)SENCFileName.GetSize().GetLo();
 
-        wxString ifs(FullPath);
+      return true;
+}
 
-        wxFileInputStream fpx_u(ifs);
-        wxBufferedInputStream fpx(fpx_u);
+//    Appends 8 byte aligned blocks to a binary SENC file, returning their offsets
+class SENCBinWriter
+{
+public:
+      SENCBinWriter(const wxString &path) : m_file(path, wxFile::write)
+      {
+            m_offset = 0;
+            m_bok = m_file.IsOpened();
+      }
 
-        int MAX_LINE = 499999;
-        char *buf = (char *)malloc(MAX_LINE + 1);
+      bool IsOk(){ return m_bok; }
+      wxInt64 Length(){ return m_offset; }
+      void Close(){ m_file.Close(); }
 
-        LUPrec           *LUP;
-        LUPname          LUP_Name = PAPER_CHART;
+      wxInt64 Put(const void *data, size_t len)
+      {
+            static const char pad[8] = { 0 };
 
-        int     nGeoFeature;
+            wxInt64 offset = m_offset;
+            size_t padded = SENC_BIN_ALIGN(len);
 
-        int object_count = 0;
+            if(m_bok && len)
+                  m_bok = (m_file.Write(data, len) == len);
+            if(m_bok && (padded > len))
+                  m_bok = (m_file.Write(pad, padded - len) == padded - len);
 
-        OGREnvelope     Envelope;
+            m_offset += padded;
+            return offset;
+      }
 
-        int dun = 0;
+      void PutAt(wxInt64 offset, const void *data, size_t len)
+      {
+            if(m_bok)
+                  m_bok = (m_file.Seek(offset) == offset) && (m_file.Write(data, len) == len);
+            if(m_bok)
+                  m_bok = (m_file.SeekEnd() == m_offset);
+      }
 
-        hdr_buf = (char *)malloc(1);
-        wxProgressDialog    *SENC_prog = NULL;
-        int nGeo1000;
-        wxString date_000, date_upd;
+private:
+      wxFile      m_file;
+      wxInt64     m_offset;
+      bool        m_bok;
+};
 
-//        if(my_fgets(buf, MAX_LINE, fpx) == 0)
-//           dun = 1;
+//    Maps a binary SENC file privately, so that in place fixups never reach the file.
+//    Where that is not possible the file is read whole.
+static char *MapSENCBinFile(const wxString &path, size_t *plen, bool *pbmapped)
+{
+      *plen = 0;
+      *pbmapped = false;
 
+#ifndef __WXMSW__
+      int fd = open(path.fn_str(), O_RDONLY);
+      if(fd < 0)
+            return NULL;
 
-        while(!dun)
-        {
+      struct stat st;
+      if((0 == fstat(fd, &st)) && (st.st_size > (off_t)sizeof(SENCBinHeader)))
+      {
+            void *p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if(p != MAP_FAILED)
+            {
+                  close(fd);
+                  *plen = st.st_size;
+                  *pbmapped = true;
+                  return (char *)p;
+            }
+      }
+      close(fd);
+#endif
 
-                if(my_fgets(buf, MAX_LINE, fpx) == 0)
-                {
-                        dun = 1;
-                        break;
-                }
+      wxFile file(path);
+      if(!file.IsOpened())
+            return NULL;
 
-                if(!strncmp(buf, "OGRF", 4))
-                {
-                      //  Debug Hook
-//                      if(!strncmp(buf, "OGRFeature(SOUNDG)", 16))
-//                            int yyo = 6;
+      wxFileOffset length = file.Length();
+      if(length <= (wxFileOffset)sizeof(SENCBinHeader))
+            return NULL;
 
-                    S57Obj *obj = new S57Obj(buf, &fpx, 0, 0);
-                    if(obj)
-                    {
+      char *p = (char *)malloc(length);
+      if(p && (file.Read(p, length) != length))
+      {
+            free(p);
+            p = NULL;
+      }
 
-//      Build/Maintain the ATON floating/rigid arrays
-                         if (GEO_POINT == obj->Primitive_type)
-                         {
+      if(p)
+            *plen = length;
+      return p;
+}
 
-// set floating platform
-                            if ((!strncmp(obj->FeatureName, "LITFLT", 6)) ||
-                                (!strncmp(obj->FeatureName, "LITVES", 6)) ||
-                                (!strncmp(obj->FeatureName, "BOY",    3)))
-                            {
-                                pFloatingATONArray->Add(obj);
-                            }
+void s57chart::ReleaseSENCBinary(void)
+{
+      if(!m_pSENCBin)
+            return;
 
-// set rigid platform
-                            if (!strncmp(obj->FeatureName, "BCN",    3))
-                            {
-                                pRigidATONArray->Add(obj);
-                            }
+#ifndef __WXMSW__
+      if(m_bSENCBin_mapped)
+            munmap(m_pSENCBin, m_SENCBin_len);
+      else
+#endif
+            free(m_pSENCBin);
 
+      m_pSENCBin = NULL;
+      m_SENCBin_len = 0;
+      m_bSENCBin_mapped = false;
+}
 
-                        //    Mark the object as an ATON
-                            if ((!strncmp(obj->FeatureName,   "LIT",    3)) ||
-                               (!strncmp(obj->FeatureName, "LIGHTS", 6)) ||
-                               (!strncmp(obj->FeatureName, "BCN",    3)) ||
-                               (!strncmp(obj->FeatureName, "BOY",    3)))
-                            {
-                               obj->bIsAton = true;
-                            }
+//    Write the binary form of a freshly parsed text SENC, before any rules are attached
+bool s57chart::WriteSENCBinary(const wxString& BinPath, const wxFileName& SENCFileName, ListOfS57Obj &obj_list,
+                               const wxString &date_000, const wxString &date_upd)
+{
+      wxInt32 mtime, size;
+      if(!GetSENCBinKey(SENCFileName, &mtime, &size))
+            return false;
 
-                         }
+      wxString tmp_file = BinPath + _T(".tmp");
+      SENCBinWriter out(tmp_file);
+      if(!out.IsOk())
+            return false;
 
+      SENCBinHeader hdr;
+      memset(&hdr, 0, sizeof(hdr));
+      out.Put(&hdr, sizeof(hdr));                     // completed at the end
 
-//      This is where Simplified or Paper-Type point features are selected
-                         switch(obj->Primitive_type)
-                         {
-                            case GEO_POINT:
-                            case GEO_META:
-                            case GEO_PRIM:
+      wxMemoryBuffer obj_table;
+      int nobjects = 0;
 
-                                if(PAPER_CHART == ps52plib->m_nSymbolStyle)
-                                    LUP_Name = PAPER_CHART;
-                                else
-                                    LUP_Name = SIMPLIFIED;
+      ListOfS57ObjNode *node = obj_list.GetFirst();
+      while(node && out.IsOk())
+      {
+            S57Obj *obj = node->GetData();
+
+            SENCBinObject rec;
+            memset(&rec, 0, sizeof(rec));
+            memcpy(rec.feature_name, obj->FeatureName, sizeof(rec.feature_name));
+            rec.primitive_type = obj->Primitive_type;
+            rec.index = obj->Index;
+            rec.npt = obj->npt;
+            rec.scamin = obj->Scamin;
+            rec.n_lsindex = obj->m_n_lsindex;
+            rec.x = obj->x;
+            rec.y = obj->y;
+            rec.z = obj->z;
+            rec.lat = obj->m_lat;
+            rec.lon = obj->m_lon;
+            rec.bbox[0] = obj->BBObj.GetMinX();
+            rec.bbox[1] = obj->BBObj.GetMinY();
+            rec.bbox[2] = obj->BBObj.GetMaxX();
+            rec.bbox[3] = obj->BBObj.GetMaxY();
+            if(obj->bBBObj_valid)
+                  rec.flags |= SENC_BIN_OBJ_BBOX_VALID;
+            if(obj->bIsAssociable)
+                  rec.flags |= SENC_BIN_OBJ_ASSOCIABLE;
+
+            //    Attributes, named in the order of attList
+            rec.attr_offset = out.Length();
+            if(obj->attList && obj->attVal)
+            {
+                  wxCharBuffer names = obj->attList->mb_str(wxConvUTF8);
+                  const char *pname = names.data();
 
-                                break;
+                  for(unsigned int iv = 0 ; iv < obj->attVal->GetCount() ; iv++)
+                  {
+                        S57attVal *pval = obj->attVal->Item(iv);
 
-                             case GEO_LINE:
-                                 LUP_Name = LINES;
-                                 break;
+                        SENCBinAttr att;
+                        memset(&att, 0, sizeof(att));
 
-                             case GEO_AREA:
-                                 if(PLAIN_BOUNDARIES == ps52plib->m_nBoundaryStyle)
-                                     LUP_Name = PLAIN_BOUNDARIES;
-                                 else
-                                     LUP_Name = SYMBOLIZED_BOUNDARIES;
+                        const char *pend = strchr(pname, '\037');
+                        size_t nlen = pend ? (size_t)(pend - pname) : strlen(pname);
+                        memcpy(att.name, pname, wxMin(nlen, sizeof(att.name) - 1));
+                        pname += pend ? nlen + 1 : nlen;
 
-                                 break;
-                         }
+                        att.type = pval->valType;
+                        switch(pval->valType)
+                        {
+                              case OGR_INT:     att.len = sizeof(int);                          break;
+                              case OGR_REAL:    att.len = sizeof(double);                       break;
+                              case OGR_STR:     att.len = strlen((char *)pval->value) + 1;      break;
+                              default:          att.len = 0;                                    break;
+                        }
 
- // Debug hooks
-//        if(!strncmp(obj->FeatureName, "_m_sor", 6))
-//            int ffl = 4;
-//    if(obj->Index == 311)
-//        int rrt = 5;
+                        out.Put(&att, sizeof(att));
+                        out.Put(pval->value, att.len);
+                        rec.nattr++;
+                  }
+            }
 
-                         LUP = ps52plib->S52_LUPLookup(LUP_Name, obj->FeatureName, obj);
+            //    Point, line and multipoint geometry
+            rec.geom_offset = out.Length();
+            if(obj->geoPtz && obj->geoPtMulti)
+            {
+                  rec.flags |= SENC_BIN_OBJ_MULTI;
+                  out.Put(obj->geoPtz, obj->npt * 3 * sizeof(double));
+                  out.Put(obj->geoPtMulti, obj->npt * 2 * sizeof(double));
+            }
+            else if(obj->geoPt)
+            {
+                  rec.flags |= SENC_BIN_OBJ_GEOPT;
+                  out.Put(obj->geoPt, obj->npt * sizeof(pt));
+            }
 
-                         if(NULL == LUP)
-                         {
-                               if(g_bDebugS57)
-                               {
-                                    wxString msg(obj->FeatureName, wxConvUTF8);
-                                    msg.Prepend(_T("   Could not find LUP for "));
-                                    LogMessageOnce(msg);
-                               }
-                               delete obj;
-                         }
-                         else
-                         {
-//              Convert LUP to rules set
-                            ps52plib->_LUP2rules(LUP, obj);
+            rec.lsindex_offset = out.Length();
+            if(obj->m_lsindex_array)
+                  out.Put(obj->m_lsindex_array, 3 * obj->m_n_lsindex * sizeof(int));
+            else
+                  rec.n_lsindex = 0;
 
-//              Add linked object/LUP to the working set
-                            _insertRules(obj,LUP, this);
+            //    Tesselated area geometry
+            if(obj->pPolyTessGeo)
+            {
+                  PolyTessGeo *ppg = obj->pPolyTessGeo;
+                  PolyTriGroup *ptg = ppg->Get_PolyTriGroup_head();
+
+                  SENCBinPoly poly;
+                  memset(&poly, 0, sizeof(poly));
+                  poly.xmin = ppg->Get_xmin();
+                  poly.ymin = ppg->Get_ymin();
+                  poly.xmax = ppg->Get_xmax();
+                  poly.ymax = ppg->Get_ymax();
+                  poly.ncontours = ptg->nContours;
+                  poly.nwkb = ppg->GetnWKB();
+                  poly.nvertex_max = ppg->GetnVertexMax();
+                  poly.bsmsenc = ptg->m_bSMSENC;
+
+                  poly.triprim_offset = out.Length();
+                  TriPrim *tp = ptg->tri_prim_head;
+                  while(tp)
+                  {
+                        SENCBinTriPrim tpr;
+                        tpr.type = tp->type;
+                        tpr.nvert = tp->nVert;
+                        tpr.bbox[0] = tp->p_bbox->GetMinX();
+                        tpr.bbox[1] = tp->p_bbox->GetMinY();
+                        tpr.bbox[2] = tp->p_bbox->GetMaxX();
+                        tpr.bbox[3] = tp->p_bbox->GetMaxY();
+
+                        out.Put(&tpr, sizeof(tpr));
+                        out.Put(tp->p_vertex, tp->nVert * 2 * sizeof(double));
+                        poly.ntriprim++;
+
+                        tp = tp->p_next;
+                  }
 
-//              Establish Object's Display Category
-                            obj->m_DisplayCat = LUP->DISC;
-                         }
+                  poly.contour_offset = out.Put(ptg->pn_vertex, ptg->nContours * sizeof(int));
+                  poly.geom_offset = out.Put(ptg->pgroup_geom, poly.nwkb);
+
+                  rec.poly_offset = out.Put(&poly, sizeof(poly));
+            }
+
+            wxInt64 rec_offset = out.Put(&rec, sizeof(rec));
+            obj_table.AppendData(&rec_offset, sizeof(rec_offset));
+            nobjects++;
+
+            node = node->GetNext();
+      }
+
+      hdr.obj_table = out.Put(obj_table.GetData(), obj_table.GetDataLen());
+
+      //    Edge and connected node tables
+      wxMemoryBuffer ve_table;
+      VE_Hash::iterator it;
+      for( it = m_ve_hash.begin(); it != m_ve_hash.end(); ++it )
+      {
+            VE_Element *pve = it->second;
+
+            SENCBinVE ver;
+            ver.index = pve->index;
+            ver.count = pve->nCount;
+            ver.points_offset = out.Put(pve->pPoints, pve->nCount * 2 * sizeof(double));
+            ve_table.AppendData(&ver, sizeof(ver));
+      }
+      hdr.ve_table = out.Put(ve_table.GetData(), ve_table.GetDataLen());
+
+      wxMemoryBuffer vc_table;
+      VC_Hash::iterator itc;
+      for( itc = m_vc_hash.begin(); itc != m_vc_hash.end(); ++itc )
+      {
+            VC_Element *pvc = itc->second;
+
+            SENCBinVC vcr;
+            vcr.index = pvc->index;
+            vcr.pad = 0;
+            vcr.point[0] = pvc->pPoint[0];
+            vcr.point[1] = pvc->pPoint[1];
+            vc_table.AppendData(&vcr, sizeof(vcr));
+      }
+      hdr.vc_table = out.Put(vc_table.GetData(), vc_table.GetDataLen());
+
+      memcpy(hdr.sig, "OCPNSENB", 8);
+      hdr.bin_version = SENC_BIN_VERSION;
+      hdr.senc_version = CURRENT_SENC_FORMAT_VERSION;
+      hdr.senc_mtime = mtime;
+      hdr.senc_size = size;
+      hdr.byte_order = SENC_BIN_BYTE_ORDER;
+      hdr.scale = m_Chart_Scale;
+      hdr.nobjects = nobjects;
+      hdr.nve = m_ve_hash.size();
+      hdr.nvc = m_vc_hash.size();
+      hdr.file_length = out.Length();
+      strncpy(hdr.name, m_Name.mb_str(wxConvUTF8), sizeof(hdr.name) - 1);
+      strncpy(hdr.date000, date_000.mb_str(wxConvUTF8), sizeof(hdr.date000) - 1);
+      strncpy(hdr.dateupd, date_upd.mb_str(wxConvUTF8), sizeof(hdr.dateupd) - 1);
+
+      out.PutAt(0, &hdr, sizeof(hdr));
+
+      bool bok = out.IsOk();
+      out.Close();
+
+      if(bok)
+            bok = ::wxRenameFile(tmp_file, BinPath);
+
+      if(!bok)
+      {
+            ::wxRemoveFile(tmp_file);
+
+            wxString msg(_T("   Cannot write binary SENC file "));
+            msg.Append(BinPath);
+            wxLogMessage(msg);
+      }
+
+      return bok;
+}
+
+//    Build the objects and edge tables of the chart in place on a binary SENC.
+//    Returns non-zero, with nothing loaded, if the file is missing, stale or damaged.
+int s57chart::LoadSENCBinary(const wxString& BinPath, const wxFileName& SENCFileName, ListOfS57Obj &obj_list,
+                             wxString &date_000, wxString &date_upd)
+{
+      wxInt32 mtime, size;
+      if(!GetSENCBinKey(SENCFileName, &mtime, &size))
+            return 1;
+
+      size_t len;
+      bool bmapped;
+      char *base = MapSENCBinFile(BinPath, &len, &bmapped);
+      if(!base)
+            return 1;
+
+      m_pSENCBin = base;
+      m_SENCBin_len = len;
+      m_bSENCBin_mapped = bmapped;
+
+#define SENC_BIN_FITS(off, n)  (((off) >= 0) && ((wxUint64)(off) + (wxUint64)(n) <= (wxUint64)len))
+
+      SENCBinHeader *phdr = (SENCBinHeader *)base;
+      if(strncmp(phdr->sig, "OCPNSENB", 8) || (phdr->bin_version != SENC_BIN_VERSION)
+         || (phdr->senc_version != CURRENT_SENC_FORMAT_VERSION) || (phdr->byte_order != SENC_BIN_BYTE_ORDER)
+         || (phdr->senc_mtime != mtime) || (phdr->senc_size != size) || (phdr->file_length != (wxInt64)len)
+         || (phdr->nobjects < 0) || (phdr->nve < 0) || (phdr->nvc < 0)
+         || !SENC_BIN_FITS(phdr->obj_table, phdr->nobjects * sizeof(wxInt64))
+         || !SENC_BIN_FITS(phdr->ve_table, phdr->nve * sizeof(SENCBinVE))
+         || !SENC_BIN_FITS(phdr->vc_table, phdr->nvc * sizeof(SENCBinVC)))
+      {
+            wxString msg(_T("   Rebuilding binary SENC file "));
+            msg.Append(BinPath);
+            wxLogMessage(msg);
+
+            ReleaseSENCBinary();
+            return 1;
+      }
+
+      bool bok = true;
+
+      wxInt64 *obj_table = (wxInt64 *)(base + phdr->obj_table);
+      for(int iobj = 0 ; bok && (iobj < phdr->nobjects) ; iobj++)
+      {
+            if(!SENC_BIN_FITS(obj_table[iobj], sizeof(SENCBinObject)))
+            {
+                  bok = false;
+                  break;
+            }
+
+            SENCBinObject *prec = (SENCBinObject *)(base + obj_table[iobj]);
+
+            S57Obj *obj = new S57Obj();
+            obj->bIsMapped = true;
+            obj->attList = new wxString();
+            obj->attVal = new wxArrayOfS57attVal();
+            obj_list.Append(obj);
+
+            memcpy(obj->FeatureName, prec->feature_name, sizeof(obj->FeatureName));
+            obj->FeatureName[sizeof(obj->FeatureName) - 1] = 0;
+            obj->Primitive_type = (GeoPrim_t)prec->primitive_type;
+            obj->iOBJL = -1;
+            obj->Index = prec->index;
+            obj->npt = prec->npt;
+            obj->Scamin = prec->scamin;
+            obj->x = prec->x;
+            obj->y = prec->y;
+            obj->z = prec->z;
+            obj->m_lat = prec->lat;
+            obj->m_lon = prec->lon;
+            obj->BBObj.SetMin(prec->bbox[0], prec->bbox[1]);
+            obj->BBObj.SetMax(prec->bbox[2], prec->bbox[3]);
+            obj->bBBObj_valid = (prec->flags & SENC_BIN_OBJ_BBOX_VALID) != 0;
+            obj->bIsAssociable = (prec->flags & SENC_BIN_OBJ_ASSOCIABLE) != 0;
+
+            //    Attributes
+            wxInt64 att_offset = prec->attr_offset;
+            for(int ia = 0 ; ia < prec->nattr ; ia++)
+            {
+                  if(!SENC_BIN_FITS(att_offset, sizeof(SENCBinAttr)))
+                  {
+                        bok = false;
+                        break;
+                  }
+
+                  SENCBinAttr *patt = (SENCBinAttr *)(base + att_offset);
+                  if((patt->len < 0) || !SENC_BIN_FITS(att_offset + sizeof(SENCBinAttr), patt->len))
+                  {
+                        bok = false;
+                        break;
+                  }
+
+                  patt->name[sizeof(patt->name) - 1] = 0;
+                  obj->attList->Append(wxString(patt->name, wxConvUTF8));
+                  obj->attList->Append('\037');
+
+                  S57attVal *pattValTmp = new S57attVal;
+                  pattValTmp->valType = (OGRatt_t)patt->type;
+                  pattValTmp->value = (void *)(patt + 1);
+                  obj->attVal->Add(pattValTmp);
+
+                  att_offset += sizeof(SENCBinAttr) + SENC_BIN_ALIGN(patt->len);
+            }
+
+            //    Point, line and multipoint geometry
+            if(prec->npt < 0)
+                  bok = false;
+            else if(prec->flags & SENC_BIN_OBJ_MULTI)
+            {
+                  if(SENC_BIN_FITS(prec->geom_offset, prec->npt * 5 * sizeof(double)))
+                  {
+                        obj->geoPtz = (double *)(base + prec->geom_offset);
+                        obj->geoPtMulti = obj->geoPtz + (3 * prec->npt);
+                  }
+                  else
+                        bok = false;
+            }
+            else if(prec->flags & SENC_BIN_OBJ_GEOPT)
+            {
+                  if(SENC_BIN_FITS(prec->geom_offset, prec->npt * sizeof(pt)))
+                        obj->geoPt = (pt *)(base + prec->geom_offset);
+                  else
+                        bok = false;
+            }
+
+            //    Edge and connected node indices
+            if(prec->n_lsindex)
+            {
+                  if((prec->n_lsindex > 0) && SENC_BIN_FITS(prec->lsindex_offset, 3 * prec->n_lsindex * sizeof(int)))
+                  {
+                        obj->m_n_lsindex = prec->n_lsindex;
+                        obj->m_lsindex_array = (int *)(base + prec->lsindex_offset);
+                  }
+                  else
+                        bok = false;
+            }
+
+            //    Tesselated area geometry
+            if(bok && prec->poly_offset)
+            {
+                  SENCBinPoly *ppoly = (SENCBinPoly *)(base + prec->poly_offset);
+                  if(!SENC_BIN_FITS(prec->poly_offset, sizeof(SENCBinPoly))
+                     || (ppoly->ncontours < 0) || (ppoly->nwkb < 0) || (ppoly->ntriprim < 0)
+                     || !SENC_BIN_FITS(ppoly->contour_offset, ppoly->ncontours * sizeof(int))
+                     || !SENC_BIN_FITS(ppoly->geom_offset, ppoly->nwkb))
+                  {
+                        bok = false;
+                        break;
+                  }
+
+                  PolyTriGroup *ptg = new PolyTriGroup;
+                  ptg->m_bMapped = true;
+                  ptg->m_bSMSENC = (ppoly->bsmsenc != 0);
+                  ptg->nContours = ppoly->ncontours;
+                  ptg->pn_vertex = (int *)(base + ppoly->contour_offset);
+                  ptg->pgroup_geom = (float *)(base + ppoly->geom_offset);
+
+                  obj->pPolyTessGeo = new PolyTessGeo(ptg, ppoly->xmin, ppoly->ymin, ppoly->xmax, ppoly->ymax,
+                                                      ppoly->nwkb, ppoly->nvertex_max);
+
+                  TriPrim **p_prev_triprim = &(ptg->tri_prim_head);
+                  wxInt64 tp_offset = ppoly->triprim_offset;
+                  for(int itp = 0 ; itp < ppoly->ntriprim ; itp++)
+                  {
+                        SENCBinTriPrim *ptpr = (SENCBinTriPrim *)(base + tp_offset);
+                        if(!SENC_BIN_FITS(tp_offset, sizeof(SENCBinTriPrim)) || (ptpr->nvert < 0)
+                           || !SENC_BIN_FITS(tp_offset + sizeof(SENCBinTriPrim), ptpr->nvert * 2 * sizeof(double)))
+                        {
+                              bok = false;
+                              break;
+                        }
+
+                        TriPrim *tp = new TriPrim;
+                        *p_prev_triprim = tp;
+                        p_prev_triprim = &(tp->p_next);
+                        tp->p_next = NULL;
+
+                        tp->type = ptpr->type;
+                        tp->nVert = ptpr->nvert;
+                        tp->p_vertex = (double *)(ptpr + 1);
+                        tp->p_bbox = new wxBoundingBox;
+                        tp->p_bbox->SetMin(ptpr->bbox[0], ptpr->bbox[1]);
+                        tp->p_bbox->SetMax(ptpr->bbox[2], ptpr->bbox[3]);
+
+                        tp_offset += sizeof(SENCBinTriPrim) + (ptpr->nvert * 2 * sizeof(double));
+                  }
+            }
+      }
+
+      //    Edge and connected node tables
+      SENCBinVE *pver = (SENCBinVE *)(base + phdr->ve_table);
+      for(int i = 0 ; bok && (i < phdr->nve) ; i++, pver++)
+      {
+            if((pver->count < 0) || !SENC_BIN_FITS(pver->points_offset, pver->count * 2 * sizeof(double)))
+            {
+                  bok = false;
+                  break;
+            }
+
+            VE_Element *vep = new VE_Element;
+            vep->index = pver->index;
+            vep->nCount = pver->count;
+            vep->pPoints = pver->count ? (double *)(base + pver->points_offset) : NULL;
+            vep->max_priority = -99;
+
+            m_ve_hash[vep->index] = vep;
+      }
+
+      SENCBinVC *pvcr = (SENCBinVC *)(base + phdr->vc_table);
+      for(int i = 0 ; bok && (i < phdr->nvc) ; i++, pvcr++)
+      {
+            VC_Element *vcp = new VC_Element;
+            vcp->index = pvcr->index;
+            vcp->pPoint = pvcr->point;
+
+            m_vc_hash[vcp->index] = vcp;
+      }
+
+#undef SENC_BIN_FITS
+
+      if(!bok)
+      {
+            wxString msg(_T("   Damaged binary SENC file "));
+            msg.Append(BinPath);
+            wxLogMessage(msg);
+
+            //    Undo the partial load, the objects do not free their mapped parts
+            ListOfS57ObjNode *node = obj_list.GetFirst();
+            while(node)
+            {
+                  delete node->GetData();
+                  node = node->GetNext();
+            }
+            obj_list.Clear();
+
+            VE_Hash::iterator it;
+            for( it = m_ve_hash.begin(); it != m_ve_hash.end(); ++it )
+                  delete it->second;
+            m_ve_hash.clear();
+
+            VC_Hash::iterator itc;
+            for( itc = m_vc_hash.begin(); itc != m_vc_hash.end(); ++itc )
+                  delete itc->second;
+            m_vc_hash.clear();
+
+            ReleaseSENCBinary();
+            return 1;
+      }
+
+      phdr->name[sizeof(phdr->name) - 1] = 0;
+      phdr->date000[sizeof(phdr->date000) - 1] = 0;
+      phdr->dateupd[sizeof(phdr->dateupd) - 1] = 0;
+
+      m_Name = wxString(phdr->name, wxConvUTF8);
+      m_Chart_Scale = phdr->scale;
+      date_000 = wxString(phdr->date000, wxConvUTF8);
+      date_upd = wxString(phdr->dateupd, wxConvUTF8);
+
+      return 0;
+}
+
+//    Parse a text SENC into unattached objects and the edge tables of the chart
+int s57chart::LoadSENCText(const wxString& FullPath, ListOfS57Obj &obj_list, wxString &date_000, wxString &date_upd)
+{
+        int ret_val = 0;                    // default is OK
+
+        int nProg = 0;
+
+        //    Read the whole SENC file with one read, and parse it from memory.
+        //    Very large files fall back to a buffered file stream.
+        char *senc_data = NULL;
+        wxFileOffset senc_length = 0;
+        {
+              wxFile senc_file(FullPath);
+              if(senc_file.IsOpened())
+                    senc_length = senc_file.Length();
+
+              if((senc_length > 0) && (senc_length < SENC_MEMORY_LOAD_MAX))
+              {
+                    senc_data = (char *)malloc(senc_length);
+                    if(senc_data && (senc_file.Read(senc_data, senc_length) != senc_length))
+                    {
+                          free(senc_data);
+                          senc_data = NULL;
                     }
+              }
+        }
+
+        wxInputStream *pfpx;
+        wxFileInputStream *pfpx_u = NULL;
+        if(senc_data)
+              pfpx = new wxMemoryInputStream(senc_data, senc_length);
+        else
+        {
+              pfpx_u = new wxFileInputStream(FullPath);
+              pfpx = new wxBufferedInputStream(*pfpx_u);
+        }
+        wxInputStream &fpx = *pfpx;
+
+        int MAX_LINE = 499999;
+        char *buf = (char *)malloc(MAX_LINE + 1);
+
+        //    Line and record buffer shared by the objects of this load only,
+        //    released when the load returns
+        wxMemoryBuffer obj_scratch;
+
+        int     nGeoFeature;
+
+        int object_count = 0;
+
+        int dun = 0;
+
+        hdr_buf = (char *)malloc(1);
+        wxProgressDialog    *SENC_prog = NULL;
+        int nGeo1000 = 0;
+
+
+        while(!dun)
+        {
+
+                if(my_fgets(buf, MAX_LINE, fpx) == 0)
+                {
+                        dun = 1;
+                        break;
+                }
 
+                if(!strncmp(buf, "OGRF", 4))
+                {
+                    S57Obj *obj = new S57Obj(buf, &fpx, obj_scratch, 0, 0);
+                    if(obj)
+                          obj_list.Append(obj);
 
                     object_count++;
 
@@ -4954,7 +6324,7 @@ int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
                  if(senc_file_version != CURRENT_SENC_FORMAT_VERSION)
                  {
                        wxString msg(_T("   Wrong version on SENC file "));
-                       msg.Append(SENCFileName.GetFullPath());
+                       msg.Append(FullPath);
                        wxLogMessage(msg);
 
                        dun = 1;
@@ -5003,7 +6373,9 @@ int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
         }                       //while(!dun)
 
 
-//      fclose(fpx);
+        delete pfpx;
+        delete pfpx_u;
+        free(senc_data);
 
         free(buf);
 
@@ -5011,6 +6383,56 @@ int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
 
         delete SENC_prog;
 
+        return ret_val;
+}
+
+//    Read the SENC into the unattached object list and the edge tables of the chart.
+//    Uses neither GDI nor the S52 library, so that it may run on a worker thread.
+int s57chart::LoadSENCObjects( const wxString& FullPath )
+{
+      int ret_val = 0;                    // default is OK
+
+      //    Sanity check for existence of file
+      wxFileName SENCFileName( FullPath );
+      if(!SENCFileName.FileExists())
+      {
+            wxString msg(_T("   Cannot open SENC file "));
+            msg.Append(SENCFileName.GetFullPath());
+            wxLogMessage(msg);
+
+            return 1;
+      }
+
+      //    Use the binary form of the SENC in place, or make it from the text SENC
+      wxString date_000, date_upd;
+
+      wxFileName BinFileName(SENCFileName);
+      BinFileName.SetExt(_T("S5B"));
+
+      ret_val = 1;
+      if(BinFileName.FileExists())
+            ret_val = LoadSENCBinary(BinFileName.GetFullPath(), SENCFileName, m_SENCObjList, date_000, date_upd);
+
+      if(ret_val)
+      {
+            ret_val = LoadSENCText(FullPath, m_SENCObjList, date_000, date_upd);
+            if(0 == ret_val)
+                  WriteSENCBinary(BinFileName.GetFullPath(), SENCFileName, m_SENCObjList, date_000, date_upd);
+      }
+
+      if(ret_val)
+      {
+            ListOfS57ObjNode *node = m_SENCObjList.GetFirst();
+            while(node)
+            {
+                  delete node->GetData();
+                  node = node->GetNext();
+            }
+            m_SENCObjList.Clear();
+
+            return ret_val;
+      }
+
  //   Decide on pub date to show
 
         int d000 = atoi((date_000/*(wxString((const wchar_t *)date_000, wxConvUTF8)*/.Mid(0,4)).mb_str());
@@ -5038,104 +6460,175 @@ int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
 
       // Validate hash maps....
 
-      ObjRazRules *top;
-      ObjRazRules *nxx;
-
-      for (int i=0; i<PRIO_NUM; ++i)
+      ListOfS57ObjNode *node = m_SENCObjList.GetFirst();
+      while(node)
       {
-            for(int j=0 ; j<LUPNAME_NUM ; j++)
+            S57Obj *obj = node->GetData();
+
+            for ( int iseg=0 ; iseg < obj->m_n_lsindex ; iseg++ )
             {
-                  top = razRules[i][j];
-                  while ( top != NULL)
-                  {
-                        S57Obj *obj = top->obj;
+                  int seg_index = iseg * 3;
+                  int *index_run = &obj->m_lsindex_array[seg_index];
 
-///
-                        for ( int iseg=0 ; iseg < obj->m_n_lsindex ; iseg++ )
+      //  Get first connected node
+                  int inode = *index_run++;
+                  if (( inode >= 0 ))
+                  {
+                        if(m_vc_hash.find( inode ) == m_vc_hash.end())
                         {
-                              int seg_index = iseg * 3;
-                              int *index_run = &obj->m_lsindex_array[seg_index];
-
-                  //  Get first connected node
-                              int inode = *index_run++;
-                              if (( inode >= 0 ))
-                              {
-                                    if(m_vc_hash.find( inode ) == m_vc_hash.end())
-                                    {
-                                          //    Must be a bad index in the SENC file
-                                          //    Stuff a recognizable flag to indicate invalidity
-                                          index_run--;
-                                          *index_run = -1;
-                                          index_run++;
-                                    }
-                              }
-
-                  //  Get the edge
-//                              int enode = *index_run++;
+                              //    Must be a bad index in the SENC file
+                              //    Stuff a recognizable flag to indicate invalidity
+                              index_run--;
+                              *index_run = -1;
                               index_run++;
+                        }
+                  }
 
-                  //  Get last connected node
-                              int jnode = *index_run++;
-                              if (( jnode >= 0 ))
-                              {
-                                    if(m_vc_hash.find( jnode ) == m_vc_hash.end())
-                                    {
-                                          //    Must be a bad index in the SENC file
-                                          //    Stuff a recognizable flag to indicate invalidity
-                                          index_run--;
-                                          *index_run = -2;
-                                          index_run++;
-                                    }
+      //  Get the edge
+//                              int enode = *index_run++;
+                  index_run++;
 
-                              }
+      //  Get last connected node
+                  int jnode = *index_run++;
+                  if (( jnode >= 0 ))
+                  {
+                        if(m_vc_hash.find( jnode ) == m_vc_hash.end())
+                        {
+                              //    Must be a bad index in the SENC file
+                              //    Stuff a recognizable flag to indicate invalidity
+                              index_run--;
+                              *index_run = -2;
+                              index_run++;
                         }
-///
-                        nxx  = top->next;
-                        top = nxx;
+
                   }
             }
-      }
-
 
+            node = node->GetNext();
+      }
 
       return ret_val;
 }
 
-//------------------------------------------------------------------------------
-//      Local version of fgets for Binary Mode (SENC) file
-//------------------------------------------------------------------------------
- int s57chart::my_fgets( char *buf, int buf_len_max, wxInputStream& ifs )
-
+//    Attach the S52 rules to the objects read by LoadSENCObjects(), on the UI thread
+void s57chart::AttachSENCObjects(void)
 {
-    char        chNext;
-    int         nLineLen = 0;
-    char            *lbuf;
+      LUPrec           *LUP;
+      LUPname          LUP_Name = PAPER_CHART;
 
-    lbuf = buf;
+      ListOfS57ObjNode *node = m_SENCObjList.GetFirst();
+      while(node)
+      {
+            S57Obj *obj = node->GetData();
+            node = node->GetNext();
 
+//      Build/Maintain the ATON floating/rigid arrays
+            if (GEO_POINT == obj->Primitive_type)
+            {
 
-    while( !ifs.Eof() && nLineLen < buf_len_max )
-    {
-        chNext = (char)ifs.GetC();
+// set floating platform
+                if ((!strncmp(obj->FeatureName, "LITFLT", 6)) ||
+                    (!strncmp(obj->FeatureName, "LITVES", 6)) ||
+                    (!strncmp(obj->FeatureName, "BOY",    3)))
+                {
+                    pFloatingATONArray->Add(obj);
+                }
 
-        /* each CR/LF (or LF/CR) as if just "CR" */
-        if( chNext == 10 || chNext == 13 )
-        {
-            chNext = '\n';
-        }
+// set rigid platform
+                if (!strncmp(obj->FeatureName, "BCN",    3))
+                {
+                    pRigidATONArray->Add(obj);
+                }
 
-        *lbuf = chNext; lbuf++, nLineLen++;
 
-        if( chNext == '\n' )
-        {
-            *lbuf = '\0';
-            return nLineLen;
-        }
-    }
+            //    Mark the object as an ATON
+                if ((!strncmp(obj->FeatureName,   "LIT",    3)) ||
+                   (!strncmp(obj->FeatureName, "LIGHTS", 6)) ||
+                   (!strncmp(obj->FeatureName, "BCN",    3)) ||
+                   (!strncmp(obj->FeatureName, "BOY",    3)))
+                {
+                   obj->bIsAton = true;
+                }
 
-    *(lbuf) = '\0';
+            }
 
-    return nLineLen;
+
+//      This is where Simplified or Paper-Type point features are selected
+            switch(obj->Primitive_type)
+            {
+                case GEO_POINT:
+                case GEO_META:
+                case GEO_PRIM:
+
+                    if(PAPER_CHART == ps52plib->m_nSymbolStyle)
+                        LUP_Name = PAPER_CHART;
+                    else
+                        LUP_Name = SIMPLIFIED;
+
+                    break;
+
+                 case GEO_LINE:
+                     LUP_Name = LINES;
+                     break;
+
+                 case GEO_AREA:
+                     if(PLAIN_BOUNDARIES == ps52plib->m_nBoundaryStyle)
+                         LUP_Name = PLAIN_BOUNDARIES;
+                     else
+                         LUP_Name = SYMBOLIZED_BOUNDARIES;
+
+                     break;
+            }
+
+ // Debug hooks
+//        if(!strncmp(obj->FeatureName, "_m_sor", 6))
+//            int ffl = 4;
+//    if(obj->Index == 311)
+//        int rrt = 5;
+
+            LUP = ps52plib->S52_LUPLookup(LUP_Name, obj->FeatureName, obj);
+
+            if(NULL == LUP)
+            {
+                  if(g_bDebugS57)
+                  {
+                       wxString msg(obj->FeatureName, wxConvUTF8);
+                       msg.Prepend(_T("   Could not find LUP for "));
+                       LogMessageOnce(msg);
+                  }
+                  delete obj;
+            }
+            else
+            {
+//              Convert LUP to rules set
+               ps52plib->_LUP2rules(LUP, obj);
+
+//              Add linked object/LUP to the working set
+               _insertRules(obj,LUP, this);
+
+//              Establish Object's Display Category
+               obj->m_DisplayCat = LUP->DISC;
+            }
+      }
+
+      m_SENCObjList.Clear();
+}
+
+int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
+{
+      int ret_val = LoadSENCObjects(FullPath);
+      if(0 == ret_val)
+            AttachSENCObjects();
+
+      return ret_val;
+}
+
+//------------------------------------------------------------------------------
+//      Local version of fgets for Binary Mode (SENC) file
+//------------------------------------------------------------------------------
+ int s57chart::my_fgets( char *buf, int buf_len_max, wxInputStream& ifs )
+{
+    return SENC_fgets(buf, buf_len_max, ifs);
 }
 
 
@@ -5189,9 +6682,62 @@ int s57chart::_insertRules(S57Obj *obj, LUPrec *LUP, s57chart *pOwner)
    rzRules->child = NULL;
    razRules[disPrioIdx][LUPtypeIdx] = rzRules;
 
+   //   The spatial index no longer matches the rule lists
+   delete m_pObjIndex;
+   m_pObjIndex = NULL;
+
    return 1;
 }
 
+//    Get the spatial index of the line and area rules, building it if needed
+S57ObjIndex *s57chart::GetObjIndex(void)
+{
+      if(!m_pObjIndex)
+      {
+            m_pObjIndex = new S57ObjIndex;
+
+            for(int i=0 ; i<PRIO_NUM ; i++)
+            {
+                  for(int j=2 ; j<LUPNAME_NUM ; j++)        // Lines, Plain and Symbolized boundary areas
+                  {
+                        ObjRazRules *top = razRules[i][j];
+                        while(top != NULL)
+                        {
+                              m_pObjIndex->AddRules(top, (i * LUPNAME_NUM) + j);
+                              top = top->next;
+                        }
+                  }
+            }
+
+            m_pObjIndex->Build();
+      }
+
+      return m_pObjIndex;
+}
+
+//    Find the line and area rules which may be visible in the viewport,
+//    grouped by priority and lookup type, in rendering order.
+//    The exact check is still done by s52plib::ObjectRenderCheckPos()
+void s57chart::QueryVisibleRules(ViewPort &vp, wxArrayInt &hits, int *pbucket_first)
+{
+      S57ObjIndex *pidx = GetObjIndex();
+
+      //    The index holds the object geometry extents.  Area and line text may
+      //    be rendered outside of these, so allow a generous pixel margin.
+      double margin = (256. / vp.view_scale_ppm) / (1852. * 60.);  //degrees
+
+      LLBBox &box = vp.GetBBox();
+      pidx->Query(box.GetMinX() - margin, box.GetMinY() - margin,
+                  box.GetMaxX() + margin, box.GetMaxY() + margin, hits);
+
+      //  Also pick up objects east of Greenwich if the viewport crosses it
+      if(box.GetMaxX() > 360.)
+            pidx->Query(-margin, box.GetMinY() - margin,
+                        box.GetMaxX() - 360. + margin, box.GetMaxY() + margin, hits, true);
+
+      pidx->GetBucketRanges(hits, pbucket_first);
+}
+
 void s57chart::ResetPointBBoxes(const ViewPort &vp_last, const ViewPort &vp_this)
 {
       ObjRazRules *top;
@@ -5257,6 +6803,8 @@ void s57chart::UpdateLUPs(s57chart *pOwner)
 
     for (int i=0; i<PRIO_NUM; ++i)
     {
+        bool b_relinked = false;
+
         //  SIMPLIFIED is set, PAPER_CHART is bare
         if((razRules[i][0]) && (NULL == razRules[i][1]))
         {
@@ -5269,6 +6817,7 @@ void s57chart::UpdateLUPs(s57chart *pOwner)
                 {
                   ps52plib->_LUP2rules(LUP, top->obj);
                   _insertRules(top->obj, LUP, pOwner);
+                  b_relinked = true;
                   top->obj->m_DisplayCat = LUP->DISC;
                 }
 
@@ -5289,6 +6838,7 @@ void s57chart::UpdateLUPs(s57chart *pOwner)
                 {
                       ps52plib->_LUP2rules(LUP, top->obj);
                       _insertRules(top->obj, LUP, pOwner);
+                      b_relinked = true;
                       top->obj->m_DisplayCat = LUP->DISC;
                 }
 
@@ -5309,6 +6859,7 @@ void s57chart::UpdateLUPs(s57chart *pOwner)
                 {
                       ps52plib->_LUP2rules(LUP, top->obj);
                       _insertRules(top->obj, LUP, pOwner);
+                      b_relinked = true;
                       top->obj->m_DisplayCat = LUP->DISC;
                 }
 
@@ -5329,6 +6880,7 @@ void s57chart::UpdateLUPs(s57chart *pOwner)
                 {
                       ps52plib->_LUP2rules(LUP, top->obj);
                       _insertRules(top->obj, LUP, pOwner);
+                      b_relinked = true;
                       top->obj->m_DisplayCat = LUP->DISC;
                 }
 
@@ -5337,6 +6889,11 @@ void s57chart::UpdateLUPs(s57chart *pOwner)
             }
         }
 
+        //  CS results are kept per object, keyed on the plib CS state,
+        //  so they only need to be discarded if objects were given new LUPs
+        if(!b_relinked)
+              continue;
+
         //  Traverse this priority level again,
         //  clearing any object CS rules and flags,
         //  so that the next render operation will re-evaluate the CS
@@ -6030,6 +7587,14 @@ ListOfObjRazRules *s57chart::GetObjRuleListAtLatLon(float lat, float lon, float
 
       ListOfObjRazRules *ret_ptr = new ListOfObjRazRules;
 
+//    Areas and lines near the cursor come from the spatial index
+
+    S57ObjIndex *pidx = GetObjIndex();
+    wxArrayInt hits;
+    int hit_first[OBJ_INDEX_BUCKETS + 1];
+    pidx->Query(lon - select_radius, lat - select_radius, lon + select_radius, lat + select_radius, hits);
+    pidx->GetBucketRanges(hits, hit_first);
+
 //    Iterate thru the razRules array, by object/rule type
 
     ObjRazRules *top;
@@ -6076,31 +7641,28 @@ ListOfObjRazRules *s57chart::GetObjRuleListAtLatLon(float lat, float lon, float
       // Areas by boundary type, array indices [3..4]
 
         int area_boundary_type = (ps52plib->m_nBoundaryStyle == PLAIN_BOUNDARIES) ? 3 : 4;
-        top = razRules[i][area_boundary_type];           // Area nnn Boundaries
-        while ( top != NULL)
+        int bucket = (i * LUPNAME_NUM) + area_boundary_type;           // Area nnn Boundaries
+        for(int ih = hit_first[bucket] ; ih < hit_first[bucket + 1] ; ih++)
         {
+            top = pidx->GetEntry(hits[ih])->rzRules;
             if(ps52plib->ObjectRenderCheck(top, VPoint))
             {
                   if(DoesLatLonSelectObject(lat, lon, select_radius, top->obj))
                         ret_ptr->Append(top);
             }
-
-            top  = top->next;
-        }         // while
+        }
 
 
       // Finally, lines
-          top = razRules[i][2];           // Lines
-
-          while ( top != NULL)
+          bucket = (i * LUPNAME_NUM) + 2;           // Lines
+          for(int ih = hit_first[bucket] ; ih < hit_first[bucket + 1] ; ih++)
           {
+            top = pidx->GetEntry(hits[ih])->rzRules;
             if(ps52plib->ObjectRenderCheck(top, VPoint))
             {
                   if(DoesLatLonSelectObject(lat, lon, select_radius, top->obj))
                         ret_ptr->Append(top);
             }
-
-            top  = top->next;
           }
       }
 